@@ -4309,6 +4309,7 @@ template zeroCrossingTpl(Integer index1, Exp relation, Text &varDecls, Text &aux
     <<
     <%preExp%>
     gout[<%index1%>] = (<%e1%>) ? 1 : -1;
+    <%zeroCrossingDistanceTpl(index1, exp)%>
     >>
   case (exp1 as LBINARY(__)) then
     let &preExp = buffer ""
@@ -4376,6 +4377,23 @@ template zeroCrossingTpl(Integer index1, Exp relation, Text &varDecls, Text &aux
     error(sourceInfo(), ' UNKNOWN ZERO CROSSING for <%index1%>')
 end zeroCrossingTpl;
 
+template zeroCrossingDistanceTpl(Integer index1, Exp relation)
+ "Generates code that stores the signed distance of a zero crossing which is a
+  single relation of reals. The relation is evaluated last in the zero crossing
+  with one of the hysteresis functions, which keeps the distance for the root
+  finding in events.c."
+::=
+  match relation
+  case rel as RELATION(__) then
+    let isReal = if intEq(rel.index,-1) then '' else (if isRealType(typeof(rel.exp1)) then (if isRealType(typeof(rel.exp2)) then 'true' else '') else '')
+    if isReal then
+      match rel.operator
+      case LESS(__)
+      case LESSEQ(__)
+      case GREATER(__)
+      case GREATEREQ(__) then 'ZC_DISTANCE(<%index1%>);'
+end zeroCrossingDistanceTpl;
+
 template functionRelations(list<ZeroCrossing> relations, String modelNamePrefix) "template functionRelations
   Generates function in simulation file.
   This is a helper of template simulationFile."
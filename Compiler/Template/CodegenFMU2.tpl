@@ -144,8 +144,8 @@ case SIMCODE(__) then
     canRunAsynchronuously = "false"
     canBeInstantiatedOnlyOncePerProcess="false"
     canNotUseMemoryManagementFunctions="false"
-    canGetAndSetFMUstate="false"
-    canSerializeFMUstate="false"
+    canGetAndSetFMUstate="<%canGetAndSetFMUstate()%>"
+    canSerializeFMUstate="<%canGetAndSetFMUstate()%>"
     <% if Flags.isSet(FMU_EXPERIMENTAL) then 'providesDirectionalDerivative="true"'%> />
   >>
 end CoSimulation;
@@ -61,12 +61,24 @@ case SIMCODE(__) then
   let pdd = providesDirectionalDerivative(simCode)
   <<
   <ModelExchange
-    modelIdentifier="<%modelIdentifier%>"<% if not pdd then '>' %>
+    modelIdentifier="<%modelIdentifier%>"
+    canGetAndSetFMUstate="<%canGetAndSetFMUstate()%>"
+    canSerializeFMUstate="<%canGetAndSetFMUstate()%>"<% if not pdd then '>' %>
     <% if pdd then 'providesDirectionalDerivative="' + pdd + '">' %>
   </ModelExchange>
   >>
 end ModelExchange;
 
+template canGetAndSetFMUstate()
+ "Returns true if the runtime of the code target can get, set and serialize the FMU state."
+::=
+  match Config.simCodeTarget()
+    case "C"
+    case "Cpp" then "true"
+    else "false"
+  end match
+end canGetAndSetFMUstate;
+
 template providesDirectionalDerivative(SimCode simCode)
  "Returns true if Jacobian is present, returns nothing otherwise"
 ::=
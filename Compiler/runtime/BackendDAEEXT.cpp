@@ -344,6 +344,11 @@ void BackendDAEExtImpl__matching(int nvars, int neqns, int matchingID, int cheap
     m = nvars;
   }
   if ((match != NULL) && (row_match != NULL)) {
+    /* Incremental matching: keep the pairs of the previous matching that are still edges
+     * (e.g. after index reduction) and only augment from the unmatched equations */
+    if (clear_match==0 && match_repair(col_ptrs,col_ids,match,row_match,neqns,nvars) > 0) {
+      cheapID = 0;
+    }
     matching(col_ptrs,col_ids,match,row_match,neqns,nvars,matchingID,cheapID,relabel_period,0 /*clear_match already done*/);
   }
 }
@@ -583,6 +583,209 @@ static const char* getTimeVarName(void *vars) {
 
 #include "SimulationResultsCmpTubes.c"
 
+/* Result of comparing one variable in a worker thread, merged in the order of the compared variables */
+typedef struct {
+  char *var;
+  int failed; /* 1 if the variable is not in the reference file, 2 if it is not in the result file */
+  int isdifferent;
+  DiffDataField ddf;
+} CmpVarResult;
+
+typedef struct {
+  pthread_mutex_t mutex;
+  unsigned int current;
+  unsigned int n;
+  CmpVarResult *results;
+  ModelicaMatReader *reader;
+  ModelicaMatReader *readerRef;
+  int isResultCmp;
+  DataField *time;
+  DataField *timeref;
+  int offset;
+  int offsetRef;
+  double reltol;
+  double abstol;
+  double reltolDiffMaxMin;
+  double rangeDelta;
+  int keepEqualResults;
+  const char *prefix;
+} CmpWorkerData;
+
+/* The variables can be read by several threads if all values are in memory,
+ * i.e. the data_2 matrix is memory-mapped or was read completely */
+static int canReadConcurrently(SimulationResult_Globals* srg)
+{
+  return srg->curFormat == MATLAB4 && (srg->matReader.data_2 || srg->matReader.readAll || srg->matReader.nrows == 0);
+}
+
+/* Like getData, but copies the values directly from the reader instead of going through a list */
+static DataField getDataConcurrent(const char *varname, ModelicaMatReader *reader)
+{
+  DataField res;
+  ModelicaMatVariable_t *var;
+  unsigned int i;
+  res.n = 0;
+  res.data = NULL;
+
+  var = omc_matlab4_find_var(reader, varname);
+  if (var == NULL || reader->nrows == 0) {
+    return res;
+  }
+  res.data = (double*) malloc(sizeof(double)*reader->nrows);
+  if (var->isParam) {
+    double val = (var->index<0) ? -reader->params[abs(var->index)-1] : reader->params[abs(var->index)-1];
+    for (i=0; i<reader->nrows; i++) {
+      res.data[i] = val;
+    }
+  } else if (omc_matlab4_read_vals_range(reader, var->index, 0, reader->nrows, res.data)) {
+    free(res.data);
+    res.data = NULL;
+    return res;
+  }
+  res.n = reader->nrows;
+  return res;
+}
+
+static void cmpVarConcurrent(CmpWorkerData *w, CmpVarResult *r)
+{
+  DataField data,dataref;
+  char *diffvar[1];
+  void *diffLst = mmc_mk_nil();
+  char *var1;
+  unsigned int j,k,len;
+
+  len = strlen(r->var);
+  var1 = (char*) malloc(len+1);
+  k = 0;
+  for (j=0;j<len;j++) {
+    if (r->var[j] !='\"' ) {
+      var1[k] = r->var[j];
+      k +=1;
+    }
+  }
+  var1[k] = 0;
+
+  dataref = getDataConcurrent(var1, w->readerRef);
+  if (dataref.n==0) {
+    r->failed = 1;
+    free(var1);
+    return;
+  }
+  data = getDataConcurrent(var1, w->reader);
+  free(var1);
+  if (data.n==0) {
+    r->failed = 2;
+    free(dataref.data);
+    return;
+  }
+  /* adjust initial data points */
+  for(j=w->offset; j>0; j--)
+    data.data[j-1] = data.data[j];
+  for(j=w->offsetRef; j>0; j--)
+    dataref.data[j-1] = dataref.data[j];
+  /* compare */
+  if (w->isResultCmp) {
+    r->isdifferent = cmpData(1,r->var,w->time,w->timeref,&data,&dataref,w->reltol,w->abstol,&r->ddf,diffvar,0,w->keepEqualResults,&diffLst,w->prefix);
+  } else {
+    r->isdifferent = cmpDataTubes(0,r->var,w->time,w->timeref,&data,&dataref,w->reltol,w->rangeDelta,w->reltolDiffMaxMin,&r->ddf,diffvar,0,w->keepEqualResults,&diffLst,w->prefix,0,0);
+  }
+  free(dataref.data);
+  free(data.data);
+}
+
+static void* cmpVarsWorkerThread(void *arg)
+{
+  CmpWorkerData *w = (CmpWorkerData*) arg;
+  while (1) {
+    unsigned int i;
+    pthread_mutex_lock(&w->mutex);
+    i = w->current++;
+    pthread_mutex_unlock(&w->mutex);
+    if (i >= w->n) break;
+    cmpVarConcurrent(w, &w->results[i]);
+  }
+  return NULL;
+}
+
+/* Compares the variables with numThreads threads (including the calling one). The results are
+ * merged in the order of cmpvars, so the messages and the output do not depend on the scheduling.
+ * outOfMemory is set if the differences could not be merged into ddf. */
+static unsigned int compareVarsParallel(int numThreads, CmpWorkerData *w, char **cmpvars, unsigned int ncmpvars, DiffDataField *ddf, char **cmpdiffvars, void **res, unsigned int *ngetfailedvars, int runningTestsuite, const char *filename, const char *reffilename, int *outOfMemory)
+{
+  unsigned int i,j,vardiffindx=0;
+  pthread_t *th;
+  int *started;
+  const char *msg[2] = {"",""};
+
+  w->results = (CmpVarResult*) calloc(ncmpvars, sizeof(CmpVarResult));
+  w->current = 0;
+  w->n = ncmpvars;
+  for (i=0;i<ncmpvars;i++) {
+    w->results[i].var = cmpvars[i];
+  }
+  pthread_mutex_init(&w->mutex,NULL);
+  th = (pthread_t*) malloc(sizeof(pthread_t)*numThreads);
+  started = (int*) calloc(numThreads, sizeof(int));
+  /* The calling thread is worker 0; if a thread cannot be created the others do its work */
+  for (i=1; i<numThreads; i++) {
+    started[i] = 0 == GC_pthread_create(&th[i],NULL,cmpVarsWorkerThread,w);
+  }
+  cmpVarsWorkerThread(w);
+  for (i=1; i<numThreads; i++) {
+    if (started[i]) {
+      GC_pthread_join(th[i], NULL);
+    }
+  }
+  free(started);
+  free(th);
+  pthread_mutex_destroy(&w->mutex);
+
+  for (i=0;i<ncmpvars;i++) {
+    CmpVarResult *r = &w->results[i];
+    if (r->failed) {
+      const char *file = r->failed == 1 ? reffilename : filename;
+      msg[0] = runningTestsuite ? SystemImpl__basename(file) : file;
+      msg[1] = r->var;
+      /* the messages getData gives in the serial comparison */
+      c_add_message(NULL,-1, ErrorType_scripting, ErrorLevel_error, gettext("Could not read variable %s in file %s."), msg, 2);
+      c_add_message(NULL,-1, ErrorType_scripting, ErrorLevel_warning, gettext("Get data of variable %s from file %s failed!\n"), msg, 2);
+      (*ngetfailedvars)++;
+      continue;
+    }
+    if (r->isdifferent) {
+      cmpdiffvars[vardiffindx++] = r->var;
+      if (!w->isResultCmp) {
+        *res = mmc_mk_cons(mmc_mk_scon(r->var),*res);
+      }
+    }
+    if (r->ddf.n > 0 && !*outOfMemory) {
+      if (ddf->n + r->ddf.n > ddf->n_max) {
+        DiffData *newData;
+        unsigned int n_max = ddf->n_max ? ddf->n_max : 1024;
+        while (n_max < ddf->n + r->ddf.n) n_max *= 2;
+        newData = (DiffData*) realloc(ddf->data, sizeof(DiffData)*n_max);
+        if (newData) {
+          ddf->data = newData;
+          ddf->n_max = n_max;
+        } else {
+          /* ddf->data is still valid and freed by the caller */
+          c_add_message(NULL,-1, ErrorType_scripting, ErrorLevel_error, gettext("Out of memory while merging the differences of the compared variables."), NULL, 0);
+          *outOfMemory = 1;
+        }
+      }
+      for (j=0; j<r->ddf.n && !*outOfMemory; j++) {
+        ddf->data[ddf->n++] = r->ddf.data[j];
+      }
+    }
+    if (r->ddf.data) {
+      free(r->ddf.data);
+    }
+  }
+  free(w->results);
+  w->results = NULL;
+  return vardiffindx;
+}
+
 /* Common, huge function, for both result comparison and result diff */
 void* SimulationResultsCmp_compareResults(int isResultCmp, int runningTestsuite, const char *filename, const char *reffilename, const char *resultfilename, double reltol, double abstol, double reltolDiffMaxMin, double rangeDelta, void *vars, int keepEqualResults, int *success, int isHtml, char **htmlOut)
 {
@@ -599,6 +802,8 @@ void* SimulationResultsCmp_compareResults(int isResultCmp, int runningTestsuite,
   const char *msg[2] = {"",""};
   const char *timeVarName, *timeVarNameRef;
   int suggestReadAll=0;
+  int numThreads;
+  int outOfMemory=0;
   ddf.data=NULL;
   ddf.n=0;
   ddf.n_max=0;
@@ -651,12 +856,13 @@ void* SimulationResultsCmp_compareResults(int isResultCmp, int runningTestsuite,
   /* fprintf(stderr, "get time\n"); */
   timeVarName = getTimeVarName(allvars);
   timeVarNameRef = getTimeVarName(allvarsref);
-  time = getData(timeVarName,filename,size,suggestReadAll,&simresglob_c,runningTestsuite);
+  /* a memory-mapped file does not need to be read completely */
+  time = getData(timeVarName,filename,size,suggestReadAll && !simresglob_c.matReader.data_2,&simresglob_c,runningTestsuite);
   if (time.n==0) {
     return mmc_mk_cons(mmc_mk_scon("Error get time!"),mmc_mk_nil());
   }
   /* fprintf(stderr, "get reftime\n"); */
-  timeref = getData(timeVarNameRef,reffilename,size_ref,suggestReadAll,&simresglob_ref,runningTestsuite);
+  timeref = getData(timeVarNameRef,reffilename,size_ref,suggestReadAll && !simresglob_ref.matReader.data_2,&simresglob_ref,runningTestsuite);
   if (timeref.n==0) {
     return mmc_mk_cons(mmc_mk_scon("Error get ref time!"),mmc_mk_nil());
   }
@@ -678,7 +884,30 @@ void* SimulationResultsCmp_compareResults(int isResultCmp, int runningTestsuite,
   for(offsetRef=0; offsetRef<timeref.n-1 && timeref.data[offsetRef] == timeref.data[offsetRef+1]; ++offsetRef);
   var1=NULL;
   var2=NULL;
-  /* compare vars */
+  /* compare vars, in parallel if both files can be read concurrently; the html output is for a single variable */
+  numThreads = System_numProcessors();
+  if (numThreads > ncmpvars) {
+    numThreads = ncmpvars;
+  }
+  if (!isHtml && numThreads > 1 && canReadConcurrently(&simresglob_c) && canReadConcurrently(&simresglob_ref)) {
+    CmpWorkerData w;
+    memset(&w, 0, sizeof(CmpWorkerData));
+    w.reader = &simresglob_c.matReader;
+    w.readerRef = &simresglob_ref.matReader;
+    w.isResultCmp = isResultCmp;
+    w.time = &time;
+    w.timeref = &timeref;
+    w.offset = offset;
+    w.offsetRef = offsetRef;
+    w.reltol = reltol;
+    w.abstol = abstol;
+    w.reltolDiffMaxMin = reltolDiffMaxMin;
+    w.rangeDelta = rangeDelta;
+    w.keepEqualResults = keepEqualResults;
+    w.prefix = resultfilename;
+    vardiffindx = compareVarsParallel(numThreads,&w,cmpvars,ncmpvars,&ddf,cmpdiffvars,&res,&ngetfailedvars,runningTestsuite,filename,reffilename,&outOfMemory);
+    ncmpvars = 0; /* skip the serial loop */
+  }
   /* fprintf(stderr, "compare vars\n"); */
   for (i=0;i<ncmpvars;i++) {
     var = cmpvars[i];
@@ -755,7 +984,13 @@ void* SimulationResultsCmp_compareResults(int isResultCmp, int runningTestsuite,
     }
   }
 
-  if (isResultCmp) {
+  if (outOfMemory) {
+    /* the differences are incomplete */
+    res = mmc_mk_cons(mmc_mk_scon("Error merging the differences, out of memory!"),mmc_mk_nil());
+    if (success) {
+      *success = 0;
+    }
+  } else if (isResultCmp) {
     if (writeLogFile(resultfilename,&ddf,filename,reffilename,reltol,abstol)) {
       c_add_message(NULL,-1, ErrorType_scripting, ErrorLevel_warning, gettext("Cannot write to the difference (.csv) file!\n"), msg, 0);
     }
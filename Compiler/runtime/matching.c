@@ -26,8 +26,22 @@
 
 #include "matchmaker.h"
 
+#if defined(__GNUC__)
+#define HAVE_PARALLEL_MATCHING 1
+#include <pthread.h>
+#if defined(__MINGW32__)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+#endif
+
 #define max(a, b) (a > b ? a : b)
 
+/* Minimum number of nonzeros for which match_pf_parallel starts threads */
+#define PPF_MIN_NNZ 10000
+
 void match_dfs(int* col_ptrs, int* col_ids, int* match, int* row_match, int n, int m) {
   int* stack = (int*)malloc(sizeof(int) * n);
   int* colptrs = (int*)malloc(sizeof(int) * n);
@@ -1230,6 +1244,190 @@ void match_pr_fifo_fair(int* col_ptrs, int* col_ids, int* row_ptrs, int* row_ids
   free(r_label);
 }
 
+#if defined(HAVE_PARALLEL_MATCHING)
+
+typedef struct {
+  int* col_ptrs;
+  int* col_ids;
+  int* match;
+  int* row_match;
+  int* visited;    /* phase in which a row was claimed by one of the searches */
+  int* colptrs;
+  int* lookahead;
+  int* unmatched;
+  int nunmatched;
+  int next;        /* next entry of unmatched to search from */
+  int phase;
+  int augmented;   /* number of augmenting paths found in this phase */
+  int n;
+} ppf_data;
+
+/* A row belongs to the search that claims it first in the current phase */
+static int ppf_claim(int* visited, int row, int phase) {
+  int old = __atomic_load_n(&visited[row], __ATOMIC_RELAXED);
+  return old != phase && __atomic_compare_exchange_n(&visited[row], &old, phase, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+}
+
+/* One phase of Pothen-Fan: vertex-disjoint DFS with lookahead from the unmatched columns.
+ * Each column is on at most one stack per phase, since it is reached via its matched row. */
+static void* ppf_worker(void* arg) {
+  ppf_data* d = (ppf_data*)arg;
+  int* col_ptrs = d->col_ptrs;
+  int* col_ids = d->col_ids;
+  int* match = d->match;
+  int* row_match = d->row_match;
+  int* stack = (int*)malloc(sizeof(int) * d->n);
+  int  i, row, col, stack_col, temp, ptr, eptr, stack_last, current_col;
+
+  while((i = __atomic_fetch_add(&d->next, 1, __ATOMIC_RELAXED)) < d->nunmatched) {
+    current_col = d->unmatched[i];
+    stack[0] = current_col; stack_last = 0; d->colptrs[current_col] = col_ptrs[current_col];
+
+    while(stack_last > -1) {
+      stack_col = stack[stack_last];
+
+      eptr = col_ptrs[stack_col + 1];
+      for(ptr = d->lookahead[stack_col]; ptr < eptr; ptr++) {
+        row = col_ids[ptr];
+        if(__atomic_load_n(&row_match[row], __ATOMIC_RELAXED) == -1 && ppf_claim(d->visited, row, d->phase)) {
+          break;
+        }
+      }
+      d->lookahead[stack_col] = ptr + 1;
+
+      if(ptr >= eptr) {
+        /* all rows are matched, continue the search with the first unclaimed one */
+        for(ptr = d->colptrs[stack_col]; ptr < eptr && !ppf_claim(d->visited, col_ids[ptr], d->phase); ptr++){}
+        d->colptrs[stack_col] = ptr + 1;
+
+        if(ptr == eptr) {
+          --stack_last;
+          continue;
+        }
+
+        col = __atomic_load_n(&row_match[col_ids[ptr]], __ATOMIC_RELAXED);
+        stack[++stack_last] = col; d->colptrs[col] = col_ptrs[col];
+      } else {
+        while(row != -1){
+          col = stack[stack_last--];
+          temp = match[col];
+          match[col] = row;
+          __atomic_store_n(&row_match[row], col, __ATOMIC_RELAXED);
+          row = temp;
+        }
+        __atomic_fetch_add(&d->augmented, 1, __ATOMIC_RELAXED);
+        break;
+      }
+    }
+  }
+
+  free(stack);
+  return NULL;
+}
+
+static int matching_num_threads() {
+#if defined(__MINGW32__)
+  SYSTEM_INFO sysinfo;
+  GetSystemInfo(&sysinfo);
+  return max((int)sysinfo.dwNumberOfProcessors, 1);
+#else
+  long nproc = sysconf(_SC_NPROCESSORS_ONLN);
+  return nproc > 1 ? (int)nproc : 1;
+#endif
+}
+
+#endif /* HAVE_PARALLEL_MATCHING */
+
+/* Multithreaded Pothen-Fan: the searches of a phase run concurrently and claim the rows they visit.
+ * Searches can block each other, so a phase without augmentations is followed by the serial
+ * match_pf, which then usually only confirms that the matching is maximum. */
+void match_pf_parallel(int* col_ptrs, int* col_ids, int* match, int* row_match, int n, int m, int nthreads) {
+#if defined(HAVE_PARALLEL_MATCHING)
+  ppf_data d;
+  pthread_t* threads;
+  int* started;
+  int i;
+
+  if(nthreads <= 0) {
+    nthreads = matching_num_threads();
+  }
+  if(nthreads > 1 && col_ptrs[n] >= PPF_MIN_NNZ) {
+    d.col_ptrs = col_ptrs;
+    d.col_ids = col_ids;
+    d.match = match;
+    d.row_match = row_match;
+    d.n = n;
+    d.visited = (int*)calloc(m, sizeof(int));
+    d.colptrs = (int*)malloc(sizeof(int) * n);
+    d.lookahead = (int*)malloc(sizeof(int) * n);
+    d.unmatched = (int*)malloc(sizeof(int) * n);
+    d.phase = 0;
+    memcpy(d.lookahead, col_ptrs, sizeof(int) * n);
+    threads = (pthread_t*)malloc(sizeof(pthread_t) * nthreads);
+    started = (int*)malloc(sizeof(int) * nthreads);
+
+    do {
+      d.nunmatched = 0;
+      for(i = 0; i < n; i++) {
+        if(match[i] == -1 && col_ptrs[i] != col_ptrs[i+1]) {
+          d.unmatched[d.nunmatched++] = i;
+        }
+      }
+      d.next = 0;
+      d.augmented = 0;
+      d.phase++;
+      /* the calling thread takes part in the phase */
+      for(i = 1; i < nthreads && i < d.nunmatched; i++) {
+        started[i] = 0 == pthread_create(&threads[i], NULL, ppf_worker, &d);
+      }
+      ppf_worker(&d);
+      for(i = 1; i < nthreads && i < d.nunmatched; i++) {
+        if(started[i]) {
+          pthread_join(threads[i], NULL);
+        }
+      }
+    } while(d.augmented > 0);
+
+    free(started);
+    free(threads);
+    free(d.unmatched);
+    free(d.lookahead);
+    free(d.colptrs);
+    free(d.visited);
+  }
+#endif
+  match_pf(col_ptrs, col_ids, match, row_match, n, m);
+}
+
+/* Removes the pairs of a matching that are no longer edges of the graph (or are inconsistent),
+ * so the matching of a previous call can be reused after the graph was changed.
+ * Returns the number of pairs that were kept. */
+int match_repair(int* col_ptrs, int* col_ids, int* match, int* row_match, int n, int m) {
+  int i, ptr, row, kept = 0;
+
+  for(i = 0; i < n; i++) {
+    row = match[i];
+    if(row < 0) {
+      match[i] = -1;
+      continue;
+    }
+    if(row < m && row_match[row] == i) {
+      for(ptr = col_ptrs[i]; ptr < col_ptrs[i+1] && col_ids[ptr] != row; ptr++){}
+      if(ptr < col_ptrs[i+1]) {
+        kept++;
+        continue;
+      }
+    }
+    match[i] = -1;
+  }
+  for(i = 0; i < m; i++) {
+    if(row_match[i] < 0 || row_match[i] >= n || match[row_match[i]] != i) {
+      row_match[i] = -1;
+    }
+  }
+  return kept;
+}
+
 void matching(int* col_ptrs, int* col_ids, int* match, int* row_match, int n, int m, int matching_id, int cheap_id, double relabel_period, int clear_match) {
   int* row_ptrs;
   int* row_ids;
@@ -1245,7 +1443,7 @@ void matching(int* col_ptrs, int* col_ids, int* match, int* row_match, int n, in
     }
   }
 
-  if(matching_id >= do_hk || cheap_id > do_old_cheap) {
+  if((matching_id >= do_hk && matching_id <= do_pr_fifo_fair) || cheap_id > do_old_cheap) {
 
     row_ptrs = (int*) malloc((m+1) * sizeof(int));
     memset(row_ptrs, 0, (m+1) * sizeof(int));
@@ -1294,8 +1492,10 @@ void matching(int* col_ptrs, int* col_ids, int* match, int* row_match, int n, in
     match_abmp_bfs(col_ptrs, col_ids, row_ptrs, row_ids, match, row_match, n, m);
   } else if(matching_id == do_pr_fifo_fair) {
     match_pr_fifo_fair(col_ptrs, col_ids, row_ptrs, row_ids, match, row_match, n, m, relabel_period);
+  } else if(matching_id == do_pf_parallel) {
+    match_pf_parallel(col_ptrs, col_ids, match, row_match, n, m, 0);
   }
-  if(matching_id >= do_hk || cheap_id > do_old_cheap) {
+  if((matching_id >= do_hk && matching_id <= do_pr_fifo_fair) || cheap_id > do_old_cheap) {
     free(row_ids);
     free(row_ptrs);
   }
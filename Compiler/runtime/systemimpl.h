@@ -35,6 +35,7 @@
 
 extern const char* System_modelicaPlatform();
 extern const char* System_dirname(const char* str);
+extern int System_numProcessors(void);
 char* _replace(const char* source_str,
                const char* search_str,
                const char* replace_str);
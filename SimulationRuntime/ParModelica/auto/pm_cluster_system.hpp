@@ -49,6 +49,7 @@
 
 #include "pm_utility.hpp"
 #include "pm_timer.hpp"
+#include "pm_dependency_index.hpp"
 
 
 namespace openmodelica {
@@ -233,6 +234,9 @@ public:
 
 private:
     long node_count;
+    /*! Nodes are added before clustering. The index refers to the single task clusters created by add_node. */
+    DependencyIndex<ClusterIdType> dependency_index;
+    std::vector<ClusterIdType> parent_ids;
 
 public:
 
@@ -264,25 +268,17 @@ public:
         new_task.task_id = node_count;
         ++node_count;
 
-        int parent_count = 0;
-        vertex_iterator vert_iter, vert_end;
-        boost::tie(vert_iter, vert_end) = vertices(sys_graph);
-        /*! skip the root node. */
-        ++vert_iter;
-        /*! stop just before the new node. */
-        --vert_end;
-        for ( ; vert_iter != vert_end; ++vert_iter) {
-            const ClusterIdType& prev_clust_id = *vert_iter;
-            ClusterType& prev_clust = sys_graph[prev_clust_id];
+        /*! look up the parents in the dependency index instead of comparing with all previous nodes. */
+        parent_ids.clear();
+        dependency_index.add_task(new_clust_id, new_task.lhs.begin(), new_task.lhs.end(),
+                                  new_task.rhs.begin(), new_task.rhs.end(), parent_ids);
 
-            bool found_dep = new_clust.depends_on(prev_clust);
-            if(found_dep) {
-                boost::add_edge(prev_clust_id,new_clust_id,sys_graph);
-                ++parent_count;
-            }
+        typename std::vector<ClusterIdType>::const_iterator parent_iter;
+        for(parent_iter = parent_ids.begin(); parent_iter != parent_ids.end(); ++parent_iter) {
+            boost::add_edge(*parent_iter,new_clust_id,sys_graph);
         }
 
-        if(parent_count == 0) {
+        if(parent_ids.empty()) {
             boost::add_edge(root_node_id,new_clust_id,sys_graph);
         }
 
@@ -0,0 +1,157 @@
+#pragma once
+#ifndef id5B1E7C42_9A3D_4F6E_8C21D0A4B7E39F15
+#define id5B1E7C42_9A3D_4F6E_8C21D0A4B7E39F15
+
+
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-CurrentYear, Linköping University,
+ * Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF GPL VERSION 3
+ * AND THIS OSMC PUBLIC LICENSE (OSMC-PL).
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES RECIPIENT'S
+ * ACCEPTANCE OF THE OSMC PUBLIC LICENSE.
+ *
+ * The OpenModelica software and the Open Source Modelica
+ * Consortium (OSMC) Public License (OSMC-PL) are obtained
+ * from Linköping University, either from the above address,
+ * from the URLs: http://www.ida.liu.se/projects/OpenModelica or
+ * http://www.openmodelica.org, and in the OpenModelica distribution.
+ * GNU version 3 is obtained from: http://www.gnu.org/copyleft/gpl.html.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without
+ * even the implied warranty of  MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE, EXCEPT AS EXPRESSLY SET FORTH
+ * IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE CONDITIONS
+ * OF OSMC-PL.
+ *
+ * See the full OSMC Public License conditions for more details.
+ *
+ */
+
+
+#include <string>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
+
+namespace openmodelica {
+namespace parmodelica {
+
+
+/*!
+  Incremental dependency builder for task graphs. Variable names are interned
+  to integer ids. For every variable the last task that wrote it and the tasks
+  that read it since then are kept. A task added to the index depends on
+    - the last writer of each variable it reads (true dependency),
+    - the last writer and the readers since then of each variable it writes
+      (output- and anti-dependency).
+  Older accesses are covered transitively through the last writer, so the
+  resulting graph has the same ordering constraints as comparing every task
+  with all previous ones, without the quadratic number of set intersections.
+
+  NodeIdType is whatever the graph uses to identify a node. The ids have to
+  stay valid as long as tasks are added, i.e., the index is meant for the
+  construction of the graph before any clustering.
+*/
+template<typename NodeIdType>
+class DependencyIndex {
+
+    struct VariableAccess {
+        VariableAccess() : has_writer(false) {}
+
+        bool has_writer;
+        NodeIdType last_writer;
+        std::vector<NodeIdType> readers;
+    };
+
+    typedef boost::unordered_map<std::string, long> VariableIdMap;
+
+    VariableIdMap variable_ids;
+    std::vector<VariableAccess> accesses;
+
+    std::vector<long> write_ids;
+    std::vector<long> read_ids;
+
+public:
+    long variable_id(const std::string& name) {
+        std::pair<typename VariableIdMap::iterator, bool> res =
+                variable_ids.insert(std::make_pair(name, (long)accesses.size()));
+        if(res.second)
+            accesses.push_back(VariableAccess());
+        return res.first->second;
+    }
+
+    long variable_count() const {
+        return accesses.size();
+    }
+
+    void clear() {
+        variable_ids.clear();
+        accesses.clear();
+    }
+
+    /*! Register a new task with the variables it writes (lhs) and reads (rhs).
+        The tasks it depends on are appended to parents. A task is never
+        its own parent. Parents can appear more than once. */
+    template<typename NameIterator>
+    void add_task(const NodeIdType& node,
+                  NameIterator lhs_begin, NameIterator lhs_end,
+                  NameIterator rhs_begin, NameIterator rhs_end,
+                  std::vector<NodeIdType>& parents)
+    {
+        write_ids.clear();
+        for(; lhs_begin != lhs_end; ++lhs_begin)
+            write_ids.push_back(variable_id(*lhs_begin));
+
+        read_ids.clear();
+        for(; rhs_begin != rhs_end; ++rhs_begin)
+            read_ids.push_back(variable_id(*rhs_begin));
+
+        // True dependency
+        for(std::vector<long>::const_iterator iter = read_ids.begin(); iter != read_ids.end(); ++iter) {
+            const VariableAccess& access = accesses[*iter];
+            if(access.has_writer)
+                parents.push_back(access.last_writer);
+        }
+
+        // output- and anti-dependency
+        for(std::vector<long>::const_iterator iter = write_ids.begin(); iter != write_ids.end(); ++iter) {
+            const VariableAccess& access = accesses[*iter];
+            if(access.has_writer)
+                parents.push_back(access.last_writer);
+            parents.insert(parents.end(), access.readers.begin(), access.readers.end());
+        }
+
+        /*! update after all parents are collected so the task does not depend on itself.
+            A variable that is read and written by the task only needs the task as its writer. */
+        for(std::vector<long>::const_iterator iter = write_ids.begin(); iter != write_ids.end(); ++iter) {
+            VariableAccess& access = accesses[*iter];
+            access.has_writer = true;
+            access.last_writer = node;
+            access.readers.clear();
+        }
+
+        for(std::vector<long>::const_iterator iter = read_ids.begin(); iter != read_ids.end(); ++iter) {
+            VariableAccess& access = accesses[*iter];
+            if(!access.has_writer || !(access.last_writer == node))
+                access.readers.push_back(node);
+        }
+    }
+
+};
+
+
+
+} // openmodelica
+} // parmodelica
+
+
+
+#endif // header
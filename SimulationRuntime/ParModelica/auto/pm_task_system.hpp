@@ -47,6 +47,7 @@
 #include <boost/graph/graph_utility.hpp>
 
 #include "pm_utility.hpp"
+#include "pm_dependency_index.hpp"
 
 
 namespace openmodelica {
@@ -105,22 +106,25 @@ public:
     void construct_graph()
     {
         Edge edge;
+        DependencyIndex<Node> dependency_index;
+        std::vector<Node> parents;
 
         std::pair<vertex_iterator, vertex_iterator> vp_out = boost::vertices(graph);
         for (unsigned i = 1; i != *vp_out.second; ++i) {
-            int neigh_count = 0;
-            for (unsigned j = i - 1; j > 0; --j) {
-                bool found_dep = graph[i].depends_on(graph[j]);
-                if(found_dep) {
-                    bool b;
-                    boost::tie(edge,b) = boost::add_edge(j,i,graph);
-                    if(!b)
-                        utility::log("") << "Error adding Edge- " << graph[j].index << " --> " << graph[i].index << newl;
-                    ++neigh_count;
-                }
+            parents.clear();
+            dependency_index.add_task(i, graph[i].lhs.begin(), graph[i].lhs.end(),
+                                      graph[i].rhs.begin(), graph[i].rhs.end(), parents);
+
+            for (typename std::vector<Node>::const_iterator iter = parents.begin(); iter != parents.end(); ++iter) {
+                Node j = *iter;
+                bool b;
+                boost::tie(edge,b) = boost::add_edge(j,i,graph);
+                /*! a parent can be found through more than one variable. */
+                if(!b && !boost::edge(j,i,graph).second)
+                    utility::log("") << "Error adding Edge- " << graph[j].index << " --> " << graph[i].index << newl;
             }
 
-            if(!neigh_count) {
+            if(parents.empty()) {
                 bool b;
                 boost::tie(edge,b) = boost::add_edge(root_node,i,graph);
                 if(!b)
@@ -54,19 +54,25 @@ typedef struct list_s {
   struct list_s *next;
 } list;
 
+/* The pools of one thread. Every thread allocates from its own chain of
+ * pools, so the allocation itself needs neither a lock nor atomics. The
+ * newest (and largest) pool is the head of the list. */
+typedef struct memory_pool_s {
+  list *pools;
+  list *spare;                         /* largest released pool, reused before calling malloc */
+  memory_pool_statistics stats;
+  struct memory_pool_s *next;          /* list of arenas of terminated threads */
+} memory_pool;
+
 #if !defined(OMC_NO_THREADS)
+static pthread_key_t memory_pool_key;
+static pthread_once_t memory_pool_once = PTHREAD_ONCE_INIT;
+/* only guards the arenas of terminated threads, never taken by an allocation */
 static pthread_mutex_t memory_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static memory_pool *memory_pools_retired = NULL;
+#else
+static memory_pool *memory_pool_arena = NULL;
 #endif
-static list *memory_pools = NULL;
-
-static void pool_init(void)
-{
-  memory_pools = (list*) malloc(sizeof(list));
-  memory_pools->used = 0;
-  memory_pools->size = 2*1024*1024; /* 2MB pool by default */
-  memory_pools->memory = malloc(memory_pools->size);
-  memory_pools->next = NULL;
-}
 
 static unsigned long upper_power_of_two(unsigned long v)
 {
@@ -85,55 +91,232 @@ static inline size_t round_up(size_t num, size_t factor)
   return num + factor - 1 - (num - 1) % factor;
 }
 
-static inline void pool_expand(size_t len)
+static list* pool_new_list(memory_pool *arena, size_t size)
 {
-  list *newlist = NULL;
-  if (0==memory_pools) {
-    pool_init();
+  list *newlist = (list*) malloc(sizeof(list));
+  if (0==newlist) {
+    mmc_do_out_of_memory();
   }
-  /* Check if we have enough memory already */
-  if (memory_pools->size - memory_pools->used >= len) {
+  newlist->used = 0;
+  newlist->size = size;
+  newlist->memory = malloc(size);
+  newlist->next = NULL;
+  if (0==newlist->memory) {
+    free(newlist);
+    mmc_do_out_of_memory();
+  }
+  arena->stats.reserved += size;
+  arena->stats.expansions++;
+  return newlist;
+}
+
+static void pool_free_list(memory_pool *arena, list *pool)
+{
+  arena->stats.reserved -= pool->size;
+  free(pool->memory);
+  free(pool);
+}
+
+/* keeps the largest of the released pools for the next expansion */
+static void pool_release_list(memory_pool *arena, list *pool)
+{
+  if (arena->spare && arena->spare->size >= pool->size) {
+    pool_free_list(arena, pool);
     return;
   }
-  newlist = (list*) malloc(sizeof(list));
-  newlist->next = memory_pools;
-  memory_pools = newlist;
-  memory_pools->used = 0;
-  memory_pools->size = upper_power_of_two(3*memory_pools->next->size/2 + len); /* expand by 1.5x the old memory pool. More if we request a very large array. */
-  memory_pools->memory = malloc(memory_pools->size);
+  if (arena->spare) {
+    pool_free_list(arena, arena->spare);
+  }
+  pool->used = 0;
+  pool->next = NULL;
+  arena->spare = pool;
 }
 
-static void* pool_malloc(size_t sz)
+static void pool_free_arena(memory_pool *arena)
 {
-  void *res;
-  sz = round_up(sz,8);
+  while (arena->pools) {
+    list *next = arena->pools->next;
+    pool_free_list(arena, arena->pools);
+    arena->pools = next;
+  }
+  if (arena->spare) {
+    pool_free_list(arena, arena->spare);
+  }
+  free(arena);
+}
+
 #if !defined(OMC_NO_THREADS)
+/* the memory of a terminated thread is freed by the next pool_free, like all other temporaries */
+static void pool_retire_arena(void *arena)
+{
   pthread_mutex_lock(&memory_pool_mutex);
+  ((memory_pool*)arena)->next = memory_pools_retired;
+  memory_pools_retired = (memory_pool*)arena;
+  pthread_mutex_unlock(&memory_pool_mutex);
+}
+
+static void pool_create_key(void)
+{
+  pthread_key_create(&memory_pool_key, pool_retire_arena);
+}
 #endif
-  pool_expand(sz);
-  res = (void*)((char*)memory_pools->memory + memory_pools->used);
-  memory_pools->used += sz;
+
+static memory_pool* pool_new_arena(void)
+{
+  memory_pool *arena = (memory_pool*) calloc(1, sizeof(memory_pool));
+  if (0==arena) {
+    mmc_do_out_of_memory();
+  }
+  arena->pools = pool_new_list(arena, 2*1024*1024); /* 2MB pool by default */
 #if !defined(OMC_NO_THREADS)
-  pthread_mutex_unlock(&memory_pool_mutex);
+  pthread_setspecific(memory_pool_key, arena);
+#else
+  memory_pool_arena = arena;
+#endif
+  return arena;
+}
+
+/* the arena of the calling thread */
+static inline memory_pool* pool_get(void)
+{
+  memory_pool *arena;
+#if !defined(OMC_NO_THREADS)
+  pthread_once(&memory_pool_once, pool_create_key);
+  arena = (memory_pool*) pthread_getspecific(memory_pool_key);
+#else
+  arena = memory_pool_arena;
 #endif
+  return arena ? arena : pool_new_arena();
+}
+
+static void pool_init(void)
+{
+  pool_get();
+}
+
+static list* pool_expand(memory_pool *arena, size_t len)
+{
+  list *newlist;
+  if (arena->spare && arena->spare->size >= len) {
+    newlist = arena->spare;
+    arena->spare = NULL;
+  } else {
+    newlist = pool_new_list(arena, upper_power_of_two(3*arena->pools->size/2 + len)); /* expand by 1.5x the old memory pool. More if we request a very large array. */
+  }
+  newlist->next = arena->pools;
+  arena->pools = newlist;
+  return newlist;
+}
+
+static inline void* pool_alloc(size_t sz)
+{
+  memory_pool *arena = pool_get();
+  list *pool = arena->pools;
+  void *res;
+  if (pool->size - pool->used < sz) {
+    pool = pool_expand(arena, sz);
+  }
+  res = (void*)((char*)pool->memory + pool->used);
+  pool->used += sz;
+  arena->stats.used += sz;
+  arena->stats.allocations++;
+  if (arena->stats.used > arena->stats.peak) {
+    arena->stats.peak = arena->stats.used;
+  }
+  return res;
+}
+
+/* like GC_malloc, the memory is set to zero */
+static void* pool_malloc(size_t sz)
+{
+  void *res;
+  sz = round_up(sz,8);
+  res = pool_alloc(sz);
   memset(res,0,sz);
   return res;
 }
 
+/* like GC_malloc_atomic, the memory is not initialized */
+static void* pool_malloc_atomic(size_t sz)
+{
+  return pool_alloc(round_up(sz,8));
+}
+
+/* frees all temporaries of the calling thread and the arenas of terminated threads */
 static int pool_free(void)
 {
-  list *freelist = memory_pools->next;
+  memory_pool *arena = pool_get();
+  list *freelist = arena->pools->next;
+#if !defined(OMC_NO_THREADS)
+  memory_pool *retired;
+#endif
+
+  /* keep the newest pool, it is the largest one */
   while (freelist) {
     list *next = freelist->next;
-    free(freelist->memory);
-    free(freelist);
+    pool_free_list(arena, freelist);
     freelist = next;
   }
-  memory_pools->used = 0;
-  memory_pools->next = 0;
+  arena->pools->used = 0;
+  arena->pools->next = 0;
+  arena->stats.used = 0;
+
+#if !defined(OMC_NO_THREADS)
+  pthread_mutex_lock(&memory_pool_mutex);
+  retired = memory_pools_retired;
+  memory_pools_retired = NULL;
+  pthread_mutex_unlock(&memory_pool_mutex);
+  while (retired) {
+    memory_pool *next = retired->next;
+    pool_free_arena(retired);
+    retired = next;
+  }
+#endif
   return 0;
 }
 
+memory_pool_mark pool_mark(void)
+{
+  memory_pool *arena = pool_get();
+  memory_pool_mark mark;
+  mark.pool = arena->pools;
+  mark.offset = arena->pools->used;
+  mark.used = arena->stats.used;
+  return mark;
+}
+
+void pool_release(memory_pool_mark mark)
+{
+  memory_pool *arena = pool_get();
+  list *pool;
+
+  /* check first that the mark is part of this arena, it is ignored if it belongs to another
+   * thread or was invalidated by pool_free, nothing may be released in that case */
+  for (pool = arena->pools; pool && pool != mark.pool; pool = pool->next);
+  if (0==pool || mark.offset > pool->used) {
+    return;
+  }
+
+  while (arena->pools != mark.pool) {
+    list *next = arena->pools->next;
+    pool_release_list(arena, arena->pools);
+    arena->pools = next;
+  }
+  arena->pools->used = mark.offset;
+  arena->stats.used = mark.used;
+}
+
+void pool_get_statistics(memory_pool_statistics *stats)
+{
+  *stats = pool_get()->stats;
+}
+
+void pool_reset_peak(void)
+{
+  memory_pool *arena = pool_get();
+  arena->stats.peak = arena->stats.used;
+}
+
 static void nofree(void* ptr)
 {
 }
@@ -145,7 +328,7 @@ static void* malloc_zero(size_t sz) {
 omc_alloc_interface_t omc_alloc_interface_pooled = {
   pool_init,
   pool_malloc,
-  pool_malloc,
+  pool_malloc_atomic,
   (char*(*)(size_t)) malloc,
   strdup,
   pool_free,
@@ -212,7 +395,7 @@ omc_alloc_interface_t omc_alloc_interface = {
 #else
   pool_init,
   pool_malloc,
-  pool_malloc,
+  pool_malloc_atomic,
   (char*(*)(size_t)) malloc,
   strdup,
   pool_free,
@@ -48,6 +48,33 @@ extern _index_t** index_alloc(int n);
 
 void* generic_alloc(int n, size_t sze);
 
+/* Memory pool (omc_alloc_interface_pooled)
+ *
+ * Every thread allocates from its own pools. omc_alloc_interface.collect_a_little
+ * frees all memory of the calling thread (and of terminated threads) at once.
+ */
+typedef struct memory_pool_statistics {
+  size_t used;                         /* bytes allocated by the calling thread since the last release */
+  size_t peak;                         /* maximum of used */
+  size_t reserved;                     /* bytes held by the pools of the calling thread */
+  unsigned long allocations;
+  unsigned long expansions;            /* number of pools allocated with malloc */
+} memory_pool_statistics;
+
+typedef struct memory_pool_mark {
+  void *pool;
+  size_t offset;
+  size_t used;
+} memory_pool_mark;
+
+/* Marks the current position in the pools of the calling thread. pool_release
+ * frees everything that was allocated after the mark, e.g. the temporaries of
+ * one step. Marks have to be released in the same thread in reverse order. */
+memory_pool_mark pool_mark(void);
+void pool_release(memory_pool_mark mark);
+void pool_get_statistics(memory_pool_statistics *stats);
+void pool_reset_peak(void);
+
 #if defined(__cplusplus)
 } /* end extern "C" */
 #endif
@@ -34,13 +34,37 @@
 #include "simulation/solver/external_input.h"
 #include "simulation/options.h"
 #include "simulation/solver/model_help.h"
+#include "simulation/results/MatVer4.h"
 #include "linearize.h"
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <vector>
 
 using namespace std;
 
+/* matrix of the linear model in compressed sparse column format, the entries
+ * of column j are values[colPtr[j]] ... values[colPtr[j+1]-1] */
+typedef struct LINEAR_MATRIX
+{
+  unsigned int rows;
+  unsigned int cols;
+  vector<unsigned int> colPtr;
+  vector<unsigned int> rowIndex;
+  vector<double> values;
+} LINEAR_MATRIX;
+
+/* columns grouped by color, the columns of color c are
+ * columns[colorPtr[c]] ... columns[colorPtr[c+1]-1] */
+typedef struct LINEAR_COLORING
+{
+  vector<unsigned int> colorPtr;
+  vector<unsigned int> columns;
+} LINEAR_COLORING;
+
+typedef int (*jacobianColumnFunction)(void*, threadData_t*, ANALYTIC_JACOBIAN*, ANALYTIC_JACOBIAN*);
+typedef int (*jacobianInitFunction)(void*, threadData_t*, ANALYTIC_JACOBIAN*);
+
 static string array2string(double* array, int row, int col)
 {
   int i=0;
@@ -67,6 +91,191 @@ static string array2string(double* array, int row, int col)
   return retVal.str();
 }
 
+/* same format as array2string, the rows are expanded one at a time */
+static string matrix2string(const LINEAR_MATRIX& matrix)
+{
+  unsigned int i, j, k;
+  vector<unsigned int> rowPtr(matrix.rows+1, 0);
+  vector<unsigned int> rowCols(matrix.rowIndex.size());
+  vector<double> rowValues(matrix.rowIndex.size());
+  vector<double> denseRow(matrix.cols, 0.0);
+  ostringstream retVal(ostringstream::out);
+  retVal.precision(16);
+
+  /* transpose to compressed sparse rows */
+  for(k=0; k<matrix.rowIndex.size(); k++)
+    rowPtr[matrix.rowIndex[k]+1]++;
+  for(i=0; i<matrix.rows; i++)
+    rowPtr[i+1] += rowPtr[i];
+  vector<unsigned int> next(rowPtr.begin(), rowPtr.end()-1);
+  for(j=0; j<matrix.cols; j++)
+  {
+    for(k=matrix.colPtr[j]; k<matrix.colPtr[j+1]; k++)
+    {
+      unsigned int pos = next[matrix.rowIndex[k]]++;
+      rowCols[pos] = j;
+      rowValues[pos] = matrix.values[k];
+    }
+  }
+
+  for(i=0; i<matrix.rows; i++)
+  {
+    for(k=rowPtr[i]; k<rowPtr[i+1]; k++)
+      denseRow[rowCols[k]] = rowValues[k];
+    for(j=0; j<matrix.cols; j++)
+    {
+      retVal << denseRow[j];
+      if(j+1 < matrix.cols)
+        retVal << ", ";
+    }
+    if((i+1 != matrix.rows) && (matrix.cols != 0))
+    {
+      retVal << "; ";
+    }
+    for(k=rowPtr[i]; k<rowPtr[i+1]; k++)
+      denseRow[rowCols[k]] = 0.0;
+  }
+  return retVal.str();
+}
+
+static void setDensePattern(LINEAR_MATRIX& matrix, unsigned int rows, unsigned int cols)
+{
+  unsigned int i, j;
+
+  matrix.rows = rows;
+  matrix.cols = cols;
+  matrix.colPtr.resize(cols+1);
+  matrix.rowIndex.resize((size_t)rows*cols);
+  for(j=0; j<cols; j++)
+  {
+    matrix.colPtr[j] = j*rows;
+    for(i=0; i<rows; i++)
+      matrix.rowIndex[(size_t)j*rows+i] = i;
+  }
+  matrix.colPtr[cols] = rows*cols;
+  matrix.values.assign(matrix.rowIndex.size(), 0.0);
+}
+
+/* Initializes the generated jacobian and takes its sparsity pattern for the matrix.
+ * If no pattern is available the matrix is dense. Returns 1 if the generated pattern is used. */
+static int setJacobianPattern(DATA* data, threadData_t *threadData, int index, jacobianInitFunction initialAnalyticJacobian, LINEAR_MATRIX& matrix, unsigned int rows, unsigned int cols)
+{
+  ANALYTIC_JACOBIAN* jacobian = &(data->simulationInfo->analyticJacobians[index]);
+  const SPARSE_PATTERN* sp = &jacobian->sparsePattern;
+
+  if(0 == rows || 0 == cols)
+  {
+    setDensePattern(matrix, rows, cols);
+    return 1;
+  }
+
+  /* the solver may have initialized the jacobian already */
+  if((jacobian->seedVars || !initialAnalyticJacobian(data, threadData, jacobian)) &&
+     jacobian->sizeRows == rows && jacobian->sizeCols == cols && sp->leadindex[cols] == sp->numberOfNoneZeros)
+  {
+    matrix.rows = rows;
+    matrix.cols = cols;
+    matrix.colPtr.assign(sp->leadindex, sp->leadindex + cols + 1);
+    matrix.rowIndex.assign(sp->index, sp->index + sp->numberOfNoneZeros);
+    matrix.values.assign(sp->numberOfNoneZeros, 0.0);
+    return 1;
+  }
+
+  setDensePattern(matrix, rows, cols);
+  return 0;
+}
+
+/* groups the columns by their (0-based) color */
+static void groupColors(LINEAR_COLORING& coloring, const unsigned int* colorOf, unsigned int offset, unsigned int cols, unsigned int nColors)
+{
+  unsigned int i, j;
+
+  coloring.colorPtr.assign(nColors+1, 0);
+  coloring.columns.resize(cols);
+  for(j=0; j<cols; j++)
+    coloring.colorPtr[colorOf[j]-offset+1]++;
+  for(i=0; i<nColors; i++)
+    coloring.colorPtr[i+1] += coloring.colorPtr[i];
+  vector<unsigned int> next(coloring.colorPtr.begin(), coloring.colorPtr.end()-1);
+  for(j=0; j<cols; j++)
+    coloring.columns[next[colorOf[j]-offset]++] = j;
+}
+
+/* Greedy column coloring of the stacked patterns: columns of the same color have no
+ * common row in any of the matrices and can be perturbed at once. */
+static void colorColumns(LINEAR_COLORING& coloring, const LINEAR_MATRIX* const* matrices, int nMatrices, unsigned int cols)
+{
+  unsigned int i, j, k, l, c, nRows = 0, nColors = 0;
+  int m;
+  vector<unsigned int> rowOffset(nMatrices);
+  vector<unsigned int> color(cols);
+
+  for(m=0; m<nMatrices; m++)
+  {
+    rowOffset[m] = nRows;
+    nRows += matrices[m]->rows;
+  }
+
+  /* columns of every row */
+  vector<unsigned int> rowPtr(nRows+1, 0);
+  for(m=0; m<nMatrices; m++)
+    for(k=0; k<matrices[m]->rowIndex.size(); k++)
+      rowPtr[rowOffset[m]+matrices[m]->rowIndex[k]+1]++;
+  for(i=0; i<nRows; i++)
+  {
+    /* a dense row couples all columns */
+    if(rowPtr[i+1] == cols && cols > 1)
+    {
+      for(j=0; j<cols; j++)
+        color[j] = j;
+      groupColors(coloring, &color[0], 0, cols, cols);
+      return;
+    }
+    rowPtr[i+1] += rowPtr[i];
+  }
+  vector<unsigned int> rowCols(rowPtr[nRows]);
+  vector<unsigned int> next(rowPtr.begin(), rowPtr.end()-1);
+  for(m=0; m<nMatrices; m++)
+    for(j=0; j<cols; j++)
+      for(k=matrices[m]->colPtr[j]; k<matrices[m]->colPtr[j+1]; k++)
+        rowCols[next[rowOffset[m]+matrices[m]->rowIndex[k]]++] = j;
+
+  /* forbidden[c] == j if color c is used by a neighbour of column j */
+  vector<unsigned int> forbidden(cols+1, cols);
+  for(j=0; j<cols; j++)
+  {
+    for(m=0; m<nMatrices; m++)
+    {
+      for(k=matrices[m]->colPtr[j]; k<matrices[m]->colPtr[j+1]; k++)
+      {
+        i = rowOffset[m]+matrices[m]->rowIndex[k];
+        for(l=rowPtr[i]; l<rowPtr[i+1] && rowCols[l]<j; l++)
+          forbidden[color[rowCols[l]]] = j;
+      }
+    }
+    for(c=0; forbidden[c] == j; c++);
+    color[j] = c;
+    if(c+1 > nColors)
+      nColors = c+1;
+  }
+
+  groupColors(coloring, cols ? &color[0] : NULL, 0, cols, nColors);
+}
+
+static void logMatrix(const char* name, const LINEAR_MATRIX& matrix, unsigned int nColors)
+{
+  unsigned int j, k;
+
+  if(ACTIVE_STREAM(LOG_JAC))
+  {
+    infoStreamPrint(LOG_JAC, 1, "matrix %s: %u x %u, %u nonzeros, %u colors", name, matrix.rows, matrix.cols, (unsigned int)matrix.rowIndex.size(), nColors);
+    for(j=0; j<matrix.cols; j++)
+      for(k=matrix.colPtr[j]; k<matrix.colPtr[j+1]; k++)
+        infoStreamPrint(LOG_JAC, 0, "%s[%u,%u] = %g", name, matrix.rowIndex[k]+1, j+1, matrix.values[k]);
+    messageClose(LOG_JAC);
+  }
+}
+
 extern "C" {
 
 int functionODE_residual(DATA* data, threadData_t *threadData, double *dx, double *dy, double *dz)
@@ -112,396 +321,188 @@ int functionODE_residual(DATA* data, threadData_t *threadData, double *dx, doubl
     return 0;
 }
 
-/*  Calculate the jacobian matrix by numerical finite difference */
-int functionJacAC_num(DATA* data, threadData_t *threadData, double *matrixA, double *matrixC, double *matrixCz)
+/* Calculate the jacobian matrices [A; C; Cz] (perturbation of the states) or [B; D; Dz]
+ * (perturbation of the inputs) by numerical finite differences. The values are only computed
+ * for the sparsity pattern of the matrices and all columns of a color are perturbed at once.
+ * The data recovery matrix Cz/Dz is dense, each column is perturbed separately then. */
+static int functionJac_num(DATA* data, threadData_t *threadData, int perturbStates, LINEAR_MATRIX& matrixX, LINEAR_MATRIX& matrixY, LINEAR_MATRIX* matrixZ)
 {
     const double delta_h = numericalDifferentiationDeltaXlinearize;
     double delta_hh;
-    double xsave;
 
-    double* x;
+    int size_x = data->modelData->nStates;
+    int size_y = data->modelData->nOutputVars;
+    int size_z = data->modelData->nVariablesReal - 2*data->modelData->nStates;
+    unsigned int cols = matrixX.cols;
+    double* vars = perturbStates ? data->localData[0]->realVars : data->simulationInfo->inputVars;
 
-    int i,j,k;
+    unsigned int color, c, i, k;
+    LINEAR_COLORING coloring;
 
-    int do_data_recovery = 0;
+    if(0 == cols)
+        return 0;
 
-    int size_A = data->modelData->nStates;
-    int size_C = data->modelData->nOutputVars;
-    int size_z = data->modelData->nVariablesReal - 2*data->modelData->nStates;
-
-    double* x0 = (double*)calloc(size_A,sizeof(double));
-    double* y0 = (double*)calloc(size_C,sizeof(double));
-    double* x1 = (double*)calloc(size_A,sizeof(double));
-    double* y1 = (double*)calloc(size_C,sizeof(double));
-    double* z0 = 0;
-    double* z1 = 0;
-    double *xScaling = (double*)calloc(size_A,sizeof(double));
-
-    assertStreamPrint(threadData,0!=x0,"calloc failed");
-    assertStreamPrint(threadData,0!=y0,"calloc failed");
-    assertStreamPrint(threadData,0!=x1,"calloc failed");
-    assertStreamPrint(threadData,0!=y1,"calloc failed");
-
-    if(matrixCz){
-        do_data_recovery = 1;
-    }
+    vector<double> x0(size_x), x1(size_x), y0(size_y), y1(size_y);
+    vector<double> z0(matrixZ ? size_z : 0), z1(matrixZ ? size_z : 0);
+    vector<double> scaling(cols, 1.0), varsSave(cols), delta(cols);
 
-    if(do_data_recovery > 0){
-        z0 = (double*)calloc(size_z,sizeof(double));
-        z1 = (double*)calloc(size_z,sizeof(double));
-        assertStreamPrint(threadData,0!=z0,"calloc failed");
-        assertStreamPrint(threadData,0!=z1,"calloc failed");
+    if(matrixZ){
+        vector<unsigned int> ownColor(cols);
+        for(i=0; i<cols; i++)
+            ownColor[i] = i;
+        groupColors(coloring, &ownColor[0], 0, cols, cols);
+    }else{
+        const LINEAR_MATRIX* matrices[2] = {&matrixX, &matrixY};
+        colorColumns(coloring, matrices, 2, cols);
     }
 
-    functionODE_residual(data, threadData, x0, y0, z0);
-
-    x = data->localData[0]->realVars;
+    functionODE_residual(data, threadData, x0.empty() ? NULL : &x0[0], y0.empty() ? NULL : &y0[0], z0.empty() ? NULL : &z0[0]);
 
     /* use actually value for xScaling */
-    for (i=0;i<size_A;i++){
-        xScaling[i] = fmax(data->modelData->realVarsData[i].attribute.nominal,fabs(x[i]));
-    }
-
-    /* solverData->f1 must be set outside this function based on x */
-    for(i = 0; i < size_A; i++) {
-        xsave = x[i];
-        delta_hh = delta_h * (fabs(xsave) + 1.0);
-        if ((xsave + delta_hh >=  data->modelData->realVarsData[i].attribute.max))
-            delta_hh *= -1;
-        x[i] += delta_hh / xScaling[i];
-        /* Calculate scaled difference quotient */
-        delta_hh = 1. / delta_hh * xScaling[i];
-
-        functionODE_residual(data, threadData, x1, y1, z1);
-
-        for(j = 0; j < size_A; j++) {
-            k = i * size_A + j;
-            matrixA[k] = (x1[j] - x0[j]) * delta_hh;
+    if(perturbStates){
+        for(i=0; i<cols; i++){
+            scaling[i] = fmax(data->modelData->realVarsData[i].attribute.nominal,fabs(vars[i]));
         }
-        for(j = 0; j < size_C; j++) {
-            k = i * size_C + j;
-            matrixC[k] = (y1[j] - y0[j]) * delta_hh;
-        }
-        if(do_data_recovery > 0){
-            for(j = 0; j < size_z; j++) {
-                k = i * size_z + j;
-                matrixCz[k] = (z1[j] - z0[j]) * delta_hh;
-            }
-        }
-        x[i] = xsave;
-    }
-
-    free(xScaling);
-    free(x0);
-    free(y0);
-    free(x1);
-    free(y1);
-    if(do_data_recovery > 0){
-        free(z0);
-        free(z1);
-    }
-
-    return 0;
-}
-
-int functionJacBD_num(DATA* data, threadData_t *threadData, double *matrixB, double *matrixD, double *matrixDz)
-{
-    const double delta_h = numericalDifferentiationDeltaXlinearize;
-    double delta_hh;
-    double usave;
-    double* u;
-
-    int i,j,k;
-
-    int do_data_recovery = 0;
-    if(matrixDz){
-        do_data_recovery = 1;
-    }
-
-    int size_x = data->modelData->nStates;
-    int size_u = data->modelData->nInputVars;
-    int size_y = data->modelData->nOutputVars;
-    int size_z = data->modelData->nVariablesReal - 2*data->modelData->nStates;
-    double* x0 = (double*)calloc(size_x,sizeof(double));
-    double* y0 = (double*)calloc(size_y,sizeof(double));
-    double* x1 = (double*)calloc(size_x,sizeof(double));
-    double* y1 = (double*)calloc(size_y,sizeof(double));
-    double* z0 = 0;
-    double* z1 = 0;
-
-    assertStreamPrint(threadData,0!=x0,"calloc failed");
-    assertStreamPrint(threadData,0!=y0,"calloc failed");
-    assertStreamPrint(threadData,0!=x1,"calloc failed");
-    assertStreamPrint(threadData,0!=y1,"calloc failed");
-
-    if(do_data_recovery > 0){
-        z0 = (double*)calloc(size_z,sizeof(double));
-        z1 = (double*)calloc(size_z,sizeof(double));
-        assertStreamPrint(threadData,0!=z0,"calloc failed");
-        assertStreamPrint(threadData,0!=z1,"calloc failed");
     }
 
-    functionODE_residual(data, threadData, x0, y0, z0);
-
-    u = data->simulationInfo->inputVars;
-
-    /* solverData->f1 must be set outside this function based on x */
-    for(i = 0; i < size_u; i++) {
-        usave = u[i];
-        delta_hh = delta_h * (fabs(usave) + 1.0);
-        u[i] += delta_hh;
-        delta_hh = 1. / delta_hh;
+    for(color = 0; color+1 < coloring.colorPtr.size(); color++) {
+        for(c = coloring.colorPtr[color]; c < coloring.colorPtr[color+1]; c++) {
+            i = coloring.columns[c];
+            varsSave[i] = vars[i];
+            delta_hh = delta_h * (fabs(varsSave[i]) + 1.0);
+            if (perturbStates && (varsSave[i] + delta_hh >= data->modelData->realVarsData[i].attribute.max))
+                delta_hh *= -1;
+            vars[i] += delta_hh / scaling[i];
+            /* Calculate scaled difference quotient */
+            delta[i] = 1. / delta_hh * scaling[i];
+        }
 
-        functionODE_residual(data, threadData, x1, y1, z1);
+        functionODE_residual(data, threadData, x1.empty() ? NULL : &x1[0], y1.empty() ? NULL : &y1[0], z1.empty() ? NULL : &z1[0]);
 
-        for(j = 0; j < size_x; j++) {
-            k = i * size_x + j;
-            matrixB[k] = (x1[j] - x0[j]) * delta_hh;
-        }
-        for(j = 0; j < size_y; j++) {
-            k = i * size_y + j;
-            matrixD[k] = (y1[j] - y0[j]) * delta_hh;
-        }
-        if(do_data_recovery > 0){
-            for(j = 0; j < size_z; j++) {
-                k = i * size_z + j;
-                matrixDz[k] = (z1[j] - z0[j]) * delta_hh;
+        for(c = coloring.colorPtr[color]; c < coloring.colorPtr[color+1]; c++) {
+            i = coloring.columns[c];
+            for(k = matrixX.colPtr[i]; k < matrixX.colPtr[i+1]; k++) {
+                matrixX.values[k] = (x1[matrixX.rowIndex[k]] - x0[matrixX.rowIndex[k]]) * delta[i];
+            }
+            for(k = matrixY.colPtr[i]; k < matrixY.colPtr[i+1]; k++) {
+                matrixY.values[k] = (y1[matrixY.rowIndex[k]] - y0[matrixY.rowIndex[k]]) * delta[i];
             }
+            if(matrixZ){
+                for(k = matrixZ->colPtr[i]; k < matrixZ->colPtr[i+1]; k++) {
+                    matrixZ->values[k] = (z1[matrixZ->rowIndex[k]] - z0[matrixZ->rowIndex[k]]) * delta[i];
+                }
+            }
+            vars[i] = varsSave[i];
         }
-        u[i] = usave;
     }
 
-    free(x0);
-    free(y0);
-    free(x1);
-    free(y1);
-    if(do_data_recovery > 0){
-        free(z0);
-        free(z1);
-    }
+    infoStreamPrint(LOG_JAC, 0, "numerical jacobian of the %s: %u columns, %u colors", perturbStates ? "states" : "inputs", cols, (unsigned int)coloring.colorPtr.size()-1);
 
     return 0;
 }
 
+/* Calculate the jacobian matrix with the generated symbolic jacobian, all columns of a color
+ * are seeded at once. The matrix has to use the sparsity pattern of the jacobian. */
+static int functionJac_sym(DATA* data, threadData_t *threadData, int index, jacobianColumnFunction functionJac_column, LINEAR_MATRIX& matrix)
+{
+    ANALYTIC_JACOBIAN* jacobian = &(data->simulationInfo->analyticJacobians[index]);
+    unsigned int color, c, j, k;
+    LINEAR_COLORING coloring;
 
-/*  Calculate the jacobian matrix by analytical finite difference */
-int functionJacA(DATA* data, threadData_t *threadData, double* jac){
-
-  const int index = data->callback->INDEX_JAC_A;
-  ANALYTIC_JACOBIAN* jacobian = &(data->simulationInfo->analyticJacobians[index]);
-  unsigned int i,j,k;
-  k = 0;
-  for(i=0; i < jacobian->sizeCols; i++)
-  {
-    jacobian->seedVars[i] = 1.0;
-    if(ACTIVE_STREAM(LOG_JAC))
-    {
-      printf("Caluculate one col:\n");
-      for(j=0;  j < jacobian->sizeCols;j++)
-      {
-        infoStreamPrint(LOG_JAC,0,"seed: jacobian->seedVars[%d]= %f",j,jacobian->seedVars[j]);
-      }
-    }
-
-    data->callback->functionJacA_column(data, threadData, jacobian, NULL);
-
-    for(j = 0; j < jacobian->sizeRows; j++)
-    {
-      jac[k++] = jacobian->resultVars[j];
-      infoStreamPrint(LOG_JAC,0,"write in jac[%d]-[%d,%d]=%g from row[%d]=%g",k-1,i,j,jac[k-1],i,jacobian->resultVars[j]);
-    }
-
-    jacobian->seedVars[i] = 0.0;
-  }
-  if(ACTIVE_STREAM(LOG_JAC))
-  {
-    infoStreamPrint(LOG_JAC,0,"Print jac:");
-    for(i=0;  i < jacobian->sizeRows;i++)
-    {
-      for(j=0;  j < jacobian->sizeCols;j++) {
-        printf("% .5e ",jac[i+j*jacobian->sizeCols]);
-      }
-      printf("\n");
-    }
-  }
-
-  return 0;
-}
-int functionJacB(DATA* data, threadData_t *threadData, double* jac){
+    if(0 == matrix.rows || 0 == matrix.cols)
+        return 0;
 
-  const int index = data->callback->INDEX_JAC_B;
-  ANALYTIC_JACOBIAN* jacobian = &(data->simulationInfo->analyticJacobians[index]);
+    groupColors(coloring, jacobian->sparsePattern.colorCols, 1, jacobian->sizeCols, jacobian->sparsePattern.maxColors);
 
-  unsigned int i,j,k;
-  k = 0;
-  for(i=0; i < jacobian->sizeCols; i++)
-  {
-    jacobian->seedVars[i] = 1.0;
-    if(ACTIVE_STREAM(LOG_JAC))
+    for(color = 0; color < jacobian->sparsePattern.maxColors; color++)
     {
-      printf("Caluculate one col:\n");
-      for(j=0;  j < jacobian->sizeCols;j++)
-      {
-        infoStreamPrint(LOG_JAC,0,"seed: jacobian->seedVars[%d]= %f",j,jacobian->seedVars[j]);
-      }
-    }
-
-    data->callback->functionJacB_column(data, threadData, jacobian, NULL);
+        for(c = coloring.colorPtr[color]; c < coloring.colorPtr[color+1]; c++)
+            jacobian->seedVars[coloring.columns[c]] = 1.0;
 
-    for(j = 0; j < jacobian->sizeRows; j++)
-    {
-      jac[k++] = jacobian->resultVars[j];
-      infoStreamPrint(LOG_JAC,0,"write in jac[%d]-[%d,%d]=%g from row[%d]=%g",k-1,i,j,jac[k-1],i,jacobian->resultVars[j]);
-    }
+        if(functionJac_column(data, threadData, jacobian, NULL))
+            return 1;
 
-    jacobian->seedVars[i] = 0.0;
-  }
-  if(ACTIVE_STREAM(LOG_JAC))
-  {
-    infoStreamPrint(LOG_JAC, 0, "Print jac:");
-    for(i=0;  i < jacobian->sizeRows;i++)
-    {
-      for(j=0;  j < jacobian->sizeCols;j++)
-        printf("% .5e ",jac[i+j*jacobian->sizeCols]);
-      printf("\n");
+        for(c = coloring.colorPtr[color]; c < coloring.colorPtr[color+1]; c++)
+        {
+            j = coloring.columns[c];
+            for(k = matrix.colPtr[j]; k < matrix.colPtr[j+1]; k++)
+                matrix.values[k] = jacobian->resultVars[matrix.rowIndex[k]];
+            jacobian->seedVars[j] = 0.0;
+        }
     }
-  }
 
-  return 0;
+    return 0;
 }
-int functionJacC(DATA* data, threadData_t *threadData, double* jac){
 
-  const int index = data->callback->INDEX_JAC_C;
-  ANALYTIC_JACOBIAN* jacobian = &(data->simulationInfo->analyticJacobians[index]);
-  unsigned int i,j,k;
-  k = 0;
-  for(i=0; i < jacobian->sizeCols; i++)
-  {
-    jacobian->seedVars[i] = 1.0;
-    if(ACTIVE_STREAM(LOG_JAC))
-    {
-      printf("Caluculate one col:\n");
-      for(j=0;  j < jacobian->sizeCols;j++)
-        infoStreamPrint(LOG_JAC,0,"seed: jacobian->seedVars[%d]= %f",j,jacobian->seedVars[j]);
-    }
-
-    data->callback->functionJacC_column(data, threadData, jacobian, NULL);
+static void writeNames_matVer4(FILE* fout, const char* name, const char** names, size_t n)
+{
+    size_t i, j, len, maxLen = 0;
 
-    for(j = 0; j < jacobian->sizeRows; j++)
+    for(i=0; i<n; i++)
     {
-      jac[k++] = jacobian->resultVars[j];
-      infoStreamPrint(LOG_JAC,0,"write in jac[%d]-[%d,%d]=%g from row[%d]=%g",k-1,i,j,jac[k-1],i,jacobian->resultVars[j]);
-    }
-
-    jacobian->seedVars[i] = 0.0;
-  }
-  if(ACTIVE_STREAM(LOG_JAC))
-  {
-    infoStreamPrint(LOG_JAC, 0, "Print jac:");
-    for(i=0;  i < jacobian->sizeRows;i++)
-    {
-      for(j=0;  j < jacobian->sizeCols;j++)
-        printf("% .5e ",jac[i+j*jacobian->sizeCols]);
-      printf("\n");
-    }
-  }
-
-  return 0;
+        len = strlen(names[i]);
+        if(len > maxLen)
+            maxLen = len;
+    }
+    /* one name per row, stored column-wise and padded with blanks */
+    vector<char> buffer(n*maxLen, ' ');
+    for(i=0; i<n; i++)
+        for(j=0, len=strlen(names[i]); j<len; j++)
+            buffer[j*n+i] = names[i][j];
+    writeMatrix_matVer4(fout, name, n, maxLen, buffer.empty() ? NULL : &buffer[0], MatVer4Type_CHAR);
 }
-int functionJacD(DATA* data, threadData_t *threadData, double* jac){
-
-  const int index = data->callback->INDEX_JAC_D;
-  ANALYTIC_JACOBIAN* jacobian = &(data->simulationInfo->analyticJacobians[index]);
-  unsigned int i,j,k;
-  k = 0;
-  for(i=0; i < jacobian->sizeCols; i++)
-  {
-    jacobian->seedVars[i] = 1.0;
-    if(ACTIVE_STREAM(LOG_JAC))
-    {
-      printf("Caluculate one col:\n");
-      for(j=0;  j < jacobian->sizeCols;j++) {
-        infoStreamPrint(LOG_JAC,0,"seed: jacobian->seedVars[%d]= %f",j,jacobian->seedVars[j]);
-      }
-    }
-
-    data->callback->functionJacD_column(data, threadData, jacobian, NULL);
-
-    for(j = 0; j < jacobian->sizeRows; j++)
-    {
-      jac[k++] = jacobian->resultVars[j];
-      infoStreamPrint(LOG_JAC,0, "write in jac[%d]-[%d,%d]=%g from row[%d]=%g",k-1,i,j,jac[k-1],i,jacobian->resultVars[j]);
-    }
-
-    jacobian->seedVars[i] = 0.0;
-  }
-  if(ACTIVE_STREAM(LOG_JAC))
-  {
-    infoStreamPrint(LOG_JAC, 0, "Print jac:");
-    for(i=0;  i < jacobian->sizeRows;i++)
-    {
-      for(j=0;  j < jacobian->sizeCols;j++)
-        printf("% .5e ",jac[i+j*jacobian->sizeCols]);
-      printf("\n");
-    }
-  }
 
-  return 0;
+static void writeMatrix_linear(FILE* fout, const char* name, const LINEAR_MATRIX& matrix)
+{
+    writeSparseMatrix_matVer4(fout, name, matrix.rows, matrix.cols, &matrix.colPtr[0], matrix.rowIndex.empty() ? NULL : &matrix.rowIndex[0], matrix.values.empty() ? NULL : &matrix.values[0]);
 }
 
-
-
 int linearize(DATA* data, threadData_t *threadData)
 {
     TRACE_PUSH
     /* Check if data recovery is requested */
     int do_data_recovery = omc_flag[FLAG_L_DATA_RECOVERY] ? 1 : 0;
+    /* Check if the matrices are written to a MAT file */
+    int do_mat_output = omc_flag[FLAG_L_MAT] ? 1 : 0;
 
     /* init linearization sizes */
     int size_A = data->modelData->nStates;
     int size_Inputs = data->modelData->nInputVars;
     int size_Outputs = data->modelData->nOutputVars;
     int size_z = data->modelData->nVariablesReal - 2*data->modelData->nStates;
-    double* matrixA = (double*)calloc(size_A*size_A,sizeof(double));
-    double* matrixB = (double*)calloc(size_A*size_Inputs,sizeof(double));
-    double* matrixC = (double*)calloc(size_Outputs*size_A,sizeof(double));
-    double* matrixD = (double*)calloc(size_Outputs*size_Inputs,sizeof(double));
-    double* matrixCz = 0;
-    double* matrixDz = 0;
+    LINEAR_MATRIX matrixA, matrixB, matrixC, matrixD, matrixCz, matrixDz;
+    int patternA, patternB, patternC, patternD, symbolic;
+    vector<double> z0;
     string strA, strB, strC, strD, strCz, strDz, strX, strU, strZ0, filename;
+    const char* extension = do_mat_output ? ".mat" : ".mo";
 	std::size_t pos, pos1, pos2;
 
-    assertStreamPrint(threadData,0!=matrixA,"calloc failed");
-    assertStreamPrint(threadData,0!=matrixB,"calloc failed");
-    assertStreamPrint(threadData,0!=matrixC,"calloc failed");
-    assertStreamPrint(threadData,0!=matrixD,"calloc failed");
-
-    if(do_data_recovery > 0){
-        matrixCz = (double*)calloc(size_z*size_A,sizeof(double));
-        matrixDz = (double*)calloc(size_z*size_Inputs,sizeof(double));
-        assertStreamPrint(threadData,0!=matrixCz,"calloc failed");
-        assertStreamPrint(threadData,0!=matrixDz,"calloc failed");
-    }
+    /* Use the sparsity pattern of the generated jacobians for the numerical and the symbolic jacobian */
+    patternA = setJacobianPattern(data, threadData, data->callback->INDEX_JAC_A, data->callback->initialAnalyticJacobianA, matrixA, size_A, size_A);
+    patternB = setJacobianPattern(data, threadData, data->callback->INDEX_JAC_B, data->callback->initialAnalyticJacobianB, matrixB, size_A, size_Inputs);
+    patternC = setJacobianPattern(data, threadData, data->callback->INDEX_JAC_C, data->callback->initialAnalyticJacobianC, matrixC, size_Outputs, size_A);
+    patternD = setJacobianPattern(data, threadData, data->callback->INDEX_JAC_D, data->callback->initialAnalyticJacobianD, matrixD, size_Outputs, size_Inputs);
+    symbolic = patternA && data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_A].sizeTmpVars > 0;
 
-    /* Need to do this before changing anything so that we get a proper z0 */
     if(do_data_recovery > 0){
-        if(size_z){
-            strZ0 = "{" + array2string(&data->localData[0]->realVars[2*size_A],1,size_z) + "}";
-        }else{
-            strZ0 = "zeros(0)";
-        }
+        setDensePattern(matrixCz, size_z, size_A);
+        setDensePattern(matrixDz, size_z, size_Inputs);
+        /* Need to do this before changing anything so that we get a proper z0 */
+        z0.assign(&data->localData[0]->realVars[2*size_A], &data->localData[0]->realVars[2*size_A] + size_z);
     }
 
     /* Can currently only extract data recovery matrices Cz and Dz numerically, so we do this first if necessary */
-    if(do_data_recovery > 0 || data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_A].sizeTmpVars == 0){
+    if(do_data_recovery > 0 || !(symbolic && patternC)){
         /* Calculate numeric Jacobian */
-        if(functionJacAC_num(data, threadData, matrixA, matrixC, matrixCz))
+        if(functionJac_num(data, threadData, 1, matrixA, matrixC, do_data_recovery > 0 ? &matrixCz : NULL))
         {
             throwStreamPrint(threadData, "Error, can not get Matrix A or C ");
             TRACE_POP
             return 1;
         }
-        if(functionJacBD_num(data, threadData, matrixB, matrixD, matrixDz))
+    }
+    if(do_data_recovery > 0 || !(symbolic && patternB && patternD)){
+        if(functionJac_num(data, threadData, 0, matrixB, matrixD, do_data_recovery > 0 ? &matrixDz : NULL))
         {
             throwStreamPrint(threadData, "Error, can not get Matrix B or D ");
             TRACE_POP
@@ -510,75 +511,62 @@ int linearize(DATA* data, threadData_t *threadData)
     }
 
     /* Check if symbolic Jacobian available, if it is then use it (overwriting A,B,C,D if also doing data recovery) */
-    if (data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_A].sizeTmpVars > 0){
-        /* Retrieve symbolic Jacobian */
-        /* Determine Matrix A */
-        ANALYTIC_JACOBIAN* jacobian = &(data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_A]);
-        if(!data->callback->initialAnalyticJacobianA(data, threadData, jacobian)){
-            assertStreamPrint(threadData,0==functionJacA(data, threadData, matrixA),"Error, can not get Matrix A ");
+    if(symbolic){
+        assertStreamPrint(threadData,0==functionJac_sym(data, threadData, data->callback->INDEX_JAC_A, data->callback->functionJacA_column, matrixA),"Error, can not get Matrix A ");
+        if(patternB && patternD){
+            assertStreamPrint(threadData,0==functionJac_sym(data, threadData, data->callback->INDEX_JAC_B, data->callback->functionJacB_column, matrixB),"Error, can not get Matrix B ");
+            assertStreamPrint(threadData,0==functionJac_sym(data, threadData, data->callback->INDEX_JAC_D, data->callback->functionJacD_column, matrixD),"Error, can not get Matrix D ");
         }
-
-        /* Determine Matrix B */
-        jacobian = &(data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_B]);
-        if(!data->callback->initialAnalyticJacobianB(data, threadData, jacobian)){
-            assertStreamPrint(threadData,0==functionJacB(data, threadData, matrixB),"Error, can not get Matrix B ");
+        if(patternC){
+            assertStreamPrint(threadData,0==functionJac_sym(data, threadData, data->callback->INDEX_JAC_C, data->callback->functionJacC_column, matrixC),"Error, can not get Matrix C ");
         }
+    }
 
-        /* Determine Matrix C */
-        jacobian = &(data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_C]);
-        if(!data->callback->initialAnalyticJacobianC(data, threadData, jacobian)){
-            assertStreamPrint(threadData,0==functionJacC(data, threadData, matrixC),"Error, can not get Matrix C ");
-        }
+    logMatrix("A", matrixA, patternA ? data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_A].sparsePattern.maxColors : size_A);
+    logMatrix("B", matrixB, patternB ? data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_B].sparsePattern.maxColors : size_Inputs);
+    logMatrix("C", matrixC, patternC ? data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_C].sparsePattern.maxColors : size_A);
+    logMatrix("D", matrixD, patternD ? data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_D].sparsePattern.maxColors : size_Inputs);
 
-        /* Determine Matrix D */
-        jacobian = &(data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_D]);
-        if(!data->callback->initialAnalyticJacobianD(data, threadData, jacobian)){
-            assertStreamPrint(threadData,0==functionJacD(data, threadData, matrixD),"Error, can not get Matrix D ");
+    if(!do_mat_output){
+        strA = matrix2string(matrixA);
+        strB = matrix2string(matrixB);
+        strC = matrix2string(matrixC);
+        strD = matrix2string(matrixD);
+        if(do_data_recovery > 0){
+            strCz = matrix2string(matrixCz);
+            strDz = matrix2string(matrixDz);
+            if(size_z){
+                strZ0 = "{" + array2string(&z0[0],1,size_z) + "}";
+            }else{
+                strZ0 = "zeros(0)";
+            }
         }
-    }
 
-    strA = array2string(matrixA,size_A,size_A);
-    strB = array2string(matrixB,size_A,size_Inputs);
-    strC = array2string(matrixC,size_Outputs,size_A);
-    strD = array2string(matrixD,size_Outputs,size_Inputs);
-    if(do_data_recovery > 0){
-        strCz = array2string(matrixCz,size_z,size_A);
-        strDz = array2string(matrixDz,size_z,size_Inputs);
-    }
+        // The empty array {} is not valid modelica, so we need to put something
+        //   inside the curly braces for x0 and u0. {for i in in 1:0} will create an
+        //   empty array if needed.
+        if(size_A)
+          strX = "{" + array2string(data->localData[0]->realVars, 1, size_A) + "}";
+        else
+          strX = "zeros(0)";
 
-    // The empty array {} is not valid modelica, so we need to put something
-    //   inside the curly braces for x0 and u0. {for i in in 1:0} will create an
-    //   empty array if needed.
-    if(size_A)
-      strX = "{" + array2string(data->localData[0]->realVars, 1, size_A) + "}";
-    else
-      strX = "zeros(0)";
-
-    if(size_Inputs)
-      strU = "{" + array2string(data->simulationInfo->inputVars, 1, size_Inputs) + "}";
-    else
-      strU = "zeros(0)";
-
-    free(matrixA);
-    free(matrixB);
-    free(matrixC);
-    free(matrixD);
-    if(do_data_recovery > 0){
-        free(matrixCz);
-        free(matrixDz);
+        if(size_Inputs)
+          strU = "{" + array2string(data->simulationInfo->inputVars, 1, size_Inputs) + "}";
+        else
+          strU = "zeros(0)";
     }
 
     /* Use the result file name rather than the model name so that the linear file name can be changed with the -r flag, however strip _res.mat from the filename */
-    filename = string(data->modelData->resultFileName) + ".mo";
+    filename = string(data->modelData->resultFileName) + extension;
 	pos = filename.rfind("_res.mat");
 	if (pos != std::string::npos)
 	{
       // not found, use the modelFilePrefix
-	  filename = string(data->modelData->modelFilePrefix) + ".mo";
+	  filename = string(data->modelData->modelFilePrefix) + extension;
 	}
 	else
 	{
-      filename = filename.substr(0, pos) + ".mo";
+      filename = filename.substr(0, pos) + extension;
 	}
 #if defined(__MINGW32__) || defined(_MSC_VER)
     pos1 = filename.rfind('\\');
@@ -607,12 +595,32 @@ int linearize(DATA* data, threadData_t *threadData)
 
     FILE *fout = fopen(filename.c_str(),"wb");
     assertStreamPrint(threadData,0!=fout,"Cannot open File %s",filename.c_str());
-    if(do_data_recovery > 0){
+    if(do_mat_output){
+        vector<const char*> names(size_A > size_Inputs ? size_A : size_Inputs);
+        const char** pNames = names.empty() ? NULL : &names[0];
+        writeMatrix_matVer4(fout, "x0", size_A, 1, data->localData[0]->realVars, MatVer4Type_DOUBLE);
+        writeMatrix_matVer4(fout, "u0", size_Inputs, 1, data->simulationInfo->inputVars, MatVer4Type_DOUBLE);
+        writeMatrix_linear(fout, "A", matrixA);
+        writeMatrix_linear(fout, "B", matrixB);
+        writeMatrix_linear(fout, "C", matrixC);
+        writeMatrix_linear(fout, "D", matrixD);
+        if(do_data_recovery > 0){
+            writeMatrix_matVer4(fout, "z0", size_z, 1, z0.empty() ? NULL : &z0[0], MatVer4Type_DOUBLE);
+            writeMatrix_linear(fout, "Cz", matrixCz);
+            writeMatrix_linear(fout, "Dz", matrixDz);
+        }
+        for(int i=0; i<size_A; i++)
+            names[i] = data->modelData->realVarsData[i].info.name;
+        writeNames_matVer4(fout, "xNames", pNames, size_A);
+        if(size_Inputs)
+            data->callback->inputNames(data, (char**)pNames);
+        writeNames_matVer4(fout, "uNames", pNames, size_Inputs);
+    }else if(do_data_recovery > 0){
         fprintf(fout, data->callback->linear_model_datarecovery_frame(), strX.c_str(), strU.c_str(), strZ0.c_str(), strA.c_str(), strB.c_str(), strC.c_str(), strD.c_str(), strCz.c_str(), strDz.c_str());
     }else{
         fprintf(fout, data->callback->linear_model_frame(), strX.c_str(), strU.c_str(), strA.c_str(), strB.c_str(), strC.c_str(), strD.c_str());
     }
-    if(ACTIVE_STREAM(LOG_STATS)) {
+    if(ACTIVE_STREAM(LOG_STATS) && !do_mat_output) {
       infoStreamPrint(LOG_STATS, 0, data->callback->linear_model_frame(), strX.c_str(), strU.c_str(), strA.c_str(), strB.c_str(), strC.c_str(), strD.c_str());
     }
     fflush(fout);
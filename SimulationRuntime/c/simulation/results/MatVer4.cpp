@@ -89,6 +89,61 @@ void writeMatrix_matVer4(FILE* file, const char* name, size_t rows, size_t cols,
     fwrite(matrixData, size, rows * cols, file);
 }
 
+/* Writes a sparse double matrix given in compressed sparse column format. A MAT v4 sparse matrix is
+ * stored as (nnz+1) x 3 matrix of (1-based) row indices, column indices and values; the last row holds
+ * the dimension of the matrix. */
+void writeSparseMatrix_matVer4(FILE* file, const char* name, size_t rows, size_t cols, const unsigned int* colPtr, const unsigned int* rowIndex, const double* values)
+{
+  MatVer4Header header;
+  size_t nnz = colPtr[cols];
+  size_t i, j, k, n;
+  double buffer[1024];
+
+  header.type = (isBigEndian() ? 1000 : 0) + MatVer4Type_DOUBLE + 2 /* sparse */;
+  header.mrows = (unsigned int) (nnz + 1);
+  header.ncols = 3;
+  header.imagf = 0;
+  header.namelen = (unsigned int) strlen(name) + 1;
+
+  fwrite(&header, sizeof(MatVer4Header), 1, file);
+  fwrite(name, sizeof(uint8_t), header.namelen, file);
+
+  /* row indices */
+  for (k = 0, n = 0; k < nnz; ++k)
+  {
+    buffer[n++] = rowIndex[k] + 1.0;
+    if (n == 1024 || k + 1 == nnz)
+    {
+      fwrite(buffer, sizeof(double), n, file);
+      n = 0;
+    }
+  }
+  buffer[0] = (double) rows;
+  fwrite(buffer, sizeof(double), 1, file);
+
+  /* column indices */
+  for (j = 0, n = 0; j < cols; ++j)
+  {
+    for (i = colPtr[j]; i < colPtr[j+1]; ++i)
+    {
+      buffer[n++] = j + 1.0;
+      if (n == 1024)
+      {
+        fwrite(buffer, sizeof(double), n, file);
+        n = 0;
+      }
+    }
+  }
+  buffer[n++] = (double) cols;
+  fwrite(buffer, sizeof(double), n, file);
+
+  /* values */
+  if (nnz > 0)
+    fwrite(values, sizeof(double), nnz, file);
+  buffer[0] = 0.0;
+  fwrite(buffer, sizeof(double), 1, file);
+}
+
 void updateHeader_matVer4(FILE* file, long position, const char* name, size_t rows, size_t additional_cols, MatVer4Type_t type)
 {
   MatVer4Header header;
@@ -65,6 +65,7 @@ typedef struct MatVer4Matrix
 size_t sizeofMatVer4Type(MatVer4Type_t type);
 
 void writeMatrix_matVer4(FILE* file, const char* name, size_t rows, size_t cols, const void* matrixData, MatVer4Type_t type);
+void writeSparseMatrix_matVer4(FILE* file, const char* name, size_t rows, size_t cols, const unsigned int* colPtr, const unsigned int* rowIndex, const double* values);
 void updateHeader_matVer4(FILE* file, long position, const char* name, size_t rows, size_t additional_cols, MatVer4Type_t type);
 void appendMatrix_matVer4(FILE* file, long position, const char* name, size_t rows, size_t cols, const void* matrixData, MatVer4Type_t type);
 
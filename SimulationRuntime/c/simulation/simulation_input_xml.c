@@ -49,6 +49,9 @@
 #include "util/uthash.h"
 #include <string.h>
 #include <ctype.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 #include <expat.h>
 
 typedef struct hash_string_string
@@ -206,6 +209,10 @@ typedef hash_string_long omc_CommandLineOverridesUses;
 
 // function to handle command line settings override
 void doOverride(omc_ModelInput *mi, MODEL_DATA* modelData, const char* override, const char* overrideFile);
+static omc_CommandLineOverrides* readOverrides(const char *override, const char *overrideFile, omc_CommandLineOverridesUses **mOverridesUses);
+static void overrideDefaultExperiment(omc_ModelInput *mi, omc_CommandLineOverrides *mOverrides, omc_CommandLineOverridesUses **mOverridesUses);
+static const char* getOverrideValue(omc_CommandLineOverrides *mOverrides, omc_CommandLineOverridesUses **mOverridesUses, const char *name);
+static void checkUnusedOverrides(omc_CommandLineOverridesUses *mOverridesUses);
 
 static const double REAL_MIN = -DBL_MAX;
 static const double REAL_MAX = DBL_MAX;
@@ -414,17 +421,728 @@ static void read_var_attribute_string(omc_ScalarVariable *v, STRING_ATTRIBUTE *a
   infoStreamPrint(LOG_DEBUG, 0, "String %s(start=%s)", findHashStringString(v,"name"), MMC_STRINGDATA(attribute->start));
 }
 
+/* binary image of the parsed init xml file, used with -initCache.
+ * layout: header, key/value string offsets of fmiModelDescription and
+ * DefaultExperiment, one record per variable in the order of the classes
+ * below, string table. the payload after the header is checksummed. */
+#define INIT_CACHE_VERSION    1
+#define INIT_CACHE_BYTE_ORDER 0x01020304
+
+enum omc_InitCacheClass
+{
+  INIT_CACHE_R_STA = 0,
+  INIT_CACHE_R_DER,
+  INIT_CACHE_R_ALG,
+  INIT_CACHE_R_PAR,
+  INIT_CACHE_R_ALI,
+  INIT_CACHE_I_ALG,
+  INIT_CACHE_I_PAR,
+  INIT_CACHE_I_ALI,
+  INIT_CACHE_B_ALG,
+  INIT_CACHE_B_PAR,
+  INIT_CACHE_B_ALI,
+  INIT_CACHE_S_ALG,
+  INIT_CACHE_S_PAR,
+  INIT_CACHE_S_ALI,
+  INIT_CACHE_CLASSES
+};
+
+static const char INIT_CACHE_MAGIC[8] = "OMCINIT";
+static const char INIT_CACHE_KIND[INIT_CACHE_CLASSES] = {'r','r','r','r','a','i','i','a','b','b','a','s','s','a'};
+
+/* flags of a cached variable */
+#define INIT_CACHE_PROTECTED   0x01
+#define INIT_CACHE_HIDE_RESULT 0x02
+#define INIT_CACHE_CHANGEABLE  0x04
+#define INIT_CACHE_FIXED       0x08
+#define INIT_CACHE_USE_NOMINAL 0x10
+#define INIT_CACHE_START       0x20  /* start value of booleans */
+#define INIT_CACHE_NEGATE      0x40
+
+typedef struct omc_InitCacheHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t byteOrder;
+  uint32_t headerSize;
+  uint32_t variableSize;
+  int64_t xmlSize;                     /* size and modification time of the xml file */
+  int64_t xmlTime;
+  int64_t nVariables[INIT_CACHE_CLASSES];
+  int64_t nModelDescription;           /* number of key/value pairs */
+  int64_t nDefaultExperiment;
+  int64_t stringsSize;
+  uint64_t payloadSize;
+  uint64_t checksum;
+} omc_InitCacheHeader;
+
+typedef struct omc_InitCacheVariable
+{
+  uint32_t name;                       /* offsets into the string table */
+  uint32_t comment;
+  uint32_t fileName;
+  uint32_t str;                        /* unit of reals, start value of strings */
+  int32_t id;
+  int32_t inputIndex;
+  int32_t lineStart;
+  int32_t colStart;
+  int32_t lineEnd;
+  int32_t colEnd;
+  int32_t readonly;
+  int32_t flags;
+  int32_t aliasID;
+  int32_t aliasType;                   /* 0 variable, 1 parameter, 2 time */
+  double start;                        /* reals */
+  double nominal;
+  double min;
+  double max;
+  int64_t istart;                      /* integers */
+  int64_t imin;
+  int64_t imax;
+} omc_InitCacheVariable;
+
+typedef struct omc_InitCache
+{
+  char *buffer;                        /* the whole file */
+  const omc_InitCacheHeader *header;
+  const uint32_t *modelDescription;
+  const uint32_t *defaultExperiment;
+  const omc_InitCacheVariable *vars[INIT_CACHE_CLASSES];
+  const char *strings;
+} omc_InitCache;
+
+typedef struct omc_InitCacheStrings
+{
+  char *data;
+  size_t size;
+  size_t capacity;
+  hash_string_long *offsets;
+} omc_InitCacheStrings;
+
+static void freeHashStringString(hash_string_string **ht)
+{
+  hash_string_string *c, *tmp;
+  HASH_ITER(hh, *ht, c, tmp) {
+    HASH_DEL(*ht, c);
+    free((void*)c->id);
+    free((void*)c->val);
+    free(c);
+  }
+}
+
+static void freeHashStringLong(hash_string_long **ht)
+{
+  hash_string_long *c, *tmp;
+  HASH_ITER(hh, *ht, c, tmp) {
+    HASH_DEL(*ht, c);
+    free((void*)c->id);
+    free(c);
+  }
+}
+
+static void initCacheClassSizes(MODEL_DATA *modelData, int64_t *n)
+{
+  n[INIT_CACHE_R_STA] = modelData->nStates;
+  n[INIT_CACHE_R_DER] = modelData->nStates;
+  n[INIT_CACHE_R_ALG] = modelData->nVariablesReal - 2*modelData->nStates;
+  n[INIT_CACHE_R_PAR] = modelData->nParametersReal;
+  n[INIT_CACHE_R_ALI] = modelData->nAliasReal;
+  n[INIT_CACHE_I_ALG] = modelData->nVariablesInteger;
+  n[INIT_CACHE_I_PAR] = modelData->nParametersInteger;
+  n[INIT_CACHE_I_ALI] = modelData->nAliasInteger;
+  n[INIT_CACHE_B_ALG] = modelData->nVariablesBoolean;
+  n[INIT_CACHE_B_PAR] = modelData->nParametersBoolean;
+  n[INIT_CACHE_B_ALI] = modelData->nAliasBoolean;
+  n[INIT_CACHE_S_ALG] = modelData->nVariablesString;
+  n[INIT_CACHE_S_PAR] = modelData->nParametersString;
+  n[INIT_CACHE_S_ALI] = modelData->nAliasString;
+}
+
+/* FNV-1a over 64 bit words, size has to be a multiple of 8 to chain calls */
+static uint64_t initCacheChecksum(uint64_t hash, const char *data, size_t size)
+{
+  uint64_t word;
+  size_t i;
+  for (i = 0; i + 8 <= size; i += 8) {
+    memcpy(&word, data + i, 8);
+    hash = (hash ^ word) * UINT64_C(1099511628211);
+  }
+  for (; i < size; i++) {
+    hash = (hash ^ (unsigned char) data[i]) * UINT64_C(1099511628211);
+  }
+  return hash;
+}
+
+/* returns the cache file for the given xml file, model_init.xml -> model_init.bin */
+static char* initCacheFilename(const char *xmlFile)
+{
+  size_t len = strlen(xmlFile);
+  char *res = (char*) malloc(len + 5);
+  strcpy(res, xmlFile);
+  if (len > 4 && 0 == strcmp(res + len - 4, ".xml")) {
+    len -= 4;
+  }
+  strcpy(res + len, ".bin");
+  return res;
+}
+
+static uint32_t initCacheString(omc_InitCacheStrings *strings, const char *str)
+{
+  long *it = findHashStringLongPtr(strings->offsets, str);
+  size_t len, offset;
+  if (it) {
+    return (uint32_t) *it;
+  }
+  len = strlen(str) + 1;
+  if (strings->size + len > strings->capacity) {
+    strings->capacity = 2*(strings->size + len);
+    strings->data = (char*) realloc(strings->data, strings->capacity);
+  }
+  offset = strings->size;
+  memcpy(strings->data + offset, str, len);
+  strings->size += len;
+  addHashStringLong(&strings->offsets, str, (long) offset);
+  return (uint32_t) offset;
+}
+
+static void initCacheVariable(omc_InitCacheVariable *cv, omc_ScalarVariable *v, char kind, omc_InitCacheStrings *strings)
+{
+  modelica_integer value;
+  modelica_boolean flag;
+  int id;
+
+  memset(cv, 0, sizeof(omc_InitCacheVariable));
+  cv->name = initCacheString(strings, findHashStringString(v, "name"));
+  cv->comment = initCacheString(strings, findHashStringStringEmpty(v, "description"));
+  cv->fileName = initCacheString(strings, findHashStringString(v, "fileName"));
+  read_value_int(findHashStringString(v, "valueReference"), &id);
+  cv->id = id;
+  read_value_long(findHashStringStringNull(v, "inputIndex"), &value, -1);
+  cv->inputIndex = value;
+  read_value_long(findHashStringString(v, "startLine"), &value, 0);
+  cv->lineStart = value;
+  read_value_long(findHashStringString(v, "startColumn"), &value, 0);
+  cv->colStart = value;
+  read_value_long(findHashStringString(v, "endLine"), &value, 0);
+  cv->lineEnd = value;
+  read_value_long(findHashStringString(v, "endColumn"), &value, 0);
+  cv->colEnd = value;
+  read_value_long(findHashStringString(v, "fileWritable"), &value, 0);
+  cv->readonly = value;
+
+  if (0 == strcmp(findHashStringStringEmpty(v, "isProtected"), "true")) {
+    cv->flags |= INIT_CACHE_PROTECTED;
+  }
+  if (0 == strcmp(findHashStringStringEmpty(v, "hideResult"), "true")) {
+    cv->flags |= INIT_CACHE_HIDE_RESULT;
+  }
+  if (0 == strcmp(findHashStringStringEmpty(v, "isValueChangeable"), "true")) {
+    cv->flags |= INIT_CACHE_CHANGEABLE;
+  }
+
+  switch (kind) {
+  case 'r':
+    read_value_real(findHashStringStringEmpty(v, "start"), &cv->start, 0.0);
+    read_value_real(findHashStringStringEmpty(v, "nominal"), &cv->nominal, 1.0);
+    read_value_real(findHashStringStringEmpty(v, "min"), &cv->min, REAL_MIN);
+    read_value_real(findHashStringStringEmpty(v, "max"), &cv->max, REAL_MAX);
+    read_value_bool(findHashStringString(v, "useNominal"), &flag);
+    cv->flags |= flag ? INIT_CACHE_USE_NOMINAL : 0;
+    cv->str = initCacheString(strings, findHashStringStringEmpty(v, "unit"));
+    break;
+  case 'i':
+    read_value_long(findHashStringStringEmpty(v, "start"), &value, 0);
+    cv->istart = value;
+    read_value_long(findHashStringStringEmpty(v, "min"), &value, INTEGER_MIN);
+    cv->imin = value;
+    read_value_long(findHashStringStringEmpty(v, "max"), &value, INTEGER_MAX);
+    cv->imax = value;
+    break;
+  case 'b':
+    read_value_bool(findHashStringStringEmpty(v, "start"), &flag);
+    cv->flags |= flag ? INIT_CACHE_START : 0;
+    break;
+  case 's':
+    cv->str = initCacheString(strings, findHashStringStringEmpty(v, "start"));
+    break;
+  case 'a':
+    cv->flags |= 0 == strcmp(findHashStringStringEmpty(v, "alias"), "negatedAlias") ? INIT_CACHE_NEGATE : 0;
+    break;
+  }
+
+  if (kind != 'a' && kind != 's') {
+    read_value_bool(findHashStringString(v, "fixed"), &flag);
+    cv->flags |= flag ? INIT_CACHE_FIXED : 0;
+  }
+}
+
+/* writes the binary cache of the parsed xml file, the values are stored before overrides are applied */
+static void initCacheWrite(omc_ModelInput *mi, MODEL_DATA *modelData, const char *cacheFile, const char *xmlFile)
+{
+  omc_ModelVariables *classes[INIT_CACHE_CLASSES];
+  omc_InitCacheHeader header;
+  omc_InitCacheStrings strings = {0};
+  omc_InitCacheVariable *vars = NULL, *cv;
+  hash_string_long *mapAlias = NULL, *mapAliasParam = NULL;
+  hash_string_string *c, *tmp;
+  uint32_t *pairs = NULL;
+  size_t nVars = 0, nPairs, pos, k;
+  char *tmpFile = NULL;
+  FILE *file = NULL;
+  struct stat xmlStat;
+  int64_t i;
+  int success = 0;
+
+  if (0 != stat(xmlFile, &xmlStat)) {
+    return;
+  }
+
+  classes[INIT_CACHE_R_STA] = mi->rSta;
+  classes[INIT_CACHE_R_DER] = mi->rDer;
+  classes[INIT_CACHE_R_ALG] = mi->rAlg;
+  classes[INIT_CACHE_R_PAR] = mi->rPar;
+  classes[INIT_CACHE_R_ALI] = mi->rAli;
+  classes[INIT_CACHE_I_ALG] = mi->iAlg;
+  classes[INIT_CACHE_I_PAR] = mi->iPar;
+  classes[INIT_CACHE_I_ALI] = mi->iAli;
+  classes[INIT_CACHE_B_ALG] = mi->bAlg;
+  classes[INIT_CACHE_B_PAR] = mi->bPar;
+  classes[INIT_CACHE_B_ALI] = mi->bAli;
+  classes[INIT_CACHE_S_ALG] = mi->sAlg;
+  classes[INIT_CACHE_S_PAR] = mi->sPar;
+  classes[INIT_CACHE_S_ALI] = mi->sAli;
+
+  memset(&header, 0, sizeof(omc_InitCacheHeader));
+  memcpy(header.magic, INIT_CACHE_MAGIC, sizeof(header.magic));
+  header.version = INIT_CACHE_VERSION;
+  header.byteOrder = INIT_CACHE_BYTE_ORDER;
+  header.headerSize = sizeof(omc_InitCacheHeader);
+  header.variableSize = sizeof(omc_InitCacheVariable);
+  header.xmlSize = (int64_t) xmlStat.st_size;
+  header.xmlTime = (int64_t) xmlStat.st_mtime;
+  initCacheClassSizes(modelData, header.nVariables);
+  for (k = 0; k < INIT_CACHE_CLASSES; k++) {
+    nVars += header.nVariables[k];
+  }
+  header.nModelDescription = HASH_COUNT(mi->md);
+  header.nDefaultExperiment = HASH_COUNT(mi->de);
+
+  nPairs = header.nModelDescription + header.nDefaultExperiment;
+  pairs = (uint32_t*) malloc((2*nPairs + 1)*sizeof(uint32_t));
+  vars = (omc_InitCacheVariable*) malloc((nVars + 1)*sizeof(omc_InitCacheVariable));
+
+  pos = 0;
+  HASH_ITER(hh, mi->md, c, tmp) {
+    pairs[pos++] = initCacheString(&strings, c->id);
+    pairs[pos++] = initCacheString(&strings, c->val);
+  }
+  HASH_ITER(hh, mi->de, c, tmp) {
+    pairs[pos++] = initCacheString(&strings, c->id);
+    pairs[pos++] = initCacheString(&strings, c->val);
+  }
+
+  /* the aliased variables of every type are stored before its aliases */
+  cv = vars;
+  for (k = 0; k < INIT_CACHE_CLASSES; k++) {
+    for (i = 0; i < header.nVariables[k]; i++, cv++) {
+      omc_ScalarVariable *v = *findHashLongVar(classes[k], i);
+      initCacheVariable(cv, v, INIT_CACHE_KIND[k], &strings);
+      if (INIT_CACHE_KIND[k] != 'a') {
+        int isParameter = k == INIT_CACHE_R_PAR || k == INIT_CACHE_I_PAR || k == INIT_CACHE_B_PAR || k == INIT_CACHE_S_PAR;
+        long index = k == INIT_CACHE_R_DER ? modelData->nStates + i : (k == INIT_CACHE_R_ALG ? 2*modelData->nStates + i : i);
+        addHashStringLong(isParameter ? &mapAliasParam : &mapAlias, strings.data + cv->name, index);
+      } else {
+        const char *aliasName = findHashStringStringEmpty(v, "aliasVariable");
+        long *it = findHashStringLongPtr(mapAlias, aliasName);
+        long *itParam = findHashStringLongPtr(mapAliasParam, aliasName);
+        if (NULL != it) {
+          cv->aliasID = *it;
+          cv->aliasType = 0;
+        } else if (NULL != itParam) {
+          cv->aliasID = *itParam;
+          cv->aliasType = 1;
+        } else if (k == INIT_CACHE_R_ALI && 0 == strcmp(aliasName, "time")) {
+          cv->aliasType = 2;
+        } else {
+          /* reported while reading the variables from the xml file */
+          goto cleanup;
+        }
+      }
+    }
+  }
+
+  /* pad the string table so that every section is a multiple of 8 bytes */
+  initCacheString(&strings, "");
+  while (strings.size % 8) {
+    if (strings.size + 1 > strings.capacity) {
+      strings.capacity = strings.size + 8;
+      strings.data = (char*) realloc(strings.data, strings.capacity);
+    }
+    strings.data[strings.size++] = '\0';
+  }
+  header.stringsSize = strings.size;
+  header.payloadSize = 2*nPairs*sizeof(uint32_t) + nVars*sizeof(omc_InitCacheVariable) + strings.size;
+  header.checksum = initCacheChecksum(UINT64_C(14695981039346656037), (const char*) pairs, 2*nPairs*sizeof(uint32_t));
+  header.checksum = initCacheChecksum(header.checksum, (const char*) vars, nVars*sizeof(omc_InitCacheVariable));
+  header.checksum = initCacheChecksum(header.checksum, strings.data, strings.size);
+
+  /* write to a temporary file and rename it, concurrent runs never see a partial cache */
+  tmpFile = (char*) malloc(strlen(cacheFile) + 5);
+  sprintf(tmpFile, "%s.tmp", cacheFile);
+  file = fopen(tmpFile, "wb");
+  if (!file) {
+    goto cleanup;
+  }
+  success = 1 == fwrite(&header, sizeof(omc_InitCacheHeader), 1, file)
+         && 2*nPairs == fwrite(pairs, sizeof(uint32_t), 2*nPairs, file)
+         && nVars == fwrite(vars, sizeof(omc_InitCacheVariable), nVars, file)
+         && strings.size == fwrite(strings.data, 1, strings.size, file);
+  success = (0 == fclose(file)) && success;
+  if (success && 0 != rename(tmpFile, cacheFile)) {
+    /* rename does not replace an existing file on all platforms */
+    remove(cacheFile);
+    success = 0 == rename(tmpFile, cacheFile);
+  }
+  if (!success) {
+    remove(tmpFile);
+    warningStreamPrint(LOG_SIMULATION, 0, "simulation_input_xml.c: could not write the binary cache %s", cacheFile);
+  } else {
+    infoStreamPrint(LOG_SIMULATION, 0, "wrote binary cache %s of the setup file", cacheFile);
+  }
+
+cleanup:
+  free(tmpFile);
+  free(pairs);
+  free(vars);
+  free(strings.data);
+  freeHashStringLong(&strings.offsets);
+  freeHashStringLong(&mapAlias);
+  freeHashStringLong(&mapAliasParam);
+}
+
+/* checks that all offsets into the string table of the cache point into
+ * it and that the last string is terminated */
+static int initCacheCheckStrings(const omc_InitCache *cache, const int64_t *n)
+{
+  const omc_InitCacheHeader *header = cache->header;
+  uint64_t size = (uint64_t) header->stringsSize;
+  const omc_InitCacheVariable *cv;
+  int64_t i;
+  size_t k;
+
+  if (cache->strings[size-1] != '\0') {
+    return 0;
+  }
+  for (i = 0; i < 2*header->nModelDescription; i++) {
+    if (cache->modelDescription[i] >= size) {
+      return 0;
+    }
+  }
+  for (i = 0; i < 2*header->nDefaultExperiment; i++) {
+    if (cache->defaultExperiment[i] >= size) {
+      return 0;
+    }
+  }
+  for (k = 0; k < INIT_CACHE_CLASSES; k++) {
+    for (i = 0; i < n[k]; i++) {
+      cv = cache->vars[k] + i;
+      if (cv->name >= size || cv->comment >= size || cv->fileName >= size || cv->str >= size) {
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
+
+/* reads the binary cache with a single read, returns 0 if it does not
+ * exist, is corrupt or does not belong to the xml file and the model */
+static int initCacheRead(omc_InitCache *cache, omc_ModelInput *mi, MODEL_DATA *modelData, const char *cacheFile, const char *xmlFile)
+{
+  const omc_InitCacheHeader *header;
+  int64_t n[INIT_CACHE_CLASSES];
+  struct stat xmlStat;
+  FILE *file;
+  const char *pos, *guid = NULL;
+  size_t size, nVars = 0, k;
+  long end;
+  int64_t i;
+
+  memset(cache, 0, sizeof(omc_InitCache));
+  if (0 != stat(xmlFile, &xmlStat)) {
+    return 0;
+  }
+  file = fopen(cacheFile, "rb");
+  if (!file) {
+    return 0;
+  }
+  if (0 != fseek(file, 0L, SEEK_END) || (end = ftell(file)) < 0 || 0 != fseek(file, 0L, SEEK_SET)) {
+    fclose(file);
+    return 0;
+  }
+  size = (size_t) end;
+  if (size < sizeof(omc_InitCacheHeader)) {
+    fclose(file);
+    return 0;
+  }
+  cache->buffer = (char*) malloc(size);
+  if (!cache->buffer) {
+    fclose(file);
+    return 0;
+  }
+  if (1 != fread(cache->buffer, size, 1, file)) {
+    fclose(file);
+    free(cache->buffer);
+    cache->buffer = NULL;
+    return 0;
+  }
+  fclose(file);
+
+  header = cache->header = (const omc_InitCacheHeader*) cache->buffer;
+  initCacheClassSizes(modelData, n);
+  for (k = 0; k < INIT_CACHE_CLASSES; k++) {
+    nVars += n[k];
+  }
+  if (memcmp(header->magic, INIT_CACHE_MAGIC, sizeof(header->magic))
+    || header->version != INIT_CACHE_VERSION
+    || header->byteOrder != INIT_CACHE_BYTE_ORDER
+    || header->headerSize != sizeof(omc_InitCacheHeader)
+    || header->variableSize != sizeof(omc_InitCacheVariable)
+    || header->xmlSize != (int64_t) xmlStat.st_size
+    || header->xmlTime != (int64_t) xmlStat.st_mtime
+    || memcmp(header->nVariables, n, sizeof(n))
+    || header->nModelDescription < 0 || header->nDefaultExperiment < 0
+    || header->stringsSize <= 0 || header->stringsSize % 8
+    || header->payloadSize != size - sizeof(omc_InitCacheHeader)
+    || header->payloadSize != 2*(header->nModelDescription + header->nDefaultExperiment)*sizeof(uint32_t) + nVars*sizeof(omc_InitCacheVariable) + header->stringsSize
+    || header->checksum != initCacheChecksum(UINT64_C(14695981039346656037), cache->buffer + sizeof(omc_InitCacheHeader), header->payloadSize))
+  {
+    infoStreamPrint(LOG_SIMULATION, 0, "binary cache %s is outdated", cacheFile);
+    free(cache->buffer);
+    cache->buffer = NULL;
+    return 0;
+  }
+
+  pos = cache->buffer + sizeof(omc_InitCacheHeader);
+  cache->modelDescription = (const uint32_t*) pos;
+  pos += 2*header->nModelDescription*sizeof(uint32_t);
+  cache->defaultExperiment = (const uint32_t*) pos;
+  pos += 2*header->nDefaultExperiment*sizeof(uint32_t);
+  for (k = 0; k < INIT_CACHE_CLASSES; k++) {
+    cache->vars[k] = (const omc_InitCacheVariable*) pos;
+    pos += n[k]*sizeof(omc_InitCacheVariable);
+  }
+  cache->strings = pos;
+  if (!initCacheCheckStrings(cache, n)) {
+    infoStreamPrint(LOG_SIMULATION, 0, "binary cache %s is corrupt", cacheFile);
+    free(cache->buffer);
+    cache->buffer = NULL;
+    return 0;
+  }
+
+  for (i = 0; i < header->nModelDescription; i++) {
+    addHashStringString(&mi->md, cache->strings + cache->modelDescription[2*i], cache->strings + cache->modelDescription[2*i+1]);
+  }
+  for (i = 0; i < header->nDefaultExperiment; i++) {
+    addHashStringString(&mi->de, cache->strings + cache->defaultExperiment[2*i], cache->strings + cache->defaultExperiment[2*i+1]);
+  }
+
+  /* a cache of another model is outdated, the xml file itself is checked by read_input_xml */
+  guid = findHashStringStringNull(mi->md, "guid");
+  if (NULL != guid && strcmp(modelData->modelGUID, guid)) {
+    infoStreamPrint(LOG_SIMULATION, 0, "binary cache %s is outdated", cacheFile);
+    free(cache->buffer);
+    cache->buffer = NULL;
+    freeHashStringString(&mi->md);
+    freeHashStringString(&mi->de);
+    return 0;
+  }
+
+  infoStreamPrint(LOG_SIMULATION, 0, "read binary cache %s of the setup file", cacheFile);
+  return 1;
+}
+
+static void initCacheVarInfo(const omc_InitCache *cache, const omc_InitCacheVariable *cv, VAR_INFO *info)
+{
+  info->name = strdup(cache->strings + cv->name);
+  info->comment = strdup(cache->strings + cv->comment);
+  info->id = cv->id;
+  info->inputIndex = cv->inputIndex;
+  info->info.filename = strdup(cache->strings + cv->fileName);
+  info->info.lineStart = cv->lineStart;
+  info->info.colStart = cv->colStart;
+  info->info.lineEnd = cv->lineEnd;
+  info->info.colEnd = cv->colEnd;
+  info->info.readonly = cv->readonly;
+}
+
+static modelica_boolean initCacheFilterOutput(const omc_InitCacheVariable *cv, const char *name)
+{
+  int isProtected = cv->flags & INIT_CACHE_PROTECTED, hideResult = cv->flags & INIT_CACHE_HIDE_RESULT;
+
+  if (!omc_flag[FLAG_EMIT_PROTECTED] && isProtected && hideResult) {
+    infoStreamPrint(LOG_DEBUG, 0, "filtering protected variable %s", name);
+    return 1;
+  } else if (!omc_flag[FLAG_IGNORE_HIDERESULT] && hideResult && !isProtected) {
+    infoStreamPrint(LOG_DEBUG, 0, "filtering variable %s due to HideResult annotation", name);
+    return 1;
+  }
+  return 0;
+}
+
+static void initCacheAttributeReal(const omc_InitCache *cache, const omc_InitCacheVariable *cv, REAL_ATTRIBUTE *attribute)
+{
+  attribute->start = cv->start;
+  attribute->fixed = 0 != (cv->flags & INIT_CACHE_FIXED);
+  attribute->useNominal = 0 != (cv->flags & INIT_CACHE_USE_NOMINAL);
+  attribute->nominal = cv->nominal;
+  attribute->min = cv->min;
+  attribute->max = cv->max;
+  attribute->unit = mmc_mk_scon_persist(cache->strings + cv->str);
+}
+
+static void initCacheAttributeInt(const omc_InitCache *cache, const omc_InitCacheVariable *cv, INTEGER_ATTRIBUTE *attribute)
+{
+  attribute->start = cv->istart;
+  attribute->fixed = 0 != (cv->flags & INIT_CACHE_FIXED);
+  attribute->min = cv->imin;
+  attribute->max = cv->imax;
+}
+
+static void initCacheAttributeBool(const omc_InitCache *cache, const omc_InitCacheVariable *cv, BOOLEAN_ATTRIBUTE *attribute)
+{
+  attribute->start = 0 != (cv->flags & INIT_CACHE_START);
+  attribute->fixed = 0 != (cv->flags & INIT_CACHE_FIXED);
+}
+
+static void initCacheAttributeString(const omc_InitCache *cache, const omc_InitCacheVariable *cv, STRING_ATTRIBUTE *attribute)
+{
+  attribute->start = mmc_mk_scon_persist(cache->strings + cv->str);
+}
+
+/* fills the model data from the binary cache */
+static void initCacheReadVariables(const omc_InitCache *cache, MODEL_DATA *modelData)
+{
+  DATA_ALIAS *aliases[INIT_CACHE_CLASSES] = {0};
+  const int64_t *n = cache->header->nVariables;
+  size_t k;
+  int64_t i;
+
+#define READ_CACHED_VARIABLES(out, cls, attributeKind, start) \
+  for (i = 0; i < n[cls]; i++) \
+  { \
+    const omc_InitCacheVariable *cv = cache->vars[cls] + i; \
+    initCacheVarInfo(cache, cv, &out[start+i].info); \
+    attributeKind(cache, cv, &out[start+i].attribute); \
+    if (initCacheFilterOutput(cv, out[start+i].info.name)) { \
+      out[start+i].filterOutput = 1; \
+    } \
+  }
+
+  READ_CACHED_VARIABLES(modelData->realVarsData, INIT_CACHE_R_STA, initCacheAttributeReal, 0);
+  READ_CACHED_VARIABLES(modelData->realVarsData, INIT_CACHE_R_DER, initCacheAttributeReal, modelData->nStates);
+  READ_CACHED_VARIABLES(modelData->realVarsData, INIT_CACHE_R_ALG, initCacheAttributeReal, 2*modelData->nStates);
+  READ_CACHED_VARIABLES(modelData->integerVarsData, INIT_CACHE_I_ALG, initCacheAttributeInt, 0);
+  READ_CACHED_VARIABLES(modelData->booleanVarsData, INIT_CACHE_B_ALG, initCacheAttributeBool, 0);
+  READ_CACHED_VARIABLES(modelData->stringVarsData, INIT_CACHE_S_ALG, initCacheAttributeString, 0);
+
+  READ_CACHED_VARIABLES(modelData->realParameterData, INIT_CACHE_R_PAR, initCacheAttributeReal, 0);
+  READ_CACHED_VARIABLES(modelData->integerParameterData, INIT_CACHE_I_PAR, initCacheAttributeInt, 0);
+  READ_CACHED_VARIABLES(modelData->booleanParameterData, INIT_CACHE_B_PAR, initCacheAttributeBool, 0);
+  READ_CACHED_VARIABLES(modelData->stringParameterData, INIT_CACHE_S_PAR, initCacheAttributeString, 0);
+
+#undef READ_CACHED_VARIABLES
+
+  aliases[INIT_CACHE_R_ALI] = modelData->realAlias;
+  aliases[INIT_CACHE_I_ALI] = modelData->integerAlias;
+  aliases[INIT_CACHE_B_ALI] = modelData->booleanAlias;
+  aliases[INIT_CACHE_S_ALI] = modelData->stringAlias;
+  for (k = 0; k < INIT_CACHE_CLASSES; k++) {
+    if (INIT_CACHE_KIND[k] != 'a') {
+      continue;
+    }
+    for (i = 0; i < n[k]; i++) {
+      const omc_InitCacheVariable *cv = cache->vars[k] + i;
+      DATA_ALIAS *alias = aliases[k] + i;
+      initCacheVarInfo(cache, cv, &alias->info);
+      alias->negate = 0 != (cv->flags & INIT_CACHE_NEGATE);
+      alias->nameID = cv->aliasID;
+      alias->aliasType = cv->aliasType;
+      if (initCacheFilterOutput(cv, alias->info.name)) {
+        alias->filterOutput = 1;
+      }
+    }
+  }
+}
+
+/* applies -override and -overrideFile to the DefaultExperiment and the values read from the binary cache */
+static void initCacheOverride(const omc_InitCache *cache, omc_ModelInput *mi, MODEL_DATA *modelData, const char *override, const char *overrideFile)
+{
+  omc_CommandLineOverrides *mOverrides = NULL;
+  omc_CommandLineOverridesUses *mOverridesUses = NULL;
+  const int64_t *n = cache->header->nVariables;
+  size_t k;
+  int64_t i;
+
+  mOverrides = readOverrides(override, overrideFile, &mOverridesUses);
+  if (mOverrides == NULL) {
+    infoStreamPrint(LOG_SOLVER, 0, "NO override given on the command line.");
+    return;
+  }
+  overrideDefaultExperiment(mi, mOverrides, &mOverridesUses);
+
+  for (k = 0; k < INIT_CACHE_CLASSES; k++) {
+    for (i = 0; i < n[k]; i++) {
+      const omc_InitCacheVariable *cv = cache->vars[k] + i;
+      const char *name = cache->strings + cv->name, *value;
+      if (NULL == findHashStringStringNull(mOverrides, name)) {
+        continue;
+      }
+      if (!(cv->flags & INIT_CACHE_CHANGEABLE)) {
+        addHashStringLong(&mOverridesUses, name, OMC_OVERRIDE_USED);
+        warningStreamPrint(LOG_STDOUT, 0, "It is not possible to override the following quantity: %s\nIt seems to be structural, final, protected or evaluated or has a non-constant binding.", name);
+        continue;
+      }
+      value = getOverrideValue(mOverrides, &mOverridesUses, name);
+      infoStreamPrint(LOG_SOLVER, 0, "override %s = %s", name, value);
+      if ((k == INIT_CACHE_R_PAR || k == INIT_CACHE_I_PAR) && fabs(atof(value)) < 1e-6) {
+        warningStreamPrint(LOG_STDOUT, 0, "You are overriding %s with a small value or zero.\nThis could lead to numerically dirty solutions or divisions by zero if not tearingStrictness=veryStrict.", name);
+      }
+      switch (k) {
+      case INIT_CACHE_R_STA: read_value_real(value, &modelData->realVarsData[i].attribute.start, 0.0); break;
+      case INIT_CACHE_R_DER: read_value_real(value, &modelData->realVarsData[modelData->nStates+i].attribute.start, 0.0); break;
+      case INIT_CACHE_R_ALG: read_value_real(value, &modelData->realVarsData[2*modelData->nStates+i].attribute.start, 0.0); break;
+      case INIT_CACHE_R_PAR: read_value_real(value, &modelData->realParameterData[i].attribute.start, 0.0); break;
+      case INIT_CACHE_I_ALG: read_value_long(value, &modelData->integerVarsData[i].attribute.start, 0); break;
+      case INIT_CACHE_I_PAR: read_value_long(value, &modelData->integerParameterData[i].attribute.start, 0); break;
+      case INIT_CACHE_B_ALG: read_value_bool(value, &modelData->booleanVarsData[i].attribute.start); break;
+      case INIT_CACHE_B_PAR: read_value_bool(value, &modelData->booleanParameterData[i].attribute.start); break;
+      case INIT_CACHE_S_ALG: modelData->stringVarsData[i].attribute.start = mmc_mk_scon_persist(value); break;
+      case INIT_CACHE_S_PAR: modelData->stringParameterData[i].attribute.start = mmc_mk_scon_persist(value); break;
+      default: break; /* the start values of aliases are not used */
+      }
+    }
+  }
+
+  checkUnusedOverrides(mOverridesUses);
+  infoStreamPrint(LOG_SOLVER, 0, "override done!");
+}
+
 /* \brief
  *  Reads initial values from a text file.
  *
  *  The textfile should be given as argument to the main function using
- *  the -f file flag.
+ *  the -f file flag. With -initCache the values are read from a binary
+ *  cache next to the file, which is (re)created from the xml file if it
+ *  is missing or outdated.
  */
 void read_input_xml(MODEL_DATA* modelData,
     SIMULATION_INFO* simulationInfo)
 {
   omc_ModelInput mi = {0};
+  omc_InitCache cache = {0};
   const char *filename, *guid, *override, *overrideFile;
+  char *cacheFile = NULL;
+  int fromCache = 0;
   FILE* file = NULL;
   XML_Parser parser = NULL;
   hash_string_long *mapAlias = NULL, *mapAliasParam = NULL, *mapAliasSen = NULL;
@@ -455,51 +1173,65 @@ void read_input_xml(MODEL_DATA* modelData,
       }
     }
 
-    /* open the file and fail on error. we open it read-write to be sure other processes can overwrite it */
-    file = fopen(filename, "r");
-    if(!file) {
-      throwStreamPrint(NULL, "simulation_input_xml.c: Error: can not read file %s as setup file to the generated simulation code.",filename);
+    /* sensitivities are only read from the xml file */
+    if (omc_flag[FLAG_INIT_CACHE] && !omc_flag[FLAG_IDAS]) {
+      cacheFile = initCacheFilename(filename);
+      fromCache = initCacheRead(&cache, &mi, modelData, cacheFile, filename);
+    }
+
+    if (!fromCache) {
+      /* open the file and fail on error. we open it read-write to be sure other processes can overwrite it */
+      file = fopen(filename, "r");
+      if(!file) {
+        throwStreamPrint(NULL, "simulation_input_xml.c: Error: can not read file %s as setup file to the generated simulation code.",filename);
+      }
     }
   }
-  /* create the XML parser */
-  parser = XML_ParserCreate(NULL);
-  if(!parser)
-  {
-    fclose(file);
-    throwStreamPrint(NULL, "simulation_input_xml.c: Error: couldn't allocate memory for the XML parser!");
-  }
-  /* set our user data */
-  XML_SetUserData(parser, &mi);
-  /* set the handlers for start/end of element. */
-  XML_SetElementHandler(parser, startElement, endElement);
-  if(NULL == modelData->initXMLData)
+
+  if (!fromCache)
   {
-    int done;
-    char buf[BUFSIZ] = {0};
-    do
+    /* create the XML parser */
+    parser = XML_ParserCreate(NULL);
+    if(!parser)
     {
-      size_t len = fread(buf, 1, sizeof(buf), file);
-      done = len < sizeof(buf);
-      if(XML_STATUS_ERROR == XML_Parse(parser, buf, len, done))
+      fclose(file);
+      throwStreamPrint(NULL, "simulation_input_xml.c: Error: couldn't allocate memory for the XML parser!");
+    }
+    /* set our user data */
+    XML_SetUserData(parser, &mi);
+    /* set the handlers for start/end of element. */
+    XML_SetElementHandler(parser, startElement, endElement);
+    if(NULL == modelData->initXMLData)
+    {
+      int done;
+      char buf[BUFSIZ] = {0};
+      do
       {
-        fclose(file);
-        warningStreamPrint(LOG_STDOUT, 0, "simulation_input_xml.c: Error: failed to read the XML file %s: %s at line %lu\n",
-            filename,
-            XML_ErrorString(XML_GetErrorCode(parser)),
-            XML_GetCurrentLineNumber(parser));
-        XML_ParserFree(parser);
-        throwStreamPrint(NULL, "see last warning");
-      }
-    }while(!done);
-    fclose(file);
-  } else if(XML_STATUS_ERROR == XML_Parse(parser, modelData->initXMLData, strlen(modelData->initXMLData), 1)) { /* Got the full string already */
-    fprintf(stderr, "%s, %s %lu\n", modelData->initXMLData, XML_ErrorString(XML_GetErrorCode(parser)), XML_GetCurrentLineNumber(parser));
-    warningStreamPrint(LOG_STDOUT, 0, "simulation_input_xml.c: Error: failed to read the XML data %s: %s at line %lu\n",
-             modelData->initXMLData,
-             XML_ErrorString(XML_GetErrorCode(parser)),
-             XML_GetCurrentLineNumber(parser));
+        size_t len = fread(buf, 1, sizeof(buf), file);
+        done = len < sizeof(buf);
+        if(XML_STATUS_ERROR == XML_Parse(parser, buf, len, done))
+        {
+          fclose(file);
+          warningStreamPrint(LOG_STDOUT, 0, "simulation_input_xml.c: Error: failed to read the XML file %s: %s at line %lu\n",
+              filename,
+              XML_ErrorString(XML_GetErrorCode(parser)),
+              XML_GetCurrentLineNumber(parser));
+          XML_ParserFree(parser);
+          throwStreamPrint(NULL, "see last warning");
+        }
+      }while(!done);
+      fclose(file);
+    } else if(XML_STATUS_ERROR == XML_Parse(parser, modelData->initXMLData, strlen(modelData->initXMLData), 1)) { /* Got the full string already */
+      fprintf(stderr, "%s, %s %lu\n", modelData->initXMLData, XML_ErrorString(XML_GetErrorCode(parser)), XML_GetCurrentLineNumber(parser));
+      warningStreamPrint(LOG_STDOUT, 0, "simulation_input_xml.c: Error: failed to read the XML data %s: %s at line %lu\n",
+               modelData->initXMLData,
+               XML_ErrorString(XML_GetErrorCode(parser)),
+               XML_GetCurrentLineNumber(parser));
+      XML_ParserFree(parser);
+      throwStreamPrint(NULL, "see last warning");
+    }
+    /* all values are copied to mi */
     XML_ParserFree(parser);
-    throwStreamPrint(NULL, "see last warning");
   }
 
   /* now we should have all the data inside omc_ModelInput mi. */
@@ -513,7 +1245,6 @@ void read_input_xml(MODEL_DATA* modelData,
         modelData->modelGUID,
         filename);
   } else if (strcmp(modelData->modelGUID, guid)) {
-    XML_ParserFree(parser);
     warningStreamPrint(LOG_STDOUT, 0, "Error, the GUID: %s from input data file: %s does not match the GUID compiled in the model: %s",
         guid,
         filename,
@@ -521,39 +1252,6 @@ void read_input_xml(MODEL_DATA* modelData,
     throwStreamPrint(NULL, "see last warning");
   }
 
-  // deal with override
-  override = omc_flagValue[FLAG_OVERRIDE];
-  overrideFile = omc_flagValue[FLAG_OVERRIDE_FILE];
-  doOverride(&mi, modelData, override, overrideFile);
-
-  /* read all the DefaultExperiment values */
-  infoStreamPrint(LOG_SIMULATION, 1, "read all the DefaultExperiment values:");
-
-  read_value_real(findHashStringString(mi.de,"startTime"), &(simulationInfo->startTime), 0);
-  infoStreamPrint(LOG_SIMULATION, 0, "startTime = %g", simulationInfo->startTime);
-
-  read_value_real(findHashStringString(mi.de,"stopTime"), &(simulationInfo->stopTime), 1.0);
-  infoStreamPrint(LOG_SIMULATION, 0, "stopTime = %g", simulationInfo->stopTime);
-
-  read_value_real(findHashStringString(mi.de,"stepSize"), &(simulationInfo->stepSize), (simulationInfo->stopTime - simulationInfo->startTime) / 500);
-  infoStreamPrint(LOG_SIMULATION, 0, "stepSize = %g", simulationInfo->stepSize);
-
-  read_value_real(findHashStringString(mi.de,"tolerance"), &(simulationInfo->tolerance), 1e-5);
-  infoStreamPrint(LOG_SIMULATION, 0, "tolerance = %g", simulationInfo->tolerance);
-
-  read_value_string(findHashStringString(mi.de,"solver"), &simulationInfo->solverMethod);
-  infoStreamPrint(LOG_SIMULATION, 0, "solver method: %s", simulationInfo->solverMethod);
-
-  read_value_string(findHashStringString(mi.de,"outputFormat"), &(simulationInfo->outputFormat));
-  infoStreamPrint(LOG_SIMULATION, 0, "output format: %s", simulationInfo->outputFormat);
-
-  read_value_string(findHashStringString(mi.de,"variableFilter"), &(simulationInfo->variableFilter));
-  infoStreamPrint(LOG_SIMULATION, 0, "variable filter: %s", simulationInfo->variableFilter);
-
-  read_value_string(findHashStringString(mi.md,"OPENMODELICAHOME"), &simulationInfo->OPENMODELICAHOME);
-  infoStreamPrint(LOG_SIMULATION, 0, "OPENMODELICAHOME: %s", simulationInfo->OPENMODELICAHOME);
-  messageClose(LOG_SIMULATION);
-
   read_value_long(findHashStringString(mi.md,"numberOfContinuousStates"),          &nxchk, 0);
   read_value_long(findHashStringString(mi.md,"numberOfRealAlgebraicVariables"),    &nychk, 0);
   read_value_long(findHashStringString(mi.md,"numberOfRealParameters"),            &npchk, 0);
@@ -591,10 +1289,59 @@ void read_input_xml(MODEL_DATA* modelData,
       warningStreamPrint(LOG_SIMULATION, 0, "nystr in setup file: %ld from model code: %ld", nystrchk, modelData->nVariablesString);
       messageClose(LOG_SIMULATION);
     }
-    XML_ParserFree(parser);
     EXIT(-1);
   }
 
+  // deal with override
+  override = omc_flagValue[FLAG_OVERRIDE];
+  overrideFile = omc_flagValue[FLAG_OVERRIDE_FILE];
+  if (fromCache) {
+    initCacheReadVariables(&cache, modelData);
+    initCacheOverride(&cache, &mi, modelData, override, overrideFile);
+    free(cache.buffer);
+  } else {
+    /* the cache holds the values without overrides */
+    if (NULL != cacheFile) {
+      initCacheWrite(&mi, modelData, cacheFile, filename);
+    }
+    doOverride(&mi, modelData, override, overrideFile);
+  }
+  free(cacheFile);
+
+  /* read all the DefaultExperiment values */
+  infoStreamPrint(LOG_SIMULATION, 1, "read all the DefaultExperiment values:");
+
+  read_value_real(findHashStringString(mi.de,"startTime"), &(simulationInfo->startTime), 0);
+  infoStreamPrint(LOG_SIMULATION, 0, "startTime = %g", simulationInfo->startTime);
+
+  read_value_real(findHashStringString(mi.de,"stopTime"), &(simulationInfo->stopTime), 1.0);
+  infoStreamPrint(LOG_SIMULATION, 0, "stopTime = %g", simulationInfo->stopTime);
+
+  read_value_real(findHashStringString(mi.de,"stepSize"), &(simulationInfo->stepSize), (simulationInfo->stopTime - simulationInfo->startTime) / 500);
+  infoStreamPrint(LOG_SIMULATION, 0, "stepSize = %g", simulationInfo->stepSize);
+
+  read_value_real(findHashStringString(mi.de,"tolerance"), &(simulationInfo->tolerance), 1e-5);
+  infoStreamPrint(LOG_SIMULATION, 0, "tolerance = %g", simulationInfo->tolerance);
+
+  read_value_string(findHashStringString(mi.de,"solver"), &simulationInfo->solverMethod);
+  infoStreamPrint(LOG_SIMULATION, 0, "solver method: %s", simulationInfo->solverMethod);
+
+  read_value_string(findHashStringString(mi.de,"outputFormat"), &(simulationInfo->outputFormat));
+  infoStreamPrint(LOG_SIMULATION, 0, "output format: %s", simulationInfo->outputFormat);
+
+  read_value_string(findHashStringString(mi.de,"variableFilter"), &(simulationInfo->variableFilter));
+  infoStreamPrint(LOG_SIMULATION, 0, "variable filter: %s", simulationInfo->variableFilter);
+
+  read_value_string(findHashStringString(mi.md,"OPENMODELICAHOME"), &simulationInfo->OPENMODELICAHOME);
+  infoStreamPrint(LOG_SIMULATION, 0, "OPENMODELICAHOME: %s", simulationInfo->OPENMODELICAHOME);
+  messageClose(LOG_SIMULATION);
+
+  if (fromCache) {
+    freeHashStringString(&mi.md);
+    freeHashStringString(&mi.de);
+    return;
+  }
+
   /* read all static data from File for every variable */
 
 #define READ_VARIABLES(out, in, attributeKind, read_var_attribute, debugName, start, nStates, mapAlias) \
@@ -847,8 +1594,6 @@ void read_input_xml(MODEL_DATA* modelData,
                 modelData->stringAlias[i].aliasType ? "string parameters" : "string variables");
   }
   messageClose(LOG_DEBUG);
-
-  XML_ParserFree(parser);
 }
 
 /* reads modelica_string value from a string */
@@ -926,11 +1671,10 @@ static const char* getOverrideValue(omc_CommandLineOverrides *mOverrides, omc_Co
   return findHashStringString(mOverrides, name);
 }
 
-void doOverride(omc_ModelInput *mi, MODEL_DATA *modelData, const char *override, const char *overrideFile)
+/* reads the overrides given by -override or -overrideFile, returns NULL if there are none */
+static omc_CommandLineOverrides* readOverrides(const char *override, const char *overrideFile, omc_CommandLineOverridesUses **mOverridesUses)
 {
   omc_CommandLineOverrides *mOverrides = NULL;
-  omc_CommandLineOverridesUses *mOverridesUses = NULL, *it = NULL, *ittmp = NULL;
-  mmc_sint_t i;
   char* overrideStr = NULL;
   if((override != NULL) && (overrideFile != NULL)) {
     throwStreamPrint(NULL, "simulation_input_xml.c: usage error you cannot have both -override and -overrideFile active at the same time. see Model -? for more info!");
@@ -992,7 +1736,6 @@ void doOverride(omc_ModelInput *mi, MODEL_DATA *modelData, const char *override,
 
   if (overrideStr != NULL) {
     char *value, *p;
-    const char *strs[] = {"solver","startTime","stopTime","stepSize","tolerance","outputFormat","variableFilter"};
     /* read override values */
     infoStreamPrint(LOG_SOLVER, 0, "read override values: %s", overrideStr);
     /* fix overrideStr to contain | instead of , for splitting */
@@ -1010,20 +1753,53 @@ void doOverride(omc_ModelInput *mi, MODEL_DATA *modelData, const char *override,
       value++;
       // map[key]=value
       addHashStringString(&mOverrides, p, value);
-      addHashStringLong(&mOverridesUses, p, OMC_OVERRIDE_UNUSED);
+      addHashStringLong(mOverridesUses, p, OMC_OVERRIDE_UNUSED);
 
       // move to next
       p = strtok(NULL, "!");
     }
 
     free(overrideStr);
+  }
 
-    // now we have all overrides in mOverrides, override mi now
-    for (i=0; i<sizeof(strs)/sizeof(char*); i++) {
-      if (findHashStringStringNull(mOverrides, strs[i])) {
-        addHashStringString(&mi->de, strs[i], getOverrideValue(mOverrides, &mOverridesUses, strs[i]));
-      }
+  return mOverrides;
+}
+
+/* overrides the values of the DefaultExperiment */
+static void overrideDefaultExperiment(omc_ModelInput *mi, omc_CommandLineOverrides *mOverrides, omc_CommandLineOverridesUses **mOverridesUses)
+{
+  const char *strs[] = {"solver","startTime","stopTime","stepSize","tolerance","outputFormat","variableFilter"};
+  mmc_sint_t i;
+
+  for (i=0; i<sizeof(strs)/sizeof(char*); i++) {
+    if (findHashStringStringNull(mOverrides, strs[i])) {
+      addHashStringString(&mi->de, strs[i], getOverrideValue(mOverrides, mOverridesUses, strs[i]));
     }
+  }
+}
+
+/* gives a warning if an override is not used #3204 */
+static void checkUnusedOverrides(omc_CommandLineOverridesUses *mOverridesUses)
+{
+  omc_CommandLineOverridesUses *it = NULL, *ittmp = NULL;
+
+  HASH_ITER(hh, mOverridesUses, it, ittmp) {
+    if (it->val == OMC_OVERRIDE_UNUSED) {
+      warningStreamPrint(LOG_STDOUT, 0, "simulation_input_xml.c: override variable name not found in model: %s\n", it->id);
+    }
+  }
+}
+
+void doOverride(omc_ModelInput *mi, MODEL_DATA *modelData, const char *override, const char *overrideFile)
+{
+  omc_CommandLineOverrides *mOverrides = NULL;
+  omc_CommandLineOverridesUses *mOverridesUses = NULL;
+  mmc_sint_t i;
+
+  mOverrides = readOverrides(override, overrideFile, &mOverridesUses);
+  if (mOverrides != NULL) {
+    // now we have all overrides in mOverrides, override mi now
+    overrideDefaultExperiment(mi, mOverrides, &mOverridesUses);
 
     #define CHECK_OVERRIDE(v,b) \
       if (findHashStringStringNull(mOverrides, findHashStringString(*findHashLongVar(mi->v,i),"name"))) { \
@@ -1085,12 +1861,7 @@ void doOverride(omc_ModelInput *mi, MODEL_DATA *modelData, const char *override,
       CHECK_OVERRIDE(sAli,0);
     }
 
-    // give a warning if an override is not used #3204
-    HASH_ITER(hh, mOverridesUses, it, ittmp) {
-      if (it->val == OMC_OVERRIDE_UNUSED) {
-        warningStreamPrint(LOG_STDOUT, 0, "simulation_input_xml.c: override variable name not found in model: %s\n", it->id);
-      }
-    }
+    checkUnusedOverrides(mOverridesUses);
 
     infoStreamPrint(LOG_SOLVER, 0, "override done!");
   } else {
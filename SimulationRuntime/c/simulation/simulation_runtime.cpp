@@ -901,6 +901,14 @@ int initRuntimeAndSimulation(int argc, char**argv, DATA *data, threadData_t *thr
     nonlinearSparseSolverMinSize = atoi(omc_flagValue[FLAG_NLS_MIN_SIZE]);
     infoStreamPrint(LOG_STDOUT, 0, "Maximum system size for using non-linear sparse solver changed to %d", nonlinearSparseSolverMinSize);
   }
+  if(omc_flag[FLAG_NLS_EXTRAPOLATION_ORDER]) {
+    nonlinearExtrapolationOrder = atoi(omc_flagValue[FLAG_NLS_EXTRAPOLATION_ORDER]);
+    if (nonlinearExtrapolationOrder < 0 || nonlinearExtrapolationOrder > 2) {
+      warningStreamPrint(LOG_STDOUT, 0, "Unsupported extrapolation order %d for non-linear systems, using 1 instead.", nonlinearExtrapolationOrder);
+      nonlinearExtrapolationOrder = 1;
+    }
+    infoStreamPrint(LOG_STDOUT, 0, "Extrapolation order of non-linear system start values changed to %d", nonlinearExtrapolationOrder);
+  }
   if(omc_flag[FLAG_NEWTON_XTOL]) {
     newtonXTol = atof(omc_flagValue[FLAG_NEWTON_XTOL]);
     infoStreamPrint(LOG_STDOUT, 0, "Tolerance for updating solution vector in Newton solver changed to %g", newtonXTol);
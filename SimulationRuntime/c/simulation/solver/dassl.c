@@ -161,6 +161,7 @@ int dassl_initial(DATA* data, threadData_t *threadData, SOLVER_INFO* solverInfo,
   dasslData->newdelta = (double*) malloc(N*sizeof(double));
   dasslData->stateDer = (double*) calloc(N, sizeof(double));
   dasslData->states = (double*) malloc(N*sizeof(double));
+  dasslData->parallelJacobian = NULL;
 
   data->simulationInfo->currentContext = CONTEXT_ALGEBRAIC;
 
@@ -327,6 +328,7 @@ int dassl_initial(DATA* data, threadData_t *threadData, SOLVER_INFO* solverInfo,
     case COLOREDNUMJAC:
       data->simulationInfo->jacobianEvals = data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_A].sparsePattern.maxColors;
       dasslData->jacobianFunction =  jacA_numColored;
+      dasslData->parallelJacobian = allocateParallelJacobian(data, threadData, &data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_A].sparsePattern, N, getJacobianThreads(), N);
       break;
     case COLOREDSYMJAC:
       data->simulationInfo->jacobianEvals = data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_A].sparsePattern.maxColors;
@@ -404,6 +406,7 @@ int dassl_deinitial(DASSL_DATA *dasslData)
   free(dasslData->newdelta);
   free(dasslData->states);
   free(dasslData->stateDer);
+  freeParallelJacobian(dasslData->parallelJacobian);
 
   free(dasslData);
 
@@ -994,12 +997,92 @@ int jacA_num(double *t, double *y, double *yprime, double *delta, double *matrix
   return 0;
 }
 
+/* arguments of jacA_numColored needed by the evaluation of one color */
+typedef struct DASSL_JACOBIAN_ARGS
+{
+  double *t;
+  double *yprime;
+  double *delta;
+  double *matrixA;
+  double *cj;
+  double *h;
+  double *wt;
+  int *ipar;
+  DASSL_DATA *dasslData;
+  ANALYTIC_JACOBIAN *jacobian;
+} DASSL_JACOBIAN_ARGS;
+
+/* \fn jacA_numColoredColumns(JACOBIAN_WORKER *worker, unsigned int color, void *userData)
+ *
+ *
+ * This function evaluates the columns of one color of jacA_numColored
+ * with the data of the given worker.
+ */
+static int jacA_numColoredColumns(JACOBIAN_WORKER *worker, unsigned int color, void *userData)
+{
+  DASSL_JACOBIAN_ARGS *args = (DASSL_JACOBIAN_ARGS*) userData;
+  DASSL_DATA *dasslData = args->dasslData;
+  DATA *data = worker->data;
+  double *rpar[3] = {(double*) (void*) data, (double*) (void*) dasslData, (double*) (void*) worker->threadData};
+  ANALYTIC_JACOBIAN* jacobian = args->jacobian;
+  SPARSE_PATTERN* sparsePattern = &jacobian->sparsePattern;
+
+  /* the states of the worker, they are perturbed and restored */
+  double *y = data->localData[0]->realVars;
+  double *yprime = args->yprime;
+  double *newdelta = worker->work;
+  double *delta_hh = dasslData->delta_hh;
+  double *ysave = dasslData->ysave;
+
+  double delta_h = numericalDifferentiationDeltaXsolver;
+  double delta_hhh;
+  int ires = 0;
+
+  const unsigned int *columns;
+  unsigned int nColumns, j, l, k, ii, c;
+
+  columns = getColorColumns(worker->parent, color, &nColumns);
+
+  for(c = 0; c < nColumns; c++)
+  {
+    ii = columns[c];
+    delta_hhh = *args->h * yprime[ii];
+    delta_hh[ii] = delta_h * fmax(fmax(fabs(y[ii]),fabs(delta_hhh)),fabs(1./args->wt[ii]));
+    delta_hh[ii] = (delta_hhh >= 0 ? delta_hh[ii] : -delta_hh[ii]);
+    delta_hh[ii] = y[ii] + delta_hh[ii] - y[ii];
+
+    ysave[ii] = y[ii];
+    y[ii] += delta_hh[ii];
+
+    delta_hh[ii] = 1. / delta_hh[ii];
+  }
+
+  (*dasslData->residualFunction)(args->t, y, yprime, args->cj, newdelta, &ires, (double*) rpar, args->ipar);
+
+  for(c = 0; c < nColumns; c++)
+  {
+    ii = columns[c];
+    j = sparsePattern->leadindex[ii];
+    while(j < sparsePattern->leadindex[ii+1])
+    {
+      l  =  sparsePattern->index[j];
+      k  = l + ii*jacobian->sizeRows;
+      args->matrixA[k] = (newdelta[l] - args->delta[l]) * delta_hh[ii];
+      j++;
+    };
+    y[ii] = ysave[ii];
+  }
+
+  return 0;
+}
+
 /* \fn jacA_numColored(double *t, double *y, double *yprime, double *deltaD, double *pd, double *cj, double *h, double *wt,
    double *rpar, int* ipar)
  *
  *
  * This function calculates a jacobian matrix by
  * numerical with forward finite differences and exploiting the coloring.
+ * The colors are evaluated concurrently if -jacobianThreads is greater than one.
  */
 int jacA_numColored(double *t, double *y, double *yprime, double *delta, double *matrixA, double *cj, double *h, double *wt, double *rpar, int *ipar)
 {
@@ -1008,63 +1091,18 @@ int jacA_numColored(double *t, double *y, double *yprime, double *delta, double
   DATA* data = (DATA*)(void*)((double**)rpar)[0];
   DASSL_DATA* dasslData = (DASSL_DATA*)(void*)((double**)rpar)[1];
   threadData_t *threadData = (threadData_t*)(void*)((double**)rpar)[2];
-
-  const int index = data->callback->INDEX_JAC_A;
-  ANALYTIC_JACOBIAN* jacobian = &(data->simulationInfo->analyticJacobians[index]);
-
-  double delta_h = numericalDifferentiationDeltaXsolver;
-  double delta_hhh;
-  int ires;
-  double* delta_hh = dasslData->delta_hh;
-  double* ysave = dasslData->ysave;
-  double* ypsave = dasslData->ypsave;
-
-  unsigned int i,j,l,k,ii;
+  DASSL_JACOBIAN_ARGS args = {t, yprime, delta, matrixA, cj, h, wt, ipar, dasslData,
+                              &(data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_A])};
+  int failed;
 
   /* set context for the start values extrapolation of non-linear algebraic loops */
   setContext(data, t, CONTEXT_JACOBIAN);
 
-  for(i = 0; i < jacobian->sparsePattern.maxColors; i++)
-  {
-    for(ii=0; ii < jacobian->sizeCols; ii++)
-    {
-      if(jacobian->sparsePattern.colorCols[ii]-1 == i)
-      {
-        delta_hhh = *h * yprime[ii];
-        delta_hh[ii] = delta_h * fmax(fmax(fabs(y[ii]),fabs(delta_hhh)),fabs(1./wt[ii]));
-        delta_hh[ii] = (delta_hhh >= 0 ? delta_hh[ii] : -delta_hh[ii]);
-        delta_hh[ii] = y[ii] + delta_hh[ii] - y[ii];
-
-        ysave[ii] = y[ii];
-        y[ii] += delta_hh[ii];
-
-        delta_hh[ii] = 1. / delta_hh[ii];
-      }
-    }
-
-    (*dasslData->residualFunction)(t, y, yprime, cj, dasslData->newdelta, &ires, rpar, ipar);
-
-    increaseJacContext(data);
-
-    for(ii = 0; ii < jacobian->sizeCols; ii++)
-    {
-      if(jacobian->sparsePattern.colorCols[ii]-1 == i)
-      {
-        j = jacobian->sparsePattern.leadindex[ii];
-        while(j < jacobian->sparsePattern.leadindex[ii+1])
-        {
-          l  =  jacobian->sparsePattern.index[j];
-          k  = l + ii*jacobian->sizeRows;
-          matrixA[k] = (dasslData->newdelta[l] - delta[l]) * delta_hh[ii];
-          j++;
-        };
-        y[ii] = ysave[ii];
-      }
-    }
-  }
+  /* y is the state vector of localData[0], the workers perturb their own copy */
+  failed = evaluateParallelJacobian(dasslData->parallelJacobian, data, threadData, jacA_numColoredColumns, &args);
 
   TRACE_POP
-  return 0;
+  return failed;
 }
 
 /* \fn callJacobian(double *t, double *y, double *yprime, double *deltaD, double *pd, double *cj, double *h, double *wt,
@@ -32,6 +32,7 @@
 #define DASSL_H
 
 #include "simulation/solver/solver_main.h"
+#include "simulation/solver/parallelJacobian.h"
 
 #define DDASKR _daskr_ddaskr_
 
@@ -72,6 +73,7 @@ typedef struct DASSL_DATA{
   double *newdelta;
   double *stateDer;
   double *states;
+  PARALLEL_JACOBIAN *parallelJacobian; /* color columns and workers of the colored numerical jacobian */
 
   /* function pointer of provided functions */
   int (*residualFunction)(double *t, double *x, double *xprime, double *cj, double *delta, int *ires, double *rpar, int* ipar);
@@ -1,7 +1,7 @@
 /*
  * This file is part of OpenModelica.
  *
- * Copyright (c) 1998-2014, Open Source Modelica Consortium (OSMC),
+ * Copyright (c) 1998-CurrentYear, Open Source Modelica Consortium (OSMC),
  * c/o Linköpings universitet, Department of Computer and Information Science,
  * SE-58183 Linköping, Sweden.
  *
@@ -28,460 +28,323 @@
  *
  */
 
-#include "simulation/simulation_runtime.h"
+/*! \file dopri45.c
+ *
+ * Dormand-Prince 5(4) method (DOPRI5) with step size control. The last
+ * stage of a step is the derivative at the new states and used as first
+ * stage of the next step (FSAL). The solver steps over the output points,
+ * the states at an output point are computed with the continuous extension
+ * of order 4 of Hairer, Norsett and Wanner, which needs no additional
+ * function evaluations. All work arrays are allocated once.
+ */
+
 #include "dopri45.h"
-#include <stdlib.h>
+
 #include <math.h>
+#include <stdlib.h>
 #include <string.h>
 
+#include "simulation/options.h"
+#include "simulation/solver/external_input.h"
+#include "util/omc_error.h"
+
+static const double dop_c[7] = { 0.0, 1.0/5.0, 3.0/10.0, 4.0/5.0, 8.0/9.0, 1.0, 1.0 };
+static const double dop_a[7][6] = { { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+                                    { 1.0/5.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+                                    { 3.0/40.0, 9.0/40.0, 0.0, 0.0, 0.0, 0.0 },
+                                    { 44.0/45.0, -56.0/15.0, 32.0/9.0, 0.0, 0.0, 0.0 },
+                                    { 19372.0/6561.0, -25360.0/2187.0, 64448.0/6561.0, -212.0/729.0, 0.0, 0.0 },
+                                    { 9017.0/3168.0, -355.0/33.0, 46732.0/5247.0, 49.0/176.0, -5103.0/18656.0, 0.0 },
+                                    { 35.0/384.0, 0.0, 500.0/1113.0, 125.0/192.0, -2187.0/6784.0, 11.0/84.0 } }; /* last row: b_i of order 5 */
+/* difference of the weights of order 5 and 4, error estimate */
+static const double dop_e[7] = { 71.0/57600.0, 0.0, -71.0/16695.0, 71.0/1920.0, -17253.0/339200.0, 22.0/525.0, -1.0/40.0 };
+/* continuous extension */
+static const double dop_d[7] = { -12715105075.0/11282082432.0, 0.0, 87487479700.0/32700410799.0, -10690763975.0/1880347072.0,
+                                 701980252875.0/199316789632.0, -1453857185.0/822651844.0, 69997945.0/29380423.0 };
+
+/*! \fn allocateDopri45
+ *
+ *  \param [ref] [solverInfo]
+ *  \param [in]  [size] number of states
+ *
+ *  Allocates the work arrays of the solver once for the whole simulation.
+ */
+int allocateDopri45(SOLVER_INFO* solverInfo, int size)
+{
+  DOPRI45_DATA* userdata = (DOPRI45_DATA*) calloc(1, sizeof(DOPRI45_DATA));
+  int i;
 
-const int dopri5_s = 7;
-const int dop5dense_s = 9;
-
-
-const double dop_bst[9][6] = { { 696.0, -2439.0, 3104.0, -1710.0, 384.0, 384.0 },
-                                         { 0.0, 0.0, 0.0, 0.0, 0.0, 1.0 },
-                                         { -12000.0, 25500.0, -16000.0, 3000.0, 0.0, 1113.0 },
-                                         { -3000.0, 6375.0, -4000.0, 750.0, 0.0, 192.0 },
-                                         { 52488.0, -111537.0, 69984.0, -13122.0, 0.0, 6784.0 },
-                                         { -264.0, 561.0, -352.0, 66.0, 0.0, 84.0 },
-                                         { 32.0, -63.0, 38.0, -7.0, 0.0, 8.0 },
-                                         { 0.0, 125.0, -250.0, 125.0, 0.0, 24.0 },
-                                         { 48.0, -112.0, 80.0, -16.0, 0.0, 3.0 } };
-const double dop_b5[9] = { 5179.0 / 57600.0, 0.0, 7571.0 / 16695.0,
-                                     393.0 / 640.0, -92097.0 / 339200.0, 187.0 / 2100.0,
-                                     1.0 / 40.0, 0.0, 0.0 }; /* b_i */
-const double dop_b4[9] = { 35.0 / 384.0, 0.0, 500.0 / 1113.0,
-                                     125.0 / 192.0, -2187.0 / 6784.0, 11.0 / 84.0,
-                                     0.0, 0.0, 0.0 }; /* ^b_i */
-const double dop_c[9] = { 0.0, 1.0 / 5.0, 3.0 / 10.0, 4.0 / 5.0, 8.0 / 9.0,
-                                    1.0, 1.0, 1.0 / 5.0, 1.0 / 2.0 };
-const double dop_a[][9] = { { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
-                                      { 1.0 / 5.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
-                                      { 3.0 / 40.0, 9.0 / 40.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
-                                      { 44.0 / 45.0, -56.0 / 15.0, 32.0 / 9.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
-                                      { 19372.0 / 6561.0, -25360.0 / 2187.0, 64448.0 / 6561.0, -212.0 / 729.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
-                                      { 9017.0 / 3168.0, -355.0 / 33.0, 46732.0 / 5247.0, 49.0 / 176.0, -5103.0 / 18656.0, 0.0, 0.0, 0.0, 0.0 },
-                                      { 35.0 / 384.0, 0.0, 500.0 / 1113.0, 125.0 / 192.0, -2187.0 / 6784.0, 11.0 / 84.0, 0.0, 0.0, 0.0 },
-                                      { 5207.0 / 48000.0, 0.0, 92.0 / 795.0, -79.0 / 960.0, 53217.0 / 848000.0, -11.0 / 300.0, 4.0 / 125.0, 0.0, 0.0 },
-                                      { 613.0 / 6144.0, 0.0, 125.0 / 318.0, -125.0 / 3072.0, 8019.0 / 108544.0, -11.0 / 192.0, 1.0 / 32.0, 0.0, 0.0 } };
-
-
-/*********************variable declaration for DOPRI5(4)***************************************/
-int
-dopri54(int(*f)(), double* x4, double* x5);
-
-
-int
-init_stepsize(int(*f)(), double tolerence);
-
+  userdata->work = (double*) calloc(13*(size_t)size + 1, sizeof(double));
+  userdata->x0 = userdata->work;
+  userdata->x1 = userdata->x0 + size;
+  for(i = 0; i < 7; i++)
+    userdata->k[i] = userdata->x1 + (i+1)*size;
+  for(i = 0; i < 4; i++)
+    userdata->rcont[i] = userdata->k[6] + (i+1)*size;
 
-double
-maxnorm(double* a, double* b) {
+  userdata->h = 0.0;
+  userdata->restart = 1;
+  userdata->denseValid = 0;
 
-  double max_value = 0;
-  int i;
-
-  for(i = 0; i < globalData->nStates; i++)
-  {
-    double c;
-    c = fabs(b[i] - a[i]);
-    if(c > max_value)
-      max_value = c;
-  }
-  return max_value;
+  solverInfo->solverData = (void*) userdata;
+  return 0;
 }
 
-double
-euklidnorm(double* a) {
-
-  double erg = 0;
-  int i;
-  for(i = 0; i < globalData->nStates; i++)
-  {
-    erg = pow(a[i], 2) + erg;
-  }
-  return sqrt(erg);
+/*! \fn freeDopri45
+ *
+ *  \param [ref] [solverInfo]
+ */
+int freeDopri45(SOLVER_INFO* solverInfo)
+{
+  DOPRI45_DATA* userdata = (DOPRI45_DATA*) solverInfo->solverData;
+  free(userdata->work);
+  free(userdata);
+  return 0;
 }
 
+/*! \fn dopri45_evalODE
+ *
+ *  Evaluates the derivatives at time t for the states in sData->realVars
+ *  and stores them in der.
+ */
+static void dopri45_evalODE(DATA* data, threadData_t *threadData, double t, double *der)
+{
+  SIMULATION_DATA *sData = (SIMULATION_DATA*)data->localData[0];
+  const int nx = data->modelData->nStates;
+
+  sData->timeValue = t;
+  /* read input vars */
+  externalInputUpdate(data);
+  data->callback->input_function(data, threadData);
+  /* eval ode equations */
+  data->callback->functionODE(data, threadData);
+  memcpy(der, sData->realVars + nx, nx*sizeof(double));
+}
 
-/***************************************    STEPSIZE  ***********************************/
-int
-init_stepsize(int(*f)(), double tolerence) {
-  double p = 4.0, d0norm = 0.0, d1norm = 0.0, d2norm = 0.0, h0 = 0.0, h1 = 0.0,
-         d, backupTime;
-  double* sc = (double*) malloc(globalData->nStates * sizeof(double*));
-  double* d0 = (double*) malloc(globalData->nStates * sizeof(double*));
-  double* d1 = (double*) malloc(globalData->nStates * sizeof(double*));
-  double* temp = (double*) malloc(globalData->nStates * sizeof(double*));
-  double* x0 = (double*) malloc(globalData->nStates * sizeof(double*));
-  double* y = (double*) malloc(globalData->nStates * sizeof(double*));
+/*! \fn dopri45_initialStepSize
+ *
+ *  Initial step size as proposed by Hairer, Norsett and Wanner (Solving
+ *  ODEs I, II.4), needs one function evaluation. rcont[0] is used as work
+ *  array.
+ */
+static double dopri45_initialStepSize(DATA* data, threadData_t *threadData, DOPRI45_DATA* userdata, double rtol, double atol)
+{
+  SIMULATION_DATA *sData = (SIMULATION_DATA*)data->localData[0];
+  const int nx = data->modelData->nStates;
+  double d0 = 0.0, d1 = 0.0, d2 = 0.0, h0, h1, sk;
   int i;
-  if(sim_verbose >= LOG_SOLVER)
-  {
-     fprintf(stdout, "Initializing stepsize...\n"); fflush(NULL);
-  }
-
-  if(tolerence <= 1e-6) {
-  tolerence = 1e-5;
-    fprintf(stdout, "| warning | DOPRI5: error tolerance too stringent *setting tolerance to 1e-5*\n"); fflush(NULL);
-  }
-
-  backupTime = globalData->timeValue;
-
-  for(i = 0; i < globalData->nStates; i++)
-  {
-    x0[i] = globalData->states[i]; /* initial values for solver (used as backup too) */
-    y[i] = globalData->statesDerivatives[i]; /* initial values for solver (used as backup too) */
-    /* if(sim_verbose >= LOG_SOLVER){ cout << "x0[" << i << "]: " << x0[i] << endl;  fflush(NULL); } for debugging */
-
-    sc[i] = tolerence + fabs(globalData->states[i]) * tolerence;
-    d0[i] = globalData->states[i] / sc[i];
-    d1[i] = globalData->statesDerivatives[i];
-  }
-
-  d0norm = euklidnorm(d0) / sqrt((double)globalData->nStates);
-  d1norm = euklidnorm(d1) / sqrt((double)globalData->nStates);
-
-  free(d0);
-  free(d1);
-
-  if(d0norm < 1e-5 || d1norm < 1e-5)
-  {
-    h0 = 1e-6;
-  } else {
-    h0 = 0.01 * d0norm / d1norm;
-  }
-
-  for(i = 0; i < globalData->nStates; i++)
-  {
-    globalData->states[i] = x0[i] + h0 * y[i]; /* give new states */
-  }
-  globalData->timeValue = globalData->timeValue + h0; /* set time */
-  f(); /* get new statesDerivatives */
-
-  for(i = 0; i < globalData->nStates; i++)
-  {
-    temp[i] = globalData->statesDerivatives[i] - y[i];
-  }
-
-  d2norm = (euklidnorm(temp) / sqrt((double)globalData->nStates)) / h0;
 
-  d = fmax(d1norm, d2norm);
-
-  if(d <= 1e-15)
+  for(i = 0; i < nx; i++)
   {
-    h1 = fmax(1e-6, h0 * 1e-3);
-  } else {
-    h1 = pow((0.01 / d), (1.0 / (p + 1.0)));
+    sk = atol + rtol*fabs(userdata->x0[i]);
+    d0 += (userdata->x0[i]/sk)*(userdata->x0[i]/sk);
+    d1 += (userdata->k[0][i]/sk)*(userdata->k[0][i]/sk);
   }
+  d0 = sqrt(d0/nx);
+  d1 = sqrt(d1/nx);
+  h0 = (d0 < 1e-5 || d1 < 1e-5) ? 1e-6 : 0.01*d0/d1;
 
-  globalData->current_stepsize = fmin(tolerence * 100 * h0, tolerence * h1);
+  /* explicit euler step */
+  for(i = 0; i < nx; i++)
+    sData->realVars[i] = userdata->x0[i] + h0*userdata->k[0][i];
+  dopri45_evalODE(data, threadData, userdata->t0 + h0, userdata->rcont[0]);
 
-  if(sim_verbose >= LOG_SOLVER)
+  for(i = 0; i < nx; i++)
   {
-      fprintf(stdout, "stepsize initialized: step = %g\n",
-            globalData->current_stepsize); fflush(NULL);
+    sk = atol + rtol*fabs(userdata->x0[i]);
+    d2 += ((userdata->rcont[0][i] - userdata->k[0][i])/sk)*((userdata->rcont[0][i] - userdata->k[0][i])/sk);
   }
+  d2 = sqrt(d2/nx)/h0;
 
-  for(i = 0; i < globalData->nStates; i++)
-  {
-    globalData->states[i] = x0[i]; /* reset states */
-    globalData->statesDerivatives[i] = y[i]; /* reset statesDerivatives */
-  }
-  globalData->timeValue = backupTime; /* reset time */
-
-  free(sc);
-  free(temp);
-  free(x0);
-  free(y);
-
-  return 0;
+  h1 = (fmax(d1, d2) <= 1e-15) ? fmax(1e-6, h0*1e-3) : pow(0.01/fmax(d1, d2), 1.0/5.0);
+  return fmin(100.0*h0, h1);
 }
 
-int
-stepsize_control(double start, double stop, double fixStep, int(*f)(),
-                 int reinit_step, int useInterpolation, double tolerance, int* reject) {
-
-  double maxVal = 0, alpha, delta, TTOL, erg;
-  double backupTime;
-  int retVal;
-  int retry = 0;
-  int i,l;
-
-  double* x4 = (double*) malloc(globalData->nStates * sizeof(double));
-
-  double* x5 = (double*) malloc(globalData->nStates * sizeof(double));
-  double** k = work_states;
-
-  backupTime = globalData->timeValue;
+/*! \fn dopri45_doStep
+ *
+ *  Computes one accepted step starting at t1, x1 with the first stage k[6].
+ *  Afterwards [t0, t1] is the new step. Returns 0 on success.
+ */
+static int dopri45_doStep(DATA* data, threadData_t *threadData, SOLVER_INFO* solverInfo, DOPRI45_DATA* userdata, double rtol, double atol, double maxStepSize)
+{
+  SIMULATION_DATA *sData = (SIMULATION_DATA*)data->localData[0];
+  const int nx = data->modelData->nStates;
+  const double stopTime = data->simulationInfo->stopTime;
+  double *tmp;
+  double h, err, sk, sum, fac;
+  int i, j, l;
 
-  TTOL = tolerance * 0.6; /* tolerance * sf */
+  /* the end of the last step is the begin of this step, k[6] becomes k[0] (FSAL) */
+  tmp = userdata->x0; userdata->x0 = userdata->x1; userdata->x1 = tmp;
+  tmp = userdata->k[0]; userdata->k[0] = userdata->k[6]; userdata->k[6] = tmp;
+  userdata->t0 = userdata->t1;
+  userdata->denseValid = 0;
 
-  if(reinit_step)
+  while(1)
   {
-    init_stepsize(functionODE, tolerance);
-    reinit_step = 0;
-  }
-
-  do {
-    retVal = dopri54(functionODE, x4, x5);
-
-    for(i = 0; i < globalData->nStates; i++)
+    h = userdata->h;
+    if(maxStepSize > 0 && h > maxStepSize)
+      h = maxStepSize;
+    /* do not step over the stop time, the model may not be defined there */
+    if(userdata->t0 + h > stopTime && stopTime > userdata->t0)
+      h = stopTime - userdata->t0;
+
+    if(h < 1e-14*fmax(fabs(userdata->t0), 1.0))
     {
-      for(l = 0; l < dopri5_s; l++)
-      {
-        erg = fabs((dop_b5[l] - dop_b4[l]) * k[l][i]);
-        if(erg > maxVal)
-          maxVal = erg;
-      }
+      errorStreamPrint(LOG_STDOUT, 0, "dopri45: step size too small (%g) at time %g", h, userdata->t0);
+      return -1;
     }
 
-    delta = globalData->current_stepsize * maxVal; /* error estimate */
-    alpha = pow((delta / TTOL), (1.0 / 5.0)); /* step ratio */
-
-    if(sim_verbose >= LOG_SOLVER)
+    /* stages 2..6 and the new states of order 5 */
+    for(j = 1; j < 7; j++)
     {
-      fprintf(stdout, "delta: %g\n", delta);
-      fprintf(stdout, "alpha: %g\n", alpha);
-      fflush(NULL);
-    }
-
-    if(delta < tolerance)
-    {
-      for(i = 0; i < globalData->nStates; i++)
-      {
-        globalData->states[i] += globalData->current_stepsize * x4[i]; /* give new states */
-      }
-      f(); /* get new statesDerivatives */
-      retry = 0;
-      globalData->current_stepsize = globalData->current_stepsize / fmax(alpha, 0.1);
-    } else {
-      reject = reject + 1;
-      retry = 1; /* do another step with new stepsize until step is valid */
-      globalData->current_stepsize = globalData->current_stepsize / fmin(alpha, 10.0);
-
-      if(sim_verbose >= LOG_SOLVER)
+      for(i = 0; i < nx; i++)
       {
-        fprintf(stdout, "| info | DOPRI5: ***!! step rejected !!***\n"); fflush(NULL);
+        sum = 0.0;
+        for(l = 0; l < j; l++)
+          sum += dop_a[j][l]*userdata->k[l][i];
+        sData->realVars[i] = userdata->x0[i] + h*sum;
       }
-
-      globalData->timeValue = backupTime; /* reset time */
-
-      if((*reject > (int)10e+4) || (globalData->current_stepsize < 1e-10)) /* to avoid infinite loops */
-      {
-        fprintf(stdout, "| error | DOPRI5: Too many steps rejected (>10e+4) or desired stepsize too small (< 1e-10)!.\n"); fflush(NULL);
-        free(x4);
-        free(x5);
-
-        return 1;
-      }
-    }
-
-    /* do not advance past t_stop */
-    if((globalData->timeValue + globalData->current_stepsize) > stop)
-    {
-      globalData->current_stepsize = stop - globalData->timeValue;
-      useInterpolation = 0;
+      if(j == 6)
+        memcpy(userdata->x1, sData->realVars, nx*sizeof(double));
+      dopri45_evalODE(data, threadData, userdata->t0 + dop_c[j]*h, userdata->k[j]);
     }
 
-    if(sim_verbose >= LOG_SOLVER)
+    /* error estimate */
+    err = 0.0;
+    for(i = 0; i < nx; i++)
     {
-      fprintf(stdout, "| info | DOPRI5: stepsize on next step: %g\n",
-              globalData->current_stepsize); fflush(NULL);
+      sum = 0.0;
+      for(l = 0; l < 7; l++)
+        sum += dop_e[l]*userdata->k[l][i];
+      sk = atol + rtol*fmax(fabs(userdata->x0[i]), fabs(userdata->x1[i]));
+      err += (h*sum/sk)*(h*sum/sk);
     }
-  } while (retry);
+    err = sqrt(err/nx);
 
-  free(x4);
-  free(x5);
+    /* steps */
+    solverInfo->solverStatsTmp[0] += 1;
+    /* function ODE evaluations */
+    solverInfo->solverStatsTmp[1] += 6;
 
-  return 0;
-}
-
-
-/***************************************    DOPRI54    ***********************************/
-int
-dopri54(int(*f)(), double* x4, double* x5) {
-  double** k = work_states;
-  double sum;
-  int i, j, l;
-
-  double* backupstats = (double*) malloc(globalData->nStates * sizeof(double));
-  double* backupderivatives = (double*) malloc(globalData->nStates * sizeof(double));
-
-  memcpy(backupstats, globalData->states, globalData->nStates * sizeof(double));
-  memcpy(backupderivatives, globalData->statesDerivatives, globalData->nStates * sizeof(double));
-
-  for(i = 1; i < dop5dense_s; i++)
-  {
-    for(j = 0; j < globalData->nStates; j++)
+    fac = pow(err, 1.0/5.0)/0.9;
+    if(err <= 1.0)
     {
-      k[i][j] = 0;
+      userdata->h = h/fmax(0.1, fmin(5.0, fac));
+      userdata->t1 = userdata->t0 + h;
+      infoStreamPrint(LOG_SOLVER_V, 0, "dopri45: accepted step [%g, %g], error %g, next step size %g", userdata->t0, userdata->t1, err, userdata->h);
+      return 0;
     }
-  }
 
-  for(j = 0; j < globalData->nStates; j++)
-  {
-    k[0][j] = globalData->statesDerivatives[j];
+    /* rejected step */
+    solverInfo->solverStatsTmp[3] += 1;
+    userdata->h = h/fmin(5.0, fac);
+    infoStreamPrint(LOG_SOLVER_V, 0, "dopri45: rejected step at time %g with step size %g, error %g", userdata->t0, h, err);
   }
+}
 
-  /* calculation of extra f's used by dense output included per step */
-  for(j = 1; j < dop5dense_s; j++)
-  {
-    /* set proper time to get derivatives */
-    globalData->timeValue = globalData->oldTime + dop_c[j] * globalData->current_stepsize;
-    for(i = 0; i < globalData->nStates; i++)
-    {
-      sum = 0;
-      for(l = 0; l < dop5dense_s; l++)
-      {
-        sum = sum + dop_a[j][l] * k[l][i];
-      }
-      globalData->states[i] = backupstats[i] + globalData->current_stepsize * sum;
-    }
-    f();
-    for(i = 0; i < globalData->nStates; i++)
-    {
-      k[j][i] = globalData->statesDerivatives[i];
-    }
-  }
-
-  globalData->timeValue = globalData->oldTime + globalData->current_stepsize; /* next solver step */
-
-  for(i = 0; i < globalData->nStates; i++)
-  {
-    sum = 0;
-    for(l = 0; l < dopri5_s; l++)
-    {
-      sum = sum + dop_b5[l] * k[l][i];
-    }
-    x5[i] = sum;
-    /* if(sim_verbose >= LOG_SOLVER){ cout << "dx5[" << i << "]: " << x5[i] << endl; fflush(NULL); }; for debugging */
-  }
+/*! \fn dopri45_denseOutput
+ *
+ *  Computes the states at time t in [t0, t1] of the current step with the
+ *  continuous extension.
+ */
+static void dopri45_denseOutput(DOPRI45_DATA* userdata, int nx, double t, double *x)
+{
+  const double h = userdata->t1 - userdata->t0;
+  const double theta = (t - userdata->t0)/h;
+  const double theta1 = 1.0 - theta;
+  double **rcont = userdata->rcont;
+  double **k = userdata->k;
+  int i;
 
-  for(i = 0; i < globalData->nStates; i++)
+  if(!userdata->denseValid)
   {
-    sum = 0;
-    for(l = 0; l < dopri5_s; l++)
+    for(i = 0; i < nx; i++)
     {
-      sum = sum + dop_b4[l] * k[l][i];
+      double ydiff = userdata->x1[i] - userdata->x0[i];
+      double bspl = h*k[0][i] - ydiff;
+      rcont[0][i] = ydiff;
+      rcont[1][i] = bspl;
+      rcont[2][i] = ydiff - h*k[6][i] - bspl;
+      rcont[3][i] = h*(dop_d[0]*k[0][i] + dop_d[2]*k[2][i] + dop_d[3]*k[3][i] + dop_d[4]*k[4][i] + dop_d[5]*k[5][i] + dop_d[6]*k[6][i]);
     }
-    x4[i] = sum;
-    /* if(sim_verbose >= LOG_SOLVER){ cout << "dx4[" << i << "]: " << x4[i] << endl; fflush(NULL); }; for debugging */
+    userdata->denseValid = 1;
   }
 
-  memcpy(globalData->states, backupstats, globalData->nStates * sizeof(double));
-  memcpy(globalData->statesDerivatives, backupderivatives, globalData->nStates * sizeof(double));
-
-  free(backupstats);
-  free(backupderivatives);
-
-  return 0;
+  for(i = 0; i < nx; i++)
+    x[i] = userdata->x0[i] + theta*(rcont[0][i] + theta1*(rcont[1][i] + theta*(rcont[2][i] + theta1*rcont[3][i])));
 }
 
-/******************************* interpolation module ************************************************/
-int
-interpolation_control(const int dideventstep, double interpolationStep,
-                      double fixStep, double stop) {
-
-  int i,l;
-  if(sim_verbose >= LOG_SOLVER)
-  {
-    fprintf(stdout, "| info | dense output: $$$$$\t interpolate data at %g\n", interpolationStep); fflush(NULL);
-  }
-  /* if(sim_verbose >= LOG_SOLVER)
-   * {
-   *   cout << "oldTime,Time,interpolate data at " << globalData->oldTime << ", "
-   *     << globalData->timeValue << ", " << interpolationStep << endl; fflush(NULL);
-   * } /* for debugging */
-
-  if(dideventstep == 1)
+/*! \fn dopri45_step
+ *
+ *  \param [ref] [data]
+ *  \param [ref] [threadData]
+ *  \param [ref] [solverInfo]
+ *
+ *  Integrates to solverInfo->currentTime + solverInfo->currentStepSize. The
+ *  internal steps do not stop at the output points. The solver restarts
+ *  after events or if the runtime continues from another time.
+ */
+int dopri45_step(DATA* data, threadData_t *threadData, SOLVER_INFO* solverInfo)
+{
+  DOPRI45_DATA* userdata = (DOPRI45_DATA*) solverInfo->solverData;
+  SIMULATION_DATA *sData = (SIMULATION_DATA*)data->localData[0];
+  SIMULATION_DATA *sDataOld = (SIMULATION_DATA*)data->localData[1];
+  const int nx = data->modelData->nStates;
+  const double rtol = data->simulationInfo->tolerance;
+  const double atol = data->simulationInfo->tolerance;
+  const double maxStepSize = omc_flag[FLAG_MAX_STEP_SIZE] ? atof(omc_flagValue[FLAG_MAX_STEP_SIZE]) : -1.0;
+  const double targetTime = sDataOld->timeValue + solverInfo->currentStepSize;
+
+  solverInfo->currentTime = targetTime;
+
+  if(nx == 0)
   {
-    /* Emit data after an event */
-    sim_result.emit(&sim_result,data);
+    sData->timeValue = targetTime;
+    return 0;
   }
 
-  if(((interpolationStep > globalData->oldTime) && (interpolationStep < globalData->timeValue)) ||
-      ((dideventstep == 1) && (interpolationStep < globalData->timeValue)))
+  if(userdata->restart || solverInfo->didEventStep || sDataOld->timeValue != userdata->lastTime)
   {
-    double** k = work_states;
-    double backupTime = globalData->timeValue;
-    double backupTime_old = globalData->oldTime;
-    double* backupstats = (double*) malloc(globalData->nStates * sizeof(double));
-    double* backupderivatives = (double*) malloc(globalData->nStates * sizeof(double));
-    double* backupstats_old = (double*) malloc(globalData->nStates * sizeof(double));
-    double bstar[9];
-    double numerator = 0, sigma, sh, sum;
-
-    /* save states and derivatives as they're altered by linear interpolation method */
-    for(i = 0; i < globalData->nStates; i++)
-    {
-      backupstats[i] = globalData->states[i];
-      backupderivatives[i] = globalData->statesDerivatives[i];
-      backupstats_old[i] = globalData->states_old[i];
-    }
+    infoStreamPrint(LOG_SOLVER, 0, "dopri45: (re)start at time %g", sDataOld->timeValue);
+    userdata->t0 = userdata->t1 = sDataOld->timeValue;
+    memcpy(userdata->x1, sDataOld->realVars, nx*sizeof(double));
+    memcpy(userdata->k[6], sDataOld->realVars + nx, nx*sizeof(double));
+    userdata->denseValid = 0;
 
-    do
+    if(userdata->restart)
     {
-      if(!(backupTime == backupTime_old)) /* don't interpolate during an event */
+      if(omc_flag[FLAG_INITIAL_STEP_SIZE])
       {
-        /* calculate dense output interpolation parameter sigma */
-        sh = interpolationStep - globalData->timeValue;
-        sigma = sh / globalData->current_stepsize;
-
-        for(i = 0; i < dop5dense_s; i++)
-        {
-          /* compute bstar vector components using Horner's scheme */
-          numerator = dop_bst[i][4] +
-                      sigma * (dop_bst[i][3] +
-                      sigma * (dop_bst[i][2] +
-                      sigma * (dop_bst[i][1] +
-                      sigma * dop_bst[i][0])));
-          bstar[i] = numerator / dop_bst[i][5];
-        }
-
-        for(i = 0; i < globalData->nStates; i++)
-        {
-          sum = 0;
-          for(l = 0; l < dop5dense_s; l++)
-          {
-            sum = sum + bstar[l] * k[l][i];
-          }
-          globalData->states[i] = globalData->states[i] + sh * sum;
-        }
-
-        /* set global time value to interpolated time */
-        globalData->timeValue = interpolationStep;
-
-        /* update all dependent variables */
-        functionODE(NULL);
-        functionAlgebraics(NULL);
-        saveZeroCrossings();
-
-        /* Emit interpolated data at the current time step */
-        sim_result.emit(&sim_result,data);
+        userdata->h = atof(omc_flagValue[FLAG_INITIAL_STEP_SIZE]);
       }
+      else
+      {
+        memcpy(userdata->x0, userdata->x1, nx*sizeof(double));
+        memcpy(userdata->k[0], userdata->k[6], nx*sizeof(double));
+        userdata->h = dopri45_initialStepSize(data, threadData, userdata, rtol, atol);
+        solverInfo->solverStatsTmp[1] += 1;
+      }
+      infoStreamPrint(LOG_SOLVER, 0, "dopri45: initial step size %g", userdata->h);
+      userdata->restart = 0;
+    }
+  }
 
-      interpolationStep = interpolationStep + fixStep;
-
-    } while ((interpolationStep <= stop + fixStep) && (interpolationStep < backupTime));
+  while(userdata->t1 < targetTime)
+  {
+    if(dopri45_doStep(data, threadData, solverInfo, userdata, rtol, atol, maxStepSize))
+      return -1;
+  }
 
-    /* update old data */
-    globalData->oldTime = backupTime;
+  if(userdata->t1 == targetTime)
+    memcpy(sData->realVars, userdata->x1, nx*sizeof(double));
+  else
+    dopri45_denseOutput(userdata, nx, targetTime, sData->realVars);
+  sData->timeValue = targetTime;
+  userdata->lastTime = targetTime;
 
-    /* reset data for next solver step */
-    globalData->timeValue = backupTime;
-    for(i = 0; i < globalData->nStates; i++)
-    {
-      globalData->states[i] = backupstats[i];
-      globalData->statesDerivatives[i] = backupderivatives[i];
-    }
+  /* function ODE evaluation is done directly after this */
+  solverInfo->solverStatsTmp[1] += 1;
 
-    free(backupstats);
-    free(backupderivatives);
-    free(backupstats_old);
-  } else {
-    globalData->oldTime = globalData->timeValue;
-  }
   return 0;
 }
@@ -1,52 +1,69 @@
 /*
  * This file is part of OpenModelica.
  *
- * Copyright (c) 1998-CurrentYear, Linköping University,
- * Department of Computer and Information Science,
+ * Copyright (c) 1998-CurrentYear, Open Source Modelica Consortium (OSMC),
+ * c/o Linköpings universitet, Department of Computer and Information Science,
  * SE-58183 Linköping, Sweden.
  *
  * All rights reserved.
  *
- * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF THIS OSMC PUBLIC
- * LICENSE (OSMC-PL). ANY USE, REPRODUCTION OR DISTRIBUTION OF
- * THIS PROGRAM CONSTITUTES RECIPIENT'S ACCEPTANCE OF THE OSMC
- * PUBLIC LICENSE.
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF THE BSD NEW LICENSE OR THE
+ * GPL VERSION 3 LICENSE OR THE OSMC PUBLIC LICENSE (OSMC-PL) VERSION 1.2.
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES
+ * RECIPIENT'S ACCEPTANCE OF THE OSMC PUBLIC LICENSE OR THE GPL VERSION 3,
+ * ACCORDING TO RECIPIENTS CHOICE.
  *
- * The OpenModelica software and the Open Source Modelica
- * Consortium (OSMC) Public License (OSMC-PL) are obtained
- * from Linköping University, either from the above address,
- * from the URL: http://www.ida.liu.se/projects/OpenModelica
- * and in the OpenModelica distribution.
+ * The OpenModelica software and the OSMC (Open Source Modelica Consortium)
+ * Public License (OSMC-PL) are obtained from OSMC, either from the above
+ * address, from the URLs: http://www.openmodelica.org or
+ * http://www.ida.liu.se/projects/OpenModelica, and in the OpenModelica
+ * distribution. GNU version 3 is obtained from:
+ * http://www.gnu.org/copyleft/gpl.html. The New BSD License is obtained from:
+ * http://www.opensource.org/licenses/BSD-3-Clause.
  *
- * This program is distributed  WITHOUT ANY WARRANTY; without
- * even the implied warranty of  MERCHANTABILITY or FITNESS
- * FOR A PARTICULAR PURPOSE, EXCEPT AS EXPRESSLY SET FORTH
- * IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE CONDITIONS
- * OF OSMC-PL.
- *
- * See the full OSMC Public License conditions for more details.
+ * This program is distributed WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, EXCEPT AS
+ * EXPRESSLY SET FORTH IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE
+ * CONDITIONS OF OSMC-PL.
  *
  */
 
-/*********************       internal definitions; do not expose        ***********************/
+/*! \file dopri45.h
+ *
+ * Dormand-Prince 5(4) method with step size control, FSAL and the
+ * continuous extension of Hairer/Norsett/Wanner for the output points.
+ */
 
 #ifndef _DOPRI45_H
 #define _DOPRI45_H
 
+#include "simulation_data.h"
+#include "solver_main.h"
 
-typedef struct DOPRI_DATA{
-  double interpolationStep;
-  modelica_boolean useInterpolation;
-  modelica_boolean reinit_step;
-  modelica_boolean reject;
-} DOPRI_DATA;
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct DOPRI45_DATA
+{
+  double *x0;          /* states at the begin of the current step */
+  double *x1;          /* states at the end of the current step */
+  double *k[7];        /* stages of the current step, k[6] = f(t1, x1) is k[0] of the next step (FSAL) */
+  double *rcont[4];    /* coefficients of the dense output of the current step, x0 is the constant one */
+  double *work;        /* memory of all arrays above */
+  double t0, t1;       /* current step [t0, t1] */
+  double h;            /* size of the next step */
+  double lastTime;     /* time of the last output, the solver restarts if the runtime continues from another time */
+  int denseValid;      /* rcont belongs to the current step */
+  int restart;
+} DOPRI45_DATA;
 
-int
-stepsize_control(double start, double stop, double fixStep, int(*f)(),
-                 int reinit_step, int useInterpolation, double tolerance, int* reject);
+int allocateDopri45(SOLVER_INFO* solverInfo, int size);
+int freeDopri45(SOLVER_INFO* solverInfo);
+int dopri45_step(DATA* data, threadData_t *threadData, SOLVER_INFO* solverInfo);
 
-int
-interpolation_control(const int dideventstep, double interpolationStep,
-                      double fixStep, double stop);
+#ifdef __cplusplus
+}
+#endif
 
 #endif
@@ -51,7 +51,7 @@ extern "C" {
 #endif
 
 int maxBisectionIterations = 0;
-double bisection(DATA* data, threadData_t *threadData, double*, double*, double*, double*, LIST*, LIST*);
+int illinois(DATA* data, threadData_t *threadData, double*, double*, double*, double*, LIST*, LIST*);
 int checkZeroCrossings(DATA *data, LIST *list, LIST*);
 void saveZeroCrossingsAfterEvent(DATA *data, threadData_t *threadData);
 
@@ -300,18 +300,20 @@ double findRoot(DATA* data, threadData_t *threadData, LIST *eventList)
   long event_id;
   LIST_NODE* it;
   fortran_integer i=0;
+  int iterations;
   static LIST *tmpEventList = NULL;
 
-  double *states_right = (double*) malloc(data->modelData->nStates * sizeof(double));
-  double *states_left = (double*) malloc(data->modelData->nStates * sizeof(double));
+  double *states_right = data->simulationInfo->eventStatesRight;
+  double *states_left = data->simulationInfo->eventStatesLeft;
 
   double time_left = data->simulationInfo->timeValueOld;
   double time_right = data->localData[0]->timeValue;
 
-  tmpEventList = allocList(sizeof(long));
-
-  assert(states_right);
-  assert(states_left);
+  if(!tmpEventList)
+  {
+    tmpEventList = allocList(sizeof(long));
+  }
+  listClear(tmpEventList);
 
   for(it=listFirstNode(eventList); it; it=listNextNode(it))
   {
@@ -322,8 +324,14 @@ double findRoot(DATA* data, threadData_t *threadData, LIST *eventList)
   memcpy(states_left,  data->simulationInfo->realVarsOld, data->modelData->nStates * sizeof(double));
   memcpy(states_right, data->localData[0]->realVars    , data->modelData->nStates * sizeof(double));
 
-  /* Search for event time and event_id with bisection method */
-  eventTime = bisection(data, threadData, &time_left, &time_right, states_left, states_right, tmpEventList, eventList);
+  /* Search for event time and event_id with the illinois method */
+  iterations = illinois(data, threadData, &time_left, &time_right, states_left, states_right, tmpEventList, eventList);
+
+  /* the last iteration moved the left end point, check the events of the final interval */
+  if(listLen(tmpEventList) == 0)
+  {
+    checkZeroCrossings(data, tmpEventList, eventList);
+  }
 
   if(listLen(tmpEventList) == 0)
   {
@@ -372,6 +380,7 @@ double findRoot(DATA* data, threadData_t *threadData, LIST *eventList)
 
   eventTime = time_right;
   debugStreamPrint(LOG_EVENTS, 0, "time: %.10e", eventTime);
+  infoStreamPrint(LOG_EVENTS, 0, "root finding of the event at time %.10e needed %d iterations", eventTime, iterations);
 
   data->localData[0]->timeValue = time_left;
   for(i=0; i < data->modelData->nStates; i++) {
@@ -389,14 +398,51 @@ double findRoot(DATA* data, threadData_t *threadData, LIST *eventList)
     data->localData[0]->realVars[i] = states_right[i];
   }
 
-  free(states_left);
-  free(states_right);
-
   TRACE_POP
   return eventTime;
 }
 
-/*! \fn bisection
+/*! \fn secantPoint
+ *
+ *  \param [ref] [data]
+ *  \param [in]  [eventList]
+ *  \param [in]  [weight_a]
+ *  \param [in]  [weight_b]
+ *  \return relative position of the next point in [a, b]
+ *
+ *  Returns the earliest root of the linear interpolations of the
+ *  zero-crossing distances of all events in the list. The distances at a are
+ *  zeroCrossingsDistancePre, the distances at b zeroCrossingsDistanceBackup.
+ *  Returns 0.5 (bisection) if none of the events has a usable distance.
+ */
+static double secantPoint(DATA *data, LIST *eventList, double weight_a, double weight_b)
+{
+  LIST_NODE *it;
+  double t = 1.0;
+  int found = 0;
+
+  for(it=listFirstNode(eventList); it; it=listNextNode(it))
+  {
+    long ix = *((long*) listNodeData(it));
+    double g_a = weight_a * data->simulationInfo->zeroCrossingsDistancePre[ix];
+    double g_b = weight_b * data->simulationInfo->zeroCrossingsDistanceBackup[ix];
+
+    /* NAN for zero-crossings which are not a single relation */
+    if(g_a * g_b <= 0.0 && g_a != g_b)
+    {
+      double t_ix = g_a / (g_a - g_b);
+      if(t_ix < t)
+      {
+        t = t_ix;
+      }
+      found = 1;
+    }
+  }
+
+  return found ? t : 0.5;
+}
+
+/*! \fn illinois
  *
  *  \param [ref] [data]
  *  \param [ref] [a]
@@ -405,34 +451,63 @@ double findRoot(DATA* data, threadData_t *threadData, LIST *eventList)
  *  \param [ref] [states_b]
  *  \param [ref] [eventListTmp]
  *  \param [in]  [eventList]
- *  \return Founded event time
+ *  \return number of iterations
  *
- *  Method to find root in interval [oldTime, timeValue]
+ *  Method to find root in interval [oldTime, timeValue]. The next point is
+ *  the regula falsi point of the zero-crossing distances (illinois variant,
+ *  the distances of an end point that is kept twice in a row are halved).
+ *  The events are checked with the zero-crossing values like in bisection, so
+ *  the event is always bracketed by [a, b]. A bisection step is done if the
+ *  interval did not shrink by half within the last three iterations.
  */
-double bisection(DATA* data, threadData_t *threadData, double* a, double* b, double* states_a, double* states_b, LIST *tmpEventList, LIST *eventList)
+int illinois(DATA* data, threadData_t *threadData, double* a, double* b, double* states_a, double* states_b, LIST *tmpEventList, LIST *eventList)
 {
   TRACE_PUSH
 
   double TTOL = MINIMAL_STEP_SIZE + MINIMAL_STEP_SIZE*fabs(*b-*a); /* absTol + relTol*abs(b-a) */
-  double c;
+  double c, t;
+  double weight_a = 1.0, weight_b = 1.0;
+  double length[3];   /* interval length before the last three iterations */
+  int side = 0; /* -1: last point replaced b, 1: last point replaced a */
+  int iterations = 0;
   long i=0;
-  /* n >= log(2)/log(2) + log(|b-a|/TOL)/log(2)*/
-  unsigned int n = maxBisectionIterations > 0 ? maxBisectionIterations : 1 + ceil(log(fabs(*b - *a)/TTOL)/log(2));
+  /* n >= log(2)/log(2) + log(|b-a|/TOL)/log(2), four times as many since every fourth step halves the interval at least */
+  unsigned int n = maxBisectionIterations > 0 ? maxBisectionIterations : 4 * (1 + ceil(log(fabs(*b - *a)/TTOL)/log(2)));
 
   memcpy(data->simulationInfo->zeroCrossingsBackup, data->simulationInfo->zeroCrossings, data->modelData->nZeroCrossings * sizeof(modelica_real));
+  memcpy(data->simulationInfo->zeroCrossingsDistanceBackup, data->simulationInfo->zeroCrossingsDistance, data->modelData->nZeroCrossings * sizeof(modelica_real));
+  length[0] = length[1] = length[2] = 2.0 * fabs(*b - *a);
 
-  infoStreamPrint(LOG_ZEROCROSSINGS, 0, "bisection method starts in interval [%e, %e]", *a, *b);
-  infoStreamPrint(LOG_ZEROCROSSINGS, 0, "TTOL is set to %e and maximum number of intersections %d.", TTOL, n);
+  infoStreamPrint(LOG_ZEROCROSSINGS, 0, "illinois method starts in interval [%e, %e]", *a, *b);
+  infoStreamPrint(LOG_ZEROCROSSINGS, 0, "TTOL is set to %e and maximum number of iterations %d.", TTOL, n);
 
   while(fabs(*b - *a) > MINIMAL_STEP_SIZE && n-- > 0)
   {
-    c = 0.5 * (*a + *b);
+    if(fabs(*b - *a) > 0.5 * length[2])
+    {
+      t = 0.5;
+    }
+    else
+    {
+      t = secantPoint(data, eventList, weight_a, weight_b);
+    }
+    length[2] = length[1];
+    length[1] = length[0];
+    length[0] = fabs(*b - *a);
+
+    /* stay away from the end points, the root is approached from both sides */
+    c = *a + t * (*b - *a);
+    c = fmax(c, *a + 0.5 * MINIMAL_STEP_SIZE);
+    c = fmin(c, *b - 0.5 * MINIMAL_STEP_SIZE);
+    t = (c - *a) / (*b - *a);
+
+    iterations++;
     data->localData[0]->timeValue = c;
 
     /*calculates states at time c */
     for(i=0; i < data->modelData->nStates; i++)
     {
-      data->localData[0]->realVars[i] = 0.5*(states_a[i] + states_b[i]);
+      data->localData[0]->realVars[i] = states_a[i] + t*(states_b[i] - states_a[i]);
     }
 
     /*calculates Values dependents on new states*/
@@ -449,6 +524,13 @@ double bisection(DATA* data, threadData_t *threadData, double* a, double* b, dou
       memcpy(states_b, data->localData[0]->realVars, data->modelData->nStates * sizeof(modelica_real));
       *b = c;
       memcpy(data->simulationInfo->zeroCrossingsBackup, data->simulationInfo->zeroCrossings, data->modelData->nZeroCrossings * sizeof(modelica_real));
+      memcpy(data->simulationInfo->zeroCrossingsDistanceBackup, data->simulationInfo->zeroCrossingsDistance, data->modelData->nZeroCrossings * sizeof(modelica_real));
+      weight_b = 1.0;
+      if(side == -1)
+      {
+        weight_a *= 0.5;
+      }
+      side = -1;
     }
     else  /*else Zerocrossing in right Section */
     {
@@ -456,12 +538,21 @@ double bisection(DATA* data, threadData_t *threadData, double* a, double* b, dou
       *a = c;
       memcpy(data->simulationInfo->zeroCrossingsPre, data->simulationInfo->zeroCrossings, data->modelData->nZeroCrossings * sizeof(modelica_real));
       memcpy(data->simulationInfo->zeroCrossings, data->simulationInfo->zeroCrossingsBackup, data->modelData->nZeroCrossings * sizeof(modelica_real));
+      memcpy(data->simulationInfo->zeroCrossingsDistancePre, data->simulationInfo->zeroCrossingsDistance, data->modelData->nZeroCrossings * sizeof(modelica_real));
+      memcpy(data->simulationInfo->zeroCrossingsDistance, data->simulationInfo->zeroCrossingsDistanceBackup, data->modelData->nZeroCrossings * sizeof(modelica_real));
+      weight_a = 1.0;
+      if(side == 1)
+      {
+        weight_b *= 0.5;
+      }
+      side = 1;
     }
   }
-  c = 0.5*(*a + *b);
+
+  infoStreamPrint(LOG_ZEROCROSSINGS, 0, "illinois method stops after %d iterations in interval [%e, %e]", iterations, *a, *b);
 
   TRACE_POP
-  return c;
+  return iterations;
 }
 
 /*! \fn checkZeroCrossings
@@ -479,7 +570,7 @@ int checkZeroCrossings(DATA *data, LIST *tmpEventList, LIST *eventList)
   LIST_NODE *it;
 
   listClear(tmpEventList);
-  infoStreamPrint(LOG_ZEROCROSSINGS, 0, "bisection checks for condition changes");
+  infoStreamPrint(LOG_ZEROCROSSINGS, 0, "root finding checks for condition changes");
 
   for(it=listFirstNode(eventList); it; it=listNextNode(it))
   {
@@ -523,6 +614,7 @@ void saveZeroCrossingsAfterEvent(DATA *data, threadData_t *threadData)
   data->callback->function_ZeroCrossings(data, threadData, data->simulationInfo->zeroCrossings);
   for(i=0; i<data->modelData->nZeroCrossings; i++)
     data->simulationInfo->zeroCrossingsPre[i] = data->simulationInfo->zeroCrossings[i];
+  memcpy(data->simulationInfo->zeroCrossingsDistancePre, data->simulationInfo->zeroCrossingsDistance, data->modelData->nZeroCrossings * sizeof(modelica_real));
 
   TRACE_POP
 }
@@ -92,6 +92,18 @@ static int idaReScaleData(IDA_SOLVER *idaData);
 static int idaScaleVector(N_Vector vec, double* factors, unsigned int size);
 static int idaReScaleVector(N_Vector vec, double* factors, unsigned int size);
 
+static void setJacElementKluSparse(int row, int col, double value, int nth, SlsMat spJac);
+
+/* private data of an additional worker of the colored numerical jacobian */
+typedef struct IDA_JACOBIAN_WORKER
+{
+  IDA_SOLVER idaData;                  /* copy of the solver data, refers to the data of the worker */
+  IDA_USERDATA simData;
+  N_Vector yy;                         /* daeMode: wrap the workspace, ode mode: the states of the worker data */
+  N_Vector yp;
+  N_Vector newdelta;
+} IDA_JACOBIAN_WORKER;
+
 static IDA_SOLVER *idaDataGlobal;
 static int initializedSolver = 0;
 int ida_event_update(DATA* data, threadData_t *threadData);
@@ -648,6 +660,51 @@ ida_solver_initial(DATA* data, threadData_t *threadData, SOLVER_INFO* solverInfo
       N_VSetArrayPointer_Serial((data->simulationInfo->sensitivityMatrix + i*idaData->N), idaData->ySResult[i]);
     }
   }
+  /* prepare the colored numerical jacobian */
+  idaData->parallelJacobian = NULL;
+  if (idaData->jacobianMethod == COLOREDNUMJAC)
+  {
+    int nThreads = getJacobianThreads();
+    SPARSE_PATTERN* sparsePattern;
+
+    if (idaData->daeMode)
+    {
+      sparsePattern = data->simulationInfo->daeModeData->sparsePattern;
+    }
+    else
+    {
+      sparsePattern = &(data->simulationInfo->analyticJacobians[data->callback->INDEX_JAC_A].sparsePattern);
+    }
+    if (nThreads > 1 && (idaData->idaSmode || omc_flag[FLAG_IDA_SCALING]))
+    {
+      warningStreamPrint(LOG_STDOUT, 0, "The jacobian can not be evaluated in parallel with sensitivities or scaling of ida, use one thread.");
+      nThreads = 1;
+    }
+    /* each worker needs the states, their derivatives and the residuals; in ode mode the
+     * residual is evaluated on the variables of the data, the workspace keeps the iteration values */
+    idaData->parallelJacobian = allocateParallelJacobian(data, threadData, sparsePattern, idaData->N, nThreads, 3*idaData->N);
+    for(i = 1; i < idaData->parallelJacobian->nWorkers; ++i)
+    {
+      JACOBIAN_WORKER *worker = &idaData->parallelJacobian->workers[i];
+      IDA_JACOBIAN_WORKER *idaWorker = (IDA_JACOBIAN_WORKER*) calloc(1, sizeof(IDA_JACOBIAN_WORKER));
+      assertStreamPrint(threadData, 0 != idaWorker, "out of memory");
+      idaWorker->simData.data = worker->data;
+      idaWorker->simData.threadData = worker->threadData;
+      if (idaData->daeMode)
+      {
+        idaWorker->yy = N_VMake_Serial(idaData->N, worker->work);
+        idaWorker->yp = N_VMake_Serial(idaData->N, worker->work + idaData->N);
+      }
+      else
+      {
+        idaWorker->yy = N_VMake_Serial(idaData->N, worker->data->localData[0]->realVars);
+        idaWorker->yp = N_VMake_Serial(idaData->N, worker->data->localData[0]->realVars + data->modelData->nStates);
+      }
+      idaWorker->newdelta = N_VMake_Serial(idaData->N, worker->work + 2*idaData->N);
+      worker->solverData = idaWorker;
+    }
+  }
+
   if (compiledInDAEMode){
     idaDataGlobal = idaData;
     initializedSolver = 1;
@@ -690,6 +747,20 @@ ida_solver_deinitial(IDA_SOLVER *idaData){
   N_VDestroy_Serial(idaData->errwgt);
   N_VDestroy_Serial(idaData->newdelta);
 
+  if (idaData->parallelJacobian)
+  {
+    int i;
+    for(i = 1; i < idaData->parallelJacobian->nWorkers; ++i)
+    {
+      IDA_JACOBIAN_WORKER *idaWorker = (IDA_JACOBIAN_WORKER*) idaData->parallelJacobian->workers[i].solverData;
+      N_VDestroy_Serial(idaWorker->yy);
+      N_VDestroy_Serial(idaWorker->yp);
+      N_VDestroy_Serial(idaWorker->newdelta);
+      free(idaWorker);
+    }
+    freeParallelJacobian(idaData->parallelJacobian);
+  }
+
   IDAFree(&idaData->ida_mem);
 
   TRACE_POP
@@ -1309,25 +1380,58 @@ int rootsFunctionIDA(double time, N_Vector yy, N_Vector yp, double *gout, void*
 }
 
 
+/* arguments of the colored numerical jacobians needed by the evaluation of one color */
+typedef struct IDA_JACOBIAN_ARGS
+{
+  double tt;
+  double cj;
+  double currentStep;
+  N_Vector yy;
+  N_Vector yp;
+  N_Vector rr;
+  IDA_SOLVER *idaData;
+  SPARSE_PATTERN *sparsePattern;
+  DlsMat denseJac;                     /* either the dense */
+  SlsMat sparseJac;                    /* or the sparse jacobian is set */
+} IDA_JACOBIAN_ARGS;
+
 /*
- *  function calculates a jacobian matrix by
- *  numerical method finite differences with coloring
- *  into a dense DlsMat matrix
+ *  copies the current iteration values and the solver data
+ *  to the workers of the colored numerical jacobian
  */
-static
-int jacColoredNumericalDense(double tt, N_Vector yy, N_Vector yp, N_Vector rr, DlsMat Jac, double cj, void *userData)
+static void prepareJacobianWorkers(IDA_SOLVER *idaData, N_Vector yy, N_Vector yp)
 {
-  TRACE_PUSH
-  IDA_SOLVER* idaData = (IDA_SOLVER*)userData;
-  DATA* data = (DATA*)(((IDA_USERDATA*)idaData->simData)->data);
-  void* ida_mem = idaData->ida_mem;
-  const int index = data->callback->INDEX_JAC_A;
+  PARALLEL_JACOBIAN *parJac = idaData->parallelJacobian;
+  int i;
 
-  /* prepare variables */
-  double *states = N_VGetArrayPointer(yy);
-  double *yprime = N_VGetArrayPointer(yp);
-  double *delta  = N_VGetArrayPointer(rr);
-  double *newdelta = N_VGetArrayPointer(idaData->newdelta);
+  for(i = 1; i < parJac->nWorkers; ++i)
+  {
+    IDA_JACOBIAN_WORKER *idaWorker = (IDA_JACOBIAN_WORKER*) parJac->workers[i].solverData;
+    idaWorker->idaData = *idaData;
+    idaWorker->idaData.simData = &idaWorker->simData;
+    idaWorker->idaData.disableScaling = 1;
+    memcpy(parJac->workers[i].work, N_VGetArrayPointer(yy), idaData->N*sizeof(double));
+    memcpy(parJac->workers[i].work + idaData->N, N_VGetArrayPointer(yp), idaData->N*sizeof(double));
+  }
+}
+
+/*
+ *  function evaluates the columns of one color of the
+ *  colored numerical jacobian with the data of a worker
+ */
+static
+int jacColoredNumericalColumns(JACOBIAN_WORKER *worker, unsigned int color, void *userData)
+{
+  IDA_JACOBIAN_ARGS *args = (IDA_JACOBIAN_ARGS*) userData;
+  IDA_SOLVER* idaData = args->idaData;
+  IDA_SOLVER* workerIdaData = idaData;
+  SPARSE_PATTERN* sparsePattern = args->sparsePattern;
+  N_Vector yy = args->yy;
+  N_Vector yp = args->yp;
+  N_Vector newdeltaVec = idaData->newdelta;
+
+  double *states, *yprime, *newdelta;
+  double *delta  = N_VGetArrayPointer(args->rr);
   double *errwgt = N_VGetArrayPointer(idaData->errwgt);
 
   double *delta_hh = idaData->delta_hh;
@@ -1336,79 +1440,193 @@ int jacColoredNumericalDense(double tt, N_Vector yy, N_Vector yp, N_Vector rr, D
 
   double delta_h = numericalDifferentiationDeltaXsolver;
   double delta_hhh;
-  long int i,j,l,ii;
+  const unsigned int *columns;
+  unsigned int nColumns, c;
+  long int j, ii;
+  int nth;
+  int disBackup;
 
-  double currentStep;
+  /* the calling thread works on the vectors of ida, all others on their private copy */
+  if (worker->id > 0)
+  {
+    IDA_JACOBIAN_WORKER *idaWorker = (IDA_JACOBIAN_WORKER*) worker->solverData;
+    workerIdaData = &idaWorker->idaData;
+    yy = idaWorker->yy;
+    yp = idaWorker->yp;
+    newdeltaVec = idaWorker->newdelta;
+  }
+  states = N_VGetArrayPointer(yy);
+  yprime = N_VGetArrayPointer(yp);
+  newdelta = N_VGetArrayPointer(newdeltaVec);
 
-  /* set values */
-  IDAGetCurrentStep(ida_mem, &currentStep);
-  if (!idaData->disableScaling){
-    IDAGetErrWeights(ida_mem, idaData->errwgt);
+  /* in ode mode the states of a worker are its variables, they were overwritten
+   * by the synchronization with the main data and are set to the iteration values */
+  if (worker->id > 0 && !idaData->daeMode)
+  {
+    memcpy(states, worker->work, idaData->N*sizeof(double));
+    memcpy(yprime, worker->work + idaData->N, idaData->N*sizeof(double));
   }
 
-  SPARSE_PATTERN* sparsePattern;
+  columns = getColorColumns(worker->parent, color, &nColumns);
 
-  /* set sparse pattern */
-  if (idaData->daeMode)
+  for(c = 0; c < nColumns; c++)
   {
-    sparsePattern = data->simulationInfo->daeModeData->sparsePattern;
+    ii = columns[c];
+    delta_hhh = args->currentStep * yprime[ii];
+    delta_hh[ii] = delta_h * fmax(fmax(fabs(states[ii]),fabs(delta_hhh)),fabs(1./errwgt[ii]));
+    delta_hh[ii] = (delta_hhh >= 0 ? delta_hh[ii] : -delta_hh[ii]);
+    delta_hh[ii] = (states[ii] + delta_hh[ii]) - states[ii];
+    ysave[ii] = states[ii];
+    states[ii] += delta_hh[ii];
+
+    if (idaData->daeMode){
+      ypsave[ii] = yprime[ii];
+      yprime[ii] += args->cj * delta_hh[ii];
+    }
+
+    delta_hh[ii] = 1. / delta_hh[ii];
   }
-  else
+
+  /* the residuals of the sparse jacobian are evaluated unscaled */
+  disBackup = workerIdaData->disableScaling;
+  if (args->sparseJac)
   {
-    sparsePattern = &(data->simulationInfo->analyticJacobians[index].sparsePattern);
+    workerIdaData->disableScaling = 1;
   }
+  (*idaData->residualFunction)(args->tt, yy, yp, newdeltaVec, workerIdaData);
+  workerIdaData->disableScaling = disBackup;
 
-  setContext(data, &tt, CONTEXT_JACOBIAN);
-
-  for(i = 0; i < sparsePattern->maxColors; i++)
+  for(c = 0; c < nColumns; c++)
   {
-    for(ii=0; ii < idaData->N; ii++)
+    ii = columns[c];
+    nth = sparsePattern->leadindex[ii];
+    while(nth < sparsePattern->leadindex[ii+1])
     {
-      if(sparsePattern->colorCols[ii]-1 == i)
+      j  =  sparsePattern->index[nth];
+      if (args->denseJac)
       {
-        delta_hhh = currentStep * yprime[ii];
-        delta_hh[ii] = delta_h * fmax(fmax(fabs(states[ii]),fabs(delta_hhh)),fabs(1./errwgt[ii]));
-        delta_hh[ii] = (delta_hhh >= 0 ? delta_hh[ii] : -delta_hh[ii]);
-        delta_hh[ii] = (states[ii] + delta_hh[ii]) - states[ii];
-        ysave[ii] = states[ii];
-        states[ii] += delta_hh[ii];
-
-        if (idaData->daeMode){
-          ypsave[ii] = yprime[ii];
-          yprime[ii] += cj * delta_hh[ii];
-        }
-
-        delta_hh[ii] = 1. / delta_hh[ii];
+        DENSE_ELEM(args->denseJac, j, ii) = (newdelta[j] - delta[j]) * delta_hh[ii];
       }
+      /* use row scaling for jacobian elements */
+      else if (idaData->disableScaling == 1 || !omc_flag[FLAG_IDA_SCALING])
+      {
+        setJacElementKluSparse(j, ii, (newdelta[j] - delta[j]) * delta_hh[ii], nth, args->sparseJac);
+      }
+      else
+      {
+        setJacElementKluSparse(j, ii, ((newdelta[j] - delta[j]) * delta_hh[ii]) / idaData->resScale[j] * idaData->yScale[ii], nth, args->sparseJac);
+      }
+      nth++;
+    };
+    states[ii] = ysave[ii];
+    if (idaData->daeMode)
+    {
+      yprime[ii] = ypsave[ii];
     }
+  }
 
-    (*idaData->residualFunction)(tt, yy, yp, idaData->newdelta, userData);
+  return 0;
+}
 
-    increaseJacContext(data);
+/*
+ *  with LOG_JAC the colored numerical jacobian of several threads is
+ *  compared with the one evaluated by the calling thread only
+ */
+static void checkParallelJacobian(IDA_SOLVER *idaData, DATA *data, threadData_t *threadData, IDA_JACOBIAN_ARGS *args)
+{
+  double *values, *parallelValues;
+  double maxDiff = 0, maxValue = 0;
+  long int i, n;
 
-    for(ii = 0; ii < idaData->N; ii++)
-    {
-      if(sparsePattern->colorCols[ii]-1 == i)
-      {
-        j = sparsePattern->leadindex[ii];
-        while(j < sparsePattern->leadindex[ii+1])
-        {
-          l  =  sparsePattern->index[j];
-          DENSE_ELEM(Jac, l, ii) = (newdelta[l] - delta[l]) * delta_hh[ii];
-          j++;
-        };
-        states[ii] = ysave[ii];
-        if (idaData->daeMode)
-        {
-          yprime[ii] = ypsave[ii];
-        }
-      }
-    }
+  if (!ACTIVE_STREAM(LOG_JAC) || idaData->parallelJacobian->nWorkers < 2)
+  {
+    return;
   }
+  if (args->denseJac)
+  {
+    values = args->denseJac->data;
+    n = args->denseJac->ldata;
+  }
+  else
+  {
+    values = args->sparseJac->data;
+    n = args->sparsePattern->numberOfNoneZeros;
+  }
+  parallelValues = (double*) malloc(n*sizeof(double));
+  assertStreamPrint(threadData, 0 != parallelValues, "out of memory");
+  memcpy(parallelValues, values, n*sizeof(double));
+
+  if (evaluateSerialJacobian(idaData->parallelJacobian, data, threadData, jacColoredNumericalColumns, args))
+  {
+    warningStreamPrint(LOG_JAC, 0, "the colored jacobian could not be evaluated by one thread");
+    memcpy(values, parallelValues, n*sizeof(double));
+    free(parallelValues);
+    return;
+  }
+  for(i = 0; i < n; i++)
+  {
+    maxDiff = fmax(maxDiff, fabs(values[i] - parallelValues[i]));
+    maxValue = fmax(maxValue, fabs(values[i]));
+  }
+  free(parallelValues);
+
+  if (maxDiff > 1e-6 * fmax(1.0, maxValue))
+  {
+    warningStreamPrint(LOG_STDOUT, 0, "the colored jacobian of %d threads differs from the one of one thread by %g (largest element %g) at time %g",
+                       idaData->parallelJacobian->nWorkers, maxDiff, maxValue, args->tt);
+  }
+  else
+  {
+    infoStreamPrint(LOG_JAC, 0, "the colored jacobian of %d threads differs from the one of one thread by %g", idaData->parallelJacobian->nWorkers, maxDiff);
+  }
+}
+
+/*
+ *  function calculates a jacobian matrix by
+ *  numerical method finite differences with coloring
+ *  into a dense DlsMat matrix
+ */
+static
+int jacColoredNumericalDense(double tt, N_Vector yy, N_Vector yp, N_Vector rr, DlsMat Jac, double cj, void *userData)
+{
+  TRACE_PUSH
+  IDA_SOLVER* idaData = (IDA_SOLVER*)userData;
+  DATA* data = (DATA*)(((IDA_USERDATA*)idaData->simData)->data);
+  threadData_t* threadData = (threadData_t*)(((IDA_USERDATA*)idaData->simData)->threadData);
+  void* ida_mem = idaData->ida_mem;
+  const int index = data->callback->INDEX_JAC_A;
+  IDA_JACOBIAN_ARGS args = {tt, cj, 0, yy, yp, rr, idaData, NULL, Jac, NULL};
+  int failed;
+
+  /* set values */
+  IDAGetCurrentStep(ida_mem, &args.currentStep);
+  if (!idaData->disableScaling){
+    IDAGetErrWeights(ida_mem, idaData->errwgt);
+  }
+
+  /* set sparse pattern */
+  if (idaData->daeMode)
+  {
+    args.sparsePattern = data->simulationInfo->daeModeData->sparsePattern;
+  }
+  else
+  {
+    args.sparsePattern = &(data->simulationInfo->analyticJacobians[index].sparsePattern);
+  }
+
+  setContext(data, &tt, CONTEXT_JACOBIAN);
+
+  prepareJacobianWorkers(idaData, yy, yp);
+  failed = evaluateParallelJacobian(idaData->parallelJacobian, data, threadData, jacColoredNumericalColumns, &args);
+  if (!failed)
+  {
+    checkParallelJacobian(idaData, data, threadData, &args);
+  }
+
   unsetContext(data);
 
   TRACE_POP
-  return 0;
+  return failed;
 }
 
 /*
@@ -1561,35 +1779,15 @@ int jacoColoredNumericalSparse(double tt, N_Vector yy, N_Vector yp, N_Vector rr,
   TRACE_PUSH
   IDA_SOLVER* idaData = (IDA_SOLVER*)userData;
   DATA* data = (DATA*)(((IDA_USERDATA*)idaData->simData)->data);
+  threadData_t* threadData = (threadData_t*)(((IDA_USERDATA*)idaData->simData)->threadData);
   void* ida_mem = idaData->ida_mem;
   const int index = data->callback->INDEX_JAC_A;
-
-  /* prepare variables */
-  double *states = N_VGetArrayPointer(yy);
-  double *yprime = N_VGetArrayPointer(yp);
-  double *delta  = N_VGetArrayPointer(rr);
-  double *newdelta = N_VGetArrayPointer(idaData->newdelta);
-  double *errwgt = N_VGetArrayPointer(idaData->errwgt);
-
-  SPARSE_PATTERN* sparsePattern;
-
-  double *ysave = idaData->ysave;
-  double *ypsave = idaData->ypsave;
-
-  double delta_h = numericalDifferentiationDeltaXsolver;
-  double *delta_hh = idaData->delta_hh;
-  double delta_hhh;
-  double deltaInv;
-
-  long int i,j,ii;
-  int nth = 0;
-  int disBackup = idaData->disableScaling;
-
-  double currentStep;
+  IDA_JACOBIAN_ARGS args = {tt, cj, 0, yy, yp, rr, idaData, NULL, NULL, Jac};
+  int failed;
 
   infoStreamPrint(LOG_SOLVER_V, 1, "### eval jacobianSparseNumIDA ###");
   /* set values */
-  IDAGetCurrentStep(ida_mem, &currentStep);
+  IDAGetCurrentStep(ida_mem, &args.currentStep);
   if (!idaData->disableScaling){
     IDAGetErrWeights(ida_mem, idaData->errwgt);
   }
@@ -1597,11 +1795,11 @@ int jacoColoredNumericalSparse(double tt, N_Vector yy, N_Vector yp, N_Vector rr,
   /* set sparse pattern */
   if (idaData->daeMode)
   {
-    sparsePattern = data->simulationInfo->daeModeData->sparsePattern;
+    args.sparsePattern = data->simulationInfo->daeModeData->sparsePattern;
   }
   else
   {
-    sparsePattern = &(data->simulationInfo->analyticJacobians[index].sparsePattern);
+    args.sparsePattern = &(data->simulationInfo->analyticJacobians[index].sparsePattern);
   }
 
   /* it's needed to clear the matrix */
@@ -1619,59 +1817,14 @@ int jacoColoredNumericalSparse(double tt, N_Vector yy, N_Vector yp, N_Vector rr,
     idaReScaleData(idaData);
   }
 
-  for(i = 0; i < sparsePattern->maxColors; i++)
+  prepareJacobianWorkers(idaData, yy, yp);
+  failed = evaluateParallelJacobian(idaData->parallelJacobian, data, threadData, jacColoredNumericalColumns, &args);
+  if (!failed)
   {
-    for(ii=0; ii < idaData->N; ii++)
-    {
-      if(sparsePattern->colorCols[ii]-1 == i)
-      {
-        delta_hhh = currentStep * yprime[ii];
-        delta_hh[ii] = delta_h * fmax(fmax(fabs(states[ii]),fabs(delta_hhh)),fabs(1./errwgt[ii]));
-        delta_hh[ii] = (delta_hhh >= 0 ? delta_hh[ii] : -delta_hh[ii]);
-        delta_hh[ii] = (states[ii] + delta_hh[ii]) - states[ii];
-        ysave[ii] = states[ii];
-        states[ii] += delta_hh[ii];
-
-        if (idaData->daeMode){
-          ypsave[ii] = yprime[ii];
-          yprime[ii] += cj * delta_hh[ii];
-        }
-
-        delta_hh[ii] = 1. / delta_hh[ii];
-      }
-    }
-    idaData->disableScaling = 1;
-    (*idaData->residualFunction)(tt, yy, yp, idaData->newdelta, userData);
-    idaData->disableScaling = disBackup;
-
-    increaseJacContext(data);
-
-    for(ii = 0; ii < idaData->N; ii++)
-    {
-      if(sparsePattern->colorCols[ii]-1 == i)
-      {
-        nth = sparsePattern->leadindex[ii];
-        while(nth < sparsePattern->leadindex[ii+1])
-        {
-          j  =  sparsePattern->index[nth];
-          //setJacElementKluSparse(j, ii, (newdelta[j] - delta[j]) * delta_hh[ii], nth, Jac);
-          /* use row scaling for jacobian elements */
-          if (idaData->disableScaling == 1 || !omc_flag[FLAG_IDA_SCALING]){
-            setJacElementKluSparse(j, ii, (newdelta[j] - delta[j]) * delta_hh[ii], nth, Jac);
-          }else{
-            setJacElementKluSparse(j, ii, ((newdelta[j] - delta[j]) * delta_hh[ii]) / idaData->resScale[j] * idaData->yScale[ii], nth, Jac);
-          }
-          nth++;
-        };
-        states[ii] = ysave[ii];
-        if (idaData->daeMode)
-        {
-          yprime[ii] = ypsave[ii];
-        }
-      }
-    }
+    checkParallelJacobian(idaData, data, threadData, &args);
   }
-  finishSparseColPtr(Jac, sparsePattern->numberOfNoneZeros);
+
+  finishSparseColPtr(Jac, args.sparsePattern->numberOfNoneZeros);
 
   /* scale idaData->y and idaData->yp again */
   if ((omc_flag[FLAG_IDA_SCALING] && !idaData->disableScaling))
@@ -1684,7 +1837,7 @@ int jacoColoredNumericalSparse(double tt, N_Vector yy, N_Vector yp, N_Vector rr,
   messageClose(LOG_SOLVER_V);
 
   TRACE_POP
-  return 0;
+  return failed;
 }
 
 /* \fn jacColoredSymbolicalSparse(double tt, N_Vector yy, N_Vector yp, N_Vector rr, SlsMat Jac, double cj, void *userData)
@@ -56,6 +56,7 @@ double linearSparseSolverMaxDensity = 0.2;
 int linearSparseSolverMinSize = 201;
 double nonlinearSparseSolverMaxDensity = 0.2;
 int nonlinearSparseSolverMinSize = 10001;
+int nonlinearExtrapolationOrder = 1;
 double maxStepFactor = 1e12;
 double newtonXTol = 1e-12;
 double newtonFTol = 1e-12;
@@ -80,6 +81,8 @@ double homTauStart = 0.2;
 int homBacktraceStrategy = 1;
 
 static double tolZC;
+/* signed distance of the last relation evaluated by one of the *ZC functions, >= 0 if the relation is true */
+static double distanceZC = 0.0;
 
 /*! \fn updateDiscreteSystem
  *
@@ -155,6 +158,7 @@ void saveZeroCrossings(DATA* data, threadData_t *threadData)
 
   for(i=0;i<data->modelData->nZeroCrossings;i++)
     data->simulationInfo->zeroCrossingsPre[i] = data->simulationInfo->zeroCrossings[i];
+  memcpy(data->simulationInfo->zeroCrossingsDistancePre, data->simulationInfo->zeroCrossingsDistance, data->modelData->nZeroCrossings * sizeof(modelica_real));
 
   data->callback->function_ZeroCrossings(data, threadData, data->simulationInfo->zeroCrossings);
 
@@ -953,6 +957,14 @@ void initializeDataStruc(DATA *data, threadData_t *threadData)
   data->simulationInfo->zeroCrossings = (modelica_real*) calloc(data->modelData->nZeroCrossings, sizeof(modelica_real));
   data->simulationInfo->zeroCrossingsPre = (modelica_real*) calloc(data->modelData->nZeroCrossings, sizeof(modelica_real));
   data->simulationInfo->zeroCrossingsBackup = (modelica_real*) calloc(data->modelData->nZeroCrossings, sizeof(modelica_real));
+  data->simulationInfo->zeroCrossingsDistance = (modelica_real*) malloc(3*data->modelData->nZeroCrossings*sizeof(modelica_real));
+  data->simulationInfo->zeroCrossingsDistancePre = data->simulationInfo->zeroCrossingsDistance + data->modelData->nZeroCrossings;
+  data->simulationInfo->zeroCrossingsDistanceBackup = data->simulationInfo->zeroCrossingsDistancePre + data->modelData->nZeroCrossings;
+  /* zero-crossings that are not a single relation never get a distance */
+  for(i=0; i<3*data->modelData->nZeroCrossings; ++i)
+    data->simulationInfo->zeroCrossingsDistance[i] = NAN;
+  data->simulationInfo->eventStatesLeft = (modelica_real*) malloc(2*data->modelData->nStates*sizeof(modelica_real));
+  data->simulationInfo->eventStatesRight = data->simulationInfo->eventStatesLeft + data->modelData->nStates;
   data->simulationInfo->relations = (modelica_boolean*) calloc(data->modelData->nRelations, sizeof(modelica_boolean));
   data->simulationInfo->relationsPre = (modelica_boolean*) calloc(data->modelData->nRelations, sizeof(modelica_boolean));
   data->simulationInfo->storedRelations = (modelica_boolean*) calloc(data->modelData->nRelations, sizeof(modelica_boolean));
@@ -1166,6 +1178,8 @@ void deInitializeDataStruc(DATA *data)
   free(data->simulationInfo->zeroCrossings);
   free(data->simulationInfo->zeroCrossingsPre);
   free(data->simulationInfo->zeroCrossingsBackup);
+  free(data->simulationInfo->zeroCrossingsDistance);
+  free(data->simulationInfo->eventStatesLeft);
   free(data->simulationInfo->relations);
   free(data->simulationInfo->relationsPre);
   free(data->simulationInfo->storedRelations);
@@ -1268,24 +1282,39 @@ void setZCtol(double relativeTol)
 modelica_boolean LessZC(double a, double b, modelica_boolean direction)
 {
   double eps = tolZC * fmax(fabs(a), fabs(b)) + tolZC;
+  distanceZC = direction ? eps - (a - b) : -eps - (a - b);
   return direction ? (a - b <= eps) : (a - b <= -eps);
 }
 
 modelica_boolean LessEqZC(double a, double b, modelica_boolean direction)
 {
-  return !GreaterZC(a, b, !direction);
+  modelica_boolean res = !GreaterZC(a, b, !direction);
+  distanceZC = -distanceZC;
+  return res;
 }
 
 /* TODO: fix this */
 modelica_boolean GreaterZC(double a, double b, modelica_boolean direction)
 {
   double eps = tolZC * fmax(fabs(a), fabs(b)) + tolZC;
+  distanceZC = direction ? (a - b) + eps : (a - b) - eps;
   return direction ? (a - b >= -eps ) : (a - b >= eps);
 }
 
 modelica_boolean GreaterEqZC(double a, double b, modelica_boolean direction)
 {
-  return !LessZC(a, b, !direction);
+  modelica_boolean res = !LessZC(a, b, !direction);
+  distanceZC = -distanceZC;
+  return res;
+}
+
+/* signed distance of the last relation evaluated with hysteresis, used by
+ * the generated zero-crossing functions to store the distance of a
+ * zero-crossing for the root finding (see ZC_DISTANCE)
+ */
+double relationDistanceZC(void)
+{
+  return distanceZC;
 }
 
 modelica_boolean Less(double a, double b)
@@ -79,6 +79,7 @@ extern double linearSparseSolverMaxDensity;
 extern int linearSparseSolverMinSize;
 extern double nonlinearSparseSolverMaxDensity;
 extern int nonlinearSparseSolverMinSize;
+extern int nonlinearExtrapolationOrder;
 extern double newtonXTol;
 extern double newtonFTol;
 extern double maxStepFactor;
@@ -176,6 +177,18 @@ modelica_boolean LessZC(double a, double b, modelica_boolean);
 modelica_boolean LessEqZC(double a, double b, modelica_boolean);
 modelica_boolean GreaterZC(double a, double b, modelica_boolean);
 modelica_boolean GreaterEqZC(double a, double b, modelica_boolean);
+double relationDistanceZC(void);
+
+/* stores the signed distance of the relation evaluated last as distance
+ * of the zero-crossing with the given index, used by the root finding.
+ * The distances are only stored together with the zero-crossings of the
+ * simulation info, not for the root functions of the integrators.
+ */
+#define ZC_DISTANCE(index) \
+  do { \
+    if (gout == data->simulationInfo->zeroCrossings) \
+      data->simulationInfo->zeroCrossingsDistance[index] = relationDistanceZC(); \
+  } while(0)
 
 extern int measure_time_flag;
 
@@ -55,6 +55,12 @@
 #include "nonlinearSystem.h"
 #include "nonlinearSolverHomotopy.h"
 #include "nonlinearSolverHybrd.h"
+#if !defined(OMC_MINIMAL_RUNTIME)
+#include "linearSolverKlu.h"
+#if defined(WITH_UMFPACK)
+#define HOMOTOPY_SPARSE_SOLVER
+#endif
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -134,13 +140,26 @@ typedef struct DATA_HOMOTOPY
   double* hvec;
   double* hJac;
   double* hJac2;
-  double* hJacInit;
   double* ones;
 
   /* linear system */
   int* indRow;
   int* indCol;
 
+  /* jacobian layout: dense n x (n+1) matrices, or the values of the sparse bordered
+   * (n+1) x (n+1) matrix kluData (the last row is set for each solve) */
+  int sparse;       /* 1 = sparse jacobians and KLU, 0 = dense jacobians */
+  int jacSize;      /* number of values of fJac, fJacx0 and hJac */
+  int lastColumn;   /* offset of the last column (lambda column or function values) */
+  int* jacPos;      /* position of the sparsity pattern elements of the first n columns, NULL = unknown pattern */
+  int* diagPos;     /* position of the diagonal elements */
+  int* colorPtr;    /* columns of color i are colorCols[colorPtr[i]] ... colorCols[colorPtr[i+1]-1] */
+  int* colorCols;
+  int maxColors;
+  double* xSave;    /* values of the perturbed columns */
+  double* border;   /* last row of the bordered matrix */
+  void* kluData;
+
   int (*f)         (struct DATA_HOMOTOPY*, double*, double*);
   int (*f_con)     (struct DATA_HOMOTOPY*, double*, double*);
   int (*fJac_f)    (struct DATA_HOMOTOPY*, double*, double*);
@@ -170,6 +189,15 @@ int allocateHomotopyData(int size, void** voiddata)
   assertStreamPrint(NULL, 0 != data, "allocationHomotopyData() failed!");
 
   data->initialized = 0;
+  data->sparse = 0;
+  data->jacPos = NULL;
+  data->diagPos = NULL;
+  data->colorPtr = NULL;
+  data->colorCols = NULL;
+  data->maxColors = 0;
+  data->xSave = NULL;
+  data->border = NULL;
+  data->kluData = NULL;
   data->n = size;
   data->m = size + 1;
   data->xtol_sqrd = newtonXTol*newtonXTol;
@@ -199,12 +227,13 @@ int allocateHomotopyData(int size, void** voiddata)
   data->x1 = (double*) calloc((size+1),sizeof(double));
   data->finit = (double*) calloc(size,sizeof(double));
   data->fx0 = (double*) calloc(size,sizeof(double));
-  data->fJac = (double*) calloc((size*(size+1)),sizeof(double));
-  data->fJacx0 = (double*) calloc((size*(size+1)),sizeof(double));
+  /* the jacobians are allocated with the first call of solveHomotopy, when the sparsity pattern is known */
+  data->fJac = NULL;
+  data->fJacx0 = NULL;
 
   /* debug arrays */
   data->debug_dx = (double*) calloc(size,sizeof(double));
-  data->debug_fJac = (double*) calloc((size*(size+1)),sizeof(double));
+  data->debug_fJac = NULL;
 
    /* homotopy */
   data->y0 = (double*) calloc((size+1),sizeof(double));
@@ -215,9 +244,8 @@ int allocateHomotopyData(int size, void** voiddata)
   data->dy1 = (double*) calloc((size+homBacktraceStrategy),sizeof(double));
   data->dy2 = (double*) calloc((size+1),sizeof(double));
   data->hvec = (double*) calloc(size,sizeof(double));
-  data->hJac  = (double*) calloc(size*(size+1),sizeof(double));
-  data->hJac2  = (double*) calloc((size+1)*(size+2),sizeof(double));
-  data->hJacInit  = (double*) calloc(size*(size+1),sizeof(double));
+  data->hJac = NULL;
+  data->hJac2 = NULL;
   data->ones  = (double*) calloc(size+1,sizeof(double));
 
   /* linear system */
@@ -263,7 +291,6 @@ int freeHomotopyData(void **voiddata)
   free(data->hvec);
   free(data->hJac);
   free(data->hJac2);
-  free(data->hJacInit);
   free(data->y0);
   free(data->y1);
   free(data->y2);
@@ -278,6 +305,20 @@ int freeHomotopyData(void **voiddata)
   free(data->indRow);
   free(data->indCol);
 
+  free(data->jacPos);
+  free(data->diagPos);
+  free(data->colorPtr);
+  free(data->colorCols);
+  free(data->xSave);
+  free(data->border);
+#if defined(HOMOTOPY_SPARSE_SOLVER)
+  if (data->kluData)
+  {
+    freeKluData(&data->kluData);
+    free(data->kluData);
+  }
+#endif
+
   freeHybrdData(&data->dataHybrid);
 
   return 0;
@@ -789,6 +830,244 @@ void swapPointer(double* *p1, double* *p2)
   *p2 = help;
 }
 
+/*! \fn setColorColumns
+ *  group the first nCols columns of the sparsity pattern by color
+ */
+static void setColorColumns(DATA_HOMOTOPY* solverData, SPARSE_PATTERN* pattern, int nCols)
+{
+  int i, j;
+  int maxColors = pattern->maxColors;
+
+  solverData->maxColors = maxColors;
+  solverData->colorPtr = (int*) calloc(maxColors+1, sizeof(int));
+  solverData->colorCols = (int*) malloc(nCols*sizeof(int));
+
+  for (j=0; j<nCols; j++)
+    solverData->colorPtr[pattern->colorCols[j]]++;
+  for (i=0; i<maxColors; i++)
+    solverData->colorPtr[i+1] += solverData->colorPtr[i];
+  /* fill backwards, afterwards colorPtr[i] points to the first column of color i */
+  for (j=nCols-1; j>=0; j--)
+    solverData->colorCols[--solverData->colorPtr[pattern->colorCols[j]]] = j;
+  for (i=0; i<maxColors; i++)
+    solverData->colorPtr[i] = solverData->colorPtr[i+1];
+  solverData->colorPtr[maxColors] = nCols;
+}
+
+#if defined(HOMOTOPY_SPARSE_SOLVER)
+/*! \fn initializeSparseJacobian
+ *  sparse layout of the bordered matrix [J c; r^T d] with dimension (n+1)x(n+1):
+ *  column j < n holds the sparsity pattern of column j, the diagonal element (needed
+ *  by the fixpoint homotopy) and the last row, the last column is dense.
+ */
+static void initializeSparseJacobian(DATA_HOMOTOPY* solverData, SPARSE_PATTERN* pattern)
+{
+  int i, j, k, ii, nz, row, tag, hasDiag;
+  int n = solverData->n;
+  int* rows = (int*) malloc((n+1)*sizeof(int));
+  int* tags = (int*) malloc((n+1)*sizeof(int));
+  DATA_KLU* kluData;
+
+  nz = (n+1) + n;
+  for (j=0; j<n; j++)
+  {
+    hasDiag = 0;
+    for (ii=pattern->leadindex[j]; ii<pattern->leadindex[j+1]; ii++)
+      hasDiag |= (pattern->index[ii] == j);
+    nz += pattern->leadindex[j+1] - pattern->leadindex[j] + !hasDiag;
+  }
+  allocateKluData(n+1, n+1, nz, &solverData->kluData);
+  kluData = (DATA_KLU*) solverData->kluData;
+
+  nz = 0;
+  for (j=0; j<n; j++)
+  {
+    /* rows of column j sorted ascending, tag is the index in the pattern or -1 for an added diagonal */
+    k = 0;
+    hasDiag = 0;
+    for (ii=pattern->leadindex[j]; ii<pattern->leadindex[j+1]; ii++)
+    {
+      rows[k] = pattern->index[ii];
+      tags[k++] = ii;
+      hasDiag |= (pattern->index[ii] == j);
+    }
+    if (!hasDiag)
+    {
+      rows[k] = j;
+      tags[k++] = -1;
+    }
+    for (i=1; i<k; i++)
+    {
+      row = rows[i];
+      tag = tags[i];
+      for (ii=i; ii>0 && rows[ii-1]>row; ii--)
+      {
+        rows[ii] = rows[ii-1];
+        tags[ii] = tags[ii-1];
+      }
+      rows[ii] = row;
+      tags[ii] = tag;
+    }
+
+    kluData->Ap[j] = nz;
+    for (i=0; i<k; i++)
+    {
+      if (tags[i] >= 0)
+        solverData->jacPos[tags[i]] = nz;
+      if (rows[i] == j)
+        solverData->diagPos[j] = nz;
+      kluData->Ai[nz++] = rows[i];
+    }
+    kluData->Ai[nz++] = n;
+  }
+  kluData->Ap[n] = nz;
+  for (i=0; i<=n; i++)
+    kluData->Ai[nz++] = i;
+  kluData->Ap[n+1] = nz;
+
+  solverData->jacSize = nz;
+  solverData->lastColumn = kluData->Ap[n];
+  solverData->border = (double*) calloc(n+1, sizeof(double));
+
+  free(rows);
+  free(tags);
+}
+#endif
+
+/*! \fn initializeHomotopyJacobian
+ *
+ *  Allocate the jacobians with the first call of the solver. If the sparsity
+ *  pattern of the system is known, the jacobian is evaluated by colors. Large
+ *  sparse systems (see -nlsMaxDensity and -nlsMinSize) or systems solved with
+ *  -nlsLS=klu store the jacobians sparse and solve all linear systems of the
+ *  newton and the homotopy steps with KLU.
+ */
+static void initializeHomotopyJacobian(DATA_HOMOTOPY* solverData, DATA* data, NONLINEAR_SYSTEM_DATA* systemData)
+{
+  int i, j, ii;
+  int n = solverData->n;
+  SPARSE_PATTERN* pattern = NULL;
+
+  if (systemData->jacobianIndex != -1)
+  {
+    ANALYTIC_JACOBIAN* jacobian = &(data->simulationInfo->analyticJacobians[systemData->jacobianIndex]);
+    setColorColumns(solverData, &(jacobian->sparsePattern), jacobian->sizeCols);
+    if (jacobian->sizeRows == n && (jacobian->sizeCols == n || jacobian->sizeCols == n+1))
+      pattern = &(jacobian->sparsePattern);
+  }
+  else if (systemData->isPatternAvailable && (systemData->size == n || systemData->size == n+1))
+  {
+    pattern = &(systemData->sparsePattern);
+    /* the lambda column is calculated separately, only the first n rows are residuals */
+    for (ii=0; ii<pattern->leadindex[n]; ii++)
+    {
+      if (pattern->index[ii] >= n)
+      {
+        pattern = NULL;
+        break;
+      }
+    }
+    if (pattern)
+      setColorColumns(solverData, pattern, n);
+  }
+
+  if (pattern)
+  {
+    solverData->jacPos = (int*) malloc(pattern->leadindex[n]*sizeof(int));
+    solverData->xSave = (double*) malloc(n*sizeof(double));
+  }
+  solverData->diagPos = (int*) malloc(n*sizeof(int));
+
+#if defined(HOMOTOPY_SPARSE_SOLVER)
+  if (pattern && !solverData->casualTearingSet && n > 0)
+  {
+    double density = pattern->leadindex[n]/((double)n*n);
+    /* kinsol turns the default linear solver into KLU, only an explicit -nlsLS=klu bypasses the size and density limits */
+    int kluRequested = omc_flag[FLAG_NLS_LS] && data->simulationInfo->nlsLinearSolver == NLS_LS_KLU;
+    if (kluRequested || (density <= nonlinearSparseSolverMaxDensity && n >= nonlinearSparseSolverMinSize))
+    {
+      solverData->sparse = 1;
+      initializeSparseJacobian(solverData, pattern);
+      infoStreamPrint(LOG_NLS, 0, "Homotopy solver uses sparse jacobians and KLU for nonlinear system %d (density %.2f).", solverData->sysNumber, density);
+    }
+  }
+#endif
+
+  if (!solverData->sparse)
+  {
+    solverData->jacSize = n*(n+1);
+    solverData->lastColumn = n*n;
+    for (j=0; pattern && j<n; j++)
+      for (ii=pattern->leadindex[j]; ii<pattern->leadindex[j+1]; ii++)
+        solverData->jacPos[ii] = j*n + pattern->index[ii];
+    for (i=0; i<n; i++)
+      solverData->diagPos[i] = i*(n+1);
+    solverData->hJac2 = (double*) calloc((n+1)*(n+2), sizeof(double));
+  }
+
+  solverData->fJac = (double*) calloc(solverData->jacSize, sizeof(double));
+  solverData->fJacx0 = (double*) calloc(solverData->jacSize, sizeof(double));
+  solverData->debug_fJac = (double*) calloc(solverData->jacSize, sizeof(double));
+  solverData->hJac = (double*) calloc(solverData->jacSize, sizeof(double));
+
+  solverData->initialized = 1;
+}
+
+/*! \fn residualScaling
+ *  row sums of the absolute values of the jacobian with or without the last column
+ */
+static void residualScaling(DATA_HOMOTOPY* solverData, double* A, int withLastColumn)
+{
+  int i, j, k;
+  int n = solverData->n;
+
+  if (!solverData->sparse)
+  {
+    if (withLastColumn)
+      matVecMultAbs(n, solverData->m, A, solverData->ones, solverData->resScaling);
+    else
+      matVecMultAbsBB(n, A, solverData->ones, solverData->resScaling);
+    return;
+  }
+#if defined(HOMOTOPY_SPARSE_SOLVER)
+  {
+    DATA_KLU* kluData = (DATA_KLU*) solverData->kluData;
+    vecConst(n, 0.0, solverData->resScaling);
+    /* the last element of each column belongs to the last row */
+    for (j=0; j<n; j++)
+      for (k=kluData->Ap[j]; k<kluData->Ap[j+1]-1; k++)
+        solverData->resScaling[kluData->Ai[k]] += fabs(A[k]);
+    if (withLastColumn)
+      for (i=0; i<n; i++)
+        solverData->resScaling[i] += fabs(A[solverData->lastColumn + i]);
+  }
+#endif
+}
+
+/*! \fn debugJacobian
+ *  print the dense jacobian [n x (n+1)] or the elements of the sparse jacobian
+ */
+static void debugJacobian(int logName, char* matrixName, DATA_HOMOTOPY* solverData, double* A)
+{
+  if (!ACTIVE_STREAM(logName)) return;
+  if (!solverData->sparse)
+  {
+    debugMatrixDouble(logName, matrixName, A, solverData->n, solverData->m);
+    return;
+  }
+#if defined(HOMOTOPY_SPARSE_SOLVER)
+  {
+    DATA_KLU* kluData = (DATA_KLU*) solverData->kluData;
+    int j, k;
+    infoStreamPrint(logName, 1, "%s [%dx%d-dim, sparse]", matrixName, solverData->n, solverData->m);
+    for (j=0; j<solverData->m; j++)
+      for (k=kluData->Ap[j]; k<kluData->Ap[j+1]-1; k++)
+        infoStreamPrint(logName, 0, "[%d,%d] = %16.8g", kluData->Ai[k]+1, j+1, A[k]);
+    messageClose(logName);
+  }
+#endif
+}
+
 /*! \fn getAnalyticalJacobian
  *
  *  function calculates analytical jacobian
@@ -804,39 +1083,41 @@ int getAnalyticalJacobianHomotopy(DATA_HOMOTOPY* solverData, double* jac)
 {
   DATA* data = solverData->data;
   threadData_t *threadData = solverData->threadData;
-  int i,j,k,l,ii;
+  int i,j,k,l,ii,nCols;
+  const int* cols;
   NONLINEAR_SYSTEM_DATA* systemData = &(data->simulationInfo->nonlinearSystemData[solverData->sysNumber]);
   const int index = systemData->jacobianIndex;
   ANALYTIC_JACOBIAN* jacobian = &(data->simulationInfo->analyticJacobians[systemData->jacobianIndex]);
 
-  memset(jac, 0, (solverData->n)*(solverData->n)*sizeof(double));
+  memset(jac, 0, solverData->lastColumn*sizeof(double));
 
-  for(i=0; i < jacobian->sparsePattern.maxColors; i++)
+  for(i=0; i < solverData->maxColors; i++)
   {
+    cols = solverData->colorCols + solverData->colorPtr[i];
+    nCols = solverData->colorPtr[i+1] - solverData->colorPtr[i];
+
     /* activate seed variable for the corresponding color */
-    for(ii=0; ii < jacobian->sizeCols; ii++)
-      if(jacobian->sparsePattern.colorCols[ii]-1 == i)
-        jacobian->seedVars[ii] = 1;
+    for(ii=0; ii < nCols; ii++)
+      jacobian->seedVars[cols[ii]] = 1;
 
     ((systemData->analyticalJacobianColumn))(data, threadData, jacobian, NULL);
 
-    for(j = 0; j < jacobian->sizeCols; j++)
+    for(ii=0; ii < nCols; ii++)
     {
-      if(jacobian->seedVars[j] == 1)
+      j = cols[ii];
+      for(k = jacobian->sparsePattern.leadindex[j]; k < jacobian->sparsePattern.leadindex[j+1]; k++)
       {
-        ii = jacobian->sparsePattern.leadindex[j];
-        while(ii < jacobian->sparsePattern.leadindex[j+1])
-        {
-          l  = jacobian->sparsePattern.index[ii];
-          k  = j*jacobian->sizeRows + l;
-          /* Calculate scaled difference quotient */
-          jac[k] = jacobian->resultVars[l] * solverData->xScaling[j];
-          ii++;
-        };
+        l = jacobian->sparsePattern.index[k];
+        /* Calculate scaled difference quotient */
+        if (!solverData->jacPos)
+          jac[j*jacobian->sizeRows + l] = jacobian->resultVars[l] * solverData->xScaling[j];
+        else if (j < solverData->n)
+          jac[solverData->jacPos[k]] = jacobian->resultVars[l] * solverData->xScaling[j];
+        else
+          jac[solverData->lastColumn + l] = jacobian->resultVars[l] * solverData->xScaling[j];
       }
       /* de-activate seed variable for the corresponding color */
-      if(jacobian->sparsePattern.colorCols[j]-1 == i)
-        jacobian->seedVars[j] = 0;
+      jacobian->seedVars[j] = 0;
     }
   }
 
@@ -846,7 +1127,8 @@ int getAnalyticalJacobianHomotopy(DATA_HOMOTOPY* solverData, double* jac)
 /*! \fn getNumericalJacobianHomotopy
  *
  *  function calculates a jacobian matrix by
- *  numerical method finite differences
+ *  numerical method finite differences,
+ *  all columns of one color are perturbed at once if the sparsity pattern is known
  *  \author bbachmann
  *
 */
@@ -855,11 +1137,56 @@ static int getNumericalJacobianHomotopy(DATA_HOMOTOPY* solverData, double *x, do
   const double delta_h = sqrt(DBL_EPSILON*2e1);
   double delta_hh;
   double xsave;
-  int i,j,l;
+  double* fx = solverData->initHomotopy ? solverData->hvec : solverData->f1;
+  int i,j,k,l,ii,nCols;
+  const int* cols;
+  NONLINEAR_SYSTEM_DATA* systemData = &(solverData->data->simulationInfo->nonlinearSystemData[solverData->sysNumber]);
+  SPARSE_PATTERN* pattern = (systemData->jacobianIndex != -1) ? &(solverData->data->simulationInfo->analyticJacobians[systemData->jacobianIndex].sparsePattern) : &(systemData->sparsePattern);
+
+  if (solverData->jacPos) {
+    /* Use the colors of the sparsity pattern for the first n columns */
+    memset(fJac, 0, solverData->lastColumn*sizeof(double));
+    for(i = 0; i < solverData->maxColors; i++) {
+      cols = solverData->colorCols + solverData->colorPtr[i];
+      nCols = solverData->colorPtr[i+1] - solverData->colorPtr[i];
+      for(ii = 0; ii < nCols; ii++) {
+        j = cols[ii];
+        if (j >= solverData->n)
+          continue;
+        xsave = solverData->xSave[j] = x[j];
+        delta_hh = delta_h * (fabs(xsave) + 1.0);
+        if ((xsave + delta_hh >=  solverData->maxValue[j]))
+          delta_hh *= -1;
+        x[j] += delta_hh;
+      }
+      if (solverData->initHomotopy)
+        solverData->h_function(solverData, x, solverData->f2);
+      else if (solverData->casualTearingSet)
+        solverData->f_con(solverData, x, solverData->f2);
+      else
+        solverData->f(solverData, x, solverData->f2);
+
+      for(ii = 0; ii < nCols; ii++) {
+        j = cols[ii];
+        if (j >= solverData->n)
+          continue;
+        xsave = x[j] = solverData->xSave[j];
+        delta_hh = delta_h * (fabs(xsave) + 1.0);
+        if ((xsave + delta_hh >=  solverData->maxValue[j]))
+          delta_hh *= -1;
+        /* Calculate scaled difference quotient */
+        delta_hh = 1. / delta_hh * solverData->xScaling[j];
+        for(k = pattern->leadindex[j]; k < pattern->leadindex[j+1]; k++) {
+          l = pattern->index[k];
+          fJac[solverData->jacPos[k]] = (solverData->f2[l] - fx[l]) * delta_hh; /* fx must be set outside this function based on x */
+        }
+      }
+    }
+  }
 
   if (solverData->initHomotopy) {
     /* Use the homotopy function values hvec and also calculate the lambda column */
-    for(i = 0; i < solverData->n+1; i++) {
+    for(i = solverData->jacPos ? solverData->n : 0; i < solverData->n+1; i++) {
       xsave = x[i];
       delta_hh = delta_h * (fabs(xsave) + 1.0);
       if ((xsave + delta_hh >=  solverData->maxValue[i]))
@@ -870,12 +1197,12 @@ static int getNumericalJacobianHomotopy(DATA_HOMOTOPY* solverData, double *x, do
       solverData->h_function(solverData, x, solverData->f2);
 
       for(j = 0; j < solverData->n; j++) {
-        l = i * solverData->n + j;
+        l = (i < solverData->n) ? i * solverData->n + j : solverData->lastColumn + j;
         fJac[l] = (solverData->f2[j] - solverData->hvec[j]) * delta_hh; /* solverData->hvec must be set outside this function based on x */
       }
       x[i] = xsave;
     }
-  } else {
+  } else if (!solverData->jacPos) {
     /* Use the normal function values f2 and calculate jacobian without the lambda column */
     for(i = 0; i < solverData->n; i++) {
       xsave = x[i];
@@ -965,15 +1292,16 @@ static int wrapper_fvec_der(DATA_HOMOTOPY* solverData, double* x, double* fJac)
 
   if(ACTIVE_STREAM(LOG_NLS_JAC_TEST))
   {
-    int n = solverData->n;
+    /* compare the first n columns, dense or sparse */
+    int nJac = solverData->lastColumn;
     /* debugMatrixDouble(LOG_NLS_JAC_TEST,"analytical jacobian:",fJac, n, n+1); */
     getNumericalJacobianHomotopy(solverData, x, solverData->debug_fJac);
     /* debugMatrixDouble(LOG_NLS_JAC_TEST,"numerical jacobian:",solverData->debug_fJac, n, n+1); */
-    matDiffBB(n, fJac, solverData->debug_fJac, solverData->debug_fJac);
+    vecDiff(nJac, fJac, solverData->debug_fJac, solverData->debug_fJac);
     /* debugMatrixDouble(LOG_NLS_JAC_TEST,"Difference of jacobians:",solverData->debug_fJac, n, n+1); */
-    debugDouble(LOG_NLS_JAC_TEST,"error between analytical and numerical jacobian = ", vecMaxNorm(n*n, solverData->debug_fJac));
-    vecDivScaling(n*(n+1), solverData->debug_fJac , fJac, solverData->debug_fJac);
-    debugDouble(LOG_NLS_JAC_TEST,"relative error between analytical and numerical jacobian = ", vecMaxNorm(n*n, solverData->debug_fJac));
+    debugDouble(LOG_NLS_JAC_TEST,"error between analytical and numerical jacobian = ", vecMaxNorm(nJac, solverData->debug_fJac));
+    vecDivScaling(nJac, solverData->debug_fJac , fJac, solverData->debug_fJac);
+    debugDouble(LOG_NLS_JAC_TEST,"relative error between analytical and numerical jacobian = ", vecMaxNorm(nJac, solverData->debug_fJac));
     messageClose(LOG_NLS_JAC_TEST);
   }
   /* performance measurement and statistics */
@@ -1014,7 +1342,7 @@ static int wrapper_fvec_homotopy_newton_der(DATA_HOMOTOPY* solverData, double* x
   wrapper_fvec_der(solverData, x, hJac);
 
   /* add f(x0) as the last column of the Jacobian*/
-  vecCopy(n, solverData->fx0, hJac + n*n);
+  vecCopy(n, solverData->fx0, hJac + solverData->lastColumn);
 
   return 0;
 }
@@ -1045,17 +1373,15 @@ static int wrapper_fvec_homotopy_fixpoint(DATA_HOMOTOPY* solverData, double* x,
  */
 static int wrapper_fvec_homotopy_fixpoint_der(DATA_HOMOTOPY* solverData, double* x, double* hJac)
 {
-  int i, j;
+  int i;
   int n = solverData->n;
 
   /* Fixpoint homotopy */
   wrapper_fvec_der(solverData, x, hJac);
+  vecScalarMult(solverData->lastColumn, hJac, x[n], hJac);
   for (i=0; i<n; i++){
-    for (j=0; j<n; j++) {
-      hJac[i+ j * n] = x[n]*hJac[i+ j * n];
-    }
-    hJac[i+ i * n] = hJac[i+ i * n] + (1-x[n]);
-    hJac[i+ n * n] = solverData->f1[i]-(x[i] - solverData->x0[i]);
+    hJac[solverData->diagPos[i]] = hJac[solverData->diagPos[i]] + (1-x[n]);
+    hJac[solverData->lastColumn + i] = solverData->f1[i]-(x[i] - solverData->x0[i]);
   }
   return 0;
 }
@@ -1234,6 +1560,7 @@ int linearSolverWrapper(int n, double* x, double* A, int* indRow, int* indCol, i
         returnValue = 0;
       }
       break;
+    case NLS_LS_KLU: /* the jacobian is dense, if the sparsity pattern is unknown */
     case NLS_LS_LAPACK:
       /* Solve system with lapack */
       dgesv_((int*) &n,
@@ -1288,6 +1615,156 @@ int linearSolverWrapper(int n, double* x, double* A, int* indRow, int* indCol, i
 }
 
 
+/*! \fn solveSparseBorderedSystem
+ *
+ *  solve [A; border^T] y = b with KLU, A is the sparse jacobian [J c] and border
+ *  the last row of the bordered matrix. The symbolic analysis is done once, the
+ *  numeric factorization reuses the pivots as long as the growth factor is small.
+ *
+ *  \param [in]     [A]  values of the sparse jacobian
+ *  \param [in,out] [y]  right hand side b [n+1], on return the solution
+ *  \return 0 on success, -1 if the system is singular
+ */
+static int solveSparseBorderedSystem(DATA_HOMOTOPY* solverData, double* A, double* y)
+{
+#if defined(HOMOTOPY_SPARSE_SOLVER)
+  DATA_KLU* kluData = (DATA_KLU*) solverData->kluData;
+  int i, n = solverData->n;
+
+  memcpy(kluData->Ax, A, kluData->nnz*sizeof(double));
+  /* the last element of every column belongs to the last row */
+  for (i=0; i<=n; i++)
+    kluData->Ax[kluData->Ap[i+1]-1] = solverData->border[i];
+
+  if (!kluData->symbolic)
+  {
+    kluData->symbolic = klu_analyze(n+1, kluData->Ap, kluData->Ai, &kluData->common);
+    if (!kluData->symbolic)
+    {
+      debugString(LOG_NLS_V, "Sparse linear solver KLU: symbolic analysis failed!!!");
+      return -1;
+    }
+  }
+
+  if (kluData->numeric)
+  {
+    /* refactor with the previous pivots, unless the growth factor gets too small */
+    if (!klu_refactor(kluData->Ap, kluData->Ai, kluData->Ax, kluData->symbolic, kluData->numeric, &kluData->common) || kluData->common.status != KLU_OK ||
+        !klu_rgrowth(kluData->Ap, kluData->Ai, kluData->Ax, kluData->symbolic, kluData->numeric, &kluData->common) || kluData->common.rgrowth < 1e-3)
+    {
+      klu_free_numeric(&kluData->numeric, &kluData->common);
+    }
+  }
+  if (!kluData->numeric)
+    kluData->numeric = klu_factor(kluData->Ap, kluData->Ai, kluData->Ax, kluData->symbolic, &kluData->common);
+
+  if (!kluData->numeric || kluData->common.status != KLU_OK ||
+      !klu_rcond(kluData->symbolic, kluData->numeric, &kluData->common) || kluData->common.rcond < DBL_EPSILON)
+  {
+    debugString(LOG_NLS_V, "Sparse linear solver KLU failed, the matrix is singular!!!");
+    if (kluData->numeric)
+      klu_free_numeric(&kluData->numeric, &kluData->common);
+    return -1;
+  }
+
+  if (!klu_solve(kluData->symbolic, kluData->numeric, n+1, 1, y, &kluData->common))
+    return -1;
+  kluData->numberSolving++;
+
+  for (i=0; i<=n; i++)
+    if (isnan(y[i]))
+      return -1;
+
+  debugVectorDouble(LOG_NLS_JAC,"solution:", y, n+1);
+  return 0;
+#else
+  return -1;
+#endif
+}
+
+/*! \fn solveSparseNewtonStep
+ *  newton step of [J f] with fixed lambda, like solveSystemWithTotalPivotSearch with pos = n
+ */
+static int solveSparseNewtonStep(DATA_HOMOTOPY* solverData, double* dy, double* fJac)
+{
+  int n = solverData->n;
+
+  vecConst(n, 0.0, solverData->border);
+  solverData->border[n] = 1.0;
+  vecScalarMult(n, fJac + solverData->lastColumn, -1.0, dy);
+  dy[n] = 0.0;
+
+  if (solveSparseBorderedSystem(solverData, fJac, dy) == -1)
+    return -1;
+  dy[n] = 1.0;
+  return 0;
+}
+
+/*! \fn solveSparseTangent
+ *
+ *  tangent vector of the homotopy path with hJac dy = 0, the last row of the
+ *  bordered system fixes the component in direction of the previous tangent.
+ *  Like solveSystemWithTotalPivotSearch with pos = -1, the largest component of
+ *  the (scaled) tangent is one and returned in pos.
+ */
+static int solveSparseTangent(DATA_HOMOTOPY* solverData, double* dy, double* hJac, double* direction, int* pos)
+{
+  int i, n = solverData->n;
+
+  for (i=0; i<=n; i++)
+  {
+    solverData->border[i] = direction[i]/solverData->xScaling[i];
+    dy[i] = 0.0;
+  }
+  dy[n] = 1.0;
+
+  if (solveSparseBorderedSystem(solverData, hJac, dy) == -1)
+    return -1;
+
+  *pos = 0;
+  for (i=1; i<=n; i++)
+    if (fabs(dy[i]) > fabs(dy[*pos]))
+      *pos = i;
+  vecScalarMult(n+1, dy, 1.0/dy[*pos], dy);
+  return 0;
+}
+
+/*! \fn solveSparseCorrector
+ *  newton step of the corrector, either with the fixed coordinate pos or
+ *  orthogonal to the tangent vector v (v != NULL)
+ */
+static int solveSparseCorrector(DATA_HOMOTOPY* solverData, double* dy, double* hJac, double* hvec, double* v, int pos)
+{
+  int n = solverData->n;
+
+  if (v)
+    vecCopy(n+1, v, solverData->border);
+  else
+  {
+    vecConst(n+1, 0.0, solverData->border);
+    solverData->border[pos] = 1.0;
+  }
+  vecScalarMult(n, hvec, -1.0, dy);
+  dy[n] = 0.0;
+
+  return solveSparseBorderedSystem(solverData, hJac, dy);
+}
+
+/*! \fn solveNewtonSystem
+ *  solve [fJac f] for the newton step dy0 with fixed lambda,
+ *  the dense matrix is scaled and decomposed (side effect)
+ */
+static int solveNewtonSystem(DATA_HOMOTOPY* solverData)
+{
+  int pos = solverData->n, rank;
+
+  if (solverData->sparse)
+    return solveSparseNewtonStep(solverData, solverData->dy0, solverData->fJac);
+
+  scaleMatrixRows(solverData->n, solverData->m, solverData->fJac);
+  return solveSystemWithTotalPivotSearch(solverData->n, solverData->dy0, solverData->fJac, solverData->indRow, solverData->indCol, &pos, &rank, solverData->casualTearingSet);
+}
+
 /*! \fn solve system with damped Newton-Raphson
  *
  *  \author bbachmann
@@ -1338,7 +1815,12 @@ static int newtonAlgorithm(DATA_HOMOTOPY* solverData, double* x)
 
     /* solve jacobian and function value (both stored in hJac, last column is fvec), side effects: jacobian matrix is changed */
     if (numberOfIterations>1)
-      solverinfo = linearSolverWrapper(solverData->n, solverData->dy0, solverData->fJac, solverData->indRow, solverData->indCol, &pos, &rank, linearSolverMethod, solverData->casualTearingSet);
+    {
+      if (solverData->sparse)
+        solverinfo = solveSparseNewtonStep(solverData, solverData->dy0, solverData->fJac);
+      else
+        solverinfo = linearSolverWrapper(solverData->n, solverData->dy0, solverData->fJac, solverData->indRow, solverData->indCol, &pos, &rank, linearSolverMethod, solverData->casualTearingSet);
+    }
 
     if (solverinfo == -1)
     {
@@ -1627,12 +2109,15 @@ static int newtonAlgorithm(DATA_HOMOTOPY* solverData, double* x)
       debugString(LOG_NLS_V,"UPS! assert when calculating Jacobian!!!");
       break;
     }
-    vecCopy(n, solverData->f1, solverData->fJac + n*n);
+    vecCopy(n, solverData->f1, solverData->fJac + solverData->lastColumn);
     /* calculate scaling factor of residuals */
-    matVecMultAbsBB(solverData->n, solverData->fJac, solverData->ones, solverData->resScaling);
+    residualScaling(solverData, solverData->fJac, 0);
     debugVectorDouble(LOG_NLS_JAC, "residuum scaling:", solverData->resScaling, solverData->n);
-    scaleMatrixRows(solverData->n, solverData->m, solverData->fJac);
-    vecCopy(n, solverData->fJac + n*n, solverData->dy0);
+    if (!solverData->sparse)
+    {
+      scaleMatrixRows(solverData->n, solverData->m, solverData->fJac);
+      vecCopy(n, solverData->fJac + n*n, solverData->dy0);
+    }
   }
   return 0;
 }
@@ -1758,16 +2243,20 @@ static int homotopyAlgorithm(DATA_HOMOTOPY* solverData, double *x)
     MMC_TRY_INTERNAL(simulationJumpBuffer)
 #endif
       solverData->hJac_dh(solverData, solverData->y0, solverData->hJac);
-      debugMatrixDouble(LOG_NLS_JAC,"Jacobian hJac:",solverData->hJac, solverData->n, solverData->n+1);
-      scaleMatrixRows(solverData->n, solverData->m, solverData->hJac);
-      debugMatrixDouble(LOG_NLS_JAC,"Jacobian hJac after scaling:",solverData->hJac, solverData->n, solverData->n+1);
+      debugJacobian(LOG_NLS_JAC,"Jacobian hJac:", solverData, solverData->hJac);
+      if (!solverData->sparse)
+      {
+        scaleMatrixRows(solverData->n, solverData->m, solverData->hJac);
+        debugMatrixDouble(LOG_NLS_JAC,"Jacobian hJac after scaling:",solverData->hJac, solverData->n, solverData->n+1);
+      }
       assert = 0;
       pos = -1; /* stable solution algorithm for solving a generalized over-determined linear system */
 #ifndef OMC_EMCC
     MMC_CATCH_INTERNAL(simulationJumpBuffer)
 #endif
 
-      if (assert || (solveSystemWithTotalPivotSearch(solverData->n, solverData->dy0, solverData->hJac, solverData->indRow, solverData->indCol, &pos, &rank, solverData->casualTearingSet) == -1))
+      if (assert || (solverData->sparse ? solveSparseTangent(solverData, solverData->dy0, solverData->hJac, solverData->dy2, &pos)
+                                        : solveSystemWithTotalPivotSearch(solverData->n, solverData->dy0, solverData->hJac, solverData->indRow, solverData->indCol, &pos, &rank, solverData->casualTearingSet)) == -1)
       {
         /* report solver abortion */
         solverData->info=-1;
@@ -1900,9 +2389,9 @@ static int homotopyAlgorithm(DATA_HOMOTOPY* solverData, double *x)
 #endif
       /* calculate homotopy jacobian */
       solverData->hJac_dh(solverData, solverData->y1, solverData->hJac);
-      debugMatrixDouble(LOG_NLS_JAC,"Jacobian hJac:",solverData->hJac, solverData->n, solverData->n+1);
+      debugJacobian(LOG_NLS_JAC,"Jacobian hJac:", solverData, solverData->hJac);
 
-      if (correctorStrategy==2)
+      if (correctorStrategy==2 && !solverData->sparse)
       {
         /* calculate the newton matrix hJac2 for the orthogonal backtrace strategy */
         orthogonalBacktraceMatrix(solverData, solverData->hJac, solverData->hvec, solverData->dy0, solverData->hJac2, solverData->n, solverData->m);
@@ -1919,10 +2408,21 @@ static int homotopyAlgorithm(DATA_HOMOTOPY* solverData, double *x)
         stepAccept = 0;
         break;
       }
-      matVecMultAbs(solverData->n, solverData->m, solverData->hJac, solverData->ones, solverData->resScaling);
+      residualScaling(solverData, solverData->hJac, 1);
       debugVectorDouble(LOG_NLS_HOMOTOPY, "residuum scaling of function h:", solverData->resScaling, solverData->n);
 
-      if (correctorStrategy==1) // fix one coordinate
+      if (solverData->sparse) // bordered system with KLU, the last row fixes one coordinate or is the tangent vector
+      {
+        if (solveSparseCorrector(solverData, solverData->dy1, solverData->hJac, solverData->hvec, correctorStrategy==1 ? NULL : solverData->dy0, pos) == -1)
+        {
+          debugString(LOG_NLS_HOMOTOPY, "step NOT accepted, because solveSparseCorrector failed!");
+          stepAccept = 0;
+          break;
+        }
+        if (correctorStrategy==1)
+          solverData->dy1[pos] = 0.0;
+      }
+      else if (correctorStrategy==1) // fix one coordinate
       {
         /* copy vector h to column "pos" of the jacobian */
         debugVectorDouble(LOG_NLS_HOMOTOPY, "copy vector hvec to column 'pos' of the jacobian: ", solverData->hvec, solverData->n);
@@ -2106,8 +2606,6 @@ int solveHomotopy(DATA *data, threadData_t *threadData, int sysNumber)
   int assert = 1;
   int giveUp = 0;
   int alreadyTested = 0;
-  int pos;
-  int rank;
   int tries = 0;
   int runHomotopy = 0;
   int skipNewton = 0;
@@ -2133,6 +2631,9 @@ int solveHomotopy(DATA *data, threadData_t *threadData, int sysNumber)
   solverData->maxValue = systemData->max;
   solverData->info = 0;
 
+  if (!solverData->initialized)
+    initializeHomotopyJacobian(solverData, data, systemData);
+
   vecConst(solverData->m,1.0,solverData->ones);
 
   debugString(LOG_NLS_V, "------------------------------------------------------");
@@ -2233,17 +2734,15 @@ int solveHomotopy(DATA *data, threadData_t *threadData, int sysNumber)
         }
       }
       solverData->fJac_f(solverData, solverData->x0, solverData->fJac);
-      vecCopy(solverData->n, solverData->f1, solverData->fJac + solverData->n*solverData->n);
-      vecCopy(solverData->n*solverData->m, solverData->fJac, solverData->fJacx0);
+      vecCopy(solverData->n, solverData->f1, solverData->fJac + solverData->lastColumn);
+      vecCopy(solverData->jacSize, solverData->fJac, solverData->fJacx0);
       if (mixedSystem)
         memcpy(relationsPreBackup, data->simulationInfo->relations, sizeof(modelica_boolean)*data->modelData->nRelations);
       /* calculate scaling factor of residuals */
-      matVecMultAbsBB(solverData->n, solverData->fJac, solverData->ones, solverData->resScaling);
+      residualScaling(solverData, solverData->fJac, 0);
       debugVectorDouble(LOG_NLS_JAC, "residuum scaling:", solverData->resScaling, solverData->n);
-      scaleMatrixRows(solverData->n, solverData->m, solverData->fJac);
 
-      pos = solverData->n;
-      assert = (solveSystemWithTotalPivotSearch(solverData->n, solverData->dy0, solverData->fJac, solverData->indRow, solverData->indCol, &pos, &rank, solverData->casualTearingSet) == -1);
+      assert = (solveNewtonSystem(solverData) == -1);
       if (!assert)
         debugString(LOG_NLS_V, "regular initial point!!!");
       giveUp = 0;
@@ -2346,14 +2845,11 @@ int solveHomotopy(DATA *data, threadData_t *threadData, int sysNumber)
           alreadyTested = 1;
           vecCopy(solverData->n, solverData->x0, solverData->x);
           vecCopy(solverData->n, solverData->fx0, solverData->f1);
-          vecCopy(solverData->n*solverData->m, solverData->fJacx0, solverData->fJac);
+          vecCopy(solverData->jacSize, solverData->fJacx0, solverData->fJac);
 
           /* calculate scaling factor of residuals */
-          matVecMultAbsBB(solverData->n, solverData->fJac, solverData->ones, solverData->resScaling);
-          scaleMatrixRows(solverData->n, solverData->m, solverData->fJac);
-
-          pos = solverData->n;
-          solveSystemWithTotalPivotSearch(solverData->n, solverData->dy0, solverData->fJac,   solverData->indRow, solverData->indCol, &pos, &rank, solverData->casualTearingSet);
+          residualScaling(solverData, solverData->fJac, 0);
+          solveNewtonSystem(solverData);
           debugDouble(LOG_NLS_V,"solve mixed system at time : ", solverData->timeValue);
           continue;
         }
@@ -2460,14 +2956,12 @@ int solveHomotopy(DATA *data, threadData_t *threadData, int sysNumber)
         solverData->f(solverData, solverData->x, solverData->f1);
 
       solverData->fJac_f(solverData, solverData->x, solverData->fJac);
-      vecCopy(solverData->n, solverData->f1, solverData->fJac + solverData->n*solverData->n);
+      vecCopy(solverData->n, solverData->f1, solverData->fJac + solverData->lastColumn);
       /* calculate scaling factor of residuals */
-      matVecMultAbsBB(solverData->n, solverData->fJac, solverData->ones, solverData->resScaling);
+      residualScaling(solverData, solverData->fJac, 0);
       debugVectorDouble(LOG_NLS_JAC, "residuum scaling:", solverData->resScaling, solverData->n);
-      scaleMatrixRows(solverData->n, solverData->m, solverData->fJac);
 
-      pos = solverData->n;
-      assert = (solveSystemWithTotalPivotSearch(solverData->n, solverData->dy0, solverData->fJac,   solverData->indRow, solverData->indCol, &pos, &rank, solverData->casualTearingSet) == -1);
+      assert = (solveNewtonSystem(solverData) == -1);
       if (!assert)
         debugString(LOG_NLS_V, "regular initial point!!!");
 #ifndef OMC_EMCC
@@ -408,7 +408,7 @@ int initializeNonlinearSystems(DATA *data, threadData_t *threadData)
     nonlinsys[i].resValues = (double*) malloc(size*sizeof(double));
 
     /* allocate value list*/
-    nonlinsys[i].oldValueList = (void*) allocValueList(1);
+    nonlinsys[i].oldValueList = (void*) allocValueList(size, nonlinearExtrapolationOrder);
 
     nonlinsys[i].lastTimeSolved = 0.0;
 
@@ -550,7 +550,7 @@ int freeNonlinearSystems(DATA *data, threadData_t *threadData)
     free(nonlinsys[i].nominal);
     free(nonlinsys[i].min);
     free(nonlinsys[i].max);
-    freeValueList(nonlinsys[i].oldValueList, 1);
+    freeValueList((VALUES_LIST*)nonlinsys[i].oldValueList);
 
 #if !defined(OMC_MINIMAL_RUNTIME)
     if (data->simulationInfo->nlsCsvInfomation)
@@ -692,7 +692,7 @@ int getInitialGuess(NONLINEAR_SYSTEM_DATA *nonlinsys, double time)
   /* value extrapolation */
   printValuesListTimes((VALUES_LIST*)nonlinsys->oldValueList);
   /* if list is empty use current start values */
-  if (listLen(((VALUES_LIST*)nonlinsys->oldValueList)->valueList)==0)
+  if (((VALUES_LIST*)nonlinsys->oldValueList)->length==0)
   {
     /* use old value if no values are stored in the list */
     memcpy(nonlinsys->nlsx, nonlinsys->nlsxOld, nonlinsys->size*(sizeof(double)));
@@ -724,21 +724,16 @@ int updateInitialGuessDB(NONLINEAR_SYSTEM_DATA *nonlinsys, double time, int cont
     /* do not use solution of jacobian for next extrapolation */
     if (context < 4)
     {
-      addListElement((VALUES_LIST*)nonlinsys->oldValueList,
-              createValueElement(nonlinsys->size, time, nonlinsys->nlsx));
+      addListElement((VALUES_LIST*)nonlinsys->oldValueList, time, nonlinsys->nlsx);
     }
   }
   else if (nonlinsys->solved == 2)
   {
-    if (listLen(((VALUES_LIST*)nonlinsys->oldValueList)->valueList)>0)
-    {
-      cleanValueList((VALUES_LIST*)nonlinsys->oldValueList, NULL);
-    }
+    cleanValueList((VALUES_LIST*)nonlinsys->oldValueList);
     /* do not use solution of jacobian for next extrapolation */
     if (context < 4)
     {
-      addListElement((VALUES_LIST*)nonlinsys->oldValueList,
-              createValueElement(nonlinsys->size, time, nonlinsys->nlsx));
+      addListElement((VALUES_LIST*)nonlinsys->oldValueList, time, nonlinsys->nlsx);
     }
   }
   messageClose(LOG_NLS_EXTRAPOLATE);
@@ -945,7 +940,6 @@ int solve_nonlinear_system(DATA *data, threadData_t *threadData, int sysNumber)
   int solveWithHomotopySolver = 0;
   int homotopyDeactivated = 0;
   int j;
-  int nlsLs;
   int kinsol = 0;
   struct dataSolver *solverData;
   struct dataMixedSolver *mixedSolverData;
@@ -1046,10 +1040,7 @@ int solve_nonlinear_system(DATA *data, threadData_t *threadData, int sysNumber)
       if (!kinsol) {
         nonlinsys->solved = solveNLS(data, threadData, sysNumber);
       } else {
-        nlsLs = data->simulationInfo->nlsLinearSolver;
-        data->simulationInfo->nlsLinearSolver = NLS_LS_LAPACK;
         nonlinsys->solved = solveWithInitHomotopy(data, threadData, sysNumber);
-        data->simulationInfo->nlsLinearSolver = nlsLs;
       }
       nonlinsys->homotopySupport = 1;
       infoStreamPrint(LOG_INIT, 0, "solving lambda0-system done with%s success\n---------------------------", nonlinsys->solved ? "" : " no");
@@ -31,7 +31,7 @@
 
 /*! \file nonlinearValuesList.h
  * Description: This is a C implementation of a value database
- *              based on a list. It's purpose is to be used by a
+ *              based on a ring buffer. It's purpose is to be used by a
  *              a non-linear solver in OpenModelica in order to
  *              guess next value by extrapolation or interpolation.
  *              Assuming time passes forward.
@@ -41,302 +41,214 @@
 #include "epsilon.h"
 #include "nonlinearValuesList.h"
 
-#include "util/list.h"
 #include "util/omc_error.h"
 
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
 /* Forward extrapolate function definition */
 double extrapolateValues(const double, const double, const double, const double, const double);
 
-VALUES_LIST* allocValueList(unsigned int numberOfList)
+/* ring position of the element with the given index, 0 is the newest element */
+static inline unsigned int elementPosition(VALUES_LIST* valueList, unsigned int index)
 {
-  unsigned int i = 0;
-  VALUES_LIST* valueList = (VALUES_LIST*) malloc(numberOfList*sizeof(VALUES_LIST));
+  return (valueList->first + index) % valueList->capacity;
+}
 
-  for(i=0; i<numberOfList; ++i){
-    (valueList+i)->valueList = allocList(sizeof(VALUE));
-  }
+static inline double elementTime(VALUES_LIST* valueList, unsigned int index)
+{
+  return valueList->time[elementPosition(valueList, index)];
+}
 
-  return valueList;
+static inline double* elementValues(VALUES_LIST* valueList, unsigned int index)
+{
+  return valueList->values + (size_t)elementPosition(valueList, index)*valueList->size;
 }
 
-void freeValueList(VALUES_LIST *valueList, unsigned int numberOfList)
+VALUES_LIST* allocValueList(unsigned int size, int order)
 {
-  VALUE* elem;
-  VALUES_LIST *tmpList;
+  VALUES_LIST* valueList = (VALUES_LIST*) malloc(sizeof(VALUES_LIST));
+  assertStreamPrint(NULL, NULL != valueList, "out of memory");
+
+  valueList->size = size;
+  valueList->capacity = VALUES_LIST_CAPACITY;
+  valueList->length = 0;
+  valueList->first = 0;
+  valueList->order = order;
+  valueList->time = (double*) malloc(valueList->capacity*sizeof(double));
+  valueList->values = (double*) malloc((size_t)valueList->capacity*size*sizeof(double));
+  assertStreamPrint(NULL, NULL != valueList->time && (NULL != valueList->values || 0 == size), "out of memory");
 
-  int i,j;
-  for(j = 0; j < numberOfList; ++j)
-  {
-    tmpList = valueList+j;
-    for(i = 0; i < listLen(tmpList->valueList); ++i)
-    {
-      elem = (VALUE*) listFirstData(tmpList->valueList);
-      listPopFront(tmpList->valueList);
-    }
-    freeList(tmpList->valueList);
-  }
-  free(valueList);
+  return valueList;
 }
 
-void cleanValueList(VALUES_LIST *valueList, LIST_NODE *startNode)
+void freeValueList(VALUES_LIST *valueList)
 {
-  LIST_NODE *next, *node;
-  VALUE* elem;
+  free(valueList->time);
+  free(valueList->values);
+  free(valueList);
+}
 
-  int i, j;
-  if (startNode == NULL)
-  {
-    listClear(valueList->valueList);
-  }
-  else
-  {
-    next = listNextNode(startNode);
-    /* clean list from next node */
-    infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, "cleanValueList length: %d", listLen(valueList->valueList));
-    updateNodeNext(valueList->valueList, startNode, NULL);
-    removeNodes(valueList->valueList, next);
-  }
+void cleanValueList(VALUES_LIST *valueList)
+{
+  infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, "cleanValueList length: %d", valueList->length);
+  valueList->length = 0;
 }
 
+/* keeps only the newest element with a time point <= time, or the oldest
+ * element if all elements are later */
 void cleanValueListbyTime(VALUES_LIST *valueList, double time)
 {
-  LIST_NODE *next, *node;
-  VALUE* elem;
+  unsigned int i;
 
   /*  if it's empty anyway */
-  if (listLen(valueList->valueList) == 0)
+  if (valueList->length == 0)
   {
     return;
   }
   printValuesListTimes(valueList);
-  node = listFirstNode(valueList->valueList);
-  do
+  for(i = 0; i < valueList->length - 1; ++i)
   {
-    elem = ((VALUE*)listNodeData(node));
-    next = listNextNode(node);
-    /*  if next node is empty */
-    if (!next)
-    {
-      return;
-    }
-    if (elem->time <= time)
+    if (elementTime(valueList, i) <= time)
     {
       break;
     }
     /* debug output */
     infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, "cleanValueListbyTime %g check element: ", time);
-    printValueElement(elem);
-
-    freeNode(node);
-    updatelistFirst(valueList->valueList, next);
-    updatelistLength(valueList->valueList, listLen(valueList->valueList)-1);
-    node = next;
-  }while(1);
-  cleanValueList(valueList, node);
-  infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, "New list length %d: ", listLen(valueList->valueList));
+    printValueElement(valueList, i);
+  }
+  valueList->first = elementPosition(valueList, i);
+  valueList->length = 1;
+  infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, "New list length %d: ", valueList->length);
   printValuesListTimes(valueList);
   infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, "Done!");
 }
 
-VALUE* createValueElement(unsigned int size, double time, double* values)
-{
-  VALUE* elem = (VALUE*) malloc(sizeof(VALUE));
-  elem->values = (double*) malloc(size*sizeof(double));
-  elem->time = time;
-  elem->size = size;
-
-  memcpy(elem->values, values, size*sizeof(double));
-
-  /* debug output */
-  infoStreamPrint(LOG_NLS_EXTRAPOLATE, 1, "Create Element");
-  messageClose(LOG_NLS_EXTRAPOLATE);
-
-  return elem;
-}
-
-void freeValue(VALUE* elem)
-{
-  free(elem->values);
-  free(elem);
-}
-
-void addListElement(VALUES_LIST* valuesList, VALUE* newElem)
+/* adds a solution as newest element, a solution at the same time as the newest
+ * element replaces it and the oldest element is overwritten if the list is full */
+void addListElement(VALUES_LIST* valueList, double time, const double* values)
 {
-  LIST_NODE *node, *next;
-  VALUE* elem;
-  int replace = 0, i = 0;
-
   /* debug output */
-  infoStreamPrint(LOG_NLS_EXTRAPOLATE, 1, "Adding element in a list of size %d", listLen(valuesList->valueList));
-  printValueElement(newElem);
+  infoStreamPrint(LOG_NLS_EXTRAPOLATE, 1, "Adding element at time %g in a list of size %d", time, valueList->length);
 
-  /*  if it's empty, just push in  */
-  if (listLen(valuesList->valueList) == 0)
-  {
-    infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, "List is empty add just.");
-    listPushFront(valuesList->valueList, (void*) newElem);
-
-    messageClose(LOG_NLS_EXTRAPOLATE);
-    return;
-  }
-
-  /*  if the element at begin is earlier than current
-   *  push the element just in front and if the end element
-   *  is later than current push it just back.*/
-  node = listFirstNode(valuesList->valueList);
-  if ( fabs( ((VALUE*)listNodeData(node))->time - newElem->time ) > MINIMAL_STEP_SIZE )
-  {
-    infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, "First Value list element is:");
-    printValueElement(((VALUE*)listNodeData(node)));
-    infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, "so new element is added before.");
-    listPushFront(valuesList->valueList, (void*) newElem);
-
-    messageClose(LOG_NLS_EXTRAPOLATE);
-    return;
-  }
-
-  infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, "Search position of new element");
-  /* search correct position */
-  next = node;
-  do
-  {
-    /*  if next node is empty */
-    if (!next)
-    {
-      infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, "Search finished last element reached");
-      break;
-    }
-
-    elem = ((VALUE*)listNodeData(next));
-
-    /* debug output */
-    infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, "Next node of list is element:");
-    printValueElement(elem);
-
-
-    if (fabs(elem->time - newElem->time)<=MINIMAL_STEP_SIZE)
-    {
-      replace = 1;
-      break;
-    }
-    else if (elem->time < newElem->time)
-    {
-      break;
-    }
-    node = next;
-    next = listNextNode(node);
-    i++; /* count insert or replace place */
-  }while(1);
-
-  /* add element before currect node */
-  if (!replace){
-    infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, "Insert element before last output element.");
-    listInsert(valuesList->valueList, node, (void*) newElem);
-  }
-  else
+  if (valueList->length > 0 && fabs(elementTime(valueList, 0) - time) <= MINIMAL_STEP_SIZE)
   {
     infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, "replace element.");
-    updateNodeData(valuesList->valueList, next, (void*) newElem);
   }
-  /*  clean list if too full */
-  if (i < 3 && listLen(valuesList->valueList)>10)
+  else
   {
-    while(i < 4)
+    valueList->first = (valueList->first + valueList->capacity - 1) % valueList->capacity;
+    if (valueList->length < valueList->capacity)
     {
-      next = listNextNode(next);
-      i++;
+      valueList->length++;
     }
-    cleanValueList(valuesList, next);
   }
+  valueList->time[valueList->first] = time;
+  memcpy(elementValues(valueList, 0), values, valueList->size*sizeof(double));
+  printValueElement(valueList, 0);
 
   messageClose(LOG_NLS_EXTRAPOLATE);
-  return;
 }
 
-void getValues(VALUES_LIST* valuesList, double time, double* extrapolatedValues, double* oldOutput)
+void getValues(VALUES_LIST* valueList, double time, double* extrapolatedValues, double* oldOutput)
 {
-  LIST_NODE *begin, *next, *old, *old2;
-  VALUE *oldValues, *old2Values, *elem;
-
-  infoStreamPrint(LOG_NLS_EXTRAPOLATE, 1, "Get values for time %g in a list of size %d", time, listLen(valuesList->valueList));
-  begin = listFirstNode(valuesList->valueList);
+  unsigned int i, index, n;
+  double *old, *old2, *old3;
+  double t1, t2, t3;
 
-  assertStreamPrint(NULL, NULL != begin, "getValues failed, no elements");
+  infoStreamPrint(LOG_NLS_EXTRAPOLATE, 1, "Get values for time %g in a list of size %d", time, valueList->length);
 
-  /* find corresponding values */
-  do{
-    elem = (VALUE*)listNodeData(begin);
-    infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, "Searching current element:");
-    printValueElement(elem);
+  assertStreamPrint(NULL, 0 < valueList->length, "getValues failed, no elements");
 
-    if (fabs(elem->time - time)<=MINIMAL_STEP_SIZE)
+  /* find the newest element before time, number of elements used for the extrapolation */
+  n = 1;
+  for(index = 0; index < valueList->length; ++index)
+  {
+    if (fabs(elementTime(valueList, index) - time) <= MINIMAL_STEP_SIZE)
     {
-      old = begin;
-      old2 = NULL;
       infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, "take element with the same time.");
       break;
     }
-    else if (elem->time < time)
+    else if (elementTime(valueList, index) < time)
     {
-      old = begin;
-      old2 = listNextNode(old);
+      n = valueList->length - index;
+      if (n > valueList->order + 1)
+      {
+        n = valueList->order + 1;
+      }
       infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, "found element to use for extrapolation.");
       break;
     }
-   else
+  }
+  if (index == valueList->length)
+  {
+    index = valueList->length - 1;
+    infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, "reached end of list.");
+  }
+
+  old = elementValues(valueList, index);
+  t1 = elementTime(valueList, index);
+  /* quadratic extrapolation needs three distinct time points */
+  if (n == 3)
+  {
+    t2 = elementTime(valueList, index+1);
+    t3 = elementTime(valueList, index+2);
+    if (t1 == t2 || t1 == t3 || t2 == t3)
     {
-      next = listNextNode(begin);
-      if (!next){
-        old = begin;
-        old2 = next;
-        infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, "reached end of list.");
-        break;
-      }
-      else
-      {
-        begin = next;
-      }
+      n = 2;
     }
-  }while(1);
+  }
 
-  /*  get next values */
-  if (old2 == NULL)
+  if (n == 1)
   {
-    oldValues = (VALUE*) listNodeData(old);
-    memcpy(extrapolatedValues, oldValues->values, oldValues->size*sizeof(double));
-    memcpy(oldOutput, oldValues->values, oldValues->size*sizeof(double));
+    memcpy(extrapolatedValues, old, valueList->size*sizeof(double));
     infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, "take just old values.");
   }
+  else if (n == 2)
+  {
+    old2 = elementValues(valueList, index+1);
+    t2 = elementTime(valueList, index+1);
+    infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, "Use following elements for calculation:");
+    printValueElement(valueList, index);
+    printValueElement(valueList, index+1);
+    for(i = 0; i < valueList->size; ++i)
+    {
+      extrapolatedValues[i] = extrapolateValues(time, old[i], t1, old2[i], t2);
+    }
+  }
   else
   {
-    int i;
-    oldValues = (VALUE*) listNodeData(old);
-    old2Values = (VALUE*) listNodeData(old2);
+    /* Lagrange polynomial through the three newest solutions */
+    double l1 = (time - t2)*(time - t3)/((t1 - t2)*(t1 - t3));
+    double l2 = (time - t1)*(time - t3)/((t2 - t1)*(t2 - t3));
+    double l3 = (time - t1)*(time - t2)/((t3 - t1)*(t3 - t2));
+    old2 = elementValues(valueList, index+1);
+    old3 = elementValues(valueList, index+2);
     infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, "Use following elements for calculation:");
-    printValueElement(oldValues);
-    printValueElement(old2Values);
-    for(i = 0; i < oldValues->size; ++i)
+    printValueElement(valueList, index);
+    printValueElement(valueList, index+1);
+    printValueElement(valueList, index+2);
+    for(i = 0; i < valueList->size; ++i)
     {
-      extrapolatedValues[i] = extrapolateValues(time, oldValues->values[i], oldValues->time, old2Values->values[i], old2Values->time);
+      extrapolatedValues[i] = l1*old[i] + l2*old2[i] + l3*old3[i];
     }
-    memcpy(oldOutput, oldValues->values, oldValues->size*sizeof(double));
   }
+  memcpy(oldOutput, old, valueList->size*sizeof(double));
   messageClose(LOG_NLS_EXTRAPOLATE);
   return;
 }
 
-void printValueElement(VALUE* elem)
+void printValueElement(VALUES_LIST* valueList, unsigned int index)
 {
   /* debug output */
   if(ACTIVE_STREAM(LOG_NLS_EXTRAPOLATE))
   {
     int i;
-    infoStreamPrint(LOG_NLS_EXTRAPOLATE, 1, "Element(size %d) at time %g ", elem->size, elem->time);
-    for(i = 0; i < elem->size; i++) {
-      infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, " oldValues[%d] = %g",i, elem->values[i]);
+    double *values = elementValues(valueList, index);
+    infoStreamPrint(LOG_NLS_EXTRAPOLATE, 1, "Element(size %d) at time %g ", valueList->size, elementTime(valueList, index));
+    for(i = 0; i < valueList->size; i++) {
+      infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, " oldValues[%d] = %g",i, values[i]);
     }
     messageClose(LOG_NLS_EXTRAPOLATE);
   }
@@ -348,24 +260,17 @@ void printValuesListTimes(VALUES_LIST* list)
   if(ACTIVE_STREAM(LOG_NLS_EXTRAPOLATE))
   {
     int i;
-    LIST_NODE *next;
-    VALUE *elem;
 
     infoStreamPrint(LOG_NLS_EXTRAPOLATE, 1, "Print all elements");
-    if (listLen(list->valueList) == 0){
+    if (list->length == 0){
       infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, "List is empty!");
       messageClose(LOG_NLS_EXTRAPOLATE);
       return;
     }
-    next = listFirstNode(list->valueList);
-
-    assertStreamPrint(NULL, NULL != next, "printValuesListTimes failed, no elements");
 
     /* go though the list */
-    for(i = 0; i < listLen(list->valueList); i++) {
-      elem = (VALUE*)listNodeData(next);
-      infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, "Element %d at time %g", i, elem->time);
-      next = listNextNode(next);
+    for(i = 0; i < list->length; i++) {
+      infoStreamPrint(LOG_NLS_EXTRAPOLATE, 0, "Element %d at time %g", i, elementTime(list, i));
     }
     messageClose(LOG_NLS_EXTRAPOLATE);
   }
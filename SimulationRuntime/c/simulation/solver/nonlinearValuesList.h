@@ -37,38 +37,36 @@
 #ifndef _OMC_VALUE_LIST_H
 #define _OMC_VALUE_LIST_H
 
-#include "util/list.h"
+/* maximal number of stored solutions of one system */
+#define VALUES_LIST_CAPACITY 8
 
+/* Solutions of a non-linear system of previous steps in a ring buffer,
+ * ordered from the newest (index 0) to the oldest element. All solutions
+ * are stored in one block, adding a solution does not allocate memory. */
 typedef struct VALUES_LIST
 {
-  LIST* valueList;
+  unsigned int size;       /* number of values of one solution */
+  unsigned int capacity;   /* maximal number of stored solutions */
+  unsigned int length;     /* number of stored solutions */
+  unsigned int first;      /* ring position of the newest solution */
+  int order;               /* order of the extrapolation polynomial: 0, 1 or 2 */
+  double *time;            /* capacity time points */
+  double *values;          /* capacity*size values */
 } VALUES_LIST;
 
-typedef struct VALUE
-{
-  double time;
-  unsigned int size;
-  double *values;
-} VALUE;
-
 
-VALUES_LIST *allocValueList(const unsigned int numberOfLists);
-void freeValueList(VALUES_LIST *valueList, unsigned int numberOfLists);
+VALUES_LIST *allocValueList(unsigned int size, int order);
+void freeValueList(VALUES_LIST *valueList);
 
-VALUE* createValueElement(unsigned int size, double time, double* values);
-void freeValue(VALUE* elem);
-void cleanValueList(VALUES_LIST *valueListm, LIST_NODE* next);
+void cleanValueList(VALUES_LIST *valueList);
 void cleanValueListbyTime(VALUES_LIST *valueList, double time);
-void removeNodes(LIST* list, LIST_NODE *node);
 
-void addListElement(VALUES_LIST* valueList, VALUE* elem);
+void addListElement(VALUES_LIST* valueList, double time, const double* values);
 void getValues(VALUES_LIST* valueList, double time, double* values, double* oldOutput);
 
-void printValueElement(VALUE* elem);
+void printValueElement(VALUES_LIST* valueList, unsigned int index);
 void printValuesListTimes(VALUES_LIST* list);
 
 
 
 #endif
-
-
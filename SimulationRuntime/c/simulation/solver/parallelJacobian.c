@@ -0,0 +1,588 @@
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-2018, Open Source Modelica Consortium (OSMC),
+ * c/o Linköpings universitet, Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF THE BSD NEW LICENSE OR THE
+ * GPL VERSION 3 LICENSE OR THE OSMC PUBLIC LICENSE (OSMC-PL) VERSION 1.2.
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES
+ * RECIPIENT'S ACCEPTANCE OF THE OSMC PUBLIC LICENSE OR THE GPL VERSION 3,
+ * ACCORDING TO RECIPIENTS CHOICE.
+ *
+ * The OpenModelica software and the OSMC (Open Source Modelica Consortium)
+ * Public License (OSMC-PL) are obtained from OSMC, either from the above
+ * address, from the URLs: http://www.openmodelica.org or
+ * http://www.ida.liu.se/projects/OpenModelica, and in the OpenModelica
+ * distribution. GNU version 3 is obtained from:
+ * http://www.gnu.org/copyleft/gpl.html. The New BSD License is obtained from:
+ * http://www.opensource.org/licenses/BSD-3-Clause.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, EXCEPT AS
+ * EXPRESSLY SET FORTH IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE
+ * CONDITIONS OF OSMC-PL.
+ *
+ */
+
+/*! \file parallelJacobian.c
+ */
+
+#include <string.h>
+#include <setjmp.h>
+#include <stdlib.h>
+
+#include "openmodelica.h"
+#include "openmodelica_func.h"
+#include "simulation_data.h"
+
+#include "util/omc_error.h"
+#include "util/omc_init.h"
+#include "gc/omc_gc.h"
+#include "meta/meta_modelica.h"
+
+#include "simulation/options.h"
+#include "simulation/solver/model_help.h"
+#include "simulation/solver/linearSystem.h"
+#include "simulation/solver/nonlinearSystem.h"
+#include "simulation/solver/mixedSystem.h"
+#include "simulation/solver/parallelJacobian.h"
+
+/*! \fn getJacobianThreads
+ *
+ *  \return number of threads for the colored jacobian, 1 if not specified
+ */
+int getJacobianThreads(void)
+{
+  int nThreads = 1;
+  if (omc_flag[FLAG_JACOBIAN_THREADS])
+  {
+    nThreads = atoi(omc_flagValue[FLAG_JACOBIAN_THREADS]);
+    if (nThreads < 1)
+    {
+      warningStreamPrint(LOG_STDOUT, 0, "invalid number of jacobian threads %s, use 1 instead", omc_flagValue[FLAG_JACOBIAN_THREADS]);
+      nThreads = 1;
+    }
+  }
+#if defined(OMC_NO_THREADS)
+  nThreads = 1;
+#endif
+  return nThreads;
+}
+
+/*! \fn initializeColorColumns
+ *
+ *  Groups the columns by color, so that the columns of a color can be
+ *  perturbed without a search over all columns.
+ */
+static void initializeColorColumns(PARALLEL_JACOBIAN *parJac, SPARSE_PATTERN *sparsePattern, threadData_t *threadData)
+{
+  unsigned int i, color;
+  unsigned int *next;
+
+  parJac->maxColors = sparsePattern->maxColors;
+  parJac->colorPtr = (unsigned int*) calloc(parJac->maxColors + 1, sizeof(unsigned int));
+  parJac->colorColumns = (unsigned int*) malloc((parJac->nCols > 0 ? parJac->nCols : 1) * sizeof(unsigned int));
+  next = (unsigned int*) malloc((parJac->maxColors + 1) * sizeof(unsigned int));
+  assertStreamPrint(threadData, 0 != parJac->colorPtr && 0 != parJac->colorColumns && 0 != next, "out of memory");
+
+  for(i = 0; i < parJac->nCols; i++)
+  {
+    color = sparsePattern->colorCols[i] - 1;
+    assertStreamPrint(threadData, color < parJac->maxColors, "invalid color %u of column %u", color + 1, i);
+    parJac->colorPtr[color + 1]++;
+  }
+  for(color = 0; color < parJac->maxColors; color++)
+  {
+    parJac->colorPtr[color + 1] += parJac->colorPtr[color];
+  }
+
+  memcpy(next, parJac->colorPtr, (parJac->maxColors + 1) * sizeof(unsigned int));
+  for(i = 0; i < parJac->nCols; i++)
+  {
+    color = sparsePattern->colorCols[i] - 1;
+    parJac->colorColumns[next[color]++] = i;
+  }
+  free(next);
+}
+
+#if !defined(OMC_NO_THREADS)
+/*! \fn initializeWorkerData
+ *
+ *  Sets up the private copy of the data of one worker. All arrays that are
+ *  written during the evaluation of the residual get their own memory, the
+ *  algebraic loops are initialized like the ones of the main data.
+ */
+static void initializeWorkerData(JACOBIAN_WORKER *worker, DATA *data, threadData_t *threadData)
+{
+  MODEL_DATA *modelData = data->modelData;
+  SIMULATION_INFO *simInfo = &worker->simulationInfo;
+  int streams[SIM_LOG_MAX];
+
+  worker->dataCopy = *data;
+  worker->dataCopy.simulationInfo = simInfo;
+  memcpy(simInfo, data->simulationInfo, sizeof(SIMULATION_INFO));
+  simInfo->nlsCsvInfomation = 0;
+
+  /* variables of the current time */
+  worker->localData = (SIMULATION_DATA**) malloc(SIZERINGBUFFER * sizeof(SIMULATION_DATA*));
+  memcpy(worker->localData, data->localData, SIZERINGBUFFER * sizeof(SIMULATION_DATA*));
+  worker->currentData = *data->localData[0];
+  worker->currentData.realVars = (modelica_real*) calloc(modelData->nVariablesReal, sizeof(modelica_real));
+  worker->currentData.integerVars = (modelica_integer*) calloc(modelData->nVariablesInteger, sizeof(modelica_integer));
+  worker->currentData.booleanVars = (modelica_boolean*) calloc(modelData->nVariablesBoolean, sizeof(modelica_boolean));
+  worker->localData[0] = &worker->currentData;
+  worker->dataCopy.localData = worker->localData;
+
+  worker->inputVars = (modelica_real*) calloc(modelData->nInputVars, sizeof(modelica_real));
+  simInfo->inputVars = worker->inputVars;
+
+  /* daeMode residuals */
+  worker->daeModeData = *data->simulationInfo->daeModeData;
+  worker->daeModeData.residualVars = (modelica_real*) calloc(worker->daeModeData.nResidualVars, sizeof(modelica_real));
+  worker->daeModeData.auxiliaryVars = (modelica_real*) calloc(worker->daeModeData.nAuxiliaryVars, sizeof(modelica_real));
+  simInfo->daeModeData = &worker->daeModeData;
+
+  /* algebraic loops and their jacobians */
+  worker->analyticJacobians = (ANALYTIC_JACOBIAN*) calloc(modelData->nJacobians, sizeof(ANALYTIC_JACOBIAN));
+  simInfo->analyticJacobians = worker->analyticJacobians;
+  worker->mixedSystemData = NULL;
+  worker->linearSystemData = NULL;
+  worker->nonlinearSystemData = NULL;
+  if (modelData->nMixedSystems)
+  {
+    worker->mixedSystemData = (MIXED_SYSTEM_DATA*) omc_alloc_interface.malloc_uncollectable(modelData->nMixedSystems*sizeof(MIXED_SYSTEM_DATA));
+    data->callback->initialMixedSystem(modelData->nMixedSystems, worker->mixedSystemData);
+  }
+  if (modelData->nLinearSystems)
+  {
+    worker->linearSystemData = (LINEAR_SYSTEM_DATA*) omc_alloc_interface.malloc_uncollectable(modelData->nLinearSystems*sizeof(LINEAR_SYSTEM_DATA));
+    data->callback->initialLinearSystem(modelData->nLinearSystems, worker->linearSystemData);
+  }
+  if (modelData->nNonLinearSystems)
+  {
+    worker->nonlinearSystemData = (NONLINEAR_SYSTEM_DATA*) omc_alloc_interface.malloc_uncollectable(modelData->nNonLinearSystems*sizeof(NONLINEAR_SYSTEM_DATA));
+    data->callback->initialNonLinearSystem(modelData->nNonLinearSystems, worker->nonlinearSystemData);
+  }
+  simInfo->mixedSystemData = worker->mixedSystemData;
+  simInfo->linearSystemData = worker->linearSystemData;
+  simInfo->nonlinearSystemData = worker->nonlinearSystemData;
+
+  worker->threadDataCopy = *threadData;
+  worker->threadDataCopy.parent = threadData;
+
+  /* the solver setup was already reported for the main data */
+  memcpy(streams, useStream, sizeof(streams));
+  memset(useStream, 0, sizeof(streams));
+  initializeMixedSystems(&worker->dataCopy, &worker->threadDataCopy);
+  initializeLinearSystems(&worker->dataCopy, &worker->threadDataCopy);
+  initializeNonlinearSystems(&worker->dataCopy, &worker->threadDataCopy);
+  memcpy(useStream, streams, sizeof(streams));
+
+  worker->data = &worker->dataCopy;
+  worker->threadData = &worker->threadDataCopy;
+}
+
+static void freeWorkerData(JACOBIAN_WORKER *worker)
+{
+  DATA *data = &worker->dataCopy;
+  threadData_t *threadData = &worker->threadDataCopy;
+
+  freeMixedSystems(data, threadData);
+  freeLinearSystems(data, threadData);
+  freeNonlinearSystems(data, threadData);
+  if (worker->mixedSystemData)
+    omc_alloc_interface.free_uncollectable(worker->mixedSystemData);
+  if (worker->linearSystemData)
+    omc_alloc_interface.free_uncollectable(worker->linearSystemData);
+  if (worker->nonlinearSystemData)
+    omc_alloc_interface.free_uncollectable(worker->nonlinearSystemData);
+  free(worker->analyticJacobians);
+
+  free(worker->daeModeData.residualVars);
+  free(worker->daeModeData.auxiliaryVars);
+  free(worker->inputVars);
+  free(worker->currentData.realVars);
+  free(worker->currentData.integerVars);
+  free(worker->currentData.booleanVars);
+  free(worker->localData);
+}
+
+/*! \fn synchronizeWorkerData
+ *
+ *  Copies the current state of the main data to the private copy of a worker.
+ */
+static void synchronizeWorkerData(JACOBIAN_WORKER *worker, DATA *data)
+{
+  MODEL_DATA *modelData = data->modelData;
+  SIMULATION_INFO *simInfo = &worker->simulationInfo;
+  long i;
+
+  memcpy(simInfo, data->simulationInfo, sizeof(SIMULATION_INFO));
+  simInfo->nlsCsvInfomation = 0;
+  simInfo->inputVars = worker->inputVars;
+  simInfo->daeModeData = &worker->daeModeData;
+  simInfo->analyticJacobians = worker->analyticJacobians;
+  simInfo->mixedSystemData = worker->mixedSystemData;
+  simInfo->linearSystemData = worker->linearSystemData;
+  simInfo->nonlinearSystemData = worker->nonlinearSystemData;
+  memcpy(worker->inputVars, data->simulationInfo->inputVars, modelData->nInputVars * sizeof(modelica_real));
+
+  /* the ring buffer is rotated after every step */
+  memcpy(worker->localData, data->localData, SIZERINGBUFFER * sizeof(SIMULATION_DATA*));
+  worker->localData[0] = &worker->currentData;
+  worker->currentData.timeValue = data->localData[0]->timeValue;
+  worker->currentData.stringVars = data->localData[0]->stringVars;
+  worker->currentData.inlineVars = data->localData[0]->inlineVars;
+  memcpy(worker->currentData.realVars, data->localData[0]->realVars, modelData->nVariablesReal * sizeof(modelica_real));
+  memcpy(worker->currentData.integerVars, data->localData[0]->integerVars, modelData->nVariablesInteger * sizeof(modelica_integer));
+  memcpy(worker->currentData.booleanVars, data->localData[0]->booleanVars, modelData->nVariablesBoolean * sizeof(modelica_boolean));
+
+  /* start values of the algebraic loops */
+  for(i = 0; i < modelData->nNonLinearSystems; i++)
+  {
+    NONLINEAR_SYSTEM_DATA *mainSystem = &data->simulationInfo->nonlinearSystemData[i];
+    NONLINEAR_SYSTEM_DATA *system = &worker->nonlinearSystemData[i];
+    memcpy(system->nlsx, mainSystem->nlsx, system->size * sizeof(double));
+    memcpy(system->nlsxOld, mainSystem->nlsxOld, system->size * sizeof(double));
+    memcpy(system->nlsxExtrapolation, mainSystem->nlsxExtrapolation, system->size * sizeof(double));
+    system->lastTimeSolved = mainSystem->lastTimeSolved;
+  }
+}
+#endif
+
+/*! \fn evaluateWorkerColors
+ *
+ *  Evaluates the colors of one worker, the colors are distributed cyclic.
+ */
+static void evaluateWorkerColors(JACOBIAN_WORKER *worker)
+{
+  PARALLEL_JACOBIAN *parJac = worker->parent;
+  threadData_t *threadData = worker->threadData;
+  unsigned int color;
+  int saveJumpState = threadData->currentErrorStage;
+
+  worker->failed = 1;
+  threadData->currentErrorStage = ERROR_INTEGRATOR;
+
+  /* try */
+  MMC_TRY_INTERNAL(simulationJumpBuffer)
+  MMC_TRY_INTERNAL(globalJumpBuffer)
+
+  for(color = worker->id; color < parJac->maxColors; color += parJac->nWorkers)
+  {
+    worker->data->simulationInfo->currentJacobianEval = color;
+    if (parJac->evalColor(worker, color, parJac->userData))
+    {
+      break;
+    }
+  }
+  worker->failed = (color < parJac->maxColors);
+
+  MMC_CATCH_INTERNAL(globalJumpBuffer)
+  MMC_CATCH_INTERNAL(simulationJumpBuffer)
+
+  threadData->currentErrorStage = saveJumpState;
+}
+
+#if !defined(OMC_NO_THREADS)
+/*! \fn jacobianWorkerThread
+ *
+ *  Thread of one worker, it evaluates the colors of the worker whenever a new
+ *  evaluation is started and exits when the jacobian is freed.
+ */
+static void* jacobianWorkerThread(void *arg)
+{
+  JACOBIAN_WORKER *worker = (JACOBIAN_WORKER*) arg;
+  PARALLEL_JACOBIAN *parJac = worker->parent;
+  threadData_t *threadData = worker->threadData;
+  unsigned long generation = 0;
+
+  pthread_setspecific(mmc_thread_data_key, threadData);
+  mmc_init_stackoverflow(threadData);
+  threadData->mmc_thread_work_exit = NULL;
+
+  pthread_mutex_lock(&parJac->mutex);
+  while (1)
+  {
+    while (generation == parJac->generation && !parJac->shutdown)
+    {
+      pthread_cond_wait(&parJac->start, &parJac->mutex);
+    }
+    if (parJac->shutdown)
+    {
+      break;
+    }
+    generation = parJac->generation;
+    pthread_mutex_unlock(&parJac->mutex);
+
+    worker->failed = 1;
+    MMC_TRY_INTERNAL(mmc_jumper)
+    threadData->mmc_stack_overflow_jumper = threadData->mmc_jumper;
+    evaluateWorkerColors(worker);
+    MMC_CATCH_INTERNAL(mmc_jumper)
+    /* the temporaries of the evaluation are not used anymore */
+    omc_alloc_interface.collect_a_little();
+
+    pthread_mutex_lock(&parJac->mutex);
+    if (0 == --parJac->running)
+    {
+      pthread_cond_signal(&parJac->finished);
+    }
+  }
+  pthread_mutex_unlock(&parJac->mutex);
+
+  return NULL;
+}
+
+/*! \fn startWorkerThreads
+ *
+ *  Starts the threads of the workers 1 ... nWorkers-1. The colors of a worker
+ *  without thread are evaluated by the calling thread.
+ */
+static void startWorkerThreads(PARALLEL_JACOBIAN *parJac)
+{
+  int i;
+
+  pthread_mutex_init(&parJac->mutex, NULL);
+  pthread_cond_init(&parJac->start, NULL);
+  pthread_cond_init(&parJac->finished, NULL);
+  parJac->generation = 0;
+  parJac->running = 0;
+  parJac->shutdown = 0;
+
+  for(i = 1; i < parJac->nWorkers; i++)
+  {
+    JACOBIAN_WORKER *worker = &parJac->workers[i];
+#if defined(OMC_MINIMAL_RUNTIME) || defined(OMC_FMI_RUNTIME)
+    worker->started = (0 == pthread_create(&worker->thread, NULL, jacobianWorkerThread, worker));
+#else
+    worker->started = (0 == GC_pthread_create(&worker->thread, NULL, jacobianWorkerThread, worker));
+#endif
+    if (!worker->started)
+    {
+      warningStreamPrint(LOG_SOLVER, 0, "could not start jacobian thread %d", i);
+    }
+  }
+}
+
+static void stopWorkerThreads(PARALLEL_JACOBIAN *parJac)
+{
+  int i;
+
+  pthread_mutex_lock(&parJac->mutex);
+  parJac->shutdown = 1;
+  pthread_cond_broadcast(&parJac->start);
+  pthread_mutex_unlock(&parJac->mutex);
+
+  for(i = 1; i < parJac->nWorkers; i++)
+  {
+    JACOBIAN_WORKER *worker = &parJac->workers[i];
+    if (worker->started)
+    {
+#if defined(OMC_MINIMAL_RUNTIME) || defined(OMC_FMI_RUNTIME)
+      pthread_join(worker->thread, NULL);
+#else
+      GC_pthread_join(worker->thread, NULL);
+#endif
+      worker->started = 0;
+    }
+  }
+
+  pthread_cond_destroy(&parJac->finished);
+  pthread_cond_destroy(&parJac->start);
+  pthread_mutex_destroy(&parJac->mutex);
+}
+#endif
+
+/*! \fn allocateParallelJacobian
+ *
+ *  \param [in]  [sparsePattern] pattern with coloring of the jacobian
+ *  \param [in]  [nCols] number of columns of the jacobian
+ *  \param [in]  [nThreads] number of threads, the calling thread included
+ *  \param [in]  [workSize] size of the private workspace of each worker
+ */
+PARALLEL_JACOBIAN* allocateParallelJacobian(DATA *data, threadData_t *threadData, SPARSE_PATTERN *sparsePattern, unsigned int nCols, int nThreads, size_t workSize)
+{
+  PARALLEL_JACOBIAN *parJac = (PARALLEL_JACOBIAN*) calloc(1, sizeof(PARALLEL_JACOBIAN));
+  int i;
+
+  assertStreamPrint(threadData, 0 != parJac, "out of memory");
+  parJac->nCols = nCols;
+  initializeColorColumns(parJac, sparsePattern, threadData);
+
+#if defined(OMC_NO_THREADS)
+  nThreads = 1;
+#endif
+  /* external objects are shared and not thread safe */
+  if (nThreads > 1 && data->modelData->nExtObjs > 0)
+  {
+    warningStreamPrint(LOG_STDOUT, 0, "the model has external objects, the colored jacobian is evaluated by one thread");
+    nThreads = 1;
+  }
+  /* more threads than colors are useless */
+  if (nThreads > (int)parJac->maxColors)
+  {
+    nThreads = parJac->maxColors > 0 ? parJac->maxColors : 1;
+  }
+  parJac->nWorkers = nThreads;
+  parJac->workers = (JACOBIAN_WORKER*) calloc(nThreads, sizeof(JACOBIAN_WORKER));
+  assertStreamPrint(threadData, 0 != parJac->workers, "out of memory");
+
+  for(i = 0; i < nThreads; i++)
+  {
+    JACOBIAN_WORKER *worker = &parJac->workers[i];
+    worker->id = i;
+    worker->parent = parJac;
+    worker->work = (double*) calloc(workSize > 0 ? workSize : 1, sizeof(double));
+    assertStreamPrint(threadData, 0 != worker->work, "out of memory");
+    if (i == 0)
+    {
+      worker->data = data;
+      worker->threadData = threadData;
+    }
+#if !defined(OMC_NO_THREADS)
+    else
+    {
+      initializeWorkerData(worker, data, threadData);
+    }
+#endif
+  }
+
+#if !defined(OMC_NO_THREADS)
+  if (nThreads > 1)
+  {
+    startWorkerThreads(parJac);
+    infoStreamPrint(LOG_SOLVER, 0, "colored jacobian with %d colors is evaluated by %d threads", parJac->maxColors, nThreads);
+  }
+#endif
+
+  return parJac;
+}
+
+void freeParallelJacobian(PARALLEL_JACOBIAN *parJac)
+{
+  int i;
+
+  if (!parJac)
+    return;
+
+#if !defined(OMC_NO_THREADS)
+  if (parJac->nWorkers > 1)
+  {
+    stopWorkerThreads(parJac);
+  }
+#endif
+  for(i = 0; i < parJac->nWorkers; i++)
+  {
+#if !defined(OMC_NO_THREADS)
+    if (i > 0)
+    {
+      freeWorkerData(&parJac->workers[i]);
+    }
+#endif
+    free(parJac->workers[i].work);
+  }
+  free(parJac->workers);
+  free(parJac->colorPtr);
+  free(parJac->colorColumns);
+  free(parJac);
+}
+
+/*! \fn evaluateParallelJacobian
+ *
+ *  Evaluates all colors of the jacobian. The calling thread works on the
+ *  main data, each additional thread on its synchronized private copy.
+ *  The color function may only write the columns of its color to shared
+ *  arrays.
+ *
+ *  \return 0 on success, 1 if the evaluation of a color failed
+ */
+int evaluateParallelJacobian(PARALLEL_JACOBIAN *parJac, DATA *data, threadData_t *threadData, jacobianColorFunction evalColor, void *userData)
+{
+  int i, failed = 0;
+#if !defined(OMC_NO_THREADS)
+  int nStarted = 0;
+#endif
+
+  parJac->evalColor = evalColor;
+  parJac->userData = userData;
+  parJac->workers[0].data = data;
+  parJac->workers[0].threadData = threadData;
+
+#if !defined(OMC_NO_THREADS)
+  if (parJac->nWorkers > 1)
+  {
+    /* the threads are idle, their data can be updated without lock */
+    for(i = 1; i < parJac->nWorkers; i++)
+    {
+      JACOBIAN_WORKER *worker = &parJac->workers[i];
+      synchronizeWorkerData(worker, data);
+      nStarted += worker->started;
+    }
+    pthread_mutex_lock(&parJac->mutex);
+    parJac->running = nStarted;
+    parJac->generation++;
+    pthread_cond_broadcast(&parJac->start);
+    pthread_mutex_unlock(&parJac->mutex);
+  }
+#endif
+
+  evaluateWorkerColors(&parJac->workers[0]);
+  failed = parJac->workers[0].failed;
+
+#if !defined(OMC_NO_THREADS)
+  if (parJac->nWorkers > 1)
+  {
+    /* colors of workers without thread */
+    for(i = 1; i < parJac->nWorkers; i++)
+    {
+      if (!parJac->workers[i].started)
+      {
+        evaluateWorkerColors(&parJac->workers[i]);
+      }
+    }
+
+    pthread_mutex_lock(&parJac->mutex);
+    while (parJac->running > 0)
+    {
+      pthread_cond_wait(&parJac->finished, &parJac->mutex);
+    }
+    pthread_mutex_unlock(&parJac->mutex);
+
+    for(i = 1; i < parJac->nWorkers; i++)
+    {
+      failed = failed || parJac->workers[i].failed;
+    }
+  }
+#endif
+
+  return failed;
+}
+
+/*! \fn evaluateSerialJacobian
+ *
+ *  Evaluates all colors of the jacobian with the main data in the calling
+ *  thread, like a jacobian with one thread.
+ *
+ *  \return 0 on success, 1 if the evaluation of a color failed
+ */
+int evaluateSerialJacobian(PARALLEL_JACOBIAN *parJac, DATA *data, threadData_t *threadData, jacobianColorFunction evalColor, void *userData)
+{
+  int nWorkers = parJac->nWorkers;
+
+  parJac->evalColor = evalColor;
+  parJac->userData = userData;
+  parJac->workers[0].data = data;
+  parJac->workers[0].threadData = threadData;
+
+  /* worker 0 evaluates every color */
+  parJac->nWorkers = 1;
+  evaluateWorkerColors(&parJac->workers[0]);
+  parJac->nWorkers = nWorkers;
+
+  return parJac->workers[0].failed;
+}
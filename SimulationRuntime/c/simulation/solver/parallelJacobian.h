@@ -0,0 +1,140 @@
+/*
+ * This file is part of OpenModelica.
+ *
+ * Copyright (c) 1998-2018, Open Source Modelica Consortium (OSMC),
+ * c/o Linköpings universitet, Department of Computer and Information Science,
+ * SE-58183 Linköping, Sweden.
+ *
+ * All rights reserved.
+ *
+ * THIS PROGRAM IS PROVIDED UNDER THE TERMS OF THE BSD NEW LICENSE OR THE
+ * GPL VERSION 3 LICENSE OR THE OSMC PUBLIC LICENSE (OSMC-PL) VERSION 1.2.
+ * ANY USE, REPRODUCTION OR DISTRIBUTION OF THIS PROGRAM CONSTITUTES
+ * RECIPIENT'S ACCEPTANCE OF THE OSMC PUBLIC LICENSE OR THE GPL VERSION 3,
+ * ACCORDING TO RECIPIENTS CHOICE.
+ *
+ * The OpenModelica software and the OSMC (Open Source Modelica Consortium)
+ * Public License (OSMC-PL) are obtained from OSMC, either from the above
+ * address, from the URLs: http://www.openmodelica.org or
+ * http://www.ida.liu.se/projects/OpenModelica, and in the OpenModelica
+ * distribution. GNU version 3 is obtained from:
+ * http://www.gnu.org/copyleft/gpl.html. The New BSD License is obtained from:
+ * http://www.opensource.org/licenses/BSD-3-Clause.
+ *
+ * This program is distributed WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE, EXCEPT AS
+ * EXPRESSLY SET FORTH IN THE BY RECIPIENT SELECTED SUBSIDIARY LICENSE
+ * CONDITIONS OF OSMC-PL.
+ *
+ */
+
+/*! \file parallelJacobian.h
+ *
+ * Colored finite difference jacobians of the integrators (dassl, ida) with
+ * per color column lists. The colors can be evaluated concurrently, every
+ * additional thread works on a private copy of the data that is written
+ * while the residual is evaluated (variables, algebraic loops, daeMode
+ * residuals, jump buffers). Static model data and parameters are shared.
+ * The additional threads are started once with the jacobian and wait for
+ * the next evaluation until the jacobian is freed.
+ *
+ * External objects are shared by all copies and may keep internal state
+ * (e.g. the last interval of a table), models with external objects are
+ * therefore always evaluated by the calling thread only.
+ */
+
+#ifndef PARALLEL_JACOBIAN_H
+#define PARALLEL_JACOBIAN_H
+
+#include "simulation_data.h"
+
+#if !defined(OMC_NO_THREADS)
+#include <pthread.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* one thread of the jacobian evaluation, worker 0 is the calling thread and uses the main data */
+typedef struct JACOBIAN_WORKER
+{
+  int id;
+  DATA *data;                          /* data used by this worker */
+  threadData_t *threadData;
+  double *work;                        /* private workspace of the solver */
+  void *solverData;                    /* private solver data, allocated and freed by the solver */
+  int failed;                          /* =1 if the evaluation of a color failed */
+#if !defined(OMC_NO_THREADS)
+  pthread_t thread;
+  int started;                         /* =1 if the thread of the worker is running (worker > 0) */
+#endif
+
+  /* private copy of the data (worker > 0) */
+  DATA dataCopy;
+  SIMULATION_INFO simulationInfo;
+  SIMULATION_DATA **localData;
+  SIMULATION_DATA currentData;
+  threadData_t threadDataCopy;
+  DAEMODE_DATA daeModeData;
+  ANALYTIC_JACOBIAN *analyticJacobians;
+  LINEAR_SYSTEM_DATA *linearSystemData;
+  NONLINEAR_SYSTEM_DATA *nonlinearSystemData;
+  MIXED_SYSTEM_DATA *mixedSystemData;
+  modelica_real *inputVars;
+
+  struct PARALLEL_JACOBIAN *parent;
+} JACOBIAN_WORKER;
+
+/* evaluates all columns of one color with the data of the worker, returns 0 on success */
+typedef int (*jacobianColorFunction)(JACOBIAN_WORKER *worker, unsigned int color, void *userData);
+
+typedef struct PARALLEL_JACOBIAN
+{
+  unsigned int nCols;
+  unsigned int maxColors;
+  unsigned int *colorPtr;              /* columns of color i are colorColumns[colorPtr[i]] ... colorColumns[colorPtr[i+1]-1] */
+  unsigned int *colorColumns;
+
+  int nWorkers;
+  JACOBIAN_WORKER *workers;
+
+#if !defined(OMC_NO_THREADS)
+  /* synchronization of the persistent worker threads */
+  pthread_mutex_t mutex;
+  pthread_cond_t start;                /* a new evaluation was started or the threads shall exit */
+  pthread_cond_t finished;             /* all threads finished the current evaluation */
+  unsigned long generation;            /* number of the current evaluation */
+  int running;                         /* threads that have not finished the current evaluation */
+  int shutdown;
+#endif
+
+  /* current evaluation */
+  jacobianColorFunction evalColor;
+  void *userData;
+} PARALLEL_JACOBIAN;
+
+/* number of threads requested by -jacobianThreads */
+int getJacobianThreads(void);
+
+PARALLEL_JACOBIAN* allocateParallelJacobian(DATA *data, threadData_t *threadData, SPARSE_PATTERN *sparsePattern, unsigned int nCols, int nThreads, size_t workSize);
+void freeParallelJacobian(PARALLEL_JACOBIAN *parJac);
+
+/* columns of the given color */
+static inline const unsigned int* getColorColumns(PARALLEL_JACOBIAN *parJac, unsigned int color, unsigned int *nColumns)
+{
+  *nColumns = parJac->colorPtr[color+1] - parJac->colorPtr[color];
+  return parJac->colorColumns + parJac->colorPtr[color];
+}
+
+/* evaluates all colors, distributed over the workers; returns 0 on success */
+int evaluateParallelJacobian(PARALLEL_JACOBIAN *parJac, DATA *data, threadData_t *threadData, jacobianColorFunction evalColor, void *userData);
+
+/* evaluates all colors in the calling thread, e.g. to verify the parallel evaluation; returns 0 on success */
+int evaluateSerialJacobian(PARALLEL_JACOBIAN *parJac, DATA *data, threadData_t *threadData, jacobianColorFunction evalColor, void *userData);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -59,7 +59,21 @@ static modelica_integer deltaQ( DATA* data,const modelica_real dQ, const modelic
 static modelica_integer getDerWithStateK(const unsigned int *index, const unsigned int* leadindex, modelica_integer* der, uinteger* numDer, const uinteger k);
 static modelica_integer getStatesInDer(const unsigned int* index, const unsigned int* leadindex, const uinteger ROWS, const uinteger STATES, uinteger** StatesInDer);
 static modelica_integer qss_step(DATA* data, SOLVER_INFO* solverInfo);
-static uinteger minStep( const modelica_real* tqp, const uinteger size );
+
+/*! struct QSS_HEAP
+ * \brief  Indexed binary min-heap of the states, ordered by the time of the next change tqp.
+ */
+typedef struct QSS_HEAP
+{
+  const modelica_real* tqp;  /*!< Time of the next change of every state, the keys of the heap. */
+  uinteger* heap;            /*!< State indices, heap[0] is the state which will change first. */
+  uinteger* pos;             /*!< Position of every state in heap. */
+  uinteger size;
+} QSS_HEAP;
+
+static void heapInit(QSS_HEAP* h, const modelica_real* tqp, uinteger* heap, uinteger* pos, const uinteger size);
+static void heapUpdate(QSS_HEAP* h, const uinteger state);
+static uinteger minStep(const QSS_HEAP* h);
 
 /*! performQSSSimulation(DATA* data, SOLVER_INFO* solverInfo)
  *
@@ -88,6 +102,8 @@ int prefixedName_performQSSSimulation(DATA* data, threadData_t *threadData, SOLV
   uinteger numDer = 0;
   modelica_boolean fail = 0;
   modelica_real *qik, *xik, *derXik, *tq, *tx, *tqp, *nQh, *dQ;
+  uinteger *heapWork = NULL;
+  QSS_HEAP tqpHeap;
   modelica_real diffQ = 0.0, dTnextQ = 0.0, nextQ = 0.0;
   modelica_integer* der = NULL;
   const int index = data->callback->INDEX_JAC_A;
@@ -128,27 +144,29 @@ int prefixedName_performQSSSimulation(DATA* data, threadData_t *threadData, SOLV
   nQh = NULL;    /* next value of the state */
   dQ = NULL;    /* change in quantity of every state, default = nominal*10^-4 */
 
-  /* allocate memory*/
-  qik = (modelica_real*)calloc(STATES, sizeof(modelica_real));
+  /* allocate memory, all work arrays are allocated once for the whole simulation */
+  qik = (modelica_real*)calloc(8*STATES, sizeof(modelica_real));
   fail = (qik == NULL) ? 1 : ( 0 | fail);
-  xik = (modelica_real*)calloc(STATES, sizeof(modelica_real));
-  fail = (xik == NULL) ? 1 : ( 0 | fail);
-  derXik = (modelica_real*)calloc(STATES, sizeof(modelica_real));
-  fail = (derXik == NULL) ? 1 : ( 0 | fail);
-  tq = (modelica_real*)calloc(STATES, sizeof(modelica_real));
-  fail = (tq == NULL) ? 1 : ( 0 | fail);
-  tx = (modelica_real*)calloc(STATES, sizeof(modelica_real));
-  fail = (tx == NULL) ? 1 : ( 0 | fail);
-  tqp = (modelica_real*)calloc(STATES, sizeof(modelica_real));
-  fail = (tqp == NULL) ? 1 : ( 0 | fail);
-  nQh = (modelica_real*)calloc(STATES, sizeof(modelica_real));
-  fail = (nQh == NULL) ? 1 : ( 0 | fail);
-  dQ = (modelica_real*)calloc(STATES, sizeof(modelica_real));
-  fail = (dQ == NULL) ? 1 : ( 0 | fail);
-
+  heapWork = (uinteger*)calloc(2*STATES, sizeof(uinteger));
+  fail = (heapWork == NULL) ? 1 : ( 0 | fail);
+  der = (modelica_integer*)calloc(ROWS, sizeof(modelica_integer));
+  fail = (der == NULL) ? 1 : ( 0 | fail);
 
   if (fail)
+  {
+    free(qik);
+    free(heapWork);
+    free(der);
     return OO_MEMORY;
+  }
+
+  xik = qik + STATES;
+  derXik = xik + STATES;
+  tq = derXik + STATES;
+  tx = tq + STATES;
+  tqp = tx + STATES;
+  nQh = tqp + STATES;
+  dQ = nQh + STATES;
   /* end - allocate memory */
 
   /* further initialization of local variables */
@@ -168,10 +186,10 @@ int prefixedName_performQSSSimulation(DATA* data, threadData_t *threadData, SOLV
     nQh[i] = nextQ;
   }
 
+  /* next change times of all states, only the entries of changed states are updated */
+  heapInit(&tqpHeap, tqp, heapWork, heapWork + STATES, STATES);
+
 /* Transform the sparsity pattern into a data structure for an index based access. */
-  der = (modelica_integer*)calloc(ROWS, sizeof(modelica_integer));
-  if (NULL==der)
-    return OO_MEMORY;
   for (i = 0; i < ROWS; i++)
     der[i] = -1;
 
@@ -243,14 +261,15 @@ int prefixedName_performQSSSimulation(DATA* data, threadData_t *threadData, SOLV
 
     currStepNo++;
 
-    ind = minStep(tqp, STATES);
+    ind = minStep(&tqpHeap);
 
     if (isnan(tqp[ind]))
     {
 #ifdef D
       fprintf(fid,"Exit caused by #QNAN!\tind=%d",ind);
 #endif
-      return ISNAN;
+      retValue = ISNAN;
+      break;
     }
     if (isinf(tqp[ind]))
     {
@@ -284,14 +303,13 @@ int prefixedName_performQSSSimulation(DATA* data, threadData_t *threadData, SOLV
       return retValue;
     tqp[ind] = tq[ind] + dTnextQ;
     nQh[ind] = nextQ;
+    heapUpdate(&tqpHeap, ind);
 
     if (0 != strcmp("ia", data->simulationInfo->outputFormat)) {
       communicateStatus("Running", (solverInfo->currentTime-simInfo->startTime)/(simInfo->stopTime-simInfo->startTime), solverInfo->currentTime, 0.0);
     }
 
-    /* get the derivatives depending on state[ind] */
-    for (i = 0; i < ROWS; i++)
-      der[i] = -1;
+    /* get the derivatives depending on state[ind], only the first numDer entries of der are used */
     retValue = getDerWithStateK(pattern->index, pattern->leadindex, der, &numDer, ind);
 
     k = 0, j = 0;
@@ -309,12 +327,14 @@ int prefixedName_performQSSSimulation(DATA* data, threadData_t *threadData, SOLV
     /*
      * Recalculate all equations which are affected by state[ind].
      * Unfortunately all equations will be calculated up to now. And we need to evaluate
-     * the equations as f(t,q) and not f(t,x). So all states were saved onto a local stack
-     * and overwritten by q. After evaluating the equations the states are written back.
+     * the equations as f(t,q) and not f(t,x). So all states are overwritten by q and
+     * written back after evaluating the equations. Outside of this evaluation state and
+     * xik are always equal, so xik already holds the current states.
+     * This, the full evaluation of the equations and the write back of the derivatives
+     * still cost O(STATES) per step, only the search of the next state is O(log(STATES)).
      */
     for (i = 0; i < STATES; i++)
     {
-      xik[i] = state[i];   /* save current state */
       state[i] = qik[i];  /* overwrite current state for dx/dt = f(t,q) */
     }
 
@@ -359,6 +379,7 @@ int prefixedName_performQSSSimulation(DATA* data, threadData_t *threadData, SOLV
         return retValue;
       tqp[j] = solverInfo->currentTime + dTnextQ;
       nQh[j] = nextQ;
+      heapUpdate(&tqpHeap, j);
     }
 
     /*sData->timeValue = solverInfo->currentTime;*/
@@ -437,13 +458,7 @@ int prefixedName_performQSSSimulation(DATA* data, threadData_t *threadData, SOLV
    free(StatesInDer);
    free(numStatesInDer); */
    free(qik);
-   free(xik);
-   free(derXik);
-   free(tq);
-   free(tx);
-   free(tqp);
-   free(nQh);
-   free(dQ);
+   free(heapWork);
    /* end - free memory */
 
   TRACE_POP
@@ -558,30 +573,97 @@ static modelica_integer getStatesInDer(const unsigned int* index, const unsigned
 }
 
 
-/*! static unsigned int minStep(const modelica_real* tqp, const unsigned int size )
- *  \brief  Finds the index of the state which will change first.
- *  \param [in] [tqp]  State[i] will change in time tqp[i].
+/*! static int heapLess(const QSS_HEAP* h, const uinteger a, const uinteger b)
+ *  \brief  Order of the heap, #QNAN is behind all other times.
+ *  \return  [1]  State a changes before state b.
+ */
+static int heapLess(const QSS_HEAP* h, const uinteger a, const uinteger b)
+{
+  const modelica_real ta = h->tqp[a];
+  const modelica_real tb = h->tqp[b];
+  if (isnan(ta))
+    return 0;
+  return isnan(tb) || ta < tb;
+}
+
+/*! static void heapSwap(QSS_HEAP* h, const uinteger i, const uinteger j)
+ *  \brief  Swaps the heap entries i and j and updates the positions of both states.
+ */
+static void heapSwap(QSS_HEAP* h, const uinteger i, const uinteger j)
+{
+  uinteger tmp = h->heap[i];
+  h->heap[i] = h->heap[j];
+  h->heap[j] = tmp;
+  h->pos[h->heap[i]] = i;
+  h->pos[h->heap[j]] = j;
+}
+
+/*! static void heapSiftDown(QSS_HEAP* h, uinteger i)
+ *  \brief  Moves the entry i down until both children change later.
+ */
+static void heapSiftDown(QSS_HEAP* h, uinteger i)
+{
+  uinteger child;
+  while ((child = 2*i + 1) < h->size)
+  {
+    if (child + 1 < h->size && heapLess(h, h->heap[child+1], h->heap[child]))
+      child++;
+    if (!heapLess(h, h->heap[child], h->heap[i]))
+      break;
+    heapSwap(h, i, child);
+    i = child;
+  }
+}
+
+/*! static void heapInit(QSS_HEAP* h, const modelica_real* tqp, uinteger* heap, uinteger* pos, const uinteger size)
+ *  \brief  Builds the heap of all states in O(size).
+ *  \param [out] [h]
+ *  \param [in] [tqp]  State[i] will change in time tqp[i], the array is referenced by the heap.
+ *  \param [ref] [heap]  Work array of size elements.
+ *  \param [ref] [pos]  Work array of size elements.
  *  \param [in] [size]  Number of states.
- *  \return  Index of the state which will change first.
  */
-static uinteger minStep(const modelica_real* tqp, const uinteger size )
+static void heapInit(QSS_HEAP* h, const modelica_real* tqp, uinteger* heap, uinteger* pos, const uinteger size)
 {
-  uinteger i = 0;
-  uinteger ind = i;
-  modelica_real tmin =
-#if defined(_MSC_VER)
-      NAN;
-#else
-      1.0/0.0; /* We can have a QNAN at any index and tqp[i] < QNAN will fail in every case. */
-#endif
+  uinteger i;
+
+  h->tqp = tqp;
+  h->heap = heap;
+  h->pos = pos;
+  h->size = size;
 
   for (i = 0; i < size; i++)
   {
-    if (tqp[i] < tmin && !isnan(tqp[i]))
-    {
-      ind = i;
-      tmin = tqp[i];
-    }
+    heap[i] = i;
+    pos[i] = i;
+  }
+  for (i = size/2; i > 0; i--)
+    heapSiftDown(h, i-1);
+}
+
+/*! static void heapUpdate(QSS_HEAP* h, const uinteger state)
+ *  \brief  Restores the heap order after tqp[state] changed, O(log(size)).
+ *  \param [ref] [h]
+ *  \param [in] [state]  State with a new time of the next change.
+ */
+static void heapUpdate(QSS_HEAP* h, const uinteger state)
+{
+  uinteger i = h->pos[state];
+
+  while (i > 0 && heapLess(h, h->heap[i], h->heap[(i-1)/2]))
+  {
+    heapSwap(h, i, (i-1)/2);
+    i = (i-1)/2;
   }
-  return ind;
+  heapSiftDown(h, i);
+}
+
+/*! static unsigned int minStep(const QSS_HEAP* h)
+ *  \brief  Finds the index of the state which will change first.
+ *  \param [in] [h]  Heap of the times of the next change of all states.
+ *  \return  Index of the state which will change first.
+ */
+static uinteger minStep(const QSS_HEAP* h)
+{
+  return h->heap[0];
 }
@@ -52,6 +52,7 @@
 #include "linearSystem.h"
 #include "sym_solver_ssc.h"
 #include "irksco.h"
+#include "dopri45.h"
 #if !defined(OMC_MINIMAL_RUNTIME)
 #include "simulation/solver/embedded_server.h"
 #include "simulation/solver/real_time_sync.h"
@@ -60,9 +61,6 @@
 
 #include "optimization/OptimizerInterface.h"
 
-/*
- * #include "dopri45.h"
- */
 #include "util/rtclock.h"
 #include "util/omc_error.h"
 #include "simulation/options.h"
@@ -161,6 +159,12 @@ int solver_main_step(DATA* data, threadData_t *threadData, SOLVER_INFO* solverIn
       data->simulationInfo->solverSteps = solverInfo->solverStats[0] + solverInfo->solverStatsTmp[0];
     TRACE_POP
     return retVal;
+  case S_DOPRI45:
+    retVal = dopri45_step(data, threadData, solverInfo);
+    if(omc_flag[FLAG_SOLVER_STEPS])
+      data->simulationInfo->solverSteps = solverInfo->solverStats[0] + solverInfo->solverStatsTmp[0];
+    TRACE_POP
+    return retVal;
   case S_SYM_SOLVER:
     retVal = sym_solver_step(data, threadData, solverInfo);
     if(omc_flag[FLAG_SOLVER_STEPS])
@@ -242,6 +246,11 @@ int initializeSolverData(DATA* data, threadData_t *threadData, SOLVER_INFO* solv
     allocateIrksco(solverInfo, data->modelData->nStates, data->modelData->nZeroCrossings);
     break;
   }
+  case S_DOPRI45:
+  {
+    allocateDopri45(solverInfo, data->modelData->nStates);
+    break;
+  }
   case S_ERKSSC:
   case S_RUNGEKUTTA:
   case S_HEUN:
@@ -381,6 +390,10 @@ int freeSolverData(DATA* data, SOLVER_INFO* solverInfo)
   {
     freeIrksco(solverInfo);
   }
+  else if (solverInfo->solverMethod == S_DOPRI45)
+  {
+    freeDopri45(solverInfo);
+  }
 #if !defined(OMC_MINIMAL_RUNTIME)
   else if(solverInfo->solverMethod == S_DASSL)
   {
@@ -622,7 +622,12 @@ typedef struct SIMULATION_INFO
 
   modelica_real* zeroCrossings;
   modelica_real* zeroCrossingsPre;
-  modelica_real* zeroCrossingsBackup;  /* used by bisection in event.c */
+  modelica_real* zeroCrossingsBackup;  /* used by the root finding in event.c */
+  modelica_real* zeroCrossingsDistance; /* signed distance of zero-crossings which are a single relation (>= 0 if true), NAN otherwise */
+  modelica_real* zeroCrossingsDistancePre;
+  modelica_real* zeroCrossingsDistanceBackup; /* used by the root finding in event.c */
+  modelica_real* eventStatesLeft;      /* work arrays of the root finding in event.c */
+  modelica_real* eventStatesRight;
   modelica_boolean* relations;
   modelica_boolean* relationsPre;
   modelica_boolean* storedRelations;   /* this array contains a copy of relations each time the event iteration starts */
@@ -58,6 +58,7 @@ typedef struct InterpolationTable
   int ipoType;
   int expoType;
   double startTime;
+  size_t lastRow; /* result of the last row search, most lookups hit the same or the next interval */
 } InterpolationTable;
 
 typedef struct InterpolationTable2D
@@ -86,6 +87,7 @@ static InterpolationTable *InterpolationTable_init(double time,double startTime,
 /* InterpolationTable *InterpolationTable_Copy(InterpolationTable *orig); */
 static void InterpolationTable_deinit(InterpolationTable *tpl);
 static double InterpolationTable_interpolate(InterpolationTable *tpl, double time, size_t col);
+static size_t InterpolationTable_findRow(InterpolationTable *tpl, double time, size_t lastIdx);
 static double InterpolationTable_maxTime(InterpolationTable *tpl);
 static double InterpolationTable_minTime(InterpolationTable *tpl);
 static char InterpolationTable_compare(InterpolationTable *tpl, const char* fname, const char* tname, const double* table);
@@ -1095,6 +1097,36 @@ static void InterpolationTable_deinit(InterpolationTable *tpl)
   }
 }
 
+/* index of the first row with a time greater than time, lastIdx if there is none */
+static size_t InterpolationTable_findRow(InterpolationTable *tpl, double time, size_t lastIdx)
+{
+  size_t i = tpl->lastRow;
+  size_t lo = 0, hi = lastIdx, mid;
+
+  /* check the interval of the last call and the next one */
+  if(i > 0 && i < lastIdx && InterpolationTable_getElt(tpl,i-1,0) <= time) {
+    if(InterpolationTable_getElt(tpl,i,0) > time)
+      return i;
+    if(i+1 < lastIdx && InterpolationTable_getElt(tpl,i+1,0) > time) {
+      tpl->lastRow = i+1;
+      return i+1;
+    }
+    lo = i+1;
+  }
+
+  /* binary search */
+  while(lo < hi) {
+    mid = lo + (hi-lo)/2;
+    if(InterpolationTable_getElt(tpl,mid,0) > time)
+      hi = mid;
+    else
+      lo = mid+1;
+  }
+  if(lo < lastIdx)
+    tpl->lastRow = lo;
+  return lo;
+}
+
 static double InterpolationTable_interpolate(InterpolationTable *tpl, double time, size_t col)
 {
   size_t i = 0;
@@ -1112,13 +1144,12 @@ static double InterpolationTable_interpolate(InterpolationTable *tpl, double tim
   if(time < InterpolationTable_minTime(tpl))
     return InterpolationTable_extrapolate(tpl,time,col,time <= InterpolationTable_minTime(tpl));
 
-  for(i = 0; i < lastIdx; ++i) {
-    if(InterpolationTable_getElt(tpl,i,0) > time) {
-      if(tpl->ipoType == 1 || lastIdx==2)
-        return InterpolationTable_interpolateLin(tpl,time, i-1,col);
-      else if(tpl->ipoType == 2){
-        return InterpolationTable_interpolateSpline(tpl,time, i-1,col);
-      }
+  i = InterpolationTable_findRow(tpl,time,lastIdx);
+  if(i < lastIdx) {
+    if(tpl->ipoType == 1 || lastIdx==2)
+      return InterpolationTable_interpolateLin(tpl,time, i-1,col);
+    else if(tpl->ipoType == 2){
+      return InterpolationTable_interpolateSpline(tpl,time, i-1,col);
     }
   }
   return InterpolationTable_extrapolate(tpl,time,col,time <= InterpolationTable_minTime(tpl));
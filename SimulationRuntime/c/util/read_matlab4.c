@@ -35,6 +35,7 @@
 #include <assert.h>
 #include <ctype.h>
 #include "read_matlab4.h"
+#include "omc_mmap.h"
 
 extern const char *omc_mat_Aclass;
 
@@ -54,6 +55,9 @@ typedef struct {
 static const char *binTrans_char = "binTrans";
 static const char *binNormal_char = "binNormal";
 
+/* Number of bytes of the data_2 matrix that is transposed at once by omc_matlab4_read_all_vals */
+#define MAT4_TRANSPOSE_BLOCK_SIZE (256*1024)
+
 /* strcmp ignore whitespace */
 static OMC_INLINE int strcmp_iws(const char *a, const char *b)
 {
@@ -109,6 +113,14 @@ int mat_element_length(int type)
 void omc_free_matlab4_reader(ModelicaMatReader *reader)
 {
   unsigned int i;
+#if HAVE_MMAP
+  if (reader->mapped) {
+    munmap(reader->mapped, reader->mappedSize);
+    reader->mapped = NULL;
+    reader->mappedSize = 0;
+    reader->data_2 = NULL;
+  }
+#endif
   if (reader->file) {
     fclose(reader->file);
     reader->file = 0;
@@ -122,7 +134,7 @@ void omc_free_matlab4_reader(ModelicaMatReader *reader)
     free(reader->allInfo[i].descr);
   }
   reader->nall = 0;
-  if (reader->file) {
+  if (reader->allInfo) {
     free(reader->allInfo);
     reader->allInfo=NULL;
   }
@@ -130,7 +142,7 @@ void omc_free_matlab4_reader(ModelicaMatReader *reader)
     free(reader->params);
     reader->params=NULL;
   }
-  for(i=0; i<reader->nvar*2; i++) {
+  for(i=0; reader->vars && i<reader->nvar*2; i++) {
     if (reader->vars[i]) free(reader->vars[i]);
   }
   reader->nvar = 0;
@@ -214,6 +226,43 @@ static int read_double(int type, size_t n, FILE *file, double *val)
   return 1;
 }
 
+/* Maps the whole file if the data_2 matrix is stored transposed, i.e. one time point after the other.
+ * The variables can then be read directly from the page cache instead of one fseek/fread per value.
+ * Failing to map the file is not an error; the reader falls back to fread. */
+static void map_data_2(ModelicaMatReader *reader)
+{
+#if HAVE_MMAP
+  struct stat s;
+  void *data;
+  size_t elementSize = reader->doublePrecision==1 ? sizeof(double) : sizeof(float);
+  size_t dataSize = (size_t)reader->nrows*reader->nvar*elementSize;
+
+  if (dataSize == 0 || fstat(fileno(reader->file), &s) < 0 || (size_t)s.st_size < reader->var_offset + dataSize) {
+    return;
+  }
+  data = mmap(0, s.st_size, PROT_READ, MAP_SHARED, fileno(reader->file), 0);
+  if (data == MAP_FAILED) {
+    return;
+  }
+  reader->mapped = data;
+  reader->mappedSize = s.st_size;
+  reader->data_2 = (const char*)data + reader->var_offset;
+#endif
+}
+
+/* Value of variable col (0-based) at time point row in the mapped data_2 matrix */
+static OMC_INLINE double mapped_value(const ModelicaMatReader *reader, size_t row, size_t col)
+{
+  if (reader->doublePrecision==1) {
+    double d;
+    memcpy(&d, reader->data_2 + (row*reader->nvar + col)*sizeof(double), sizeof(double));
+    return d;
+  } else {
+    float f;
+    memcpy(&f, reader->data_2 + (row*reader->nvar + col)*sizeof(float), sizeof(float));
+    return f;
+  }
+}
 
 /* Returns 0 on success; the error message on error */
 const char* omc_new_matlab4_reader(const char *filename, ModelicaMatReader *reader)
@@ -251,7 +300,7 @@ const char* omc_new_matlab4_reader(const char *filename, ModelicaMatReader *read
       return "Corrupt header (3)";
     }
     /* fprintf(stderr, "  Name of matrix: %s\n", name); */
-    matrix_length = hdr.mrows*hdr.ncols*(1+hdr.imagf)*element_length;
+    matrix_length = (size_t)hdr.mrows*hdr.ncols*(1+hdr.imagf)*element_length;
     if(0 != strcmp(name,matrixNames[i])) {
       free(name);
       return matrixNamesMismatch[i];
@@ -441,6 +490,7 @@ const char* omc_new_matlab4_reader(const char *filename, ModelicaMatReader *read
         reader->var_offset = ftell(reader->file);
         reader->vars = (double**) calloc(reader->nvar*2,sizeof(double*));
         if(-1==fseek(reader->file,matrix_length,SEEK_CUR)) return "Corrupt header: data_2 matrix";
+        map_data_2(reader);
       }
       if(binTrans==0) {
         unsigned int k,j;
@@ -572,10 +622,17 @@ double* omc_matlab4_read_vals(ModelicaMatReader *reader, int varIndex)
   } else if(!reader->vars[ix]) {
     unsigned int i;
     double *tmp = (double*) malloc(reader->nrows*sizeof(double));
-    if(reader->doublePrecision==1)
+    if(reader->data_2)
+    {
+      if (omc_matlab4_read_vals_range(reader, varIndex, 0, reader->nrows, tmp)) {
+        free(tmp);
+        return NULL;
+      }
+    }
+    else if(reader->doublePrecision==1)
     {
       for(i=0; i<reader->nrows; i++) {
-        fseek(reader->file,reader->var_offset + sizeof(double)*(i*reader->nvar + absVarIndex-1), SEEK_SET);
+        fseek(reader->file,reader->var_offset + sizeof(double)*((size_t)i*reader->nvar + absVarIndex-1), SEEK_SET);
         if(1 != fread(&tmp[i], sizeof(double), 1, reader->file)) {
           /* fprintf(stderr, "Corrupt file at %d of %d? nvar %d\n", i, reader->nrows, reader->nvar); */
           free(tmp);
@@ -590,7 +647,7 @@ double* omc_matlab4_read_vals(ModelicaMatReader *reader, int varIndex)
     {
       float *buffer = (float*) malloc(reader->nrows*sizeof(float));
       for(i=0; i<reader->nrows; i++) {
-        fseek(reader->file,reader->var_offset + sizeof(float)*(i*reader->nvar + absVarIndex-1), SEEK_SET);
+        fseek(reader->file,reader->var_offset + sizeof(float)*((size_t)i*reader->nvar + absVarIndex-1), SEEK_SET);
         if(1 != fread(&buffer[i], sizeof(float), 1, reader->file)) {
           /* fprintf(stderr, "Corrupt file at %d of %d? nvar %d\n", i, reader->nrows, reader->nvar); */
           free(buffer);
@@ -619,6 +676,48 @@ double* omc_matlab4_read_vals(ModelicaMatReader *reader, int varIndex)
   return reader->vars[ix];
 }
 
+int omc_matlab4_read_vals_range(ModelicaMatReader *reader, int varIndex, size_t start, size_t n, double *res)
+{
+  size_t absVarIndex = abs(varIndex);
+  size_t ix = (varIndex < 0 ? absVarIndex + reader->nvar : absVarIndex) -1;
+  size_t i;
+  assert(absVarIndex > 0 && absVarIndex <= reader->nvar);
+  if (start + n > reader->nrows) {
+    return 1;
+  }
+  if (reader->vars[ix]) {
+    memcpy(res, reader->vars[ix] + start, n*sizeof(double));
+    return 0;
+  }
+  if (reader->data_2) {
+    for (i=0; i<n; i++) {
+      res[i] = mapped_value(reader, start+i, absVarIndex-1);
+    }
+  } else {
+    size_t elementSize = reader->doublePrecision==1 ? sizeof(double) : sizeof(float);
+    for (i=0; i<n; i++) {
+      double d;
+      float f;
+      if (0 != fseek(reader->file, reader->var_offset + elementSize*((start+i)*reader->nvar + absVarIndex-1), SEEK_SET)) {
+        return 1;
+      }
+      if (reader->doublePrecision==1) {
+        if (1 != fread(&d, sizeof(double), 1, reader->file)) return 1;
+      } else {
+        if (1 != fread(&f, sizeof(float), 1, reader->file)) return 1;
+        d = f;
+      }
+      res[i] = d;
+    }
+  }
+  if (varIndex < 0) {
+    for (i=0; i<n; i++) {
+      res[i] = -res[i];
+    }
+  }
+  return 0;
+}
+
 void matrix_transpose(double *m, int w, int h)
 {
   int start;
@@ -679,6 +778,35 @@ int omc_matlab4_read_all_vals(ModelicaMatReader *reader)
     reader->readAll = 1;
     return 0;
   }
+  if (reader->data_2) {
+    /* Transpose the mapped matrix block-wise into the columns; a block of time points stays in the cache
+     * while it is distributed over all variables */
+    size_t blockRows = MAT4_TRANSPOSE_BLOCK_SIZE / (nvar*(reader->doublePrecision==1 ? sizeof(double) : sizeof(float)));
+    size_t rows = reader->nrows, row, r, end;
+    if (blockRows == 0) {
+      blockRows = 1;
+    }
+    for (i=0; i<2*nvar; i++) {
+      if (!reader->vars[i]) {
+        reader->vars[i] = (double*) malloc(nrows*sizeof(double));
+        if (!reader->vars[i]) {
+          return 1;
+        }
+      }
+    }
+    for (row=0; row<rows; row=end) {
+      end = row+blockRows < rows ? row+blockRows : rows;
+      for (i=0; i<nvar; i++) {
+        double *pos = reader->vars[i], *neg = reader->vars[nvar+i];
+        for (r=row; r<end; r++) {
+          pos[r] = mapped_value(reader, r, i);
+          neg[r] = -pos[r];
+        }
+      }
+    }
+    reader->readAll = 1;
+    return 0;
+  }
   tmp = (double*) malloc(2*nvar*nrows*sizeof(double));
   if (!tmp) {
     return 1;
@@ -719,15 +847,17 @@ double omc_matlab4_read_single_val(double *res, ModelicaMatReader *reader, int v
     *res = reader->vars[ix][timeIndex];
     return 0;
   }
-  if(reader->doublePrecision==1) {
-    fseek(reader->file,reader->var_offset + sizeof(double)*(timeIndex*reader->nvar + absVarIndex-1), SEEK_SET);
+  if(reader->data_2) {
+    *res = mapped_value(reader, timeIndex, absVarIndex-1);
+  } else if(reader->doublePrecision==1) {
+    fseek(reader->file,reader->var_offset + sizeof(double)*((size_t)timeIndex*reader->nvar + absVarIndex-1), SEEK_SET);
     if(1 != fread(res, sizeof(double), 1, reader->file)) {
       *res = 0;
       return 1;
     }
   } else {
     float tmpres;
-    fseek(reader->file,reader->var_offset + sizeof(float)*(timeIndex*reader->nvar + absVarIndex-1), SEEK_SET);
+    fseek(reader->file,reader->var_offset + sizeof(float)*((size_t)timeIndex*reader->nvar + absVarIndex-1), SEEK_SET);
     if(1 != fread(&tmpres, sizeof(float), 1, reader->file)) {
       *res = 0;
       return 1;
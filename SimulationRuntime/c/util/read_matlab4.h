@@ -55,6 +55,9 @@ typedef struct {
   int readAll; /* Read all variables already */
   double **vars;
   char doublePrecision; /* data_1 and data_2 in double ore single precision */
+  void *mapped; /* The memory-mapped file (binTrans only), NULL if the file is read with fread */
+  size_t mappedSize;
+  const char *data_2; /* The data_2 matrix in the mapped file: nrows rows of nvar values, possibly unaligned */
 } ModelicaMatReader;
 
 /* Returns 0 on success; the error message on error.
@@ -78,6 +81,11 @@ ModelicaMatVariable_t *omc_matlab4_find_var(ModelicaMatReader *reader, const cha
  */
 double* omc_matlab4_read_vals(ModelicaMatReader *reader, int varIndex);
 
+/* Reads the values of a variable at the time points start ... start+n-1 into res without caching them.
+ * Like omc_matlab4_read_vals, negative indexes return the negated values.
+ * Returns 0 on success */
+int omc_matlab4_read_vals_range(ModelicaMatReader *reader, int varIndex, size_t start, size_t n, double *res);
+
 /* Returns 0 on success */
 int omc_matlab4_val(double *res, ModelicaMatReader *reader, ModelicaMatVariable_t *var, double time);
 
@@ -116,6 +116,12 @@ void dequeueNFirstRingDatas(RINGBUFFER *rb, int n)
   rb->nElements -= n;
 }
 
+void clearRingBuffer(RINGBUFFER *rb)
+{
+  rb->firstElement = 0;
+  rb->nElements = 0;
+}
+
 int ringBufferLength(RINGBUFFER *rb)
 {
   return rb->nElements;
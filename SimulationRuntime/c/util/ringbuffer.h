@@ -51,6 +51,8 @@ extern "C" {
 
   void appendRingData(RINGBUFFER *rb, void *value);
   void dequeueNFirstRingDatas(RINGBUFFER *rb, int n);
+  /* removes all elements, the allocated buffer is kept */
+  void clearRingBuffer(RINGBUFFER *rb);
 
   int ringBufferLength(RINGBUFFER *rb);
 
@@ -77,6 +77,7 @@ const char *FLAG_NAME[FLAG_MAX+1] = {
   /* FLAG_IMPRK_ORDER */                  "impRKOrder",
   /* FLAG_IMPRK_LS */                     "impRKLS",
   /* FLAG_INITIAL_STEP_SIZE */            "initialStepSize",
+  /* FLAG_INIT_CACHE */                   "initCache",
   /* FLAG_INPUT_CSV */                    "csvInput",
   /* FLAG_INPUT_FILE */                   "exInputFile",
   /* FLAG_INPUT_FILE_STATES */            "stateFile",
@@ -87,8 +88,10 @@ const char *FLAG_NAME[FLAG_MAX+1] = {
   /* FLAG_IPOPT_MAX_ITER */               "ipopt_max_iter",
   /* FLAG_IPOPT_WARM_START */             "ipopt_warm_start",
   /* FLAG_JACOBIAN */                     "jacobian",
+  /* FLAG_JACOBIAN_THREADS */             "jacobianThreads",
   /* FLAG_L */                            "l",
   /* FLAG_L_DATA_RECOVERY */              "l_datarec",
+  /* FLAG_L_MAT */                        "l_mat",
   /* FLAG_LOG_FORMAT */                   "logFormat",
   /* FLAG_LS */                           "ls",
   /* FLAG_LS_IPOPT */                     "ls_ipopt",
@@ -106,6 +109,7 @@ const char *FLAG_NAME[FLAG_MAX+1] = {
   /* FLAG_NEWTON_XTOL */                  "newtonXTol",
   /* FLAG_NEWTON_STRATEGY */              "newton",
   /* FLAG_NLS */                          "nls",
+  /* FLAG_NLS_EXTRAPOLATION_ORDER */      "nlsExtrapolationOrder",
   /* FLAG_NLS_INFO */                     "nlsInfo",
   /* FLAG_NLS_LS */                       "nlsLS",
   /* FLAG_NLS_MAX_DENSITY */              "nlssMaxDensity",
@@ -187,6 +191,7 @@ const char *FLAG_DESC[FLAG_MAX+1] = {
   /* FLAG_IMPRK_ORDER */                  "[int (default 5)] value specifies the integration order of the implicit Runge-Kutta method. Valid values: 1-6",
   /* FLAG_IMPRK_LS */                     "selects the linear solver of the integration methods: impeuler, trapezoid and imprungekuta",
   /* FLAG_INITIAL_STEP_SIZE */            "value specifies an initial step size for supported solver",
+  /* FLAG_INIT_CACHE */                   "read and write a binary cache of the model_init.xml file",
   /* FLAG_INPUT_CSV */                    "value specifies an csv-file with inputs for the simulation/optimization of the model",
   /* FLAG_INPUT_FILE */                   "value specifies an external file with inputs for the simulation/optimization of the model",
   /* FLAG_INPUT_FILE_STATES */            "value specifies an file with states start values for the optimization of the model",
@@ -197,8 +202,10 @@ const char *FLAG_DESC[FLAG_MAX+1] = {
   /* FLAG_IPOPT_MAX_ITER */               "value specifies the max number of iteration for ipopt",
   /* FLAG_IPOPT_WARM_START */             "value specifies lvl for a warm start in ipopt: 1,2,3,...",
   /* FLAG_JACOBIAN */                     "select the calculation method of the Jacobian used only by ida and dassl solver.",
+  /* FLAG_JACOBIAN_THREADS */             "value specifies the number of threads for the colored numerical Jacobian of ida and dassl",
   /* FLAG_L */                            "value specifies a time where the linearization of the model should be performed",
   /* FLAG_L_DATA_RECOVERY */              "emit data recovery matrices with model linearization",
+  /* FLAG_L_MAT */                        "emit the linearization as sparse matrices in a MAT v4 file instead of a Modelica model",
   /* FLAG_LOG_FORMAT */                   "value specifies the log format of the executable. -logFormat=text (default), -logFormat=xml or -logFormat=xmltcp",
   /* FLAG_LS */                           "value specifies the linear solver method (default: lapack, totalpivot (fallback))",
   /* FLAG_LS_IPOPT */                     "value specifies the linear solver method for ipopt",
@@ -216,6 +223,7 @@ const char *FLAG_DESC[FLAG_MAX+1] = {
   /* FLAG_NEWTON_XTOL */                  "[double (default 1e-12)] tolerance respecting newton correction (delta_x) for updating solution vector in Newton solver",
   /* FLAG_NEWTON_STRATEGY */              "value specifies the damping strategy for the newton solver",
   /* FLAG_NLS */                          "value specifies the nonlinear solver",
+  /* FLAG_NLS_EXTRAPOLATION_ORDER */      "[int (default 1)] value specifies the order of the extrapolation of the start values of non-linear systems: 0, 1 or 2",
   /* FLAG_NLS_INFO */                     "outputs detailed information about solving process of non-linear systems into csv files.",
   /* FLAG_NLS_LS */                       "value specifies the linear solver used by the non-linear solver",
   /* FLAG_NLS_MAX_DENSITY */              "[double (default 0.2)] value specifies the maximum density for using a non-linear sparse solver",
@@ -357,6 +365,12 @@ const char *FLAG_DETAILED_DESC[FLAG_MAX+1] = {
   "  * dense - dense linear solver, SUNDIALS default method",
   /* FLAG_INITIAL_STEP_SIZE */
   "  Value specifies an initial step size, used by the methods: dassl, ida",
+  /* FLAG_INIT_CACHE */
+  "  Reads the model description and the start values from a binary cache of the\n"
+  "  model_init.xml file (model_init.bin) instead of parsing the xml file. The cache\n"
+  "  is written next to the xml file if it does not exist or is outdated, i.e. if the\n"
+  "  xml file or the model were changed. Overrides are applied to the cached values.\n"
+  "  The cache is not used together with -idaSensitivity.",
   /* FLAG_INPUT_CSV */
   "  Value specifies an csv-file with inputs for the simulation/optimization of the model",
   /* FLAG_INPUT_FILE */
@@ -377,10 +391,18 @@ const char *FLAG_DETAILED_DESC[FLAG_MAX+1] = {
   "  Value specifies lvl for a warm start in ipopt: 1,2,3,...",
   /* FLAG_JACOBIAN */
   "  Select the calculation method for Jacobian used by the integration method:\n",
+  /* FLAG_JACOBIAN_THREADS */
+  "  Value specifies the number of threads used to evaluate the colors of the\n"
+  "  colored numerical Jacobian of ida and dassl concurrently (default: 1).\n"
+  "  Every additional thread works on its own copy of the model data.",
   /* FLAG_L */
   "  Value specifies a time where the linearization of the model should be performed.",
   /* FLAG_L_DATA_RECOVERY */
   "  Emit data recovery matrices with model linearization.",
+  /* FLAG_L_MAT */
+  "  Emit the linearization as sparse matrices A, B, C, D (and Cz, Dz with -l_datarec)\n"
+  "  together with the operating point x0, u0 and the names of states and inputs in the\n"
+  "  MAT v4 file linear_<model>.mat instead of the Modelica model linear_<model>.mo.",
   /* FLAG_LOG_FORMAT */
   "  Value specifies the log format of the executable:\n\n"
   "  * text (default)\n"
@@ -404,7 +426,9 @@ const char *FLAG_DETAILED_DESC[FLAG_MAX+1] = {
   "  enable. Multiple options can be enabled at the same time.",
   /* FLAG_MAX_BISECTION_ITERATIONS */
   "  Value specifies the maximum number of bisection iterations for state event\n"
-  "  detection or zero for default behavior",
+  "  detection or zero for default behavior. The event location uses the regula\n"
+  "  falsi method (illinois variant) with bisection steps as safeguard, all of\n"
+  "  them count as an iteration.",
   /* FLAG_MAX_EVENT_ITERATIONS */
   "  Value specifies the maximum number of event iterations.\n"
   "  The value is an Integer with default value 20.",
@@ -434,6 +458,12 @@ const char *FLAG_DETAILED_DESC[FLAG_MAX+1] = {
   "  Value specifies the damping strategy for the newton solver.",
   /* FLAG_NLS */
   "  Value specifies the nonlinear solver:",
+  /* FLAG_NLS_EXTRAPOLATION_ORDER */
+  "  Value specifies the order of the polynomial that extrapolates the start values\n"
+  "  of non-linear systems from the stored solutions of previous steps:\n"
+  "  0: use the last solution\n"
+  "  1: linear extrapolation from the last two solutions (default)\n"
+  "  2: quadratic extrapolation from the last three solutions",
   /* FLAG_NLS_INFO */
   "  Outputs detailed information about solving process of non-linear systems into csv files.",
   /* FLAG_NLS_LS */
@@ -563,6 +593,7 @@ const int FLAG_TYPE[FLAG_MAX] = {
   /* FLAG_IMPRK_LS */                     FLAG_TYPE_OPTION,
   /* FLAG_IMPRK_ORDER */                  FLAG_TYPE_OPTION,
   /* FLAG_INITIAL_STEP_SIZE */            FLAG_TYPE_OPTION,
+  /* FLAG_INIT_CACHE */                   FLAG_TYPE_FLAG,
   /* FLAG_INPUT_CSV */                    FLAG_TYPE_OPTION,
   /* FLAG_INPUT_FILE */                   FLAG_TYPE_OPTION,
   /* FLAG_INPUT_FILE_STATES */            FLAG_TYPE_OPTION,
@@ -573,8 +604,10 @@ const int FLAG_TYPE[FLAG_MAX] = {
   /* FLAG_IPOPT_MAX_ITER */               FLAG_TYPE_OPTION,
   /* FLAG_IPOPT_WARM_START */             FLAG_TYPE_OPTION,
   /* FLAG_JACOBIAN */                     FLAG_TYPE_OPTION,
+  /* FLAG_JACOBIAN_THREADS */             FLAG_TYPE_OPTION,
   /* FLAG_L */                            FLAG_TYPE_OPTION,
   /* FLAG_L_DATA_RECOVERY */              FLAG_TYPE_FLAG,
+  /* FLAG_L_MAT */                        FLAG_TYPE_FLAG,
   /* FLAG_LOG_FORMAT */                   FLAG_TYPE_OPTION,
   /* FLAG_LS */                           FLAG_TYPE_OPTION,
   /* FLAG_LS_IPOPT */                     FLAG_TYPE_OPTION,
@@ -592,6 +625,7 @@ const int FLAG_TYPE[FLAG_MAX] = {
   /* FLAG_NEWTON_XTOL */                  FLAG_TYPE_OPTION,
   /* FLAG_NEWTON_STRATEGY */              FLAG_TYPE_OPTION,
   /* FLAG_NLS */                          FLAG_TYPE_OPTION,
+  /* FLAG_NLS_EXTRAPOLATION_ORDER */      FLAG_TYPE_OPTION,
   /* FLAG_NLS_INFO */                     FLAG_TYPE_FLAG,
   /* FLAG_NLS_LS */                       FLAG_TYPE_OPTION,
   /* FLAG_NLS_MAX_DENSITY */              FLAG_TYPE_OPTION,
@@ -636,6 +670,7 @@ const char *SOLVER_METHOD_NAME[S_MAX] = {
   /* S_DASSL */         "dassl",
   /* S_IDA */           "ida",
   /* S_ERKSSC */        "rungekuttaSsc",
+  /* S_DOPRI45 */       "dopri45",
   /* S_SYM_SOLVER */    "symSolver",
   /* S_SYM_SOLVER_SSC */"symSolverSsc",
   /* S_QSS */           "qss",
@@ -654,6 +689,7 @@ const char *SOLVER_METHOD_DESC[S_MAX] = {
   /* S_DASSL */         "dassl - default solver - BDF method - implicit, step size control, order 1-5",
   /* S_IDA */           "ida - SUNDIALS IDA solver - BDF method with sparse linear solver - implicit, step size control, order 1-5",
   /* S_ERKSSC */        "rungekuttaSsc - Runge-Kutta based on Novikov (2016) - explicit, step size control, order 4-5 [experimental]",
+  /* S_DOPRI45 */       "dopri45 - Dormand-Prince method with dense output - explicit, step size control, order 5(4)",
   /* S_SYM_SOLVER */     "symSolver - symbolic inline Solver [compiler flag +symSolver needed] - fixed step size, order 1",
   /* S_SYM_SOLVER_SSC */ "symSolverSsc - symbolic implicit Euler with step size control [compiler flag +symSolver needed] - step size control, order 1",
   /* S_QSS */           "qss - A QSS solver [experimental]",
@@ -836,7 +872,7 @@ const char *NLS_LS_METHOD_DESC[NLS_LS_MAX] = {
   "chooses the nls linear solver based on which nls is being used.",
   "internal total pivot implementation. Solve in some case even under-determined systems.",
   "use external LAPACK implementation.",
-  "use KLU direct sparse solver. Only with KINSOL available."
+  "use KLU direct sparse solver. Only with KINSOL or the homotopy solver (if the sparsity pattern is known) available."
 };
 
 const char *IMPRK_LS_METHOD[IMPRK_LS_MAX] = {
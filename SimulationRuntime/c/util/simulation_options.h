@@ -85,6 +85,7 @@ enum _FLAG
   FLAG_IMPRK_ORDER,
   FLAG_IMPRK_LS,
   FLAG_INITIAL_STEP_SIZE,
+  FLAG_INIT_CACHE,
   FLAG_INPUT_CSV,
   FLAG_INPUT_FILE,
   FLAG_INPUT_FILE_STATES,
@@ -95,8 +96,10 @@ enum _FLAG
   FLAG_IPOPT_MAX_ITER,
   FLAG_IPOPT_WARM_START,
   FLAG_JACOBIAN,
+  FLAG_JACOBIAN_THREADS,
   FLAG_L,
   FLAG_L_DATA_RECOVERY,
+  FLAG_L_MAT,
   FLAG_LOG_FORMAT,
   FLAG_LS,
   FLAG_LS_IPOPT,
@@ -114,6 +117,7 @@ enum _FLAG
   FLAG_NEWTON_XTOL,
   FLAG_NEWTON_STRATEGY,
   FLAG_NLS,
+  FLAG_NLS_EXTRAPOLATION_ORDER,
   FLAG_NLS_INFO,
   FLAG_NLS_LS,
   FLAG_NLS_MAX_DENSITY,
@@ -177,6 +181,7 @@ enum SOLVER_METHOD
   S_DASSL,
   S_IDA,
   S_ERKSSC,
+  S_DOPRI45,
   S_SYM_SOLVER,
   S_SYM_SOLVER_SSC,
   S_QSS,
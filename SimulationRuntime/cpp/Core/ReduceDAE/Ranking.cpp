@@ -198,6 +198,114 @@ label_list_type Ranking::residuenRanking(ublas::matrix<double>& R, ublas::matrix
 	else
 		throw std::runtime_error("Modelica system is not of type IReduceDAE");
 }
+/*
+Simulates the system with the label of the given index removed and returns the rank value
+(maximum error of the outputs compared to the reference solution Ro)
+*/
+double Ranking::rankLabel(unsigned int labelIndex, ublas::matrix<double>& Ro, shared_ptr<IMixedSystem> system, IReduceDAESettings* settings,
+                          SimSettings& simsettings, string& modelKey, vector<string>& output_names, double timeout, ISimController* sim_controller)
+{
+	shared_ptr<IReduceDAE> reduce_dae = dynamic_pointer_cast<IReduceDAE>(system);
+	//the label tuples refer to the variables of the given system instance
+	label_list_type labels = reduce_dae->getLabels();
+	label_type label = labels[labelIndex];
+	ublas::matrix<double> Rc; //current result
+	double rank_value;
+	//the output is written at once, the labels may be ranked concurrently
+	ostringstream message;
+	try{
+
+		sim_controller->initialize(simsettings, modelKey, timeout);
+		//set label_1 to 0 and label_2 to 1
+		*(get<1>(label)) = 0;
+		*(get<2>(label)) = 1;
+		//vector for errors
+		ublas::vector<double> e(Ro.size1());
+
+		sim_controller->runReducedSimulation();
+		IHistory* history = reduce_dae->getHistory();
+		//query simulation result outputs
+		history->getOutputResults(Rc);
+
+
+		Reduction reduction(system, settings);
+		e = reduction.getError(Rc, Ro, output_names);
+
+		//rank norm_inf (x)= max |xi|
+		rank_value = ublas::norm_inf(e);
+
+	}
+	catch (ModelicaSimulationError& ex)
+	{
+#undef max
+		rank_value = std::numeric_limits<double>::max();
+		if (!ex.isSuppressed())
+			message << "removing label " << (get<0>(label)) << "causes error " << ex.what() << std::endl;
+		// std::cerr << "Simulation stopped with error in " << error_id_string(ex.getErrorID()) << ": "  << ex.what();
+
+	}
+	catch (std::invalid_argument& ex) // division by zero
+	{
+#undef max
+		rank_value = std::numeric_limits<double>::max();
+		message << "division by zero for label " << (get<0>(label)) << std::endl;
+	}
+
+	message << "rank value for label " << (get<0>(label)) << ": " << rank_value << std::endl;
+	{
+#if defined(USE_THREAD)
+		unique_lock<mutex> lock(_output_mutex);
+#endif
+		cout << message.str();
+	}
+
+	//reset current label values
+	*(get<1>(label)) = 1;
+	*(get<2>(label)) = 0;
+
+	return rank_value;
+}
+
+#if defined(USE_THREAD)
+/*
+Result file of a ranking worker, the index of the worker is appended to the name of the given file
+*/
+static string rankingResultFile(const string& file_name, unsigned int index)
+{
+	ostringstream suffix;
+	suffix << "_rank" << index;
+	size_t name_start = file_name.find_last_of("/\\");
+	size_t extension = file_name.find_last_of('.');
+	if (extension == string::npos || (name_start != string::npos && extension < name_start))
+		return file_name + suffix.str();
+	return file_name.substr(0, extension) + suffix.str() + file_name.substr(extension);
+}
+
+/*
+Worker of the parallel perfect ranking, ranks the labels with the indices taken from the shared counter
+on its own instance of the system
+*/
+void Ranking::rankLabelsWorker(RankingWorker* worker)
+{
+	try
+	{
+		shared_ptr<IMixedSystem> system = worker->sim_controller->getSystem(*worker->modelKey);
+		while (true)
+		{
+			unsigned int k = worker->next_label->fetch_add(1);
+			if (k >= worker->rank_vector->size())
+				break;
+			(*worker->rank_vector)[k] = rankLabel(k, *worker->Ro, system, worker->settings, worker->simsettings,
+			                                      *worker->modelKey, *worker->output_names, worker->timeout, worker->sim_controller.get());
+		}
+	}
+	catch (std::exception& ex)
+	{
+		worker->error = ex.what();
+	}
+}
+#endif
+
 label_list_type Ranking::perfectRanking(ublas::matrix<double>& Ro, shared_ptr<IMixedSystem> _system, IReduceDAESettings* _settings, SimSettings simsettings,
                                         string modelKey, vector<string> output_names, double timeout,ISimController* sim_controller)
 {
@@ -209,9 +317,6 @@ label_list_type Ranking::perfectRanking(ublas::matrix<double>& Ro, shared_ptr<IM
 	//cast modelica system to reduce dae object
 	shared_ptr<IReduceDAE> reduce_dae = dynamic_pointer_cast<IReduceDAE>(_system);
 
-	IHistory* history;
-	ublas::matrix<double> Rc; //current result
-
 	if (reduce_dae)
 	{
 
@@ -222,59 +327,48 @@ label_list_type Ranking::perfectRanking(ublas::matrix<double>& Ro, shared_ptr<IM
 		int kDim = labels.size();
 		//vector for ranks
 		vector<double> rank_vector(kDim);
-		double rank_value;
-		//index for current ranking
-		unsigned int k = 0;
-		//loop over labels
-		FOREACH(label_type  label, labels)
-		{
-			try{
-
-				sim_controller->initialize(simsettings, modelKey, timeout);
-				//set label_1 to 0 and label_2 to 1
-				*(get<1>(label)) = 0;
-				*(get<2>(label)) = 1;
-				//vector for errors
-				ublas::vector<double> e(n);
-
-				sim_controller->runReducedSimulation();
-				history = reduce_dae->getHistory();
-				//query simulation result outputs
-				Rc.clear();
-				history->getOutputResults(Rc);
-
-
-				Reduction reduction(_system, _settings);
-				e = reduction.getError(Rc, Ro, output_names);;
-
-				//rank norm_inf (x)= max |xi|
-				rank_value = ublas::norm_inf(e);
+		//number of label simulations that run concurrently
+		unsigned int nThreads = std::max(1u, std::min(_settings->getRankingThreads(), (unsigned int)kDim));
 
-			}
-			catch (ModelicaSimulationError& ex)
+#if defined(USE_THREAD)
+		if (nThreads > 1)
+		{
+			cout << "rank " << kDim << " labels with " << nThreads << " threads" << std::endl;
+			//every worker simulates its own instance of the system, loaded by a clone of the controller
+			atomic<unsigned int> next_label(0);
+			vector<RankingWorker> workers(nThreads);
+			for (unsigned int i = 0; i < nThreads; i++)
 			{
-#undef max
-				rank_value = std::numeric_limits<double>::max();
-				if (!ex.isSuppressed())
-					cout << "removing label " << (get<0>(label)) << "causes error " << ex.what() << std::endl;
-				// std::cerr << "Simulation stopped with error in " << error_id_string(ex.getErrorID()) << ": "  << ex.what();
-
+				RankingWorker& worker = workers[i];
+				worker.sim_controller = sim_controller->cloneController(modelKey);
+				worker.settings = _settings;
+				worker.Ro = &Ro;
+				//the clones run concurrently, each one writes its own result file
+				worker.simsettings = simsettings;
+				worker.simsettings.outputfile_name = rankingResultFile(simsettings.outputfile_name, i);
+				worker.modelKey = &modelKey;
+				worker.output_names = &output_names;
+				worker.timeout = timeout;
+				worker.rank_vector = &rank_vector;
+				worker.next_label = &next_label;
 			}
-			catch (std::invalid_argument& ex) // division by zero
+			vector<thread> threads;
+			for (unsigned int i = 0; i < nThreads; i++)
+				threads.push_back(thread(&Ranking::rankLabelsWorker, this, &workers[i]));
+			for (unsigned int i = 0; i < nThreads; i++)
+				threads[i].join();
+			for (unsigned int i = 0; i < nThreads; i++)
 			{
-#undef max
-				rank_value = std::numeric_limits<double>::max();
-				cout << "division by zero for label " << (get<0>(label)) << std::endl;
+				if (!workers[i].error.empty())
+					throw std::runtime_error("Perfect ranking failed: " + workers[i].error);
 			}
-
-
-
-			rank_vector[k++] = rank_value;
-			cout << "rank value for label " << (get<0>(label)) << ": " << rank_value << std::endl;
-
-			//reset current label values
-			*(get<1>(label)) = 1;
-			*(get<2>(label)) = 0;
+		}
+		else
+#endif
+		{
+			//loop over labels
+			for (unsigned int k = 0; k < (unsigned int)kDim; k++)
+				rank_vector[k] = rankLabel(k, Ro, _system, _settings, simsettings, modelKey, output_names, timeout, sim_controller);
 		}
 		//sort the label list in the order of the sorted ranking vector
 		sort(labels.begin(), labels.end(),
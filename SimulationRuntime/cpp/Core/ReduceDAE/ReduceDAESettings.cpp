@@ -9,7 +9,8 @@
 ReduceDAESettings::ReduceDAESettings(IGlobalSettings*	globalSettings)
 	:_globalSettings(globalSettings),
 	_ranking_method(RESIDUEN),
-	_reduction_method(CANCEL_TERMS)
+	_reduction_method(CANCEL_TERMS),
+	_ranking_threads(1)
 
 {
 	//initialize max errro vector with default size
@@ -47,6 +48,16 @@ void ReduceDAESettings::setNFail(unsigned int fail)
 	_nfail = fail;
 }
 
+unsigned int ReduceDAESettings::getRankingThreads()
+{
+	return _ranking_threads;
+}
+
+void ReduceDAESettings::setRankingThreads(unsigned int threads)
+{
+	_ranking_threads = threads;
+}
+
 ublas::vector<double> ReduceDAESettings::getMaxError()
 {
 	return _max_error;
@@ -99,6 +110,11 @@ void ReduceDAESettings::load(std::string xml_file)
 					_ranking_method = vars.second.get<int>("<xmlattr>.value");
 				}
 
+				if (vars.first == "RankingThreads")
+				{
+					_ranking_threads = vars.second.get<int>("<xmlattr>.value");
+				}
+
 				if (vars.first == "ReductionMethod")
 				{
 					_reduction_method = vars.second.get<int>("<xmlattr>.value");
@@ -80,6 +80,7 @@ weak_ptr<IMixedSystem> SimController::LoadSystem(string modelLib,string modelKey
      //create system
     shared_ptr<IMixedSystem> system = createSystem(modelLib, modelKey, _config->getGlobalSettings().get(), _sim_objects);
     _systems[modelKey] = system;
+    _systemLibs[modelKey] = modelLib;
     return system;
 }
 
@@ -131,6 +132,20 @@ shared_ptr<IMixedSystem> SimController::getSystem(string modelname)
  {
      _simMgr->runSimulation();
  }
+
+shared_ptr<ISimController> SimController::cloneController(string modelKey)
+{
+    std::map<string, string>::iterator iter = _systemLibs.find(modelKey);
+    if(iter == _systemLibs.end())
+    {
+        string error = string("System library was not found for model: ") + modelKey;
+        throw ModelicaSimulationError(SIMMANAGER,error);
+    }
+    //the new controller creates its own configuration, sim objects and system instance
+    shared_ptr<SimController> controller = shared_ptr<SimController>(new SimController(_library_path, _modelicasystem_path));
+    controller->LoadSystem(iter->second, modelKey);
+    return controller;
+}
 void SimController::Start(SimSettings simsettings, string modelKey)
 {
     try
@@ -160,6 +175,7 @@ void SimController::Start(SimSettings simsettings, string modelKey)
         global_settings->setOutputFormat(simsettings.outputFormat);
         global_settings->setEmitResults(simsettings.emitResults);
         global_settings->setNonLinearSolverContinueOnError(simsettings.nonLinearSolverContinueOnError);
+        global_settings->setNonLinearSolverJacobianReuse(simsettings.nonLinearSolverJacobianReuse);
         global_settings->setSolverThreads(simsettings.solverThreads);
         global_settings->setInputPath(simsettings.inputPath);
         global_settings->setOutputPath(simsettings.outputPath);
@@ -172,6 +188,7 @@ void SimController::Start(SimSettings simsettings, string modelKey)
         solver_settings->setUpperLimit(simsettings.upper_limit);
         solver_settings->setRTol(simsettings.tolerance);
         solver_settings->setATol(simsettings.tolerance);
+        solver_settings->setUseSparseFormat(simsettings.useSparseFormat);
         #ifdef RUNTIME_PROFILING
         if(MeasureTime::getInstance() != NULL)
         {
@@ -261,6 +278,7 @@ void SimController::StartReduceDAE(SimSettings simsettings,string modelPath, str
         global_settings->setOutputFormat(simsettings.outputFormat);
         global_settings->setEmitResults(simsettings.emitResults);
         global_settings->setNonLinearSolverContinueOnError(simsettings.nonLinearSolverContinueOnError);
+        global_settings->setNonLinearSolverJacobianReuse(simsettings.nonLinearSolverJacobianReuse);
         global_settings->setSolverThreads(simsettings.solverThreads);
         /*shared_ptr<SimManager>*/ _simMgr = shared_ptr<SimManager>(new SimManager(mixedsystem, _config.get()));
 
@@ -270,6 +288,7 @@ void SimController::StartReduceDAE(SimSettings simsettings,string modelPath, str
         solver_settings->setUpperLimit(simsettings.upper_limit);
         solver_settings->setRTol(simsettings.tolerance);
         solver_settings->setATol(simsettings.tolerance);
+        solver_settings->setUseSparseFormat(simsettings.useSparseFormat);
         #ifdef RUNTIME_PROFILING
         if(MeasureTime::getInstance() != NULL)
         {
@@ -470,6 +489,7 @@ void SimController::initialize(SimSettings simsettings, string modelKey, double
         global_settings->setOutputFormat(simsettings.outputFormat);
         global_settings->setEmitResults(simsettings.emitResults);
         global_settings->setNonLinearSolverContinueOnError(simsettings.nonLinearSolverContinueOnError);
+        global_settings->setNonLinearSolverJacobianReuse(simsettings.nonLinearSolverJacobianReuse);
         global_settings->setSolverThreads(simsettings.solverThreads);
         /*shared_ptr<SimManager>*/ _simMgr = shared_ptr<SimManager>(new SimManager(mixedsystem, _config.get()));
 
@@ -479,6 +499,7 @@ void SimController::initialize(SimSettings simsettings, string modelKey, double
         solver_settings->setUpperLimit(simsettings.upper_limit);
         solver_settings->setRTol(simsettings.tolerance);
         solver_settings->setATol(simsettings.tolerance);
+        solver_settings->setUseSparseFormat(simsettings.useSparseFormat);
         #ifdef RUNTIME_PROFILING
         if(MeasureTime::getInstance() != NULL)
         {
@@ -20,6 +20,7 @@ GlobalSettings::GlobalSettings()
   , _resultsfile_name("results.csv")
   , _endless_sim(false)
   , _nonLinSolverContinueOnError(false)
+  , _nonLinSolverJacobianReuse(false)
   , _outputPointType(OPT_ALL)
   , _alarm_time(0)
   , _outputFormat(MAT)
@@ -211,6 +212,16 @@ bool GlobalSettings::getNonLinearSolverContinueOnError()
   return _nonLinSolverContinueOnError;
 }
 
+void GlobalSettings::setNonLinearSolverJacobianReuse(bool value)
+{
+  _nonLinSolverJacobianReuse = value;
+}
+
+bool GlobalSettings::getNonLinearSolverJacobianReuse()
+{
+  return _nonLinSolverJacobianReuse;
+}
+
 void GlobalSettings::setSolverThreads(int val)
 {
   _solverThreads = val;
@@ -18,6 +18,7 @@ SolverSettings::SolverSettings(IGlobalSettings* globalSettings)
   , _dRtol    (1e-6)
   , _dAtol    (1e-6)
   , _denseOutput  (false)
+  , _useSparseFormat  (false)
 {
   _globalSettings = globalSettings ;
 }
@@ -96,6 +97,16 @@ void SolverSettings::setDenseOutput(bool dense)
   _denseOutput = dense;
 }
 
+bool SolverSettings::getUseSparseFormat()
+{
+  return _useSparseFormat;
+}
+
+void SolverSettings::setUseSparseFormat(bool sparse)
+{
+  _useSparseFormat = sparse;
+}
+
 IGlobalSettings* SolverSettings::getGlobalSettings()
 {
   return _globalSettings;
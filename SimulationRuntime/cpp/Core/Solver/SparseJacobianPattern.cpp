@@ -0,0 +1,137 @@
+/** @addtogroup coreSolver
+ *
+ *  @{
+ */
+#include <Core/ModelicaDefine.h>
+#include <Core/Modelica.h>
+#include <Core/Solver/FactoryExport.h>
+#include <Core/Solver/SparseJacobianPattern.h>
+
+SparseJacobianPattern::SparseJacobianPattern()
+  : _dim(0)
+  , _colPtrs()
+  , _rowIndices()
+  , _diagIndex()
+  , _addedDiagIndex()
+  , _colorPtrs()
+  , _colorColumns()
+{
+}
+
+SparseJacobianPattern::~SparseJacobianPattern()
+{
+}
+
+bool SparseJacobianPattern::initialize(IMixedSystem* system, int dim, bool addDiagonal)
+{
+  // the sparse jacobian is only generated together with the symbolic jacobian
+  if (!system->isJacobianSparse() || !system->isAnalyticJacobianGenerated() || dim <= 0)
+    return false;
+
+  const sparsematrix_t* jacobian;
+  try
+  {
+    jacobian = &system->getSparseJacobian();
+  }
+  catch (ModelicaSimulationError&)
+  {
+    return false;
+  }
+  const sparsematrix_t& A = *jacobian;
+  if (A.size1() != (size_t)dim || A.size2() != (size_t)dim || A.nnz() == 0)
+    return false;
+
+  // collect the row indices column by column, they are sorted within each column
+  vector<vector<int> > columns(dim);
+  for (sparsematrix_t::const_iterator2 it2 = A.begin2(); it2 != A.end2(); ++it2)
+    for (sparsematrix_t::const_iterator1 it1 = it2.begin(); it1 != it2.end(); ++it1)
+      columns[it1.index2()].push_back((int)it1.index1());
+
+  _dim = dim;
+  _colPtrs.assign(dim + 1, 0);
+  _rowIndices.clear();
+  _diagIndex.assign(dim, -1);
+  _addedDiagIndex.clear();
+
+  for (int col = 0; col < dim; col++)
+  {
+    vector<int>& rows = columns[col];
+    bool hasDiagonal = std::binary_search(rows.begin(), rows.end(), col);
+    if (addDiagonal && !hasDiagonal)
+      rows.insert(std::lower_bound(rows.begin(), rows.end(), col), col);
+
+    for (size_t i = 0; i < rows.size(); i++)
+    {
+      if (rows[i] == col)
+      {
+        _diagIndex[col] = (int)_rowIndices.size();
+        if (!hasDiagonal)
+          _addedDiagIndex.push_back(_diagIndex[col]);
+      }
+      _rowIndices.push_back(rows[i]);
+    }
+    _colPtrs[col + 1] = (int)_rowIndices.size();
+  }
+
+  // group the columns by color, every column gets its own color if the system provides no coloring
+  int maxColors = system->getAMaxColors();
+  vector<int> colorOfColumn(dim);
+  if (maxColors > 0)
+    system->getAColorOfColumn(&colorOfColumn[0], dim);
+  else
+  {
+    maxColors = dim;
+    for (int col = 0; col < dim; col++)
+      colorOfColumn[col] = col + 1;
+  }
+
+  _colorPtrs.assign(maxColors + 1, 0);
+  for (int col = 0; col < dim; col++)
+  {
+    if (colorOfColumn[col] < 1 || colorOfColumn[col] > maxColors)
+      throw ModelicaSimulationError(MATH_FUNCTION, "Invalid color of column " + to_string(col) + " in jacobian coloring");
+    _colorPtrs[colorOfColumn[col]]++;
+  }
+  for (int color = 0; color < maxColors; color++)
+    _colorPtrs[color + 1] += _colorPtrs[color];
+
+  vector<int> next(_colorPtrs.begin(), _colorPtrs.end() - 1);
+  _colorColumns.resize(dim);
+  for (int col = 0; col < dim; col++)
+    _colorColumns[next[colorOfColumn[col] - 1]++] = col;
+
+  return true;
+}
+
+void SparseJacobianPattern::copyPattern(int* colPtrs, int* rowIndices) const
+{
+  std::copy(_colPtrs.begin(), _colPtrs.end(), colPtrs);
+  std::copy(_rowIndices.begin(), _rowIndices.end(), rowIndices);
+}
+
+void SparseJacobianPattern::copyValues(const sparsematrix_t& A, double* values) const
+{
+  std::fill_n(values, _rowIndices.size(), 0.0);
+
+  for (sparsematrix_t::const_iterator2 it2 = A.begin2(); it2 != A.end2(); ++it2)
+  {
+    for (sparsematrix_t::const_iterator1 it1 = it2.begin(); it1 != it2.end(); ++it1)
+    {
+      int col = (int)it1.index2();
+      int row = (int)it1.index1();
+      const int* begin = &_rowIndices[0] + _colPtrs[col];
+      const int* end = &_rowIndices[0] + _colPtrs[col + 1];
+      const int* pos = std::lower_bound(begin, end, row);
+      if (pos == end || *pos != row)
+        throw ModelicaSimulationError(MATH_FUNCTION, "Jacobian element (" + to_string(row) + "," + to_string(col) + ") is not part of the sparsity pattern");
+      values[pos - &_rowIndices[0]] = *it1;
+    }
+  }
+}
+
+void SparseJacobianPattern::resetAddedDiagonal(double* values) const
+{
+  for (size_t i = 0; i < _addedDiagIndex.size(); i++)
+    values[_addedDiagIndex[i]] = 0.0;
+}
+ /** @} */ // end of coreSolver
@@ -46,6 +46,7 @@ shared_ptr<INonLinearAlgLoopSolver> AlgLoopSolverFactory::createNonLinearAlgLoop
 		string nonlinsolver_name = _global_settings->getSelectedNonLinSolver();
 		shared_ptr<INonLinSolverSettings> algsolversetting= createNonLinSolverSettings(nonlinsolver_name);
 		algsolversetting->setContinueOnError(_global_settings->getNonLinearSolverContinueOnError());
+		algsolversetting->setJacobianReuse(_global_settings->getNonLinearSolverJacobianReuse());
 		_algsolversettings.push_back(algsolversetting);
 
 		shared_ptr<INonLinearAlgLoopSolver> algsolver= createNonLinSolver(nonlinsolver_name,algsolversetting,algLoop);
@@ -473,6 +473,27 @@ bool& SimVars::getPreVar(const bool& var)
 	return _pre_bool_vars[i];
 }
 
+/**\brief returns the pre values of all real variables, NULL if there are no real variables
+*/
+double* SimVars::getPreRealVarsVector() const
+{
+	return _pre_real_vars;
+}
+
+/**\brief returns the pre values of all integer variables, NULL if there are no integer variables
+*/
+int* SimVars::getPreIntVarsVector() const
+{
+	return _pre_int_vars;
+}
+
+/**\brief returns the pre values of all boolean variables, NULL if there are no boolean variables
+*/
+bool* SimVars::getPreBoolVarsVector() const
+{
+	return _pre_bool_vars;
+}
+
 /**\brief returns a pointer to a real simvar variable in simvar array
 *  \param [in] i index  of simvar in simvar array
 *  \return pointer to simvar
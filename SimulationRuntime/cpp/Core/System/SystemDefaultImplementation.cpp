@@ -63,6 +63,9 @@ SystemDefaultImplementation::SystemDefaultImplementation(IGlobalSettings *global
   , _outputStream(NULL)
   , _callType        (IContinuous::UNDEF_UPDATE)
   , _initial        (false)
+  , _delay_capacity (0)
+  , _delay_head     (0)
+  , _delay_count    (0)
   , _delay_max      (0.0)
   , _start_time      (0.0)
   , _terminal        (false)
@@ -104,6 +107,9 @@ SystemDefaultImplementation::SystemDefaultImplementation(SystemDefaultImplementa
   , _outputStream(NULL)
   , _callType        (IContinuous::UNDEF_UPDATE)
   , _initial        (false)
+  , _delay_capacity (0)
+  , _delay_head     (0)
+  , _delay_count    (0)
   , _delay_max      (0.0)
   , _start_time      (0.0)
   , _terminal        (false)
@@ -498,121 +504,164 @@ void SystemDefaultImplementation::getResidual(double* f)
 
 void  SystemDefaultImplementation::intDelay(vector<unsigned int> expr, vector<double> delay_max)
 {
+  unsigned int max_id = 0;
   FOREACH(unsigned int expr_id, expr)
+    max_id = max(max_id, expr_id);
+
+  _delay_slots.assign(expr.empty() ? 0 : max_id + 1, -1);
+  for (size_t i = 0; i < expr.size(); i++)
+    _delay_slots[expr[i]] = (int)i;
+
+  _delay_capacity = 64;
+  _delay_head = 0;
+  _delay_count = 0;
+  _time_buffer.assign(_delay_capacity, 0.0);
+  _delay_values.assign(_delay_capacity * expr.size(), 0.0);
+
+  vector<double>::iterator iter = std::max_element(delay_max.begin(),delay_max.end());
+  _delay_max = iter != delay_max.end() ? *iter : 0.0;
+}
+
+int SystemDefaultImplementation::getDelaySlot(unsigned int expr_id) const
+{
+  return expr_id < _delay_slots.size() ? _delay_slots[expr_id] : -1;
+}
+
+/// Logical index of the first stored time point >= time, _delay_count if there is none
+size_t SystemDefaultImplementation::findDelayTime(double time) const
+{
+  size_t first = 0;
+  size_t count = _delay_count;
+  while (count > 0)
+  {
+    size_t step = count / 2;
+    if (_time_buffer[delayPosition(first + step)] < time)
+    {
+      first += step + 1;
+      count -= step + 1;
+    }
+    else
+      count = step;
+  }
+  return first;
+}
+
+/// Double the capacity, the entries are unrolled so that the oldest one is stored at position 0
+void SystemDefaultImplementation::growDelayBuffer()
+{
+  size_t capacity = max(2 * _delay_capacity, (size_t)64);
+  size_t numDelays = _delay_capacity > 0 ? _delay_values.size() / _delay_capacity : 0;
+  vector<double> time_buffer(capacity);
+  vector<double> delay_values(capacity * numDelays);
+
+  for (size_t i = 0; i < _delay_count; i++)
   {
-    buffer_type delay_buffer;
-    _delay_buffer[expr_id]=delay_buffer;
+    size_t pos = delayPosition(i);
+    time_buffer[i] = _time_buffer[pos];
+    for (size_t slot = 0; slot < numDelays; slot++)
+      delay_values[slot * capacity + i] = _delay_values[slot * _delay_capacity + pos];
   }
-  vector<double>::iterator iter = std::max_element(delay_max.begin(),delay_max.end());
-  _delay_max =  *iter;
+
+  _time_buffer.swap(time_buffer);
+  _delay_values.swap(delay_values);
+  _delay_capacity = capacity;
+  _delay_head = 0;
 }
 
 void SystemDefaultImplementation::storeDelay(unsigned int expr_id, double expr_value, double time)
 {
-  map<unsigned int,buffer_type>::iterator iter;
-  if ((iter = _delay_buffer.find(expr_id)) != _delay_buffer.end()) {
-    iter->second.push_back(expr_value);
-  }
-  else
+  int slot = getDelaySlot(expr_id);
+  if (slot < 0)
     throw ModelicaSimulationError(MODEL_EQ_SYSTEM,"invalid delay expression id");
+
+  // the value belongs to the time point stored last by storeTime
+  size_t pos = delayPosition(_delay_count > 0 ? _delay_count - 1 : 0);
+  _delay_values[slot * _delay_capacity + pos] = expr_value;
 }
 
 void SystemDefaultImplementation::storeTime(double time)
 {
-  // delete up to last value < time - _delay_max
-  buffer_type::iterator first = _time_buffer.begin();
-  buffer_type::iterator pos = find_if(first, _time_buffer.end(),
-                                      bind2nd(std::greater_equal<double>(),
-                                              time - _delay_max));
-  if (pos != first && --pos != first) {
-    difference_type n = std::distance(first, pos);
-    _time_buffer.erase(first, first + n);
-    map<unsigned int, buffer_type>::iterator iter;
-    for (iter = _delay_buffer.begin(); iter != _delay_buffer.end(); iter++) {
-      first = iter->second.begin();
-      iter->second.erase(first, first + n);
-    }
+  // delete up to last value < time - _delay_max, the time points are stored in ascending order
+  size_t index = findDelayTime(time - _delay_max);
+  if (index > 1)
+  {
+    _delay_head = delayPosition(index - 1);
+    _delay_count -= index - 1;
   }
   // store new value
-  _time_buffer.push_back(time);
+  if (_delay_count == _delay_capacity)
+    growDelayBuffer();
+  _time_buffer[delayPosition(_delay_count)] = time;
+  _delay_count++;
 }
 
 double SystemDefaultImplementation::delay(unsigned int expr_id,double expr_value,double delayTime, double delayMax)
 {
-  map<unsigned int,buffer_type>::iterator iter;
   //find buffer for delay expression
-  if((iter = _delay_buffer.find(expr_id))!=_delay_buffer.end())
+  int slot = getDelaySlot(expr_id);
+  if (slot < 0)
+    throw ModelicaSimulationError(MODEL_EQ_SYSTEM,"invalid delay expression id");
+
+  if(delayTime < 0.0)
   {
-    if(delayTime < 0.0)
-    {
-      throw ModelicaSimulationError(MODEL_EQ_SYSTEM,"Negative delay requested");
-    }
-    if(_time_buffer.size()==0) //occurs in the initialization phase
-    {
+    throw ModelicaSimulationError(MODEL_EQ_SYSTEM,"Negative delay requested");
+  }
+  if(_delay_count==0) //occurs in the initialization phase
+  {
+    return expr_value;
+  }
+  if(_simTime<=_start_time)
+    return expr_value;
 
-      return expr_value;
-    }
-    if(_simTime<=_start_time)
-      return expr_value;
+  const double* values = &_delay_values[slot * _delay_capacity];
+  double ts; //difference of current time and delay time
+  double tl; //last buffer entry
+  double res0, res1, t0, t1;
 
-    double ts; //difference of current time and delay time
-    double tl; //last buffer entry
-    double res0, res1, t0, t1;
+  if(_simTime <=  delayTime)
+  {
+    res0 = values[delayPosition(0)];
+    return res0;
+  }
+  else //time > delay time
+  {
+    ts = _simTime -delayTime;
 
-    if(_simTime <=  delayTime)
+    size_t last = delayPosition(_delay_count - 1);
+    tl = _time_buffer[last];
+    if(ts > tl)
     {
-      res0 = iter->second[0];
-      return res0;
+      t0 = tl;
+      res0 = values[last];
+      t1=_simTime;
+      res1=expr_value;
     }
-    else //time > delay time
+    else
     {
-      ts = _simTime -delayTime;
-
-      tl = _time_buffer.back();
-      if(ts > tl)
-      {
-        t0 = tl;
-        res0=iter->second.back();
-        t1=_simTime;
-        res1=expr_value;
-      }
-      else
-      {
-        //find posion in value buffer for queried time
-        buffer_type::iterator pos = find_if(_time_buffer.begin(),_time_buffer.end(),bind2nd(std::greater_equal<double>(),ts));
-
-        if(pos!=_time_buffer.end())
-        {
-          buffer_type::iterator first = _time_buffer.begin(); // first time entry
-          difference_type index = std::distance(first, pos); //index of found time
-          t1 = *pos;
-          res1 = iter->second[index];
-          if(index == 0)
-            return res1;
-          t0 = _time_buffer[index-1];
-          res0 = iter->second[index-1];
-        }
-        else
-        {
-          throw ModelicaSimulationError(MODEL_EQ_SYSTEM,"time not found in delay buffer");
-        }
-      }
-      if(t0==ts)//found exact time
-        return res0;
-      else if(t1==ts)
+      //find position in value buffer for queried time, it exists because ts <= tl
+      size_t index = findDelayTime(ts);
+      size_t pos = delayPosition(index);
+      t1 = _time_buffer[pos];
+      res1 = values[pos];
+      if(index == 0)
         return res1;
-      else //linear interpolation
-      {
-        double timedif = t1 - t0;
-        double dt0 = t1 - ts;
-        double dt1 = ts - t0;
-        double res2 = (res0 * dt0 + res1 * dt1) / timedif;
-        return res2;
-      }
+      pos = delayPosition(index - 1);
+      t0 = _time_buffer[pos];
+      res0 = values[pos];
+    }
+    if(t0==ts)//found exact time
+      return res0;
+    else if(t1==ts)
+      return res1;
+    else //linear interpolation
+    {
+      double timedif = t1 - t0;
+      double dt0 = t1 - ts;
+      double dt1 = ts - t0;
+      double res2 = (res0 * dt0 + res1 * dt1) / timedif;
+      return res2;
     }
   }
-  else
-    throw ModelicaSimulationError(MODEL_EQ_SYSTEM,"invalid delay expression id");
 }
 
 double& SystemDefaultImplementation::getRealStartValue(double& key)
@@ -804,6 +853,296 @@ double SystemDefaultImplementation::computeNextTimeEvents(double currTime, std::
   return closestTimeEvent;
 }
 
+/// Copy n values of an array of the system into a buffer of a snapshot
+template<typename S, typename T>
+static void saveValues(const S* values, size_t n, vector<T>& buffer)
+{
+  buffer.resize(n);
+  if (n > 0)
+    std::copy(values, values + n, buffer.begin());
+}
+
+/// Copy the values of a snapshot back into an array of the system
+template<typename S, typename T>
+static void restoreValues(const vector<T>& buffer, S* values, size_t n)
+{
+  if (buffer.size() != n)
+    throw ModelicaSimulationError(MODEL_EQ_SYSTEM, "system state does not match the dimensions of the system");
+  for (size_t i = 0; i < n; i++)
+    values[i] = (S)buffer[i];
+}
+
+void SystemDefaultImplementation::saveState(SystemState& state)
+{
+  shared_ptr<ISimVars> simVars = getSimVars();
+  size_t dimReal = simVars->getDimReal();
+  size_t dimInt = simVars->getDimInt();
+  size_t dimBool = simVars->getDimBool();
+
+  state.simTime = _simTime;
+  state.startTime = _start_time;
+  state.initial = _initial;
+  state.terminal = _terminal;
+  state.terminate = _terminate;
+
+  saveValues(simVars->getRealVarsVector(), dimReal, state.realVars);
+  saveValues(simVars->getIntVarsVector(), dimInt, state.intVars);
+  saveValues(simVars->getBoolVarsVector(), dimBool, state.boolVars);
+  saveValues(simVars->getStringVarsVector(), simVars->getDimString(), state.stringVars);
+  saveValues(simVars->getPreRealVarsVector(), dimReal, state.preRealVars);
+  saveValues(simVars->getPreIntVarsVector(), dimInt, state.preIntVars);
+  saveValues(simVars->getPreBoolVarsVector(), dimBool, state.preBoolVars);
+
+  saveValues(_conditions, _conditions ? _dimZeroFunc : 0, state.conditions);
+  saveValues(_time_conditions, _time_conditions ? _dimTimeEvent : 0, state.timeConditions);
+  saveValues(_currTimeEvents, _currTimeEvents ? _dimTimeEvent : 0, state.currTimeEvents);
+  state.timeEventData.resize(_timeEventData ? 2 * _dimTimeEvent : 0);
+  for (size_t i = 0; i < state.timeEventData.size() / 2; i++)
+  {
+    state.timeEventData[2 * i] = _timeEventData[i].first;
+    state.timeEventData[2 * i + 1] = _timeEventData[i].second;
+  }
+
+  size_t dimClock = _clockInterval ? _dimClock : 0;
+  state.clockData.resize(3 * dimClock);
+  state.clockFlags.resize(3 * dimClock);
+  for (size_t i = 0; i < dimClock; i++)
+  {
+    state.clockData[3 * i] = _clockInterval[i];
+    state.clockData[3 * i + 1] = _clockShift[i];
+    state.clockData[3 * i + 2] = _clockTime[i];
+    state.clockFlags[3 * i] = _clockCondition[i];
+    state.clockFlags[3 * i + 1] = _clockStart[i];
+    state.clockFlags[3 * i + 2] = _clockSubactive[i];
+  }
+
+  // delay buffers are copied as they are, the capacity only grows during a simulation
+  state.delayTimes = _time_buffer;
+  state.delayValues = _delay_values;
+  state.delayCapacity = _delay_capacity;
+  state.delayHead = _delay_head;
+  state.delayCount = _delay_count;
+}
+
+void SystemDefaultImplementation::restoreState(const SystemState& state)
+{
+  shared_ptr<ISimVars> simVars = getSimVars();
+  size_t dimReal = simVars->getDimReal();
+  size_t dimInt = simVars->getDimInt();
+  size_t dimBool = simVars->getDimBool();
+
+  restoreValues(state.realVars, simVars->getRealVarsVector(), dimReal);
+  restoreValues(state.intVars, simVars->getIntVarsVector(), dimInt);
+  restoreValues(state.boolVars, simVars->getBoolVarsVector(), dimBool);
+  restoreValues(state.stringVars, simVars->getStringVarsVector(), simVars->getDimString());
+  restoreValues(state.preRealVars, simVars->getPreRealVarsVector(), dimReal);
+  restoreValues(state.preIntVars, simVars->getPreIntVarsVector(), dimInt);
+  restoreValues(state.preBoolVars, simVars->getPreBoolVarsVector(), dimBool);
+
+  restoreValues(state.conditions, _conditions, _conditions ? _dimZeroFunc : 0);
+  restoreValues(state.timeConditions, _time_conditions, _time_conditions ? _dimTimeEvent : 0);
+  restoreValues(state.currTimeEvents, _currTimeEvents, _currTimeEvents ? _dimTimeEvent : 0);
+  if (state.timeEventData.size() != (_timeEventData ? 2 * _dimTimeEvent : 0))
+    throw ModelicaSimulationError(MODEL_EQ_SYSTEM, "system state does not match the dimensions of the system");
+  for (size_t i = 0; i < state.timeEventData.size() / 2; i++)
+    _timeEventData[i] = std::make_pair(state.timeEventData[2 * i], state.timeEventData[2 * i + 1]);
+
+  size_t dimClock = _clockInterval ? _dimClock : 0;
+  if (state.clockData.size() != 3 * dimClock || state.clockFlags.size() != 3 * dimClock)
+    throw ModelicaSimulationError(MODEL_EQ_SYSTEM, "system state does not match the dimensions of the system");
+  for (size_t i = 0; i < dimClock; i++)
+  {
+    _clockInterval[i] = state.clockData[3 * i];
+    _clockShift[i] = state.clockData[3 * i + 1];
+    _clockTime[i] = state.clockData[3 * i + 2];
+    _clockCondition[i] = state.clockFlags[3 * i] != 0;
+    _clockStart[i] = state.clockFlags[3 * i + 1] != 0;
+    _clockSubactive[i] = state.clockFlags[3 * i + 2] != 0;
+  }
+
+  if (state.delayValues.size() != state.delayCapacity * (_delay_capacity > 0 ? _delay_values.size() / _delay_capacity : 0))
+    throw ModelicaSimulationError(MODEL_EQ_SYSTEM, "system state does not match the delay expressions of the system");
+  _time_buffer = state.delayTimes;
+  _delay_values = state.delayValues;
+  _delay_capacity = state.delayCapacity;
+  _delay_head = state.delayHead;
+  _delay_count = state.delayCount;
+
+  _simTime = state.simTime;
+  _start_time = state.startTime;
+  _initial = state.initial;
+  _terminal = state.terminal;
+  _terminate = state.terminate;
+}
+
+/// Version of the serialized system state, to be increased if the format changes
+static const unsigned int SYSTEM_STATE_VERSION = 1;
+
+template<typename T>
+static size_t serializedSize(const vector<T>& values)
+{
+  return sizeof(size_t) + values.size() * sizeof(T);
+}
+
+static size_t serializedSize(const vector<string>& values)
+{
+  size_t size = sizeof(size_t);
+  for (size_t i = 0; i < values.size(); i++)
+    size += sizeof(size_t) + values[i].size();
+  return size;
+}
+
+template<typename T>
+static void writeValue(char*& pos, const T& value)
+{
+  memcpy(pos, &value, sizeof(T));
+  pos += sizeof(T);
+}
+
+template<typename T>
+static void writeValues(char*& pos, const vector<T>& values)
+{
+  writeValue(pos, values.size());
+  if (values.size() > 0)
+    memcpy(pos, &values[0], values.size() * sizeof(T));
+  pos += values.size() * sizeof(T);
+}
+
+static void writeValues(char*& pos, const vector<string>& values)
+{
+  writeValue(pos, values.size());
+  for (size_t i = 0; i < values.size(); i++)
+  {
+    writeValue(pos, values[i].size());
+    memcpy(pos, values[i].data(), values[i].size());
+    pos += values[i].size();
+  }
+}
+
+template<typename T>
+static bool readValue(const char*& pos, const char* end, T& value)
+{
+  if ((size_t)(end - pos) < sizeof(T))
+    return false;
+  memcpy(&value, pos, sizeof(T));
+  pos += sizeof(T);
+  return true;
+}
+
+template<typename T>
+static bool readValues(const char*& pos, const char* end, vector<T>& values)
+{
+  size_t n;
+  if (!readValue(pos, end, n) || (size_t)(end - pos) / sizeof(T) < n)
+    return false;
+  values.resize(n);
+  if (n > 0)
+    memcpy(&values[0], pos, n * sizeof(T));
+  pos += n * sizeof(T);
+  return true;
+}
+
+static bool readValues(const char*& pos, const char* end, vector<string>& values)
+{
+  size_t n, length;
+  if (!readValue(pos, end, n) || (size_t)(end - pos) / sizeof(size_t) < n)
+    return false;
+  values.resize(n);
+  for (size_t i = 0; i < n; i++)
+  {
+    if (!readValue(pos, end, length) || (size_t)(end - pos) < length)
+      return false;
+    values[i].assign(pos, length);
+    pos += length;
+  }
+  return true;
+}
+
+SystemState::SystemState()
+  : simTime(0.0)
+  , startTime(0.0)
+  , initial(false)
+  , terminal(false)
+  , terminate(false)
+  , delayCapacity(0)
+  , delayHead(0)
+  , delayCount(0)
+{
+}
+
+size_t SystemState::getSerializedSize() const
+{
+  return sizeof(unsigned int) + 2 * sizeof(double) + 3 * sizeof(bool)
+    + serializedSize(realVars) + serializedSize(intVars) + serializedSize(boolVars) + serializedSize(stringVars)
+    + serializedSize(preRealVars) + serializedSize(preIntVars) + serializedSize(preBoolVars)
+    + serializedSize(conditions) + serializedSize(timeConditions) + serializedSize(timeEventData)
+    + serializedSize(currTimeEvents) + serializedSize(clockData) + serializedSize(clockFlags)
+    + serializedSize(delayTimes) + serializedSize(delayValues) + 3 * sizeof(size_t);
+}
+
+void SystemState::serialize(char* buffer) const
+{
+  char* pos = buffer;
+  writeValue(pos, SYSTEM_STATE_VERSION);
+  writeValue(pos, simTime);
+  writeValue(pos, startTime);
+  writeValue(pos, initial);
+  writeValue(pos, terminal);
+  writeValue(pos, terminate);
+  writeValues(pos, realVars);
+  writeValues(pos, intVars);
+  writeValues(pos, boolVars);
+  writeValues(pos, stringVars);
+  writeValues(pos, preRealVars);
+  writeValues(pos, preIntVars);
+  writeValues(pos, preBoolVars);
+  writeValues(pos, conditions);
+  writeValues(pos, timeConditions);
+  writeValues(pos, timeEventData);
+  writeValues(pos, currTimeEvents);
+  writeValues(pos, clockData);
+  writeValues(pos, clockFlags);
+  writeValues(pos, delayTimes);
+  writeValues(pos, delayValues);
+  writeValue(pos, delayCapacity);
+  writeValue(pos, delayHead);
+  writeValue(pos, delayCount);
+}
+
+bool SystemState::deserialize(const char* buffer, size_t size)
+{
+  const char* pos = buffer;
+  const char* end = buffer + size;
+  unsigned int version;
+  if (!readValue(pos, end, version) || version != SYSTEM_STATE_VERSION)
+    return false;
+  bool valid = readValue(pos, end, simTime)
+    && readValue(pos, end, startTime)
+    && readValue(pos, end, initial)
+    && readValue(pos, end, terminal)
+    && readValue(pos, end, terminate)
+    && readValues(pos, end, realVars)
+    && readValues(pos, end, intVars)
+    && readValues(pos, end, boolVars)
+    && readValues(pos, end, stringVars)
+    && readValues(pos, end, preRealVars)
+    && readValues(pos, end, preIntVars)
+    && readValues(pos, end, preBoolVars)
+    && readValues(pos, end, conditions)
+    && readValues(pos, end, timeConditions)
+    && readValues(pos, end, timeEventData)
+    && readValues(pos, end, currTimeEvents)
+    && readValues(pos, end, clockData)
+    && readValues(pos, end, clockFlags)
+    && readValues(pos, end, delayTimes)
+    && readValues(pos, end, delayValues)
+    && readValue(pos, end, delayCapacity)
+    && readValue(pos, end, delayHead)
+    && readValue(pos, end, delayCount);
+  return valid && pos == end
+    && delayTimes.size() == delayCapacity && delayHead < max(delayCapacity, (size_t)1) && delayCount <= delayCapacity;
+}
+
 /** @} */ // end of coreSystem
 
 /*
@@ -51,5 +51,17 @@ class DefaultContainerManager : public Writer
     {
       writeContainer(container);
     };
+    /**
+     * Containers are written directly, nothing has to be waited for.
+     */
+    virtual void waitForWriteQueue()
+    {
+    }
+    /**
+     * There is no writer thread that has to be stopped.
+     */
+    virtual void stopWriteThread()
+    {
+    }
 };
 /** @} */ // end of dataexchange
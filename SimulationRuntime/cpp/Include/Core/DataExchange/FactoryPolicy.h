@@ -2,7 +2,7 @@
 *
 *  @{
 */
-#if defined USE_PARALLEL_OUTPUT && defined USE_BOOST_THREAD
+#if defined USE_PARALLEL_OUTPUT && defined USE_THREAD
   #include <Core/DataExchange/ParallelContainerManager.h>
   typedef ParallelContainerManager ContainerManager;
 #else
@@ -28,7 +28,8 @@ public:
 
   virtual ~HistoryImpl()
   {
-
+    //write all pending output points before the results policy closes its file
+    ResultsPolicy::stopWriteThread();
   }
 
   /*
@@ -40,6 +41,7 @@ public:
 
   virtual void init()
   {
+    ResultsPolicy::waitForWriteQueue();
     ResultsPolicy::init(_globalSettings.getResultsFileName(), _dim);
   }
 
@@ -51,16 +53,19 @@ public:
 
   void getSimResults(const double time, ublas::vector<double>& v, ublas::vector<double>& dv)
   {
+    ResultsPolicy::waitForWriteQueue();
     ResultsPolicy::read(time,v,dv);
   }
 
   void getSimResults(ublas::matrix<double>& R, ublas::matrix<double>& dR)
   {
+    ResultsPolicy::waitForWriteQueue();
     ResultsPolicy::read(R,dR);
   }
 
   void getSimResults(ublas::matrix<double>& R, ublas::matrix<double>& dR, ublas::matrix<double>& Re)
   {
+    ResultsPolicy::waitForWriteQueue();
     ResultsPolicy::read(R, dR, Re);
   }
 
@@ -68,11 +73,25 @@ public:
   {
     //vector<unsigned int> ids;
     //boost::copy(_var_outputs | boost::adaptors::map_keys, std::back_inserter(ids));
+    ResultsPolicy::waitForWriteQueue();
     ResultsPolicy::read(Ro);
   }
 
+  virtual const double* getOutputValues(unsigned long index, unsigned long& size)
+  {
+    ResultsPolicy::waitForWriteQueue();
+    return ResultsPolicy::getOutputValues(index, size);
+  }
+
+  virtual const double* getTimeValues(unsigned long& size)
+  {
+    ResultsPolicy::waitForWriteQueue();
+    return ResultsPolicy::getTimeValues(size);
+  }
+
   unsigned long getSize()
   {
+    ResultsPolicy::waitForWriteQueue();
     return ResultsPolicy::size();
   }
 
@@ -94,12 +113,14 @@ public:
   vector<double> getTimeEntries()
   {
     vector<double> time;
+    ResultsPolicy::waitForWriteQueue();
     ResultsPolicy::getTime(time);
     return time;
   }
 
  virtual  void clear()
   {
+    ResultsPolicy::waitForWriteQueue();
     ResultsPolicy::eraseAll();
   };
   virtual void write(const all_vars_t& v_list, double start_time, double end_time)
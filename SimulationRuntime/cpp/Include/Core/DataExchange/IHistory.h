@@ -134,6 +134,15 @@ public:
   */
   virtual void getOutputResults(ublas::matrix<double>& OR)=0;
   /**
+  Returns the values of an output variable for all time entries without copying them,
+  NULL if the results are not kept in memory. The values are valid until the next write or clear
+  */
+  virtual const double* getOutputValues(unsigned long index, unsigned long& size)=0;
+  /**
+  Returns all time entries without copying them, NULL if the results are not kept in memory
+  */
+  virtual const double* getTimeValues(unsigned long& size)=0;
+  /**
   Retunrs all time entries
   */
   virtual vector<double> getTimeEntries() =0;
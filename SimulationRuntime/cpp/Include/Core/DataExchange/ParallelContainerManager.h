@@ -7,95 +7,280 @@
 #include <Core/Modelica.h>
 #include <Core/ModelicaDefine.h>
 
-#define CONTAINER_COUNT 3
+/** default number of preallocated output slots of the parallel writer, can be overwritten at compile time */
+#ifndef PARALLEL_OUTPUT_BUFFER_DEPTH
+  #define PARALLEL_OUTPUT_BUFFER_DEPTH 64
+#endif
 
 /**
- * This container manager is designed to write simulation results in parallel. It has multiple data containers that
- * can be filled with values. The write routine works asynchronously with the help of a consumer-producer-queue.
+ * Statistics of the parallel result output, used to tune the buffer depth.
+ */
+struct ParallelOutputStatistics
+{
+  /** number of slots of the ring buffer */
+  size_t bufferDepth;
+  /** number of output points handed over to the writer thread */
+  unsigned long enqueuedContainers;
+  /** number of output points written by the writer thread */
+  unsigned long writtenContainers;
+  /** number of times the simulation thread had to wait for a free slot */
+  unsigned long producerStalls;
+  /** maximum number of output points that were waiting to be written */
+  size_t maxQueueLength;
+};
+
+/**
+ * This container manager is designed to write simulation results in parallel. The simulation thread (producer)
+ * copies the values of all output variables into one of the preallocated slots of a single-producer/single-consumer
+ * ring buffer, the writer thread (consumer) writes the slots to the result file. Both sides exchange slots through
+ * two atomic indices without taking a lock, a mutex is only used to put a thread to sleep if the ring buffer is
+ * empty (writer) or full (simulation).
  */
 class ParallelContainerManager : public Writer
 {
   private:
-    deque<write_data_t > _writeContainers;
-    deque<write_data_t > _freeContainers;
-    semaphore _freeContainerMutex;
-    semaphore _writeContainerMutex;
-    semaphore _nempty;
+    /**
+     * A slot of the ring buffer. It owns a copy of all output values of one output point, the pointers of
+     * the container refer to this copy, so the simulation can continue while the slot is written.
+     */
+    struct OutputSlot
+    {
+      boost::container::vector<double> realValues;
+      boost::container::vector<int> intValues;
+      boost::container::vector<bool> boolValues;
+      boost::container::vector<double> derValues;
+      boost::container::vector<double> resValues;
+      write_data_t container;
+    };
+
+    vector<OutputSlot> _slots;
+    /** index of the next slot that is filled by the simulation thread, only written by the producer */
+    atomic<size_t> _head;
+    /** index of the next slot that is written by the writer thread, only written by the consumer */
+    atomic<size_t> _tail;
+    atomic<bool> _writerWaiting;
+    atomic<bool> _producerWaiting;
+    atomic<bool> _threadWorkDone;
+    mutex _waitMutex;
+    condition_variable _writerCondition;
+    condition_variable _producerCondition;
     thread _writerThread;
-    bool _threadWorkDone;
+    bool _writerThreadRunning;
+
+    unsigned long _enqueuedContainers;
+    atomic<unsigned long> _writtenContainers;
+    unsigned long _producerStalls;
+    size_t _maxQueueLength;
+
+    /**
+     * Copy the values the pointers in src are referring to into values and let dst refer to this copy.
+     */
+    template<typename T>
+    static void copyValues(const boost::container::vector<const T*>& src, boost::container::vector<T>& values,
+                           boost::container::vector<const T*>& dst)
+    {
+      size_t n = src.size();
+      if (values.size() != n)
+        values.resize(n);
+
+      for (size_t i = 0; i < n; ++i)
+        values[i] = *src[i];
+
+      if (dst.size() != n || (n > 0 && dst[0] != &values[0]))
+      {
+        dst.resize(n);
+        for (size_t i = 0; i < n; ++i)
+          dst[i] = &values[i];
+      }
+    }
+
+    size_t nextIndex(size_t index) const
+    {
+      return (index + 1 == _slots.size()) ? 0 : index + 1;
+    }
+
+    bool isEmpty() const
+    {
+      return _head.load() == _tail.load();
+    }
+
+    bool isFull() const
+    {
+      return nextIndex(_head.load()) == _tail.load();
+    }
 
   protected:
     void writeThread()
     {
-      std::cerr << "Parallel writer thread used" << std::endl;
-      while(!_threadWorkDone)
-        writeContainer();
+      while (true)
+      {
+        if (isEmpty())
+        {
+          unique_lock<mutex> lock(_waitMutex);
+          _writerWaiting = true;
+          while (isEmpty() && !_threadWorkDone)
+            _writerCondition.wait(lock);
+          _writerWaiting = false;
 
-      while(!_writeContainers.empty())
+          //the simulation is finished and all slots are written
+          if (isEmpty())
+            break;
+        }
         writeContainer();
+      }
     }
 
+    /**
+     * Write the oldest filled slot and hand it back to the simulation thread.
+     */
     void writeContainer()
     {
-      const write_data_t* container;
+      size_t tail = _tail.load();
+      const write_data_t& container = _slots[tail].container;
 
-      _writeContainerMutex.wait();
-      if (!_writeContainers.empty())
-        container = &_writeContainers.front();
+      write(get<0>(container), get<1>(container));
 
-      _writeContainerMutex.post();
+      _tail = nextIndex(tail);
+      _writtenContainers++;
 
-      if (!container)
+      if (_producerWaiting)
       {
-        usleep(5);
-        return;
+        unique_lock<mutex> lock(_waitMutex);
+        _producerCondition.notify_one();
       }
+    }
 
-      write(get<0>(*container),get<1>(*container));
-
-      _writeContainerMutex.wait();
-      _writeContainers.pop_front();
-      _writeContainerMutex.post();
+    /**
+     * Wait until the slot at the head of the ring buffer can be used by the simulation thread.
+     */
+    void waitForFreeSlot()
+    {
+      if (!isFull())
+        return;
 
-      _freeContainerMutex.wait();
-      _freeContainers.push_back(*container);
-      _freeContainerMutex.post();
-      _nempty.post();
+      _producerStalls++;
+      unique_lock<mutex> lock(_waitMutex);
+      _producerWaiting = true;
+      while (isFull())
+        _producerCondition.wait(lock);
+      _producerWaiting = false;
     }
 
   public:
-    ParallelContainerManager() : Writer()
-      , _writeContainers()
-      ,_freeContainers()
-      ,_freeContainerMutex(1)
-      ,_writeContainerMutex(1)
-      ,_nempty(CONTAINER_COUNT)
-      ,_writerThread(&ParallelContainerManager::writeThread, this)
+    ParallelContainerManager(size_t bufferDepth = PARALLEL_OUTPUT_BUFFER_DEPTH) : Writer()
+      ,_slots(max(bufferDepth, (size_t)1) + 1)
+      ,_head(0)
+      ,_tail(0)
+      ,_writerWaiting(false)
+      ,_producerWaiting(false)
       ,_threadWorkDone(false)
+      ,_waitMutex()
+      ,_writerCondition()
+      ,_producerCondition()
+      ,_writerThread()
+      ,_writerThreadRunning(false)
+      ,_enqueuedContainers(0)
+      ,_writtenContainers(0)
+      ,_producerStalls(0)
+      ,_maxQueueLength(0)
     {
+      _writerThread = thread(&ParallelContainerManager::writeThread, this);
+      _writerThreadRunning = true;
     }
 
     virtual ~ParallelContainerManager()
     {
-      _threadWorkDone = true;
-      _writerThread.join();
+      stopWriteThread();
     }
 
+    /**
+     * Get the slot that is filled next. The call blocks if all slots are waiting to be written.
+     * @return A reference to a container that can be filled with values.
+     */
     virtual write_data_t& getFreeContainer()
     {
-      _nempty.wait();
-      _freeContainerMutex.wait();
+      waitForFreeSlot();
+      return _slots[_head.load()].container;
+    };
+
+    /**
+     * Copy the current values of the given container into a free slot and pass it to the writer thread.
+     * @param container The container that should be written.
+     */
+    virtual void addContainerToWriteQueue(const write_data_t& container)
+    {
+      waitForFreeSlot();
 
-       write_data_t& container = _freeContainers.front();
-      _freeContainers.pop_front();
-      _freeContainerMutex.post();
+      size_t head = _head.load();
+      OutputSlot& slot = _slots[head];
+      const all_vars_time_t& vars = get<0>(container);
+      all_vars_time_t& slotVars = get<0>(slot.container);
 
-      return container;
-  };
+      copyValues(get<0>(vars), slot.realValues, get<0>(slotVars));
+      copyValues(get<1>(vars), slot.intValues, get<1>(slotVars));
+      copyValues(get<2>(vars), slot.boolValues, get<2>(slotVars));
+      get<3>(slotVars) = get<3>(vars);
+      copyValues(get<4>(vars), slot.derValues, get<4>(slotVars));
+      copyValues(get<5>(vars), slot.resValues, get<5>(slotVars));
+      if (&get<1>(slot.container) != &get<1>(container))
+        get<1>(slot.container) = get<1>(container);
 
-  virtual void addContainerToWriteQueue(const write_data_t& container)
-  {
-    _writeContainers.push_back(container);
-  };
+      _head = nextIndex(head);
+      _enqueuedContainers++;
+
+      size_t queueLength = _enqueuedContainers - _writtenContainers;
+      if (queueLength > _maxQueueLength)
+        _maxQueueLength = queueLength;
+
+      if (_writerWaiting)
+      {
+        unique_lock<mutex> lock(_waitMutex);
+        _writerCondition.notify_one();
+      }
+    };
+
+    /**
+     * Block until all queued output points are written to the result file.
+     */
+    virtual void waitForWriteQueue()
+    {
+      if (!_writerThreadRunning)
+        return;
+
+      unique_lock<mutex> lock(_waitMutex);
+      _producerWaiting = true;
+      while (!isEmpty())
+        _producerCondition.wait(lock);
+      _producerWaiting = false;
+    }
+
+    /**
+     * Write all queued output points and stop the writer thread. Has to be called before the
+     * result file of the derived policy is closed.
+     */
+    virtual void stopWriteThread()
+    {
+      if (!_writerThreadRunning)
+        return;
+
+      {
+        unique_lock<mutex> lock(_waitMutex);
+        _threadWorkDone = true;
+        _writerCondition.notify_one();
+      }
+      _writerThread.join();
+      _writerThreadRunning = false;
+    }
+
+    ParallelOutputStatistics getOutputStatistics() const
+    {
+      ParallelOutputStatistics statistics;
+      statistics.bufferDepth = _slots.size() - 1;
+      statistics.enqueuedContainers = _enqueuedContainers;
+      statistics.writtenContainers = _writtenContainers;
+      statistics.producerStalls = _producerStalls;
+      statistics.maxQueueLength = _maxQueueLength;
+      return statistics;
+    }
 };
 /** @} */ // end of dataexchange
@@ -5,39 +5,26 @@
  */
 #include "TextfileWriter.h"
 
-#include <boost/circular_buffer.hpp>
-typedef boost::container::vector<double> real_values_t;
-typedef boost::container::vector<int> int_values_t;
-typedef boost::container::vector<bool> bool_values_t;
-typedef boost::container::vector<double> der_values_t;
-typedef boost::container::vector<double> res_values_t;
-struct CopyVar {
-  template<class T>
-   T operator()(T* var) const {
-    return *var;
-  }
-};
+/**
+ * Keeps the simulation results in memory. The values are stored column wise, every output variable has its own
+ * contiguous array of values over all time entries, the time entries are kept in a sorted vector. The values of a
+ * variable can be accessed without copying them, see getOutputValues.
+ */
 class BufferReaderWriter : public ContainerManager
 {
-    //typedef TextFileWriter<dim_1,dim_2> TextwriterType;
 public:
     BufferReaderWriter(unsigned long size, string file_name)
-        : ContainerManager(),
-            _buffer_pos(0)
+        : ContainerManager()
+        , _column_capacity(size + size/5)
+        , _dim_real(0)
+        , _dim_int(0)
+        , _dim_bool(0)
+        , _dim_der(0)
+        , _dim_res(0)
     {
         try
         {
-
-            _real_variables_buffer.set_capacity(size+size/5);
-            _bool_variables_buffer.set_capacity(size+size/5);
-            _int_variables_buffer.set_capacity(size+size/5);
-            _der_variables_buffer.set_capacity(size+size/5);
-             _res_variables_buffer.set_capacity(size+size/5);
-
-            // cout<<"size+size/5 "<< size+size/5 << std::endl;
-
-
-            /*ToDo: use correct size for corresponding type*/
+            _time_values.reserve(_column_capacity);
         }
         catch(std::exception& ex)
         {
@@ -55,234 +42,44 @@ public:
     */
     void read(ublas::matrix<double>& R,ublas::matrix<double>& dR)
     {
-        /*
-        try
-        {
-            ublas::matrix<double>::size_type  m = size();
-            R.resize(dim_1,m);
-            for(int i=0;i<m;++i)
-                ublas::column(R,i)=_variables_buffer[i];
-            dR.resize(dim_2,m);
-            for(int i=0;i<m;++i)
-                ublas::column(dR,i)=_derivatives_buffer[i];
-        }
-        catch(std::exception& ex)
-        {
-            cout<<"read  from  buffer faild" << std::endl;
-            throw ex;
-        }
-        */
-
+        readColumns(_real_columns, _dim_real, R, "real Variables");
+        readColumns(_der_columns, _dim_der, dR, "derivatives");
     }
 
     void read(ublas::matrix<double>& R,ublas::matrix<double>& dR,ublas::matrix<double>& Re)
     {
-        /*
-        try
-        {
-            ublas::matrix<double>::size_type  m = size();
-            R.resize(dim_1,m);
-            for(int i=0;i<m;++i)
-                ublas::column(R,i)=_variables_buffer[i];
-            dR.resize(dim_2,m);
-            for(int i=0;i<m;++i)
-                ublas::column(dR,i)=_derivatives_buffer[i];
-            Re.resize(dim_3,m);
-            for(int i=0;i<m;++i)
-                ublas::column(Re,i)=_residues_buffer[i];
-        }
-        catch(std::exception& ex)
-        {
-            cout<<"read  from  buffer faild" << std::endl;
-            throw ex;
-        }
-        */
-
-         ublas::matrix<double>::size_type m = size();
-         cout<<"time in buffer "<< m << std::endl;
-        ublas::matrix<double>::size_type n =_dim_der;/*get<0>(_var_outputs).size() + get<1>(_var_outputs).size() + get<2>(_var_outputs).size()*/;
-       // cout<<"_dim_der "<< n << std::endl;
-
-        ublas::matrix<double>::size_type i,i2=0,j;
-        try
-        {
-            dR.resize(n,m);
-        }
-        catch(std::exception& ex)
-        {
-            cout<<"read  from derivative buffer faild alloc R with sizes "<<m <<"," << n << std::endl;
-            throw ModelicaSimulationError(DATASTORAGE,string("read  from derivatives buffer failed alloc dR matrix")+ex.what());
-
-        }
-         try
-        {
-            /*FOREACH(i,indices)*/
-            for(i=0;i<n;i++)
-            {
-                //cout<<"Var "<<i;
-                for(j=0;j<m;++j)
-                {
-                   // cout<<" t "<<j;
-                     dR(i2,j)= (_der_variables_buffer[j][i]);
-                   // cout<<" val "<<(_der_variables_buffer[j][i]) << std::endl;
-                }
-
-                i2++;
-            }
-
-              /*  ublas::vector<double> o_j;
-            for(i=0;i<n;i++)
-            {
-		    o_j = ublas::row(dR,i);
-            cout << "derivatives on read buffer " << o_j << std::endl;
-            }  */
-        }
-        catch(std::exception& ex)
-        {
-
-          throw ModelicaSimulationError(DATASTORAGE,string("read  from derivative buffer failed")+ex.what());
-
-        }
-
-         n =_dim_real;
-         i2=0;
-        // cout<<"_dim_real "<< n << std::endl;
-         try
-        {
-
-
-            R.resize(n,m);
-        }
-        catch(std::exception& ex)
-        {
-
-            throw ModelicaSimulationError(DATASTORAGE,string("read  from real Variables buffer failed alloc R matrix")+ex.what());
-
-        }
-         try
-        {
-
-            //FOREACH(i,indices)
-            for(i=0;i<n;i++)
-            {
-                for(j=0;j<m;++j)
-
-                    R(i2,j)= (_real_variables_buffer[j][i]);
-
-                    //ToDo: add int and bool variables
-                i2++;
-            }
-
-
-        }
-        catch(std::exception& ex)
-        {
-
-          throw ModelicaSimulationError(DATASTORAGE,string("read  from real buffer failed")+ex.what());
-
-        }
-        n =_dim_res;
-
-         i2=0;
-        // cout<<"_dim_res "<< n << std::endl;
-         try
-        {
-
-
-            Re.resize(n,m);
-        }
-        catch(std::exception& ex)
-        {
-
-            throw ModelicaSimulationError(DATASTORAGE,string("read  from residues Variables buffer failed alloc R matrix")+ex.what());
-
-        }
-         try
-        {
-
-
-            for(i=0;i<n;i++)
-            {
-                for(j=0;j<m;++j)
-
-                    Re(i2,j)= (_res_variables_buffer[j][i]);
-
-
-                i2++;
-            }
-        }
-        catch(std::exception& ex)
-        {
-
-          throw ModelicaSimulationError(DATASTORAGE,string("read  from residues Variables buffer failed")+ex.what());
-
-        }
-
-
+        readColumns(_der_columns, _dim_der, dR, "derivatives");
+        //ToDo: add int and bool variables
+        readColumns(_real_columns, _dim_real, R, "real Variables");
+        readColumns(_res_columns, _dim_res, Re, "residues Variables");
     }
 
     void read(ublas::matrix<double>& R)
     {
-
-        ublas::matrix<double>::size_type m = size();
-
-        ublas::matrix<double>::size_type n ;
-
+        size_t n;
         if(_var_outputs.size()!=0)
-
-            n= _var_outputs.size();/*get<0>(_var_outputs).size() + get<1>(_var_outputs).size() + get<2>(_var_outputs).size()*/
-
+            n = _var_outputs.size();
         else
-            n=_dim_real;
-
-       // cout<<"_dim_outputR "<< n << std::endl;
-        try
-        {
-
-
-            R.resize(n,m);
-        }
-        catch(std::exception& ex)
-        {
-           // cout<<"read  from variables buffer faild alloc R with sizes "<<m <<"," << n << std::endl;
-            throw ModelicaSimulationError(DATASTORAGE,string("read  from variables buffer failed alloc R matrix")+ex.what());
-
-        }
-         ublas::matrix<double>::size_type i,i2=0,j;
-         try
-        {
-            /*FOREACH(i,indices)*/
-            for(i=0;i<n;i++)
-            {
-                for(j=0;j<m;++j)
-                {
-                    R(i2,j)= (_real_variables_buffer[j][i]);
-
-                }
-
-                i2++;
-            }
-        }
-        catch(std::exception& ex)
-        {
-
-          throw ModelicaSimulationError(DATASTORAGE,string("read  from variables buffer failed")+ex.what());
-
-        }
-
+            n = _dim_real;
 
+        readColumns(_real_columns, n, R, "variables");
     }
 
+    /**
+    Reads the real variables (v) and derivatives (dv) of the given time entry
+    */
     void read(const double& time,ublas::vector<double>& dv,ublas::vector<double>& v)
     {
-        /*
-        std::map<double,unsigned long>::iterator iter;
-        iter = find_if( _time_entries.begin(), _time_entries.end(), floatCompare<double>(time, 1e-10) );
-        if(iter==_time_entries.end())
-            throw ModelicaSimulationError(MODEL_ARRAY_FUNCTION,string("getVariables: time parameters");
-        v=_variables_buffer[iter->second];
-        dv = _derivatives_buffer[iter->second];
-        */
+        size_t pos = findTime(time - 1e-10);
+        if(pos == _time_values.size() || _time_values[pos] > time + 1e-10)
+            throw ModelicaSimulationError(DATASTORAGE,"getSimResults: no results for the given time");
+
+        v.resize(_dim_real, false);
+        for(size_t i = 0; i < _dim_real; ++i)
+            v(i) = _real_columns[i][pos];
+        dv.resize(_dim_der, false);
+        for(size_t i = 0; i < _dim_der; ++i)
+            dv(i) = _der_columns[i][pos];
     }
 
     void read(const double& time,ublas::vector<double>& r,ublas::vector<double>& dv,ublas::vector<double>& v)
@@ -298,6 +95,31 @@ public:
        */
     }
 
+    /**
+    Returns the values of the output variable with the given index for all time entries. The values are not copied,
+    the pointer is valid until the next write or eraseAll.
+    @index index of the output variable
+    @size number of time entries
+    */
+    const double* getOutputValues(unsigned long index, unsigned long& size)
+    {
+        size = _time_values.size();
+        if(index >= _real_columns.size() || size == 0)
+            return NULL;
+        return &_real_columns[index][0];
+    }
+
+    /**
+    Returns the sorted time entries without copying them, the pointer is valid until the next write or eraseAll.
+    */
+    const double* getTimeValues(unsigned long& size)
+    {
+        size = _time_values.size();
+        if(size == 0)
+            return NULL;
+        return &_time_values[0];
+    }
+
     void write(const vector<string>& s)
     {
 
@@ -331,10 +153,17 @@ public:
           _dim_bool = get<2>(s_list).size();
           _dim_der = get<3>(s_list).size();
 
-          _real_values = real_values_t(_dim_real);
-          _int_values =  int_values_t(_dim_int);
-          _bool_values =  bool_values_t(_dim_bool);
-          _der_values =  der_values_t(_dim_der);
+        try
+        {
+          allocateColumns(_real_columns, _dim_real);
+          allocateColumns(_int_columns, _dim_int);
+          allocateColumns(_bool_columns, _dim_bool);
+          allocateColumns(_der_columns, _dim_der);
+        }
+        catch(std::exception& ex)
+        {
+           throw ModelicaSimulationError(DATASTORAGE,string("allocating   buffers failed")+ex.what());
+        }
 
         //_var_outputs = s_list;
 		_var_outputs.clear();
@@ -352,66 +181,30 @@ public:
      */
     virtual void write(const all_vars_time_t& v_list,const neg_all_vars_t& neg_v_list)
     {
-
-
         try
         {
+            double time = get<3>(v_list);
+            size_t pos = _time_values.size();
+            bool new_entry = true;
 
-            std::pair<std::map<double, unsigned long>::iterator,bool> p;
-            p = _time_entries.insert(make_pair(get<3>(v_list),_buffer_pos));
-
-            if(!p.second)//if variable and derivatives for time are already inserted, erase old values
+            //results are usually written in increasing time order, so the search is only needed at events
+            if(pos > 0 && time <= _time_values.back())
             {
-                //cout<< "size real "<< _real_variables_buffer.size() <<std::endl;
-                _real_variables_buffer.pop_back();
-                //cout << "size int " << _int_variables_buffer.size()<<std::endl;
-                _int_variables_buffer.pop_back();
-                //cout << "size bool " << _bool_variables_buffer.size()<<std::endl;
-                _bool_variables_buffer.pop_back();
-                _der_variables_buffer.pop_back();
-                _res_variables_buffer.pop_back();
-
+                pos = findTime(time);
+                //if variable and derivatives for time are already inserted, overwrite old values
+                new_entry = (_time_values[pos] != time);
             }
-            else
-            {
-                _buffer_pos++;
 
-            }
+            if(new_entry)
+                _time_values.insert(_time_values.begin() + pos, time);
 
             _dim_res = get<5>(v_list).size();
-            _res_values =  res_values_t(_dim_res);
-
-       /*   for (real_vars_t::const_iterator it = get<0>(v_list).begin(); it != get<0>(v_list).end(); ++it)
-        {
-
-             std::cout << *(*it)<<",";
-        }
-            std::cout<<"\n";  */
-
-             std::transform(get<0>(v_list).begin(),get<0>(v_list).end(),_real_values.begin(),CopyVar());
-             std::transform(get<1>(v_list).begin(),get<1>(v_list).end(),_int_values.begin(),CopyVar());
-             std::transform(get<2>(v_list).begin(),get<2>(v_list).end(),_bool_values.begin(),CopyVar());
-             std::transform(get<4>(v_list).begin(),get<4>(v_list).end(),_der_values.begin(),CopyVar());
-             std::transform(get<5>(v_list).begin(),get<5>(v_list).end(),_res_values.begin(),CopyVar());
-
-
-              _real_variables_buffer.push_back(_real_values);
-              _int_variables_buffer.push_back(_int_values);
-              _bool_variables_buffer.push_back(_bool_values);
-              _der_variables_buffer.push_back(_der_values);
-              _res_variables_buffer.push_back(_res_values);
-
-         // cout<<"output values on write buffer "<< std::endl;
-
-      /*      for (real_values_t::const_iterator it = _real_values.begin(); it != _real_values.end(); ++it)
-        {
-
-             std::cout << *it<<",";
-        }
-            std::cout<<"\n"; */
-
-           //_all_var_size=get<0>(v_list).size();// now just  real variables are supported
 
+            storeValues(_real_columns, get<0>(v_list), pos, new_entry);
+            storeValues(_int_columns, get<1>(v_list), pos, new_entry);
+            storeValues(_bool_columns, get<2>(v_list), pos, new_entry);
+            storeValues(_der_columns, get<4>(v_list), pos, new_entry);
+            storeValues(_res_columns, get<5>(v_list), pos, new_entry);
         }
         catch(std::exception& ex)
         {
@@ -419,8 +212,6 @@ public:
             throw ModelicaSimulationError(DATASTORAGE,string("write to buffer failed")+ex.what());
 
         }
-
-        // textwriter->write(v,v2, time);
     }
 
 
@@ -428,11 +219,7 @@ public:
     {
         try
         {
-            typedef std::pair<double, unsigned long> pair_double_ulong;
-            FOREACH(pair_double_ulong i, _time_entries)
-            {
-                time.push_back(i.first);
-            }
+            time.insert(time.end(), _time_values.begin(), _time_values.end());
         }
         catch(std::exception& ex)
         {
@@ -443,62 +230,118 @@ public:
     }
     unsigned long size()
     {
-        try
+        return _time_values.size();
+    }
+    void eraseAll()
+    {
+        //the allocated memory of the columns is kept for the next simulation run
+        _time_values.clear();
+        clearColumns(_real_columns);
+        clearColumns(_int_columns);
+        clearColumns(_bool_columns);
+        clearColumns(_der_columns);
+        clearColumns(_res_columns);
+    }
+
+
+protected:
+    typedef vector<vector<double> > real_columns_type;
+    typedef vector<vector<int> > int_columns_type;
+    typedef vector<vector<bool> > bool_columns_type;
+
+    /**
+    Position of the first time entry that is not less than time
+    */
+    size_t findTime(double time) const
+    {
+        return std::lower_bound(_time_values.begin(), _time_values.end(), time) - _time_values.begin();
+    }
+
+    template<typename T>
+    void allocateColumns(vector<vector<T> >& columns, size_t dim)
+    {
+        //the time entries have to match the (empty) columns
+        _time_values.clear();
+        columns.resize(dim);
+        for(size_t i = 0; i < dim; ++i)
         {
-        return _time_entries.size();
+            columns[i].clear();
+            columns[i].reserve(_column_capacity);
         }
-        catch(std::exception& ex)
-        {
+    }
+
+    template<typename T>
+    static void clearColumns(vector<vector<T> >& columns)
+    {
+        for(size_t i = 0; i < columns.size(); ++i)
+            columns[i].clear();
+    }
 
-            throw ModelicaSimulationError(DATASTORAGE,string("time entries size failed")+ex.what());
+    /**
+    Stores the values the pointers in vars are referring to at time entry pos of the columns
+    @new_entry insert a new time entry at pos, otherwise the values of the time entry are overwritten
+    */
+    template<typename T>
+    void storeValues(vector<vector<T> >& columns, const boost::container::vector<const T*>& vars, size_t pos, bool new_entry)
+    {
+        size_t n = vars.size();
+        if(columns.size() < n)
+        {
+            //variables that were not announced with the names, e.g. residues, get zero values for the previous time entries
+            size_t m = _time_values.size() - (new_entry ? 1 : 0);
+            size_t i = columns.size();
+            columns.resize(n);
+            for(; i < n; ++i)
+            {
+                columns[i].reserve(max(_column_capacity, m + 1));
+                columns[i].resize(m, T());
+            }
+        }
 
+        if(new_entry)
+        {
+            for(size_t i = 0; i < n; ++i)
+                columns[i].insert(columns[i].begin() + pos, *vars[i]);
+        }
+        else
+        {
+            for(size_t i = 0; i < n; ++i)
+                columns[i][pos] = *vars[i];
         }
     }
-    void eraseAll()
+
+    /**
+    Copies the first n columns into the rows of R, Rij i variable index, j time index
+    */
+    void readColumns(const real_columns_type& columns, size_t n, ublas::matrix<double>& R, const char* name)
     {
-        try{
-        _real_variables_buffer.clear();
-        _int_variables_buffer.clear();
-         _bool_variables_buffer.clear();
-        _der_variables_buffer.clear();
-        _res_variables_buffer.clear();
-        //_residues_buffer.clear();
-        _time_entries.clear();
-        _buffer_pos=0;
-        //textwriter->eraseAll();
+        size_t m = size();
+        try
+        {
+            R.resize(n, m, false);
         }
-
         catch(std::exception& ex)
         {
-
-            throw ModelicaSimulationError(DATASTORAGE,string("can not erase buffer of variables")+ex.what());
-
+            throw ModelicaSimulationError(DATASTORAGE,string("read  from ") + name + " buffer failed alloc matrix" + ex.what());
         }
 
-    }
-
+        if(m == 0)
+            return;
+        if(n > columns.size())
+            throw ModelicaSimulationError(DATASTORAGE,string("read  from ") + name + " buffer failed");
 
-protected:
+        //ublas matrices are stored row major, so every column of the buffer is copied to a contiguous row
+        for(size_t i = 0; i < n; ++i)
+            std::copy(columns[i].begin(), columns[i].begin() + m, &R(i, 0));
+    }
 
-    typedef boost::circular_buffer<  real_values_t > real_buffer_type;
-     typedef boost::circular_buffer<  int_values_t   > int_buffer_type;
-    typedef boost::circular_buffer<  bool_values_t   > bool_buffer_type;
-    typedef boost::circular_buffer<  der_values_t> der_buffer_type;
-    typedef boost::circular_buffer<  res_values_t> res_buffer_type;
-     //typedef boost::circular_buffer< boost::container::vector<double>> buffer_type;
-
-    typedef std::map<double,unsigned long> _time_entries_type;
-
-    real_buffer_type _real_variables_buffer;
-    int_buffer_type _int_variables_buffer;
-    bool_buffer_type _bool_variables_buffer;
-     der_buffer_type _der_variables_buffer;
-     res_buffer_type _res_variables_buffer;
-     //buffer_type buffer_var;
-
-    //buffer_type_r _residues_buffer;
-    _time_entries_type _time_entries;
-    unsigned long _buffer_pos;
+    size_t _column_capacity;
+    vector<double> _time_values;
+    real_columns_type _real_columns;
+    int_columns_type _int_columns;
+    bool_columns_type _bool_columns;
+    real_columns_type _der_columns;
+    real_columns_type _res_columns;
     vector<string> _var_outputs;
 
     size_t _dim_real;
@@ -506,11 +349,5 @@ protected:
     size_t _dim_bool;
     size_t _dim_der;
     size_t _dim_res;
-
-    real_values_t  _real_values;
-    int_values_t   _int_values;
-    bool_values_t  _bool_values;
-    der_values_t  _der_values;
-    res_values_t  _res_values;
 };
 /** @} */ // end of dataexchangePolicies
@@ -23,6 +23,10 @@ using std::ios;
 */
 #include <Core/DataExchange/FactoryPolicy.h>
 
+/** size of the buffer in bytes that collects output points before they are appended to the "data_2" matrix */
+#ifndef MAT_FILE_WRITER_BLOCK_SIZE
+  #define MAT_FILE_WRITER_BLOCK_SIZE (1 << 20)
+#endif
 
 class MatFileWriter : public ContainerManager
 {
@@ -33,6 +37,9 @@ class MatFileWriter : public ContainerManager
               _dataEofPos(),
               _curser_position(0),
               _uiValueCount(0),
+              _uiRowSize(0),
+              _uiBlockRows(0),
+              _uiBufferedRows(0),
               _file_name(file_name),
               _doubleMatrixData1(NULL),
               _doubleMatrixData2(NULL),
@@ -44,6 +51,10 @@ class MatFileWriter : public ContainerManager
     }
     ~MatFileWriter()
     {
+        // append the output points that are still buffered
+        if (_output_stream.is_open())
+            flushDataBlock();
+
         // free memory and initialize pointer
         delete[] _doubleMatrixData1;
         delete[] _doubleMatrixData2;
@@ -239,8 +250,12 @@ class MatFileWriter : public ContainerManager
 
         _file_name = file_name;
 
+        // append the output points that are still buffered to the previous file
         if (_output_stream.is_open())
+        {
+            flushDataBlock();
             _output_stream.close();
+        }
 
         // open new file
         _output_stream.open(file_name.c_str(), ios::binary | ios::trunc);
@@ -256,14 +271,17 @@ class MatFileWriter : public ContainerManager
         _dataEofPos = 0;
 
         _doubleMatrixData1 = NULL;
-        _doubleMatrixData2 = NULL;
         _stringMatrix = NULL;
         _pacString = NULL;
         _intMatrix = NULL;
 
-        // allocate temp buffer for simulation data:
-        // dim_1 (number of variables) + dim_2 (number of der. variables) + 1 (time)
-        _doubleMatrixData2 = new double[dim + 1];
+        // the block buffer for simulation data is allocated with the first output point,
+        // because the number of output variables is known there
+        delete[] _doubleMatrixData2;
+        _doubleMatrixData2 = NULL;
+        _uiRowSize = 0;
+        _uiBlockRows = 0;
+        _uiBufferedRows = 0;
     }
 
     /*=={function}===================================================================================*/
@@ -684,7 +702,8 @@ class MatFileWriter : public ContainerManager
      *
      *  brief:
      *  ------
-     *  function writes variables, which are NOT constant over simulation time
+     *  function writes variables, which are NOT constant over simulation time.
+     *  The values are collected in a block buffer that is appended to the file when it is full
      *
      * \param[in]       v_list
      * \n        usage: list with names of the simulation variables
@@ -706,54 +725,72 @@ class MatFileWriter : public ContainerManager
         unsigned int uiVarCount = get<0>(v_list).size() + get<1>(v_list).size() + get<2>(v_list).size() + 1;  // alle Variablen, alle abgeleiteten Variablen und die Zeit
         double *doubleHelpMatrix = NULL;
 
+        // (re)allocate the block buffer, it holds as many rows as fit into MAT_FILE_WRITER_BLOCK_SIZE
+        if (uiVarCount != _uiRowSize)
+        {
+            flushDataBlock();
+            delete[] _doubleMatrixData2;
+            _uiRowSize = uiVarCount;
+            _uiBlockRows = max((unsigned int)(MAT_FILE_WRITER_BLOCK_SIZE / (sizeof(double) * uiVarCount)), 1u);
+            _doubleMatrixData2 = new double[_uiBlockRows * uiVarCount];
+        }
+
         _uiValueCount++;
 
-        // reset tempbuffer to zero
-        memset(_doubleMatrixData2, 0, sizeof(double) * uiVarCount);
-        doubleHelpMatrix = _doubleMatrixData2;
+        // every entry of the row is written below, so the buffer needn't be reset
+        doubleHelpMatrix = _doubleMatrixData2 + _uiBufferedRows * uiVarCount;
 
         // first time ist written to "data_2" matrix...
         *doubleHelpMatrix = get<3>(v_list);
         doubleHelpMatrix++;
 
         // ...followed by real variable values...
-        /*for (real_vars_t::const_iterator it = get<0>(v_list).begin(); it != get<0>(v_list).end(); ++it)
-        {
-            *doubleHelpMatrix = *(*it);
-            doubleHelpMatrix++;
-        }*/
-
         std::transform(get<0>(v_list).begin(), get<0>(v_list).end(), get<0>(neg_v_list).begin(),
             doubleHelpMatrix, WriteOutputVar<double>());
+        doubleHelpMatrix += get<0>(v_list).size();
 
-
-        // ...followed by int variable values.
-        /*for (int_vars_t::const_iterator it = get<1>(v_list).begin(); it != get<1>(v_list).end(); ++it)
-        {
-            *doubleHelpMatrix = *(*it);
-            doubleHelpMatrix++;
-        }*/
-            size_t nReal = get<0>(v_list).size();
+        // ...followed by int variable values...
         std::transform(get<1>(v_list).begin(), get<1>(v_list).end(), get<1>(neg_v_list).begin(),
-            doubleHelpMatrix + nReal, WriteOutputVar<int>());
+            doubleHelpMatrix, WriteOutputVar<int>());
+        doubleHelpMatrix += get<1>(v_list).size();
+
         // ...followed by bool variable values.
-        /*for (bool_vars_t::const_iterator it = get<2>(v_list).begin(); it != get<2>(v_list).end(); ++it)
-        {
-            *doubleHelpMatrix = *(*it);
-            doubleHelpMatrix++;
-        }
-        */
-             size_t nInt = get<1>(v_list).size();
         std::transform(get<2>(v_list).begin(), get<2>(v_list).end(), get<2>(neg_v_list).begin(),
-            doubleHelpMatrix+nReal+nInt, WriteOutputVar<bool>());
+            doubleHelpMatrix, WriteOutputVar<bool>());
 
-        // write matrix to file
-        writeMatVer4Matrix("data_2", uiVarCount, _uiValueCount, _doubleMatrixData2, sizeof(double));
+        // write the block to file if it is complete
+        if (++_uiBufferedRows == _uiBlockRows)
+            flushDataBlock();
 
         // initialize pointer
         doubleHelpMatrix = NULL;
     }
 
+    /*=={function}===================================================================================*/
+    /*!
+     *  void flushDataBlock()
+     *
+     *  brief:
+     *  ------
+     *  function appends all buffered output points to the "data_2" matrix with one write call
+     *  and updates the number of columns in the matrix header
+     *
+     * \return
+     */
+    /*========================================================================================{end}==*/
+    void flushDataBlock()
+    {
+        if (_uiBufferedRows == 0)
+            return;
+
+        // the header is written with the first block and patched with every following block
+        writeMatVer4MatrixHeader("data_2", _uiRowSize, _uiValueCount, sizeof(double));
+        _output_stream.write((const char*) _doubleMatrixData2, sizeof(double) * _uiRowSize * _uiBufferedRows);
+        _output_stream.flush();
+
+        _uiBufferedRows = 0;
+    }
+
     /*=================================================================================*/
     /*
      *    the following functions are not used, but must be declared
@@ -784,6 +821,20 @@ class MatFileWriter : public ContainerManager
         //not supported for file output
     }
 
+    const double* getOutputValues(unsigned long index, unsigned long& size)
+    {
+        //not supported for file output
+        size = 0;
+        return NULL;
+    }
+
+    const double* getTimeValues(unsigned long& size)
+    {
+        //not supported for file output
+        size = 0;
+        return NULL;
+    }
+
     void getTime(std::vector<double>& time)
     {
         //not supported for file output
@@ -807,6 +858,9 @@ class MatFileWriter : public ContainerManager
     std::ofstream::pos_type _dataEofPos;
     unsigned int _curser_position;
     unsigned int _uiValueCount;
+    unsigned int _uiRowSize;
+    unsigned int _uiBlockRows;
+    unsigned int _uiBufferedRows;
     std::string _file_name;
     double *_doubleMatrixData1;
     double *_doubleMatrixData2;
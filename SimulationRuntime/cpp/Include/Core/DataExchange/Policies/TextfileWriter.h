@@ -126,6 +126,20 @@ class TextFileWriter : public ContainerManager
         _output_stream << std::endl;
     }
 
+    const double* getOutputValues(unsigned long index, unsigned long& size)
+    {
+        //not supported for file output
+        size = 0;
+        return NULL;
+    }
+
+    const double* getTimeValues(unsigned long& size)
+    {
+        //not supported for file output
+        size = 0;
+        return NULL;
+    }
+
     void getTime(std::vector<double>& time)
     {
         //not supported for file output
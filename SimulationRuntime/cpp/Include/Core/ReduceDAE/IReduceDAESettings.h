@@ -28,6 +28,8 @@ public:
 	virtual void setReductionMethod(unsigned int)=0;
 	virtual unsigned int getNFail()=0;
 	virtual void setNFail(unsigned int)=0;
+	virtual unsigned int getRankingThreads()=0;
+	virtual void setRankingThreads(unsigned int)=0;
 	virtual ublas::vector<double> getMaxError()=0;
 	virtual void setMaxError(ublas::vector<double>& error)=0;
 	virtual IGlobalSettings* getGlobalSettings()=0;
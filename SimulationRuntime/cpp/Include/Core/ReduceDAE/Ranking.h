@@ -12,6 +12,26 @@ public:
                                               string modelKey,vector<string> output_names, double timeout,ISimController* sim_controller);
 private:
 	//methods:
+	double rankLabel(unsigned int labelIndex, ublas::matrix<double>& Ro, shared_ptr<IMixedSystem> system, IReduceDAESettings* settings,
+	                 SimSettings& simsettings, string& modelKey, vector<string>& output_names, double timeout, ISimController* sim_controller);
+#if defined(USE_THREAD)
+	/// State of one thread of the parallel perfect ranking
+	struct RankingWorker
+	{
+		shared_ptr<ISimController> sim_controller;	///< controller with an own instance of the system
+		IReduceDAESettings* settings;
+		ublas::matrix<double>* Ro;
+		SimSettings simsettings;	///< own copy of the settings with a separate result file
+		string* modelKey;
+		vector<string>* output_names;
+		double timeout;
+		vector<double>* rank_vector;
+		atomic<unsigned int>* next_label;	///< index of the next label that is ranked, shared by all workers
+		string error;
+	};
+	void rankLabelsWorker(RankingWorker* worker);
+	mutex _output_mutex;	///< serializes the progress output of the workers
+#endif
 	IReduceDAESettings* _settings;
     shared_ptr<IMixedSystem>  _system;
 	double	*_zeroVal;
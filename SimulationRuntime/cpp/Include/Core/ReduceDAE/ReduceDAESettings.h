@@ -18,6 +18,10 @@ public:
 	virtual unsigned int getNFail();
 	//Sets the number of restarts
 	virtual void setNFail(unsigned int);
+	//Returns the number of label simulations of the perfect ranking that run concurrently
+	virtual unsigned int getRankingThreads();
+	//Sets the number of concurrent label simulations
+	virtual void setRankingThreads(unsigned int);
     //Returns value of error bound to stop reduction
 	//Returns the maximum error of each outputvaribale
 	virtual ublas::vector<double> getMaxError();
@@ -34,7 +38,8 @@ private:
 	unsigned int
 		_ranking_method,				///< ranking mehtod
 		_reduction_method,				///< reduction mehtod
-		_nfail;							///< number of restarts after error bound was reached
+		_nfail,							///< number of restarts after error bound was reached
+		_ranking_threads;				///< number of concurrent simulations of the perfect ranking
 	ublas::vector<double>
 		_max_error;						///< max error for all output variables, used in reduction algorithm
 
@@ -53,6 +58,7 @@ private:
 
 			ar & make_nvp("NFail", _nfail);
 			ar & make_nvp("RakingMethod", _ranking_method);
+			ar & make_nvp("RankingThreads", _ranking_threads);
 
 			ar & make_nvp("ReductionMethod", _reduction_method);
 
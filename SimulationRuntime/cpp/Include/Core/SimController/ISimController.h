@@ -25,6 +25,8 @@ struct SimSettings
   EmitResults emitResults;
   string inputPath;
   string outputPath;
+  bool useSparseFormat;
+  bool nonLinearSolverJacobianReuse;
 };
 
 /**
@@ -44,6 +46,11 @@ public:
   virtual void initialize(SimSettings simsettings, string modelKey, double timeout)=0;
   virtual void StartReduceDAE(SimSettings simsettings,string modelPath, string modelKey, bool loadMSL, bool loadPackage)=0;
   virtual void runReducedSimulation()=0;
+  /**
+   *    Creates a new controller with its own instance of a loaded system (variables, result history,
+   *    settings and solver), so that both controllers can simulate concurrently
+   */
+  virtual shared_ptr<ISimController> cloneController(string modelKey) = 0;
   /**
    *    Stops the simulation
    */
@@ -23,11 +23,13 @@ public:
     virtual void StartReduceDAE(SimSettings simsettings,string modelPath, string modelKey,bool loadMSL, bool loadPackage);
     virtual void initialize(SimSettings simsettings, string modelKey, double timeout);
      virtual void runReducedSimulation();
+    virtual shared_ptr<ISimController> cloneController(string modelKey);
 private:
     void initialize(PATH library_path, PATH modelicasystem_path);
     bool _initialized;
     shared_ptr<Configuration> _config;
     std::map<string, shared_ptr<IMixedSystem> > _systems;
+    std::map<string, string> _systemLibs; ///< library of each system loaded with LoadSystem
 
 
 
@@ -60,6 +60,8 @@ public:
 
   virtual void setNonLinearSolverContinueOnError(bool);
   virtual bool getNonLinearSolverContinueOnError();
+  virtual void setNonLinearSolverJacobianReuse(bool);
+  virtual bool getNonLinearSolverJacobianReuse();
 
   virtual void setSolverThreads(int);
   virtual int getSolverThreads();
@@ -74,7 +76,8 @@ private:
   bool
       _infoOutput,  ///< Write out statistical simulation infos, e.g. number of steps (at the end of simulation); [false,true]; default: true)
       _endless_sim,
-      _nonLinSolverContinueOnError;
+      _nonLinSolverContinueOnError,
+      _nonLinSolverJacobianReuse;
   string
       _input_path,
       _output_path,
@@ -100,6 +100,8 @@ public:
 
   virtual void setNonLinearSolverContinueOnError(bool) = 0;
   virtual bool getNonLinearSolverContinueOnError() = 0;
+  virtual void setNonLinearSolverJacobianReuse(bool) = 0;
+  virtual bool getNonLinearSolverJacobianReuse() = 0;
 
   virtual void setSolverThreads(int) = 0;
   virtual int getSolverThreads() = 0;
@@ -27,5 +27,8 @@ public:
   virtual void load(string) = 0;
   virtual void setContinueOnError(bool) = 0;
   virtual bool getContinueOnError() = 0;
+  /// Keep the factorized jacobian across iterations and steps as long as the iteration converges fast enough
+  virtual void setJacobianReuse(bool) = 0;
+  virtual bool getJacobianReuse() = 0;
 };
  /** @} */ // end of coreSolver
@@ -42,6 +42,9 @@ public:
   virtual void setATol(double) = 0;
   virtual double getRTol() = 0;
   virtual void setRTol(double) = 0;
+  /// Use a sparse direct linear solver for the jacobian of implicit integrators if available (default: false)
+  virtual bool getUseSparseFormat() = 0;
+  virtual void setUseSparseFormat(bool) = 0;
 
   /// Global simulation settings
   virtual IGlobalSettings* getGlobalSettings() = 0;
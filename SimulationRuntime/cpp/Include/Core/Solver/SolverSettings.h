@@ -43,6 +43,8 @@ public:
   virtual void setATol(double);
   virtual double getRTol();
   virtual void setRTol(double);
+  virtual bool getUseSparseFormat();
+  virtual void setUseSparseFormat(bool);
 
   ///  Global simulation settings
   virtual IGlobalSettings* getGlobalSettings();
@@ -60,6 +62,7 @@ private:
     _globalSettings;    ///< Global simulation settings
 
   bool
-    _denseOutput;
+    _denseOutput,
+    _useSparseFormat;   ///< Use a sparse direct linear solver for the jacobian (default: false)
 };
  /** @} */ // end of coreSolver
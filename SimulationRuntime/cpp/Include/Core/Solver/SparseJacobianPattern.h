@@ -0,0 +1,63 @@
+#pragma once
+/** @addtogroup coreSolver
+ *
+ *  @{
+ */
+#if defined(__TRICORE__) || defined(__vxworks)
+#define BOOST_EXTENSION_SOLVER_DECL
+#endif
+
+/**
+ * Sparsity pattern of the state jacobian A in compressed sparse column (CSC) format, as it is used by the
+ * sparse direct linear solvers (KLU) of the sundials integrators. The pattern is read from the sparse jacobian
+ * of the system, the column coloring is grouped by color so that a colored finite difference approximation
+ * can fill the CSC values directly.
+ */
+class BOOST_EXTENSION_SOLVER_DECL SparseJacobianPattern
+{
+public:
+  SparseJacobianPattern();
+  ~SparseJacobianPattern();
+
+  /**
+   * Read the pattern and the column coloring of the state jacobian.
+   * @param system system with a sparse state jacobian (IMixedSystem::isJacobianSparse)
+   * @param dim number of states
+   * @param addDiagonal add all diagonal elements to the pattern, needed for iteration matrices like J - cj*I
+   * @return false if the system does not provide a sparse jacobian of the given dimension, e.g. if it was
+   *         generated without symbolic jacobian
+   */
+  bool initialize(IMixedSystem* system, int dim, bool addDiagonal);
+
+  int getDimension() const { return _dim; }
+  int getNonZeros() const { return (int)_rowIndices.size(); }
+  const int* getColumnPointers() const { return &_colPtrs[0]; }
+  const int* getRowIndices() const { return &_rowIndices[0]; }
+
+  /// Copy the pattern to the given CSC index arrays (dim + 1 column pointers, nonzeros row indices)
+  void copyPattern(int* colPtrs, int* rowIndices) const;
+  /// Scatter the elements of a sparse jacobian with (a subset of) this pattern into the CSC value array
+  void copyValues(const sparsematrix_t& A, double* values) const;
+  /// Set the diagonal elements that are not part of the jacobian itself to zero
+  void resetAddedDiagonal(double* values) const;
+  /// Position of the diagonal element of a column in the value array, -1 if it is not part of the pattern
+  int getDiagonalIndex(int col) const { return _diagIndex[col]; }
+
+  int getMaxColors() const { return (int)_colorPtrs.size() - 1; }
+  /// Columns of the given color (0-based), they can be perturbed at once
+  const int* getColumnsOfColor(int color, int& numColumns) const
+  {
+    numColumns = _colorPtrs[color + 1] - _colorPtrs[color];
+    return &_colorColumns[_colorPtrs[color]];
+  }
+
+private:
+  int _dim;
+  vector<int> _colPtrs;
+  vector<int> _rowIndices;
+  vector<int> _diagIndex;
+  vector<int> _addedDiagIndex;
+  vector<int> _colorPtrs;
+  vector<int> _colorColumns;
+};
+ /** @} */ // end of coreSolver
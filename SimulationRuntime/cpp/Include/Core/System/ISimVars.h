@@ -67,5 +67,9 @@ public:
      virtual double& getPreVar(const double& var)=0;
      virtual int& getPreVar(const int& var)=0;
      virtual bool& getPreVar(const bool& var)=0;
+     /*access methods for all pre-variables*/
+     virtual double* getPreRealVarsVector() const = 0;
+     virtual int* getPreIntVarsVector() const = 0;
+     virtual bool* getPreBoolVarsVector() const = 0;
 };
 /** @} */ // end of coreSystem
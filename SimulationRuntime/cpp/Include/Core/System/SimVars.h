@@ -110,6 +110,9 @@ class BOOST_EXTENSION_SIMVARS_DECL SimVars: public ISimVars
     virtual double& getPreVar(const double& var);
     virtual int& getPreVar(const int& var);
     virtual bool& getPreVar(const bool& var);
+    virtual double* getPreRealVarsVector() const;
+    virtual int* getPreIntVarsVector() const;
+    virtual bool* getPreBoolVarsVector() const;
 
     virtual size_t getDimString() const;
     virtual size_t getDimBool() const;
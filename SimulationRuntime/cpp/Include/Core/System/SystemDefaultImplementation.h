@@ -39,6 +39,47 @@ private:
   unordered_map<T*, T> _start_values;
 };
 
+/**
+ * Snapshot of the complete state of a system: all variables and pre variables, the simulation time,
+ * the event conditions, the time event and clock data and the delay history.
+ * The buffers keep their memory, saving a system into the same snapshot again does not allocate.
+ */
+struct BOOST_EXTENSION_SYSTEM_DECL SystemState
+{
+  SystemState();
+
+  /// Number of bytes of the serialized snapshot
+  size_t getSerializedSize() const;
+  /// Write the snapshot to buffer, which has to hold getSerializedSize() bytes
+  void serialize(char* buffer) const;
+  /// Read a snapshot written by serialize, returns false if the data is not a valid snapshot
+  bool deserialize(const char* buffer, size_t size);
+
+  double simTime;
+  double startTime;
+  bool initial;
+  bool terminal;
+  bool terminate;
+  vector<double> realVars;
+  vector<int> intVars;
+  vector<char> boolVars;
+  vector<string> stringVars;
+  vector<double> preRealVars;
+  vector<int> preIntVars;
+  vector<char> preBoolVars;
+  vector<char> conditions;
+  vector<char> timeConditions;
+  vector<double> timeEventData;     ///< start time and interval of each time event
+  vector<double> currTimeEvents;
+  vector<double> clockData;         ///< interval, shift and time of each clock
+  vector<char> clockFlags;          ///< condition, start and subactive flag of each clock
+  vector<double> delayTimes;
+  vector<double> delayValues;
+  size_t delayCapacity;
+  size_t delayHead;
+  size_t delayCount;
+};
+
 class BOOST_EXTENSION_SYSTEM_DECL SystemDefaultImplementation
 {
 public:
@@ -136,6 +177,10 @@ public:
 
   shared_ptr<ISimData> getSimData();
   shared_ptr<ISimVars> getSimVars();
+  /// Save the complete state of the system, e.g. to roll back a rejected step
+  void saveState(SystemState& state);
+  /// Restore a state that was saved by saveState, throws if the state does not belong to this system
+  void restoreState(const SystemState& state);
 
   double computeNextTimeEvents(double currTime, std::pair<double, double>* timeEventPairs);
   void computeTimeEventConditions(double currTime);
@@ -217,11 +262,23 @@ protected:
         *__z,                 ///< "Extended state vector", containing all states and algebraic variables of all types
         *__zDot,              ///< "Extended vector of derivatives", containing all right hand sides of differential and algebraic equations
       *__daeResidual;
-    typedef std::deque<double> buffer_type;
-    typedef std::iterator_traits<buffer_type::iterator>::difference_type difference_type;
-    map<unsigned int, buffer_type> _delay_buffer;
-    buffer_type _time_buffer;
+    /// Delay history, a circular buffer of the time points and one row of values per delay expression
+    /// (struct of arrays). Logical index 0 is the oldest entry, it is stored at _delay_head.
+    vector<int> _delay_slots;       ///< row of each delay expression id, -1 if the id is not a delay expression
+    vector<double> _time_buffer;    ///< stored time points, _delay_capacity elements
+    vector<double> _delay_values;   ///< stored values, row slot starts at slot * _delay_capacity
+    size_t _delay_capacity;         ///< number of time points that fit into the buffers, a power of two
+    size_t _delay_head;             ///< position of the oldest time point
+    size_t _delay_count;            ///< number of stored time points
     double _delay_max;
+
+    size_t delayPosition(size_t index) const
+    {
+      return (_delay_head + index) & (_delay_capacity - 1);
+    }
+    int getDelaySlot(unsigned int expr_id) const;
+    size_t findDelayTime(double time) const;
+    void growDelayBuffer();
     double _start_time;
     IGlobalSettings* _global_settings; //this should be a reference, but this is not working if the libraries are linked statically
     IEvent* _event_system; //this pointer to event system
@@ -55,6 +55,8 @@ public:
     virtual unsigned int getAlarmTime() {return 0;}
     virtual void setNonLinearSolverContinueOnError(bool){};
     virtual bool getNonLinearSolverContinueOnError(){ return false; };
+    virtual void setNonLinearSolverJacobianReuse(bool){};
+    virtual bool getNonLinearSolverJacobianReuse(){ return false; };
     virtual void setSolverThreads(int){};
     virtual int getSolverThreads() { return 1; };
     virtual OutputFormat getOutputFormat() {return EMPTY;};
@@ -87,6 +87,8 @@ class FMU2GlobalSettings : public IGlobalSettings
   virtual unsigned int    getAlarmTime() { return 0; }
   virtual void setNonLinearSolverContinueOnError(bool){};
   virtual bool getNonLinearSolverContinueOnError(){ return false; };
+  virtual void setNonLinearSolverJacobianReuse(bool){};
+  virtual bool getNonLinearSolverJacobianReuse(){ return false; };
   virtual void setSolverThreads(int){};
   virtual int getSolverThreads() { return 1; };
   virtual OutputFormat getOutputFormat() {return EMPTY;};
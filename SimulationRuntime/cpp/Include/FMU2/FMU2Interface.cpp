@@ -350,38 +350,53 @@ extern "C"
   fmi2Status fmi2GetFMUstate (fmi2Component c, fmi2FMUstate* FMUstate)
   {
     FMU2Wrapper *w = reinterpret_cast<FMU2Wrapper*>(c);
-    LOG_CALL(w, "fmi2GetFMUstate not implemented");
-    return fmi2Error;
+    LOG_CALL(w, "fmi2GetFMUstate");
+    try {
+      return w->getFMUstate(FMUstate);
+    }
+    CATCH_EXCEPTION(w);
   }
 
   fmi2Status fmi2SetFMUstate (fmi2Component c, fmi2FMUstate  FMUstate)
   {
     FMU2Wrapper *w = reinterpret_cast<FMU2Wrapper*>(c);
-    LOG_CALL(w, "fmi2SetFMUstate not implemented");
-    return fmi2Error;
+    LOG_CALL(w, "fmi2SetFMUstate");
+    try {
+      return w->setFMUstate(FMUstate);
+    }
+    CATCH_EXCEPTION(w);
   }
 
   fmi2Status fmi2FreeFMUstate(fmi2Component c, fmi2FMUstate* FMUstate)
   {
     FMU2Wrapper *w = reinterpret_cast<FMU2Wrapper*>(c);
-    LOG_CALL(w, "fmi2FreeFMUstate not implemented");
-    return fmi2Error;
+    LOG_CALL(w, "fmi2FreeFMUstate");
+    try {
+      return w->freeFMUstate(FMUstate);
+    }
+    CATCH_EXCEPTION(w);
   }
 
   fmi2Status fmi2SerializedFMUstateSize(fmi2Component c, fmi2FMUstate FMUstate,
                                         size_t *size)
   {
     FMU2Wrapper *w = reinterpret_cast<FMU2Wrapper*>(c);
-    LOG_CALL(w, "fmi2SerializedFMUstateSize not implemented");
-    return fmi2Error;
+    LOG_CALL(w, "fmi2SerializedFMUstateSize");
+    try {
+      return w->serializedFMUstateSize(FMUstate, size);
+    }
+    CATCH_EXCEPTION(w);
   }
 
   fmi2Status fmi2SerializeFMUstate(fmi2Component c, fmi2FMUstate FMUstate,
                                    fmi2Byte serializedState[], size_t size)
   {
     FMU2Wrapper *w = reinterpret_cast<FMU2Wrapper*>(c);
-    LOG_CALL(w, "fmi2SerializeFMUstate not implemented");
-    return fmi2Error;
+    LOG_CALL(w, "fmi2SerializeFMUstate(size = %d)", size);
+    try {
+      return w->serializeFMUstate(FMUstate, serializedState, size);
+    }
+    CATCH_EXCEPTION(w);
   }
 
   fmi2Status fmi2DeSerializeFMUstate(fmi2Component c,
@@ -389,8 +404,11 @@ extern "C"
                                      size_t size, fmi2FMUstate* FMUstate)
   {
     FMU2Wrapper *w = reinterpret_cast<FMU2Wrapper*>(c);
-    LOG_CALL(w, "fmi2DeSerializeFMUstate not implemented");
-    return fmi2Error;
+    LOG_CALL(w, "fmi2DeSerializeFMUstate(size = %d)", size);
+    try {
+      return w->deSerializeFMUstate(serializedState, size, FMUstate);
+    }
+    CATCH_EXCEPTION(w);
   }
 
   //
@@ -136,6 +136,8 @@ FMU2Wrapper::FMU2Wrapper(fmi2String instanceName, fmi2String GUID,
 
 FMU2Wrapper::~FMU2Wrapper()
 {
+  for (size_t i = 0; i < _states.size(); i++)
+    delete _states[i];
   delete [] _clockSubactive;
   delete [] _clockTick;
   delete _model;
@@ -479,6 +481,126 @@ fmi2Status FMU2Wrapper::getNominalsOfContinuousStates(fmi2Real x_nominal[], size
   return fmi2OK;
 }
 
+FMU2Wrapper::FMU2State *FMU2Wrapper::allocateState()
+{
+  if (!_freeStates.empty()) {
+    FMU2State *state = _freeStates.back();
+    _freeStates.pop_back();
+    return state;
+  }
+  FMU2State *state = new FMU2State();
+  _states.push_back(state);
+  return state;
+}
+
+fmi2Status FMU2Wrapper::getFMUstate(fmi2FMUstate *FMUstate)
+{
+  // update a given snapshot in place, otherwise take a new one
+  FMU2State *state = reinterpret_cast<FMU2State *>(*FMUstate);
+  if (state == NULL)
+    state = allocateState();
+  _model->saveState(state->system);
+  state->clockTick.assign(_clockTick, _clockTick + _model->getDimClock());
+  state->clockSubactive.assign(_clockSubactive, _clockSubactive + _model->getDimClock());
+  state->nclockTick = _nclockTick;
+  state->needUpdate = _needUpdate;
+  *FMUstate = reinterpret_cast<fmi2FMUstate>(state);
+  return fmi2OK;
+}
+
+fmi2Status FMU2Wrapper::setFMUstate(fmi2FMUstate FMUstate)
+{
+  FMU2State *state = reinterpret_cast<FMU2State *>(FMUstate);
+  if (state == NULL) {
+    FMU2_LOG(this, fmi2Error, logStatusError, "Invalid FMU state");
+    return fmi2Error;
+  }
+  _model->restoreState(state->system);
+  std::copy(state->clockTick.begin(), state->clockTick.end(), _clockTick);
+  std::copy(state->clockSubactive.begin(), state->clockSubactive.end(), _clockSubactive);
+  _nclockTick = state->nclockTick;
+  _needUpdate = state->needUpdate;
+  _needJacUpdate = true;
+  return fmi2OK;
+}
+
+fmi2Status FMU2Wrapper::freeFMUstate(fmi2FMUstate *FMUstate)
+{
+  FMU2State *state = reinterpret_cast<FMU2State *>(*FMUstate);
+  if (state != NULL)
+    _freeStates.push_back(state);
+  *FMUstate = NULL;
+  return fmi2OK;
+}
+
+size_t FMU2Wrapper::serializedWrapperSize()
+{
+  return sizeof(int) + sizeof(bool) + 2 * _model->getDimClock() * sizeof(bool);
+}
+
+fmi2Status FMU2Wrapper::serializedFMUstateSize(fmi2FMUstate FMUstate, size_t *size)
+{
+  FMU2State *state = reinterpret_cast<FMU2State *>(FMUstate);
+  if (state == NULL) {
+    FMU2_LOG(this, fmi2Error, logStatusError, "Invalid FMU state");
+    return fmi2Error;
+  }
+  *size = serializedWrapperSize() + state->system.getSerializedSize();
+  return fmi2OK;
+}
+
+fmi2Status FMU2Wrapper::serializeFMUstate(fmi2FMUstate FMUstate,
+                                          fmi2Byte serializedState[], size_t size)
+{
+  size_t requiredSize;
+  if (serializedFMUstateSize(FMUstate, &requiredSize) != fmi2OK)
+    return fmi2Error;
+  if (size < requiredSize) {
+    FMU2_LOG(this, fmi2Error, logStatusError,
+             "Buffer of %d bytes is too small for FMU state of %d bytes",
+             size, requiredSize);
+    return fmi2Error;
+  }
+  FMU2State *state = reinterpret_cast<FMU2State *>(FMUstate);
+  char *pos = serializedState;
+  memcpy(pos, &state->nclockTick, sizeof(int));
+  pos += sizeof(int);
+  memcpy(pos, &state->needUpdate, sizeof(bool));
+  pos += sizeof(bool);
+  for (int i = 0; i < _model->getDimClock(); i++) {
+    *pos++ = state->clockTick[i];
+    *pos++ = state->clockSubactive[i];
+  }
+  state->system.serialize(pos);
+  return fmi2OK;
+}
+
+fmi2Status FMU2Wrapper::deSerializeFMUstate(const fmi2Byte serializedState[], size_t size,
+                                            fmi2FMUstate *FMUstate)
+{
+  size_t wrapperSize = serializedWrapperSize();
+  FMU2State *state = allocateState();
+  const char *pos = serializedState;
+  if (size < wrapperSize ||
+      !state->system.deserialize(pos + wrapperSize, size - wrapperSize)) {
+    _freeStates.push_back(state);
+    FMU2_LOG(this, fmi2Error, logStatusError, "Invalid serialized FMU state");
+    return fmi2Error;
+  }
+  memcpy(&state->nclockTick, pos, sizeof(int));
+  pos += sizeof(int);
+  memcpy(&state->needUpdate, pos, sizeof(bool));
+  pos += sizeof(bool);
+  state->clockTick.resize(_model->getDimClock());
+  state->clockSubactive.resize(_model->getDimClock());
+  for (int i = 0; i < _model->getDimClock(); i++) {
+    state->clockTick[i] = *pos++ != 0;
+    state->clockSubactive[i] = *pos++ != 0;
+  }
+  *FMUstate = reinterpret_cast<fmi2FMUstate>(state);
+  return fmi2OK;
+}
+
 fmi2Status FMU2Wrapper::getDirectionalDerivative(const fmi2ValueReference vrUnknown[],
                                                  size_t nUnknown,
                                                  const fmi2ValueReference vrKnown[],
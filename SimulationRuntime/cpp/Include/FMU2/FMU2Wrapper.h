@@ -162,6 +162,16 @@ class FMU2Wrapper
   virtual fmi2Status getContinuousStates(fmi2Real states[], size_t nx);
   virtual fmi2Status getNominalsOfContinuousStates(fmi2Real x_nominal[], size_t nx);
 
+  // Getting and setting the internal FMU state
+  virtual fmi2Status getFMUstate           (fmi2FMUstate *FMUstate);
+  virtual fmi2Status setFMUstate           (fmi2FMUstate FMUstate);
+  virtual fmi2Status freeFMUstate          (fmi2FMUstate *FMUstate);
+  virtual fmi2Status serializedFMUstateSize(fmi2FMUstate FMUstate, size_t *size);
+  virtual fmi2Status serializeFMUstate     (fmi2FMUstate FMUstate,
+                                            fmi2Byte serializedState[], size_t size);
+  virtual fmi2Status deSerializeFMUstate   (const fmi2Byte serializedState[], size_t size,
+                                            fmi2FMUstate *FMUstate);
+
   // Jacobian
   fmi2Status getDirectionalDerivative(const fmi2ValueReference vrUnknown[],
                                       size_t nUnknown,
@@ -182,6 +192,22 @@ class FMU2Wrapper
   bool _needJacUpdate;
   void updateModel();
 
+  /**
+   * Snapshot of the model and the wrapper, handed out as fmi2FMUstate.
+   * Freed snapshots are kept and reused by the next fmi2GetFMUstate.
+   */
+  struct FMU2State {
+    SystemState system;
+    std::vector<bool> clockTick;
+    std::vector<bool> clockSubactive;
+    int nclockTick;
+    bool needUpdate;
+  };
+  std::vector<FMU2State *> _states;     ///< all allocated snapshots
+  std::vector<FMU2State *> _freeStates; ///< freed snapshots that can be reused
+  FMU2State *allocateState();
+  size_t serializedWrapperSize();
+
   typedef enum {
     Instantiated       = 1 << 0,
     InitializationMode = 1 << 1,
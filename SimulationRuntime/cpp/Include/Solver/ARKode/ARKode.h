@@ -5,6 +5,12 @@
 #include <Core/Solver/SolverDefaultImplementation.h>
 
 #include <nvector/nvector_serial.h>   // serial N_Vector types, fcts., macros
+#if defined(klu)
+  #include <arkode/arkode_klu.h>          // prototype for ARKKLU solver
+  #include <sundials/sundials_sparse.h>   // def. of SlsMat
+#endif //klu
+#include <Core/Solver/SparseJacobianPattern.h>
+#include <Core/Utils/extension/logger.hpp>
 // ARKode includieren
 //#include <cvode/cvode.h>
 
@@ -100,6 +106,13 @@ private:
   //int calcJacobian(double t, long int N, N_Vector fHelp, N_Vector errorWeight, N_Vector jthcol, double* y, N_Vector fy, DlsMat Jac);
   //void initializeColoredJac();
 
+  // Functions for the sparse jacobian of the KLU linear solver
+#if defined(klu)
+  static int ARK_SlsJCallback(realtype t, N_Vector y, N_Vector fy, SlsMat Jac, void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3);
+  int calcSparseJacobian(double t, double* y, N_Vector fy, N_Vector fHelp, N_Vector errorWeight, SlsMat Jac);
+#endif
+  bool initializeSparseJac();
+
 
 
   ISolverSettings
@@ -164,6 +177,10 @@ double
   int const* _jacobianALeadindex;
 */
 
+  // Variables for the sparse jacobian
+  bool _useSparseFormat;
+  SparseJacobianPattern _sparsePattern;
+
 
 
   bool _arkode_initialized;
@@ -27,6 +27,8 @@ public:
 
     virtual void setContinueOnError(bool);
     virtual bool getContinueOnError();
+    virtual void setJacobianReuse(bool);
+    virtual bool getJacobianReuse();
 private:
     long int    _iNewt_max;                    ///< max. Anzahl an Broydenititerationen pro Schritt (default: 25)
 
@@ -34,5 +36,6 @@ private:
     double        _dAtol;                        ///< Absolute Toleranz für die Broydeniteration (default: 1e-6)
     double        _dDelta;                        ///< Dämpfungsfaktor (default: 0.9)
     bool _continueOnError;
+    bool _jacobianReuse;
 };
 /** @} */ // end of solverBroyden
@@ -16,6 +16,11 @@
 #endif //USE_SUNDIALS_LAPACK
 #include <nvector/nvector_serial.h>
 #include <sundials/sundials_direct.h>
+#if defined(klu)
+  #include <cvode/cvode_klu.h>
+  #include <sundials/sundials_sparse.h>
+#endif //klu
+#include <Core/Solver/SparseJacobianPattern.h>
 
 #ifdef RUNTIME_PROFILING
   #include <Core/Utils/extension/measure_time.hpp>
@@ -109,6 +114,13 @@ private:
   int calcJacobian(double t, long int N, N_Vector fHelp, N_Vector errorWeight, N_Vector jthcol, double* y, N_Vector fy, DlsMat Jac);
   void initializeColoredJac();
 
+  // Functions for the sparse jacobian of the KLU linear solver
+#if defined(klu)
+  static int CV_SlsJCallback(realtype t, N_Vector y, N_Vector fy, SlsMat Jac, void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3);
+  int calcSparseJacobian(double t, double* y, N_Vector fy, N_Vector fHelp, N_Vector errorWeight, SlsMat Jac);
+#endif
+  bool initializeSparseJac();
+
 
 
   ISolverSettings
@@ -173,6 +185,10 @@ double
   int const* _jacobianAIndex;
   int const* _jacobianALeadindex;
 
+  // Variables for the sparse jacobian
+  bool _useSparseFormat;
+  SparseJacobianPattern _sparsePattern;
+
 
 
 
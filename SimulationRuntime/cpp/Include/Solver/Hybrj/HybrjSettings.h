@@ -25,6 +25,8 @@ public:
 
     virtual void setContinueOnError(bool);
     virtual bool getContinueOnError();
+    virtual void setJacobianReuse(bool);
+    virtual bool getJacobianReuse();
 private:
     long int    _iNewt_max;                    ///< max. Anzahl an Newtonititerationen pro Schritt (default: 25)
 
@@ -32,5 +34,6 @@ private:
     double        _dAtol;                        ///< Absolute Toleranz für die Newtoniteration (default: 1e-6)
     double        _dDelta;                        ///< Dämpfungsfaktor (default: 0.9)
     bool _continueOnError;
+    bool _jacobianReuse;
 };
 /** @} */ // end of solverHybrj
@@ -8,6 +8,11 @@
 #include <nvector/nvector_serial.h>
 #include <sundials/sundials_direct.h>
 #include <idas/idas_dense.h>
+#if defined(klu)
+  #include <idas/idas_klu.h>
+  #include <sundials/sundials_sparse.h>
+#endif //klu
+#include <Core/Solver/SparseJacobianPattern.h>
 
 
 #ifdef RUNTIME_PROFILING
@@ -101,6 +106,13 @@ private:
   static int jacobianFunctionCB(long int N, realtype t, N_Vector y, N_Vector fy, DlsMat Jac,void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3);
   int calcJacobian(double t, long int N, N_Vector fHelp, N_Vector errorWeight, N_Vector jthcol, double* y, N_Vector fy, DlsMat Jac);
 
+  // Functions for the sparse jacobian of the KLU linear solver
+#if defined(klu)
+  static int sparseJacobianFunctionCB(realtype t, realtype cj, N_Vector y, N_Vector yp, N_Vector res, SlsMat Jac, void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3);
+  int calcSparseJacobian(double t, double cj, double* y, double* yp, N_Vector res, N_Vector resHelp, N_Vector errorWeight, SlsMat Jac);
+#endif
+  bool initializeSparseJac();
+
 
 
 
@@ -176,6 +188,10 @@ double
   int const* _jacobianAIndex;
   int const* _jacobianALeadindex;
 
+  // Variables for the sparse jacobian
+  bool _useSparseFormat;
+  SparseJacobianPattern _sparsePattern;
+
 
   bool _ida_initialized;
 
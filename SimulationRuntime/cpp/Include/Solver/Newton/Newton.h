@@ -28,6 +28,8 @@
    by Lapack/DGESV, which computes the solution to a real system of linear equations
    A * y = B,                            (2)
    where A is an n-by-n matrix and y and B are n-by-n(right hand side) matrices.
+   With jacobian reuse (simplified Newton) the LU factors of A are kept across iterations
+   and calls and are only updated if the residual is not reduced fast enough.
    \date     2008, September, 16th
    \author
 */
@@ -59,6 +61,11 @@ class Newton : public INonLinearAlgLoopSolver,  public AlgLoopSolverDefaultImple
   virtual bool* getConditions2WorkArray();
   virtual double* getVariableWorkArray();
 
+  /// Number of jacobian evaluations and factorizations
+  long int getNumFactorizations() const { return _numFactorizations; }
+  /// Number of iterations that reused the factors of a previous jacobian
+  long int getNumJacobianReuses() const { return _numJacobianReuses; }
+
 
  private:
   /// Encapsulation of determination of residuals to given unknowns
@@ -80,7 +87,13 @@ class Newton : public INonLinearAlgLoopSolver,  public AlgLoopSolverDefaultImple
 
 
   bool
-    _firstCall;                 ///< Temp        - Denotes the first call to the solver, init() is called
+    _firstCall,                 ///< Temp        - Denotes the first call to the solver, init() is called
+    _useJacobianReuse,          ///< Input       - Keep the factorized jacobian as long as the iteration converges fast enough
+    _hasDgesvFactors;           ///< Temp        - _jac contains the LU factors of a previous jacobian
+
+  long int
+    _numFactorizations,         ///< Output      - Number of jacobian evaluations and factorizations
+    _numJacobianReuses;         ///< Output      - Number of iterations with the factors of a previous jacobian
 
   const char*
     *_yNames;                  ///< Names of variables
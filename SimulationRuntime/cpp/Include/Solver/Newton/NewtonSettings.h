@@ -28,6 +28,8 @@ class NewtonSettings :public INonLinSolverSettings
 
   virtual void setContinueOnError(bool);
   virtual bool getContinueOnError();
+  virtual void setJacobianReuse(bool);
+  virtual bool getJacobianReuse();
  private:
   long int    _iNewt_max;        ///< max. Anzahl an Newtonititerationen pro Schritt (default: 25)
 
@@ -35,6 +37,7 @@ class NewtonSettings :public INonLinSolverSettings
   double        _dAtol;          ///< Absolute Toleranz für die Newtoniteration (default: 1e-6)
   double        _dDelta;         ///< Dämpfungsfaktor (default: 0.9)
   bool _continueOnError;
+  bool _jacobianReuse;
 };
 
 /** @} */ // end of solverNewton
@@ -311,6 +311,8 @@ SimSettings OMCFactory::readSimulationParameter(int argc, const char* argv[])
      desc.add_options()
           ("help", "produce help message")
           ("nls-continue", po::bool_switch()->default_value(false), "non linear solver will continue if it can not reach the given precision")
+          ("nls-jacobian-reuse", po::bool_switch()->default_value(false), "newton solver keeps the factorized jacobian across iterations and time steps and only updates it if the convergence slows down")
+          ("sparse-jacobian", po::bool_switch()->default_value(false), "use a sparse direct linear solver (KLU) for the jacobian of CVode, IDA and ARKode")
           ("runtime-library,R", po::value<string>(), "path to cpp runtime libraries")
           ("modelica-system-library,M",  po::value<string>(), "path to Modelica library")
           ("input-path", po::value< string >(), "directory with input files, like init xml (defaults to modelica-system-library)")
@@ -383,7 +385,9 @@ SimSettings OMCFactory::readSimulationParameter(int argc, const char* argv[])
      double stoptime = vm["stop-time"].as<double>();
      double stepsize =vm["step-size"].as<double>();
      bool nlsContinueOnError = vm["nls-continue"].as<bool>();
+     bool nlsJacobianReuse = vm["nls-jacobian-reuse"].as<bool>();
      int solverThreads = vm["solver-threads"].as<int>();
+     bool useSparseFormat = vm["sparse-jacobian"].as<bool>();
 
      if (!(stepsize > 0.0))
          stepsize = (stoptime - starttime) / vm["number-of-intervals"].as<int>();
@@ -477,7 +481,7 @@ SimSettings OMCFactory::readSimulationParameter(int argc, const char* argv[])
      libraries_path.make_preferred();
      modelica_path.make_preferred();
 
-     SimSettings settings = {solver, linSolver, nonLinSolver, starttime, stoptime, stepsize, 1e-24, 0.01, tolerance, resultsfilename, timeOut, outputPointType, logSettings, nlsContinueOnError, solverThreads, outputFormat, emitResults, inputPath, outputPath};
+     SimSettings settings = {solver, linSolver, nonLinSolver, starttime, stoptime, stepsize, 1e-24, 0.01, tolerance, resultsfilename, timeOut, outputPointType, logSettings, nlsContinueOnError, solverThreads, outputFormat, emitResults, inputPath, outputPath, useSparseFormat, nlsJacobianReuse};
 
      _library_path = libraries_path.string();
      _modelicasystem_path = modelica_path.string();
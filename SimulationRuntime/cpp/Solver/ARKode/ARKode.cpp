@@ -41,7 +41,9 @@ Arkode::Arkode(IMixedSystem* system, ISolverSettings* settings)
       _time_system(NULL),
       _delta(NULL),
       _deltaInv(NULL),
-      _ysave(NULL)
+      _ysave(NULL),
+      _useSparseFormat(false),
+      _sparsePattern()
 {
   _data = ((void*) this);
 }
@@ -235,6 +237,18 @@ void Arkode::initialize()
       throw ModelicaSimulationError(SOLVER,"Cvode::initialize()");
 
     // Initialize linear solver
+    _useSparseFormat = initializeSparseJac();
+    if (_useSparseFormat)
+    {
+#if defined(klu)
+      _idid = ARKKLU(_arkodeMem, _dimSys, _sparsePattern.getNonZeros());
+      if (_idid < 0)
+        throw ModelicaSimulationError(SOLVER,"ARKode::initialize()");
+      _idid = ARKSlsSetSparseJacFn(_arkodeMem, &ARK_SlsJCallback);
+#endif
+    }
+    else
+    {
     /*
     #ifdef USE_SUNDIALS_LAPACK
       _idid = CVLapackDense(_cvodeMem, _dimSys);
@@ -244,6 +258,7 @@ void Arkode::initialize()
     /*
     #endif
     */
+    }
     if (_idid < 0)
       throw ModelicaSimulationError(SOLVER,"Cvode::initialize()");
 
@@ -608,6 +623,108 @@ int Arkode::ARK_fCallback(double t, N_Vector y, N_Vector ydot, void *user_data)
   return ((Arkode*) user_data)->calcFunction(t, NV_DATA_S(y), NV_DATA_S(ydot));
 }
 
+#if defined(klu)
+int Arkode::ARK_SlsJCallback(realtype t, N_Vector y, N_Vector fy, SlsMat Jac, void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3)
+{
+  return ((Arkode*) user_data)->calcSparseJacobian(t, NV_DATA_S(y), fy, tmp1, tmp2, Jac);
+}
+
+int Arkode::calcSparseJacobian(double t, double* y, N_Vector fy, N_Vector fHelp, N_Vector errorWeight, SlsMat Jac)
+{
+  try
+  {
+    double fnorm, minInc, *f_data, *fHelp_data, *errorWeight_data, h, srur;
+    const int* rowIndices = _sparsePattern.getRowIndices();
+
+    // sundials resets the whole matrix before each evaluation
+    _sparsePattern.copyPattern(Jac->colptrs, Jac->rowvals);
+
+    f_data = NV_DATA_S(fy);
+    fHelp_data = NV_DATA_S(fHelp);
+
+    if (_system->isAnalyticJacobianGenerated())
+    {
+      if (calcFunction(t, y, fHelp_data))
+        return 1;
+      _sparsePattern.copyValues(_system->getSparseJacobian(), Jac->data);
+      return 0;
+    }
+
+    errorWeight_data = NV_DATA_S(errorWeight);
+    _idid = ARKodeGetErrWeights(_arkodeMem, errorWeight);
+    if (_idid < 0)
+      throw ModelicaSimulationError(SOLVER,"ARKode::calcSparseJacobian()");
+    _idid = ARKodeGetCurrentStep(_arkodeMem, &h);
+    if (_idid < 0)
+      throw ModelicaSimulationError(SOLVER,"ARKode::calcSparseJacobian()");
+
+    srur = sqrt(UROUND);
+    fnorm = N_VWrmsNorm(fy, errorWeight);
+    minInc = (fnorm != 0.0) ?
+             (1000.0 * abs(h) * UROUND * _dimSys * fnorm) : 1.0;
+
+    for (int j = 0; j < _dimSys; j++)
+    {
+      _delta[j] = max(srur*abs(y[j]), minInc/errorWeight_data[j]);
+      _deltaInv[j] = 1/_delta[j];
+    }
+
+    // colored finite differences, all columns of a color are perturbed at once
+    for (int color = 0; color < _sparsePattern.getMaxColors(); color++)
+    {
+      int numColumns;
+      const int* columns = _sparsePattern.getColumnsOfColor(color, numColumns);
+
+      for (int c = 0; c < numColumns; c++)
+      {
+        int k = columns[c];
+        _ysave[k] = y[k];
+        y[k] += _delta[k];
+      }
+
+      if (calcFunction(t, y, fHelp_data))
+        return 1;
+
+      for (int c = 0; c < numColumns; c++)
+      {
+        int k = columns[c];
+        y[k] = _ysave[k];
+        for (int j = Jac->colptrs[k]; j < Jac->colptrs[k + 1]; j++)
+          Jac->data[j] = (fHelp_data[rowIndices[j]] - f_data[rowIndices[j]]) * _deltaInv[k];
+      }
+    }
+    _sparsePattern.resetAddedDiagonal(Jac->data);
+  }
+  //workaround until exception can be catch from c- libraries
+  catch (std::exception& ex)
+  {
+    cerr << "ARKode integration error: " << ex.what();
+    return 1;
+  }
+
+  return 0;
+}
+#endif
+
+bool Arkode::initializeSparseJac()
+{
+  if (!_arkodesettings->getUseSparseFormat())
+    return false;
+
+#if defined(klu)
+  if (_continuous_system->getDimContinuousStates() > 0 && _sparsePattern.initialize(_mixed_system, _dimSys, true))
+  {
+    LOGGER_WRITE("ARKode: using KLU with " + to_string(_sparsePattern.getNonZeros()) + " nonzero jacobian elements and "
+      + to_string(_sparsePattern.getMaxColors()) + " colors", LC_SOLVER, LL_INFO);
+    return true;
+  }
+  LOGGER_WRITE("ARKode: the system provides no sparse jacobian, the dense linear solver is used", LC_SOLVER, LL_WARNING);
+#else
+  LOGGER_WRITE("ARKode: the runtime is built without KLU, the dense linear solver is used", LC_SOLVER, LL_WARNING);
+#endif
+  return false;
+}
+
 void Arkode::giveZeroVal(const double &t, const double *y, double *zeroValue)
 {
   _time_system->setTime(t);
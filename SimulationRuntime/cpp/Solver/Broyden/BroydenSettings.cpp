@@ -14,6 +14,7 @@ BroydenSettings::BroydenSettings()
 , _dAtol                        (1e-6)
 , _dDelta                    (1)
 , _continueOnError(false)
+, _jacobianReuse(false)
 {
 };
 
@@ -72,4 +73,14 @@ bool BroydenSettings::getContinueOnError()
 {
   return _continueOnError;
 }
+
+void BroydenSettings::setJacobianReuse(bool value)
+{
+  _jacobianReuse = value;
+}
+
+bool BroydenSettings::getJacobianReuse()
+{
+  return _jacobianReuse;
+}
 /** @} */ // end of solverBroyden
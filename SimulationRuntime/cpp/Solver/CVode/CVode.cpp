@@ -49,7 +49,9 @@ Cvode::Cvode(IMixedSystem* system, ISolverSettings* settings)
 	_CV_y(),
 	_CV_yWrite(),
 	_maxColors(0),
-	_jacobianANonzeros(0)
+	_jacobianANonzeros(0),
+	_useSparseFormat(false),
+	_sparsePattern()
 {
 	_data = ((void*) this);
 
@@ -284,11 +286,24 @@ void Cvode::initialize()
 			throw ModelicaSimulationError(SOLVER,/*_idid,_tCurrent,*/"Cvode::initialize()");
 
 		// Initialize linear solver
+		_useSparseFormat = initializeSparseJac();
+		if (_useSparseFormat)
+		{
+#if defined(klu)
+			_idid = CVKLU(_cvodeMem, _dimSys, _sparsePattern.getNonZeros());
+			if (_idid < 0)
+				throw ModelicaSimulationError(SOLVER, "Cvode::initialize()");
+			_idid = CVSlsSetSparseJacFn(_cvodeMem, &CV_SlsJCallback);
+#endif
+		}
+		else
+		{
 #ifdef USE_SUNDIALS_LAPACK
-		_idid = CVLapackDense(_cvodeMem, _dimSys);
+			_idid = CVLapackDense(_cvodeMem, _dimSys);
 #else
-		_idid = CVDense(_cvodeMem, _dimSys);
+			_idid = CVDense(_cvodeMem, _dimSys);
 #endif
+		}
 		if (_idid < 0)
 			throw ModelicaSimulationError(SOLVER, "Cvode::initialize()");
 
@@ -944,6 +959,114 @@ int Cvode::calcJacobian(double t, long int N, N_Vector fHelp, N_Vector errorWeig
 	return 0;
 }
 
+#if defined(klu)
+int Cvode::CV_SlsJCallback(realtype t, N_Vector y, N_Vector fy, SlsMat Jac, void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3)
+{
+	return ((Cvode*)user_data)->calcSparseJacobian(t, NV_DATA_S(y), fy, tmp1, tmp2, Jac);
+}
+
+int Cvode::calcSparseJacobian(double t, double* y, N_Vector fy, N_Vector fHelp, N_Vector errorWeight, SlsMat Jac)
+{
+	try
+	{
+		double fnorm, minInc, *f_data, *fHelp_data, *errorWeight_data, h, srur;
+		const int* rowIndices = _sparsePattern.getRowIndices();
+
+		// sundials resets the whole matrix before each evaluation
+		_sparsePattern.copyPattern(Jac->colptrs, Jac->rowvals);
+
+		f_data = NV_DATA_S(fy);
+		fHelp_data = NV_DATA_S(fHelp);
+
+		if (_system->isAnalyticJacobianGenerated())
+		{
+			if (calcFunction(t, y, fHelp_data))
+				return 1;
+			_sparsePattern.copyValues(_system->getSparseJacobian(), Jac->data);
+			return 0;
+		}
+
+		errorWeight_data = NV_DATA_S(errorWeight);
+		_idid = CVodeGetErrWeights(_cvodeMem, errorWeight);
+		if (_idid < 0)
+		{
+			_idid = -5;
+			throw ModelicaSimulationError(SOLVER, "Cvode::calcSparseJacobian()");
+		}
+		_idid = CVodeGetCurrentStep(_cvodeMem, &h);
+		if (_idid < 0)
+		{
+			_idid = -5;
+			throw ModelicaSimulationError(SOLVER, "Cvode::calcSparseJacobian()");
+		}
+
+		srur = sqrt(UROUND);
+		fnorm = N_VWrmsNorm(fy, errorWeight);
+		minInc = (fnorm != 0.0) ?
+			(1000.0 * abs(h) * UROUND * _dimSys * fnorm) : 1.0;
+
+		for (int j = 0; j < _dimSys; j++)
+		{
+			_delta[j] = max(srur*abs(y[j]), minInc / errorWeight_data[j]);
+			_deltaInv[j] = 1 / _delta[j];
+		}
+
+		// colored finite differences, all columns of a color are perturbed at once
+		for (int color = 0; color < _sparsePattern.getMaxColors(); color++)
+		{
+			int numColumns;
+			const int* columns = _sparsePattern.getColumnsOfColor(color, numColumns);
+
+			for (int c = 0; c < numColumns; c++)
+			{
+				int k = columns[c];
+				_ysave[k] = y[k];
+				y[k] += _delta[k];
+			}
+
+			if (calcFunction(t, y, fHelp_data))
+				return 1;
+
+			for (int c = 0; c < numColumns; c++)
+			{
+				int k = columns[c];
+				y[k] = _ysave[k];
+				for (int j = Jac->colptrs[k]; j < Jac->colptrs[k + 1]; j++)
+					Jac->data[j] = (fHelp_data[rowIndices[j]] - f_data[rowIndices[j]]) * _deltaInv[k];
+			}
+		}
+		_sparsePattern.resetAddedDiagonal(Jac->data);
+	}
+	//workaround until exception can be catch from c- libraries
+	catch (std::exception & ex)
+	{
+		cerr << "CVode integration error: " << ex.what();
+		return 1;
+	}
+
+	return 0;
+}
+#endif
+
+bool Cvode::initializeSparseJac()
+{
+	if (!_cvodesettings->getUseSparseFormat())
+		return false;
+
+#if defined(klu)
+	if (_continuous_system->getDimContinuousStates() > 0 && _sparsePattern.initialize(_mixed_system, _dimSys, true))
+	{
+		LOGGER_WRITE("Cvode: using KLU with " + to_string(_sparsePattern.getNonZeros()) + " nonzero jacobian elements and "
+			+ to_string(_sparsePattern.getMaxColors()) + " colors", LC_SOLVER, LL_INFO);
+		return true;
+	}
+	LOGGER_WRITE("Cvode: the system provides no sparse jacobian, the dense linear solver is used", LC_SOLVER, LL_WARNING);
+#else
+	LOGGER_WRITE("Cvode: the runtime is built without KLU, the dense linear solver is used", LC_SOLVER, LL_WARNING);
+#endif
+	return false;
+}
+
 void Cvode::initializeColoredJac()
 {
 
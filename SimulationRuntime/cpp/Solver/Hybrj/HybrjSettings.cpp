@@ -14,6 +14,7 @@ HybrjSettings::HybrjSettings()
 , _dAtol                        (1.0)
 , _dDelta                    (0.9)
 , _continueOnError(false)
+, _jacobianReuse(false)
 {
 };
 /*max. Anzahl an Newtonititerationen pro Schritt (default: 25)*/
@@ -66,4 +67,14 @@ bool HybrjSettings::getContinueOnError()
 {
   return _continueOnError;
 }
+
+void HybrjSettings::setJacobianReuse(bool value)
+{
+  _jacobianReuse = value;
+}
+
+bool HybrjSettings::getJacobianReuse()
+{
+  return _jacobianReuse;
+}
 /** @} */ // end of solverHybrj
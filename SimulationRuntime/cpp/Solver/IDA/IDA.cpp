@@ -56,7 +56,9 @@ Ida::Ida(IMixedSystem* system, ISolverSettings* settings)
       _zeroFound(false),
       _maxColors(0),
       _tLastWrite(-1.0),
-      _jacobianANonzeros(0)
+      _jacobianANonzeros(0),
+      _useSparseFormat(false),
+      _sparsePattern()
 {
   _data = ((void*) this);
   #ifdef RUNTIME_PROFILING
@@ -329,7 +331,18 @@ void Ida::initialize()
       throw std::invalid_argument(/*_idid,_tCurrent,*/"IDA::initialize()");
 
     // Initialize linear solver
-    _idid = IDADense(_idaMem, _dimSys);
+    _useSparseFormat = initializeSparseJac();
+    if (_useSparseFormat)
+    {
+#if defined(klu)
+      _idid = IDAKLU(_idaMem, _dimSys, _sparsePattern.getNonZeros());
+      if (_idid < 0)
+        throw std::invalid_argument("IDA::initialize()");
+      _idid = IDASlsSetSparseJacFn(_idaMem, &sparseJacobianFunctionCB);
+#endif
+    }
+    else
+      _idid = IDADense(_idaMem, _dimSys);
     if (_idid < 0)
       throw std::invalid_argument("IDA::initialize()");
     if(_dimAE>0)
@@ -1033,6 +1046,121 @@ int Ida::calcJacobian(double t, long int N, N_Vector fHelp, N_Vector errorWeight
   return 0;
 }
 
+#if defined(klu)
+int Ida::sparseJacobianFunctionCB(realtype t, realtype cj, N_Vector y, N_Vector yp, N_Vector res, SlsMat Jac, void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3)
+{
+  return ((Ida*) user_data)->calcSparseJacobian(t, cj, NV_DATA_S(y), NV_DATA_S(yp), res, tmp1, tmp2, Jac);
+}
+
+int Ida::calcSparseJacobian(double t, double cj, double* y, double* yp, N_Vector res, N_Vector resHelp, N_Vector errorWeight, SlsMat Jac)
+{
+  try
+  {
+    double h, srur, *res_data, *resHelp_data, *errorWeight_data;
+    const int* rowIndices = _sparsePattern.getRowIndices();
+
+    // sundials resets the whole matrix before each evaluation
+    _sparsePattern.copyPattern(Jac->colptrs, Jac->rowvals);
+
+    res_data = NV_DATA_S(res);
+    resHelp_data = NV_DATA_S(resHelp);
+
+    if (_system->isAnalyticJacobianGenerated())
+    {
+      if (calcFunction(t, y, yp, resHelp_data))
+        return 1;
+      _sparsePattern.copyValues(_system->getSparseJacobian(), Jac->data);
+    }
+    else
+    {
+      errorWeight_data = NV_DATA_S(errorWeight);
+      _idid = IDAGetErrWeights(_idaMem, errorWeight);
+      if (_idid < 0)
+      {
+        _idid = -5;
+        throw std::invalid_argument("IDA::calcSparseJacobian()");
+      }
+      _idid = IDAGetCurrentStep(_idaMem, &h);
+      if (_idid < 0)
+      {
+        _idid = -5;
+        throw std::invalid_argument("IDA::calcSparseJacobian()");
+      }
+
+      srur = sqrt(UROUND);
+      for (int j = 0; j < _dimSys; j++)
+      {
+        _delta[j] = max(srur * max(abs(y[j]), abs(h * yp[j])), 1.0 / errorWeight_data[j]);
+        _deltaInv[j] = 1 / _delta[j];
+      }
+
+      // colored finite differences of the residual f(y) - yp, all columns of a color are perturbed at once
+      for (int color = 0; color < _sparsePattern.getMaxColors(); color++)
+      {
+        int numColumns;
+        const int* columns = _sparsePattern.getColumnsOfColor(color, numColumns);
+
+        for (int c = 0; c < numColumns; c++)
+        {
+          int k = columns[c];
+          _ysave[k] = y[k];
+          y[k] += _delta[k];
+        }
+
+        if (calcFunction(t, y, yp, resHelp_data))
+          return 1;
+
+        for (int c = 0; c < numColumns; c++)
+        {
+          int k = columns[c];
+          y[k] = _ysave[k];
+          for (int j = Jac->colptrs[k]; j < Jac->colptrs[k + 1]; j++)
+            Jac->data[j] = (resHelp_data[rowIndices[j]] - res_data[rowIndices[j]]) * _deltaInv[k];
+        }
+      }
+      _sparsePattern.resetAddedDiagonal(Jac->data);
+    }
+
+    // iteration matrix dres/dy + cj * dres/dyp with dres/dyp = -I
+    for (int k = 0; k < _dimSys; k++)
+      Jac->data[_sparsePattern.getDiagonalIndex(k)] -= cj;
+  }
+  //workaround until exception can be catch from c- libraries
+  catch (std::exception& ex)
+  {
+    cerr << "IDA integration error: " << ex.what();
+    return 1;
+  }
+
+  return 0;
+}
+#endif
+
+bool Ida::initializeSparseJac()
+{
+  if (!_idasettings->getUseSparseFormat())
+    return false;
+
+#if defined(klu)
+  // the sparse jacobian of the system covers the states only
+  if (_dimAE > 0)
+  {
+    LOGGER_WRITE("IDA: the sparse jacobian is not supported for DAE systems, the dense linear solver is used", LC_SOLVER, LL_WARNING);
+    return false;
+  }
+  if (_continuous_system->getDimContinuousStates() > 0 && _sparsePattern.initialize(_mixed_system, _dimSys, true))
+  {
+    LOGGER_WRITE("IDA: using KLU with " + to_string(_sparsePattern.getNonZeros()) + " nonzero jacobian elements and "
+      + to_string(_sparsePattern.getMaxColors()) + " colors", LC_SOLVER, LL_INFO);
+    return true;
+  }
+  LOGGER_WRITE("IDA: the system provides no sparse jacobian, the dense linear solver is used", LC_SOLVER, LL_WARNING);
+#else
+  LOGGER_WRITE("IDA: the runtime is built without KLU, the dense linear solver is used", LC_SOLVER, LL_WARNING);
+#endif
+  return false;
+}
+
 
 
 int Ida::reportErrorMessage(ostream& messageStream)
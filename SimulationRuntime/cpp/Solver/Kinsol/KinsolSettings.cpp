@@ -13,6 +13,7 @@ KinsolSettings::KinsolSettings()
 , _dAtol           (1.0)
 , _dDelta          (0.9)
 , _continueOnError(false)
+, _jacobianReuse(false)
 {
 };
 /*max. Anzahl an Newtonititerationen pro Schritt (default: 25)*/
@@ -65,4 +66,14 @@ bool KinsolSettings::getContinueOnError()
 {
   return _continueOnError;
 }
+
+void KinsolSettings::setJacobianReuse(bool value)
+{
+  _jacobianReuse = value;
+}
+
+bool KinsolSettings::getJacobianReuse()
+{
+  return _jacobianReuse;
+}
 /** @} */ // end of solverKinsol
@@ -14,6 +14,9 @@
 #include <Core/Math/ILapack.h>     // needed for solution of linear system with Lapack
 #include <Core/Math/Constants.h>   // definitializeion of constants like uround
 
+/// Maximal contraction rate of the residual norm per iteration if the jacobian is reused
+static const double JACOBIAN_REUSE_MAX_RATE = 0.5;
+
 Newton::Newton(INonLinSolverSettings* settings,shared_ptr<INonLinearAlgLoop> algLoop)
   :AlgLoopSolverDefaultImplementation()
    ,_algLoop          (algLoop)
@@ -32,6 +35,10 @@ Newton::Newton(INonLinSolverSettings* settings,shared_ptr<INonLinearAlgLoop> alg
   , _iHelp            (NULL)
   , _jac              (NULL)
   , _firstCall        (true)
+  , _useJacobianReuse (false)
+  , _hasDgesvFactors  (false)
+  , _numFactorizations(0)
+  , _numJacobianReuses(0)
   , _iterationStatus  (CONTINUE)
   , _lc               (LC_NLS)
 {
@@ -65,6 +72,8 @@ Newton::~Newton()
 void Newton::initialize()
 {
   _firstCall = false;
+  _useJacobianReuse = _newtonSettings->getJacobianReuse();
+  _hasDgesvFactors = false;
 
   //(Re-) initializeialization of algebraic loop
    if(_algLoop)
@@ -164,7 +173,10 @@ void Newton::solve( )
       LOGGER_WRITE_VECTOR("y" + to_string(totSteps), _y, _dimSys, _lc, LL_DEBUG);
       LOGGER_WRITE_VECTOR("f" + to_string(totSteps), _f, _dimSys, _lc, LL_DEBUG);
 
-      calcJacobian(_jac, _fNominal);
+      // Reuse the LU factors of a previous jacobian if possible (simplified Newton)
+      bool newJacobian = !_useJacobianReuse || !_hasDgesvFactors;
+      if (newJacobian)
+        calcJacobian(_jac, _fNominal);
 
       // Initialize line search function
       double phi = 0.0;
@@ -174,7 +186,16 @@ void Newton::solve( )
       }
 
       // Solve linear system
-      dgesv_(&_dimSys, &dimRHS, _jac, &_dimSys, _iHelp, _f, &_dimSys, &info);
+      if (newJacobian) {
+        dgesv_(&_dimSys, &dimRHS, _jac, &_dimSys, _iHelp, _f, &_dimSys, &info);
+        _hasDgesvFactors = (info == 0);
+        _numFactorizations++;
+      }
+      else {
+        char trans = 'N';
+        dgetrs_(&trans, &_dimSys, &dimRHS, _jac, &_dimSys, _iHelp, _f, &_dimSys, &info);
+        _numJacobianReuses++;
+      }
 
       if (info != 0)
         throw ModelicaSimulationError(ALGLOOP_SOLVER,
@@ -187,106 +208,124 @@ void Newton::solve( )
       // New iterate
       double lambda = 1.0; // step size
       double alpha = 1e-4; // guard for sufficient decrease
-      // first find a feasible step
-      while (true) {
-        for (int i = 0; i < _dimSys; i++) {
-          _yHelp[i] = _y[i] - lambda * _f[i] /** _yNominal[i]*/;
-          _yHelp[i] = std::min(_yMax[i], std::max(_yMin[i], _yHelp[i]));
-        }
-        // evaluate function
-        try {
-          calcFunction(_yHelp, _fHelp);
-        }
-        catch (ModelicaSimulationError& ex) {
-          if (lambda < 1e-10)
-            throw ex;
-          // reduce step size
-          lambda *= 0.5;
-          continue;
-        }
-        break;
-      }
-      // check stopping criterion
-      _iterationStatus = DONE;
-      for (int i = 0; i < _dimSys; i++) {
-        if (std::abs(_fHelp[i]) > atol + rtol * _fNominal[i]) {
-          _iterationStatus = CONTINUE;
+      double phiHelp = 0.0;
+      try {
+        // first find a feasible step
+        while (true) {
+          for (int i = 0; i < _dimSys; i++) {
+            _yHelp[i] = _y[i] - lambda * _f[i] /** _yNominal[i]*/;
+            _yHelp[i] = std::min(_yMax[i], std::max(_yMin[i], _yHelp[i]));
+          }
+          // evaluate function
+          try {
+            calcFunction(_yHelp, _fHelp);
+          }
+          catch (ModelicaSimulationError& ex) {
+            if (lambda < 1e-10)
+              throw;
+            // reduce step size
+            lambda *= 0.5;
+            continue;
+          }
           break;
         }
-      }
-      // second do line search with quadratic approximation of phi(lambda)
-      // C.T.Kelley: Solving Nonlinear Equations with Newton's Method,
-      // no 1 in Fundamentals of Algorithms, SIAM 2003. ISBN 0-89871-546-6.
-      double phiHelp = 0.0;
-      for (int i = 0; i < _dimSys; i++) {
-        _fHelp[i] /= _fNominal[i];
-        phiHelp += _fHelp[i] * _fHelp[i];
-      }
-      while (_iterationStatus == CONTINUE) {
-        // test half step that also serves as max bound for step reduction
-        double lambdaTest = 0.5*lambda;
+        // check stopping criterion
+        _iterationStatus = DONE;
         for (int i = 0; i < _dimSys; i++) {
-          _yTest[i] = _y[i] - lambdaTest * _f[i] /** _yNominal[i]*/;
-          _yTest[i] = std::min(_yMax[i], std::max(_yMin[i], _yTest[i]));
+          if (std::abs(_fHelp[i]) > atol + rtol * _fNominal[i]) {
+            _iterationStatus = CONTINUE;
+            break;
+          }
         }
-        calcFunction(_yTest, _fTest);
-        double phiTest = 0.0;
+        // second do line search with quadratic approximation of phi(lambda)
+        // C.T.Kelley: Solving Nonlinear Equations with Newton's Method,
+        // no 1 in Fundamentals of Algorithms, SIAM 2003. ISBN 0-89871-546-6.
         for (int i = 0; i < _dimSys; i++) {
-          _fTest[i] /= _fNominal[i];
-          phiTest += _fTest[i] * _fTest[i];
+          _fHelp[i] /= _fNominal[i];
+          phiHelp += _fHelp[i] * _fHelp[i];
         }
-        // check for sufficient decrease of phiHelp
-        // and no further decrease with phiTest
-        // otherwise minimize quadratic approximation of phi(lambda)
-        if (phiHelp > (1.0 - alpha * lambda) * phi ||
-            phiTest < (1.0 - alpha * lambda) * phiHelp) {
-          long int n = 3;
-          long int ipiv[3];
-          double bx[] = {phi, phiTest, phiHelp};
-          double A[] = {1.0, 1.0, 1.0,
-                        0.0, lambdaTest, lambda,
-                        0.0, lambdaTest*lambdaTest, lambda*lambda};
-          dgesv_(&n, &dimRHS, A, &n, ipiv, bx, &n, &info);
-          lambda = std::max(0.1*lambda, -0.5*bx[1]/bx[2]);
-          if (!(lambda >= 1e-10))
-            throw ModelicaSimulationError(ALGLOOP_SOLVER,
-              "Can't get sufficient decrease of solution");
-          if (lambda >= lambdaTest) {
-            // upper bound 0.5*lambda
-            lambda = lambdaTest;
-            std::copy(_yTest, _yTest + _dimSys, _yHelp);
-            std::copy(_fTest, _fTest + _dimSys, _fHelp);
-            phiHelp = phiTest;
+        while (_iterationStatus == CONTINUE) {
+          // test half step that also serves as max bound for step reduction
+          double lambdaTest = 0.5*lambda;
+          for (int i = 0; i < _dimSys; i++) {
+            _yTest[i] = _y[i] - lambdaTest * _f[i] /** _yNominal[i]*/;
+            _yTest[i] = std::min(_yMax[i], std::max(_yMin[i], _yTest[i]));
+          }
+          calcFunction(_yTest, _fTest);
+          double phiTest = 0.0;
+          for (int i = 0; i < _dimSys; i++) {
+            _fTest[i] /= _fNominal[i];
+            phiTest += _fTest[i] * _fTest[i];
           }
-          else {
-            for (int i = 0; i < _dimSys; i++) {
-              _yHelp[i] = _y[i] - lambda * _f[i] /** _yNominal[i]*/;
-              _yHelp[i] = std::min(_yMax[i], std::max(_yMin[i], _yHelp[i]));
+          // check for sufficient decrease of phiHelp
+          // and no further decrease with phiTest
+          // otherwise minimize quadratic approximation of phi(lambda)
+          if (phiHelp > (1.0 - alpha * lambda) * phi ||
+              phiTest < (1.0 - alpha * lambda) * phiHelp) {
+            long int n = 3;
+            long int ipiv[3];
+            double bx[] = {phi, phiTest, phiHelp};
+            double A[] = {1.0, 1.0, 1.0,
+                          0.0, lambdaTest, lambda,
+                          0.0, lambdaTest*lambdaTest, lambda*lambda};
+            dgesv_(&n, &dimRHS, A, &n, ipiv, bx, &n, &info);
+            lambda = std::max(0.1*lambda, -0.5*bx[1]/bx[2]);
+            if (!(lambda >= 1e-10))
+              throw ModelicaSimulationError(ALGLOOP_SOLVER,
+                "Can't get sufficient decrease of solution");
+            if (lambda >= lambdaTest) {
+              // upper bound 0.5*lambda
+              lambda = lambdaTest;
+              std::copy(_yTest, _yTest + _dimSys, _yHelp);
+              std::copy(_fTest, _fTest + _dimSys, _fHelp);
+              phiHelp = phiTest;
             }
-            calcFunction(_yHelp, _fHelp);
-            phiHelp = 0.0;
-            for (int i = 0; i < _dimSys; i++) {
-              _fHelp[i] /= _fNominal[i];
-              phiHelp += _fHelp[i] * _fHelp[i];
+            else {
+              for (int i = 0; i < _dimSys; i++) {
+                _yHelp[i] = _y[i] - lambda * _f[i] /** _yNominal[i]*/;
+                _yHelp[i] = std::min(_yMax[i], std::max(_yMin[i], _yHelp[i]));
+              }
+              calcFunction(_yHelp, _fHelp);
+              phiHelp = 0.0;
+              for (int i = 0; i < _dimSys; i++) {
+                _fHelp[i] /= _fNominal[i];
+                phiHelp += _fHelp[i] * _fHelp[i];
+              }
             }
+            LOGGER_WRITE("lambda = " + to_string(lambda) +
+                         ", phi = " + to_string(phi) +
+                         " --> " + to_string(phiHelp),
+                         _lc, LL_DEBUG);
           }
-          LOGGER_WRITE("lambda = " + to_string(lambda) +
-                       ", phi = " + to_string(phi) +
-                       " --> " + to_string(phiHelp),
-                       _lc, LL_DEBUG);
+          // check for sufficient decrease
+          if (phiHelp <= (1.0 - alpha * lambda) * phi)
+            break;
         }
-        // check for sufficient decrease
-        if (phiHelp <= (1.0 - alpha * lambda) * phi)
-          break;
+      }
+      catch (ModelicaSimulationError& ex) {
+        if (newJacobian)
+          throw;
+        // the outdated jacobian gives no usable direction, start again from the last iterate with a new one
+        LOGGER_WRITE("Newton: update jacobian after failed step (" + string(ex.what()) + ")", _lc, LL_DEBUG);
+        _hasDgesvFactors = false;
+        _iterationStatus = CONTINUE;
+        calcFunction(_y, _f);
+        continue;
       }
       // take iterate
       std::copy(_yHelp, _yHelp + _dimSys, _y);
       for (int i = 0; i < _dimSys; i++)
         _f[i] = _fHelp[i] * _fNominal[i];
-      phi = phiHelp;
+      // Update the jacobian in the next iteration if the simplified Newton iteration converges too slowly
+      if (_useJacobianReuse && (lambda < 1.0 || phiHelp > JACOBIAN_REUSE_MAX_RATE * JACOBIAN_REUSE_MAX_RATE * phi))
+        _hasDgesvFactors = false;
   } // end while
 
   LOGGER_WRITE_VECTOR("y*", _y, _dimSys, _lc, LL_DEBUG);
+  if (_useJacobianReuse)
+    LOGGER_WRITE("factorizations: " + to_string(_numFactorizations) +
+                 ", jacobian reuses: " + to_string(_numJacobianReuses),
+                 _lc, LL_DEBUG);
   LOGGER_WRITE_END(_lc, LL_DEBUG);
 }
 
@@ -14,6 +14,7 @@ NewtonSettings::NewtonSettings()
   , _dAtol                     (1e-8)
   , _dDelta                    (1)
   , _continueOnError           (false)
+  , _jacobianReuse             (false)
 {
 }
 
@@ -79,4 +80,14 @@ bool NewtonSettings::getContinueOnError()
   return _continueOnError;
 }
 
+void NewtonSettings::setJacobianReuse(bool value)
+{
+  _jacobianReuse = value;
+}
+
+bool NewtonSettings::getJacobianReuse()
+{
+  return _jacobianReuse;
+}
+
 /** @} */ // end of solverNewton
@@ -15,6 +15,7 @@ NoxSettings::NoxSettings()
 , _dAtol           (1.0e-13)
 , _dDelta          (0.9)
 , _continueOnError(false)
+, _jacobianReuse(false)
 {
 };
 /*max. Anzahl an Newtonititerationen pro Schritt (default: 25)*/
@@ -71,4 +72,14 @@ bool NoxSettings::getContinueOnError()
 {
   return _continueOnError;
 }
+
+void NoxSettings::setJacobianReuse(bool value)
+{
+  _jacobianReuse = value;
+}
+
+bool NoxSettings::getJacobianReuse()
+{
+  return _jacobianReuse;
+}
 /** @} */ // end of solverNox
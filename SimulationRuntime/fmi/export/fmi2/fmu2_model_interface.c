@@ -44,6 +44,7 @@
 #include "simulation/solver/fmi_events.h"
 #include "simulation/simulation_info_json.h"
 #include "simulation/simulation_input_xml.h"
+#include "gc/memory_pool.h"
 /*
 DLLExport pthread_key_t fmu2_thread_data_key;
 */
@@ -400,10 +401,22 @@ fmi2Component fmi2Instantiate(fmi2String instanceName, fmi2Type fmuType, fmi2Str
     fmudata = (DATA *)functions->allocateMemory(1, sizeof(DATA));
     modelData = (MODEL_DATA *)functions->allocateMemory(1, sizeof(MODEL_DATA));
     simInfo = (SIMULATION_INFO *)functions->allocateMemory(1, sizeof(SIMULATION_INFO));
+    threadData = (threadData_t *)functions->allocateMemory(1, sizeof(threadData_t));
+    if (!comp->instanceName || !comp->GUID || !comp->functions || !fmudata || !modelData || !simInfo || !threadData) {
+      functions->logger(functions->componentEnvironment, instanceName, fmi2Error, "error", "fmi2Instantiate: Out of memory.");
+      /* freeMemory ignores null pointers */
+      functions->freeMemory(threadData);
+      functions->freeMemory(simInfo);
+      functions->freeMemory(modelData);
+      functions->freeMemory(fmudata);
+      functions->freeMemory((void*)comp->functions);
+      functions->freeMemory((void*)comp->GUID);
+      functions->freeMemory((void*)comp->instanceName);
+      functions->freeMemory(comp);
+      return NULL;
+    }
     fmudata->modelData = modelData;
     fmudata->simulationInfo = simInfo;
-
-    threadData = (threadData_t *)functions->allocateMemory(1, sizeof(threadData_t));
     memset(threadData, 0, sizeof(threadData_t));
     /*
     pthread_key_create(&fmu2_thread_data_key,NULL);
@@ -414,17 +427,13 @@ fmi2Component fmi2Instantiate(fmi2String instanceName, fmi2Type fmuType, fmi2Str
     comp->threadDataParent = threadDataParent;
     comp->fmuData = fmudata;
     threadData->localRoots[LOCAL_ROOT_FMI_DATA] = comp;
-    if (!comp->fmuData) {
-      functions->logger(functions->componentEnvironment, instanceName, fmi2Error, "error", "fmi2Instantiate: Could not initialize the global data structure file.");
-      return NULL;
-    }
     // set all categories to on or off. fmi2SetDebugLogging should be called to choose specific categories.
     for (i = 0; i < NUMBER_OF_CATEGORIES; i++) {
       comp->logCategories[i] = loggingOn;
     }
   }
 
-  if (!comp || !comp->instanceName || !comp->GUID || !comp->functions) {
+  if (!comp) {
     functions->logger(functions->componentEnvironment, instanceName, fmi2Error, "error", "fmi2Instantiate: Out of memory.");
     return NULL;
   }
@@ -492,6 +501,30 @@ fmi2Component fmi2Instantiate(fmi2String instanceName, fmi2Type fmuType, fmi2Str
     }
   }
 
+  /* fmi2DoStep releases the temporaries of the memory pool at the end of each step. Strings
+   * computed in a step are kept in the model data, so they have to stay in the pool. */
+  comp->memoryPool = omc_alloc_interface.malloc == omc_alloc_interface_pooled.malloc;
+  comp->releaseStepMemory = comp->memoryPool && comp->fmuData->modelData->nVariablesString == 0;
+
+  /* allocate memory for the solver of fmi2DoStep */
+  comp->doStepSize = 0;
+  comp->doStepWork = (fmi2Real*)functions->allocateMemory(7*NUMBER_OF_STATES + 2*NUMBER_OF_EVENT_INDICATORS + 1, sizeof(fmi2Real));
+  if (!comp->doStepWork) {
+    functions->logger(functions->componentEnvironment, instanceName, fmi2Error, "error", "fmi2Instantiate: Out of memory.");
+    /* the instance is complete up to the work arrays, free it like the environment would */
+    resetThreadData(comp);
+    fmi2FreeInstance(comp);
+    return NULL;
+  }
+  comp->states = comp->doStepWork;
+  comp->states_der = comp->states + NUMBER_OF_STATES;
+  comp->states_new = comp->states_der + NUMBER_OF_STATES;
+  comp->states_der_new = comp->states_new + NUMBER_OF_STATES;
+  comp->states_stages = comp->states_der_new + NUMBER_OF_STATES;
+  comp->states_interpolated = comp->states_stages + 2*NUMBER_OF_STATES;
+  comp->event_indicators = comp->states_interpolated + NUMBER_OF_STATES;
+  comp->event_indicators_prev = comp->event_indicators + NUMBER_OF_EVENT_INDICATORS;
+
   FILTERED_LOG(comp, fmi2OK, LOG_FMI2_CALL, "fmi2Instantiate: GUID=%s", fmuGUID)
   resetThreadData(comp);
   return comp;
@@ -528,6 +561,9 @@ void fmi2FreeInstance(fmi2Component c)
 
   comp->functions->freeMemory(comp->fmuData->modelData->resourcesDir);
 
+  /* free the work arrays of fmi2DoStep */
+  comp->functions->freeMemory(comp->doStepWork);
+
   /* free simuation data */
   comp->functions->freeMemory(comp->fmuData->modelData);
   comp->functions->freeMemory(comp->fmuData->simulationInfo);
@@ -657,6 +693,13 @@ fmi2Status fmi2Terminate(fmi2Component c)
     return fmi2Error;
   FILTERED_LOG(comp, fmi2OK, LOG_FMI2_CALL, "fmi2Terminate")
 
+  if (comp->memoryPool) {
+    memory_pool_statistics stats;
+    pool_get_statistics(&stats);
+    FILTERED_LOG(comp, fmi2OK, LOG_FMI2_CALL, "fmi2Terminate: memory pool peak = %lu bytes, reserved = %lu bytes, %lu allocations, %lu expansions",
+      (unsigned long)stats.peak, (unsigned long)stats.reserved, stats.allocations, stats.expansions)
+  }
+
   setThreadData(comp);
   comp->state = modelTerminated;
   resetThreadData(comp);
@@ -680,6 +723,9 @@ fmi2Status fmi2Reset(fmi2Component c)
     fmu2_model_interface_setupDataStruc(comp->fmuData, comp->threadData);
     initializeDataStruc(comp->fmuData, comp->threadData);
   }
+  if (comp->memoryPool) {
+    pool_reset_peak();
+  }
   /* reset the values to start */
   setDefaultStartValues(comp);
   setAllVarsToStart(comp->fmuData);
@@ -939,34 +985,478 @@ fmi2Status fmi2SetString(fmi2Component c, const fmi2ValueReference vr[], size_t
   return fmi2OK;
 }
 
+// ---------------------------------------------------------------------------
+// Private helpers for the FMU state
+// ---------------------------------------------------------------------------
+#define FMU2_STATE_VERSION 1
+#define FMU2_STATE_ALIGN(n) (((n) + 7) & ~((size_t)7))
+#define FMU2_STATE_ALL_MODES (modelInstantiated|modelInitializationMode|modelEventMode|modelContinuousTimeMode|modelTerminated|modelError)
+
+/* A FMU state is one contiguous memory block without any references. It
+ * starts with this header, followed by the values in the order of
+ * fmu2StateTransferValues, the contents of the strings and the contents of
+ * the delay buffers. The block is reused by fmi2GetFMUstate as long as it is
+ * large enough, fmi2SetFMUstate copies the values back into the existing
+ * model data. */
+typedef struct {
+  size_t allocatedSize;                /* number of allocated bytes including the header */
+  size_t size;                         /* number of used bytes including the header */
+  size_t stringOffset;                 /* position of the strings */
+  size_t nStrings;                     /* number of strings */
+  size_t delayOffset;                  /* position of the delay buffers */
+
+  ModelState state;
+  fmi2EventInfo eventInfo;
+  int _need_update;
+  fmi2Real doStepSize;
+
+  double nextSampleEvent;
+  double timeValueOld;
+  double solverSteps;
+  modelica_boolean initial;
+  modelica_boolean terminal;
+  modelica_boolean discreteCall;
+  modelica_boolean needToIterate;
+  modelica_boolean sampleActivated;
+} FMU2_STATE;
+
+typedef enum {
+  FMU2_STATE_SIZE,                     /* only compute the positions */
+  FMU2_STATE_STORE,                    /* copy the model data into the state */
+  FMU2_STATE_RESTORE                   /* copy the state into the model data */
+} FMU2_STATE_MODE;
+
+/* copies n bytes between the model data and the state, returns the next aligned position */
+static size_t fmu2StateCopy(FMU2_STATE_MODE mode, FMU2_STATE *s, size_t pos, void *values, size_t n)
+{
+  if (n == 0)
+    return pos;
+  if (mode == FMU2_STATE_STORE)
+    memcpy((char*)s + pos, values, n);
+  else if (mode == FMU2_STATE_RESTORE)
+    memcpy(values, (char*)s + pos, n);
+  return FMU2_STATE_ALIGN(pos + n);
+}
+
+/* copies n strings between the model data and the state. The state keeps the contents, a length
+ * (including the terminating zero, 0 for NULL) followed by the characters, since the memory of the
+ * state is not scanned by the garbage collector. Restoring allocates the strings again. */
+static size_t fmu2StateCopyStrings(FMU2_STATE_MODE mode, FMU2_STATE *s, size_t pos, modelica_string *values, size_t n)
+{
+  size_t i, length;
+  for (i = 0; i < n; i++) {
+    if (mode == FMU2_STATE_RESTORE) {
+      memcpy(&length, (char*)s + pos, sizeof(size_t));
+      values[i] = length ? mmc_mk_scon((char*)s + pos + sizeof(size_t)) : NULL;
+    } else {
+      length = values[i] ? MMC_STRLEN(values[i]) + 1 : 0;
+      if (mode == FMU2_STATE_STORE) {
+        memcpy((char*)s + pos, &length, sizeof(size_t));
+        if (length)
+          memcpy((char*)s + pos + sizeof(size_t), MMC_STRINGDATA(values[i]), length);
+      }
+    }
+    pos += sizeof(size_t) + length;
+  }
+  return pos;
+}
+
+/* transfers all values of fixed size: the ring buffer of SIMULATION_DATA, pre values, parameters,
+ * zero-crossings, relations, samples, clocks and the iteration variables of the nonlinear systems.
+ * Returns the position of the strings and their number in nStrings. */
+static size_t fmu2StateTransferValues(ModelInstance *comp, FMU2_STATE_MODE mode, FMU2_STATE *s, size_t *nStrings)
+{
+  DATA *data = comp->fmuData;
+  MODEL_DATA *mData = data->modelData;
+  SIMULATION_INFO *sInfo = data->simulationInfo;
+  size_t pos = FMU2_STATE_ALIGN(sizeof(FMU2_STATE));
+  long i;
+
+  for (i = 0; i < SIZERINGBUFFER; i++) {
+    SIMULATION_DATA *sData = data->localData[i];
+    pos = fmu2StateCopy(mode, s, pos, &sData->timeValue, sizeof(modelica_real));
+    pos = fmu2StateCopy(mode, s, pos, sData->realVars, mData->nVariablesReal*sizeof(modelica_real));
+    pos = fmu2StateCopy(mode, s, pos, sData->integerVars, mData->nVariablesInteger*sizeof(modelica_integer));
+    pos = fmu2StateCopy(mode, s, pos, sData->booleanVars, mData->nVariablesBoolean*sizeof(modelica_boolean));
+  }
+
+  pos = fmu2StateCopy(mode, s, pos, sInfo->realVarsPre, mData->nVariablesReal*sizeof(modelica_real));
+  pos = fmu2StateCopy(mode, s, pos, sInfo->integerVarsPre, mData->nVariablesInteger*sizeof(modelica_integer));
+  pos = fmu2StateCopy(mode, s, pos, sInfo->booleanVarsPre, mData->nVariablesBoolean*sizeof(modelica_boolean));
+
+  pos = fmu2StateCopy(mode, s, pos, sInfo->realParameter, mData->nParametersReal*sizeof(modelica_real));
+  pos = fmu2StateCopy(mode, s, pos, sInfo->integerParameter, mData->nParametersInteger*sizeof(modelica_integer));
+  pos = fmu2StateCopy(mode, s, pos, sInfo->booleanParameter, mData->nParametersBoolean*sizeof(modelica_boolean));
+
+  pos = fmu2StateCopy(mode, s, pos, sInfo->zeroCrossings, mData->nZeroCrossings*sizeof(modelica_real));
+  pos = fmu2StateCopy(mode, s, pos, sInfo->zeroCrossingsPre, mData->nZeroCrossings*sizeof(modelica_real));
+  pos = fmu2StateCopy(mode, s, pos, sInfo->relations, mData->nRelations*sizeof(modelica_boolean));
+  pos = fmu2StateCopy(mode, s, pos, sInfo->relationsPre, mData->nRelations*sizeof(modelica_boolean));
+  pos = fmu2StateCopy(mode, s, pos, sInfo->storedRelations, mData->nRelations*sizeof(modelica_boolean));
+  pos = fmu2StateCopy(mode, s, pos, sInfo->mathEventsValuePre, mData->nMathEvents*sizeof(modelica_real));
+
+  pos = fmu2StateCopy(mode, s, pos, sInfo->nextSampleTimes, mData->nSamples*sizeof(double));
+  pos = fmu2StateCopy(mode, s, pos, sInfo->samples, mData->nSamples*sizeof(modelica_boolean));
+  pos = fmu2StateCopy(mode, s, pos, sInfo->clocksData, mData->nClocks*sizeof(CLOCK_DATA));
+
+#if !defined(OMC_NUM_NONLINEAR_SYSTEMS) || OMC_NUM_NONLINEAR_SYSTEMS>0
+  /* iteration variables, they are used as start values of the next solver call */
+  for (i = 0; i < mData->nNonLinearSystems; i++) {
+    NONLINEAR_SYSTEM_DATA *nonlinsys = &sInfo->nonlinearSystemData[i];
+    pos = fmu2StateCopy(mode, s, pos, nonlinsys->nlsx, nonlinsys->size*sizeof(modelica_real));
+    pos = fmu2StateCopy(mode, s, pos, nonlinsys->nlsxOld, nonlinsys->size*sizeof(modelica_real));
+    pos = fmu2StateCopy(mode, s, pos, nonlinsys->nlsxExtrapolation, nonlinsys->size*sizeof(modelica_real));
+  }
+#endif
+
+  *nStrings = (SIZERINGBUFFER + 1) * mData->nVariablesString + mData->nParametersString;
+  return pos;
+}
+
+/* transfers the contents of all strings starting at pos, returns the position of the delay buffers */
+static size_t fmu2StateTransferStrings(ModelInstance *comp, FMU2_STATE_MODE mode, FMU2_STATE *s, size_t pos)
+{
+  DATA *data = comp->fmuData;
+  MODEL_DATA *mData = data->modelData;
+  long i;
+
+  for (i = 0; i < SIZERINGBUFFER; i++) {
+    pos = fmu2StateCopyStrings(mode, s, pos, data->localData[i]->stringVars, mData->nVariablesString);
+  }
+  pos = fmu2StateCopyStrings(mode, s, pos, data->simulationInfo->stringVarsPre, mData->nVariablesString);
+  pos = fmu2StateCopyStrings(mode, s, pos, data->simulationInfo->stringParameter, mData->nParametersString);
+  return FMU2_STATE_ALIGN(pos);
+}
+
+/* number of bytes needed for the delay buffers */
+static size_t fmu2StateDelaySize(ModelInstance *comp)
+{
+  size_t size = 0;
+#if !defined(OMC_NDELAY_EXPRESSIONS) || OMC_NDELAY_EXPRESSIONS>0
+  long i;
+  for (i = 0; i < comp->fmuData->modelData->nDelayExpressions; i++) {
+    size += sizeof(size_t) + ringBufferLength(comp->fmuData->simulationInfo->delayStructure[i]) * sizeof(TIME_AND_VALUE);
+  }
+#endif
+  return size;
+}
+
+static void fmu2StateStoreDelays(ModelInstance *comp, FMU2_STATE *s)
+{
+#if !defined(OMC_NDELAY_EXPRESSIONS) || OMC_NDELAY_EXPRESSIONS>0
+  char *pos = (char*)s + s->delayOffset;
+  long i;
+  size_t j;
+  for (i = 0; i < comp->fmuData->modelData->nDelayExpressions; i++) {
+    RINGBUFFER *delayStruct = comp->fmuData->simulationInfo->delayStructure[i];
+    size_t length = ringBufferLength(delayStruct);
+    memcpy(pos, &length, sizeof(size_t));
+    pos += sizeof(size_t);
+    for (j = 0; j < length; j++) {
+      memcpy(pos, getRingData(delayStruct, j), sizeof(TIME_AND_VALUE));
+      pos += sizeof(TIME_AND_VALUE);
+    }
+  }
+#endif
+}
+
+static void fmu2StateRestoreDelays(ModelInstance *comp, const FMU2_STATE *s)
+{
+#if !defined(OMC_NDELAY_EXPRESSIONS) || OMC_NDELAY_EXPRESSIONS>0
+  const char *pos = (const char*)s + s->delayOffset;
+  TIME_AND_VALUE tpl;
+  long i;
+  size_t j, length;
+  for (i = 0; i < comp->fmuData->modelData->nDelayExpressions; i++) {
+    RINGBUFFER *delayStruct = comp->fmuData->simulationInfo->delayStructure[i];
+    memcpy(&length, pos, sizeof(size_t));
+    pos += sizeof(size_t);
+    /* the buffer keeps its memory, it only grows if the restored history is longer than any before */
+    clearRingBuffer(delayStruct);
+    for (j = 0; j < length; j++) {
+      memcpy(&tpl, pos, sizeof(TIME_AND_VALUE));
+      appendRingData(delayStruct, &tpl);
+      pos += sizeof(TIME_AND_VALUE);
+    }
+  }
+#endif
+}
+
+/* checks that a state has the layout of the model data of this instance and that all strings and
+ * delay buffers lie within its size. header is an aligned copy of the header of the state, block
+ * the state itself or its serialized copy, it has to provide header->size bytes. */
+static fmi2Boolean fmu2StateIsValid(ModelInstance *comp, const FMU2_STATE *header, const char *block)
+{
+  size_t stringOffset, nStrings, pos, i, length;
+
+  stringOffset = fmu2StateTransferValues(comp, FMU2_STATE_SIZE, NULL, &nStrings);
+  if (header->stringOffset != stringOffset || header->nStrings != nStrings ||
+      header->delayOffset < stringOffset || header->size < header->delayOffset)
+    return fmi2False;
+
+  pos = stringOffset;
+  for (i = 0; i < nStrings; i++) {
+    if (header->delayOffset - pos < sizeof(size_t))
+      return fmi2False;
+    memcpy(&length, block + pos, sizeof(size_t));
+    pos += sizeof(size_t);
+    if (header->delayOffset - pos < length || (length && block[pos+length-1] != '\0'))
+      return fmi2False;
+    pos += length;
+  }
+  if (FMU2_STATE_ALIGN(pos) != header->delayOffset)
+    return fmi2False;
+
+#if !defined(OMC_NDELAY_EXPRESSIONS) || OMC_NDELAY_EXPRESSIONS>0
+  pos = header->delayOffset;
+  for (i = 0; i < (size_t)comp->fmuData->modelData->nDelayExpressions; i++) {
+    if (header->size - pos < sizeof(size_t))
+      return fmi2False;
+    memcpy(&length, block + pos, sizeof(size_t));
+    pos += sizeof(size_t);
+    if (length > (header->size - pos) / sizeof(TIME_AND_VALUE))
+      return fmi2False;
+    pos += length * sizeof(TIME_AND_VALUE);
+  }
+#endif
+  return fmi2True;
+}
+
+/* stores the current state of the instance, the given state is reused if it is large enough.
+ * Returns NULL if no memory is available, the given state is left unchanged in that case. */
+static FMU2_STATE* fmu2StoreState(ModelInstance *comp, FMU2_STATE *s)
+{
+  SIMULATION_INFO *sInfo = comp->fmuData->simulationInfo;
+  size_t stringOffset, nStrings, delayOffset, size;
+
+  stringOffset = fmu2StateTransferValues(comp, FMU2_STATE_SIZE, NULL, &nStrings);
+  delayOffset = fmu2StateTransferStrings(comp, FMU2_STATE_SIZE, NULL, stringOffset);
+  size = delayOffset + fmu2StateDelaySize(comp);
+
+  if (!s || s->allocatedSize < size) {
+    /* leave some space for growing strings and delay buffers */
+    size_t allocatedSize = size + (size - stringOffset) / 2;
+    FMU2_STATE *newState = (FMU2_STATE*)comp->functions->allocateMemory(1, allocatedSize);
+    if (!newState)
+      return NULL;
+    if (s)
+      comp->functions->freeMemory(s);
+    s = newState;
+    s->allocatedSize = allocatedSize;
+  }
+
+  s->size = size;
+  s->stringOffset = stringOffset;
+  s->nStrings = nStrings;
+  s->delayOffset = delayOffset;
+
+  s->state = comp->state;
+  s->eventInfo = comp->eventInfo;
+  s->_need_update = comp->_need_update;
+  s->doStepSize = comp->doStepSize;
+
+  s->nextSampleEvent = sInfo->nextSampleEvent;
+  s->timeValueOld = sInfo->timeValueOld;
+  s->solverSteps = sInfo->solverSteps;
+  s->initial = sInfo->initial;
+  s->terminal = sInfo->terminal;
+  s->discreteCall = sInfo->discreteCall;
+  s->needToIterate = sInfo->needToIterate;
+  s->sampleActivated = sInfo->sampleActivated;
+
+  fmu2StateTransferValues(comp, FMU2_STATE_STORE, s, &nStrings);
+  fmu2StateTransferStrings(comp, FMU2_STATE_STORE, s, stringOffset);
+  fmu2StateStoreDelays(comp, s);
+  return s;
+}
+
+/* restores a state into the model data of the instance, only the strings are allocated again */
+static void fmu2RestoreState(ModelInstance *comp, const FMU2_STATE *s)
+{
+  SIMULATION_INFO *sInfo = comp->fmuData->simulationInfo;
+  size_t nStrings;
+
+  comp->state = s->state;
+  comp->eventInfo = s->eventInfo;
+  comp->_need_update = s->_need_update;
+  comp->doStepSize = s->doStepSize;
+
+  sInfo->nextSampleEvent = s->nextSampleEvent;
+  sInfo->timeValueOld = s->timeValueOld;
+  sInfo->solverSteps = s->solverSteps;
+  sInfo->initial = s->initial;
+  sInfo->terminal = s->terminal;
+  sInfo->discreteCall = s->discreteCall;
+  sInfo->needToIterate = s->needToIterate;
+  sInfo->sampleActivated = s->sampleActivated;
+
+  fmu2StateTransferValues(comp, FMU2_STATE_RESTORE, (FMU2_STATE*)s, &nStrings);
+  fmu2StateTransferStrings(comp, FMU2_STATE_RESTORE, (FMU2_STATE*)s, s->stringOffset);
+  fmu2StateRestoreDelays(comp, s);
+
+#if !defined(OMC_NUM_NONLINEAR_SYSTEMS) || OMC_NUM_NONLINEAR_SYSTEMS>0
+  /* forget the solutions after the restored point in time, they must not be used for extrapolation */
+  cleanUpOldValueListAfterEvent(comp->fmuData, comp->fmuData->localData[0]->timeValue);
+#endif
+}
+
+/* The serialized state consists of a version, the GUID of the model and the state block, which
+ * does not contain any references. */
+static size_t fmu2StateSerializedSize(const FMU2_STATE *s)
+{
+  return sizeof(int) + sizeof(size_t) + strlen(MODEL_GUID) + s->size;
+}
+
 fmi2Status fmi2GetFMUstate(fmi2Component c, fmi2FMUstate* FMUstate)
 {
-  return unsupportedFunction(c, "fmi2GetFMUstate", modelInstantiated|modelInitializationMode|modelEventMode|modelContinuousTimeMode|modelTerminated|modelError);
+  ModelInstance *comp = (ModelInstance *)c;
+  FMU2_STATE *s;
+  if (invalidState(comp, "fmi2GetFMUstate", FMU2_STATE_ALL_MODES, FMU2_STATE_ALL_MODES))
+    return fmi2Error;
+  if (nullPointer(comp, "fmi2GetFMUstate", "FMUstate", FMUstate))
+    return fmi2Error;
+  FILTERED_LOG(comp, fmi2OK, LOG_FMI2_CALL, "fmi2GetFMUstate")
+
+  s = fmu2StoreState(comp, (FMU2_STATE*)*FMUstate);
+  if (!s) {
+    FILTERED_LOG(comp, fmi2Error, LOG_STATUSERROR, "fmi2GetFMUstate: Out of memory.")
+    return fmi2Error;
+  }
+  *FMUstate = (fmi2FMUstate)s;
+  return fmi2OK;
 }
 
 fmi2Status fmi2SetFMUstate(fmi2Component c, fmi2FMUstate FMUstate)
 {
-  return unsupportedFunction(c, "fmi2SetFMUstate", modelInstantiated|modelInitializationMode|modelEventMode|modelContinuousTimeMode|modelTerminated|modelError);
+  ModelInstance *comp = (ModelInstance *)c;
+  const FMU2_STATE *s = (const FMU2_STATE*)FMUstate;
+  if (invalidState(comp, "fmi2SetFMUstate", FMU2_STATE_ALL_MODES, FMU2_STATE_ALL_MODES))
+    return fmi2Error;
+  if (nullPointer(comp, "fmi2SetFMUstate", "FMUstate", FMUstate))
+    return fmi2Error;
+  FILTERED_LOG(comp, fmi2OK, LOG_FMI2_CALL, "fmi2SetFMUstate")
+
+  if (s->size > s->allocatedSize || !fmu2StateIsValid(comp, s, (const char*)s)) {
+    FILTERED_LOG(comp, fmi2Error, LOG_STATUSERROR, "fmi2SetFMUstate: The FMU state does not belong to this model.")
+    return fmi2Error;
+  }
+  fmu2RestoreState(comp, s);
+  return fmi2OK;
 }
 
 fmi2Status fmi2FreeFMUstate(fmi2Component c, fmi2FMUstate* FMUstate)
 {
-  return unsupportedFunction(c, "fmi2FreeFMUstate", modelInstantiated|modelInitializationMode|modelEventMode|modelContinuousTimeMode|modelTerminated|modelError);
+  ModelInstance *comp = (ModelInstance *)c;
+  if (invalidState(comp, "fmi2FreeFMUstate", FMU2_STATE_ALL_MODES, FMU2_STATE_ALL_MODES))
+    return fmi2Error;
+  if (nullPointer(comp, "fmi2FreeFMUstate", "FMUstate", FMUstate))
+    return fmi2Error;
+  FILTERED_LOG(comp, fmi2OK, LOG_FMI2_CALL, "fmi2FreeFMUstate")
+
+  if (*FMUstate) {
+    comp->functions->freeMemory(*FMUstate);
+    *FMUstate = NULL;
+  }
+  return fmi2OK;
 }
 
 fmi2Status fmi2SerializedFMUstateSize(fmi2Component c, fmi2FMUstate FMUstate, size_t *size)
 {
-  return unsupportedFunction(c, "fmi2SerializedFMUstateSize", modelInstantiated|modelInitializationMode|modelEventMode|modelContinuousTimeMode|modelTerminated|modelError);
+  ModelInstance *comp = (ModelInstance *)c;
+  if (invalidState(comp, "fmi2SerializedFMUstateSize", FMU2_STATE_ALL_MODES, FMU2_STATE_ALL_MODES))
+    return fmi2Error;
+  if (nullPointer(comp, "fmi2SerializedFMUstateSize", "FMUstate", FMUstate))
+    return fmi2Error;
+  if (nullPointer(comp, "fmi2SerializedFMUstateSize", "size", size))
+    return fmi2Error;
+
+  *size = fmu2StateSerializedSize((const FMU2_STATE*)FMUstate);
+  FILTERED_LOG(comp, fmi2OK, LOG_FMI2_CALL, "fmi2SerializedFMUstateSize: size = %d", (int)*size)
+  return fmi2OK;
 }
 
 fmi2Status fmi2SerializeFMUstate(fmi2Component c, fmi2FMUstate FMUstate, fmi2Byte serializedState[], size_t size)
 {
-  return unsupportedFunction(c, "fmi2SerializeFMUstate", modelInstantiated|modelInitializationMode|modelEventMode|modelContinuousTimeMode|modelTerminated|modelError);
+  ModelInstance *comp = (ModelInstance *)c;
+  const FMU2_STATE *s = (const FMU2_STATE*)FMUstate;
+  size_t guidLength = strlen(MODEL_GUID);
+  int version = FMU2_STATE_VERSION;
+  char *pos = serializedState;
+  if (invalidState(comp, "fmi2SerializeFMUstate", FMU2_STATE_ALL_MODES, FMU2_STATE_ALL_MODES))
+    return fmi2Error;
+  if (nullPointer(comp, "fmi2SerializeFMUstate", "FMUstate", FMUstate))
+    return fmi2Error;
+  if (nullPointer(comp, "fmi2SerializeFMUstate", "serializedState", serializedState))
+    return fmi2Error;
+  FILTERED_LOG(comp, fmi2OK, LOG_FMI2_CALL, "fmi2SerializeFMUstate: size = %d", (int)size)
+
+  if (size < fmu2StateSerializedSize(s)) {
+    FILTERED_LOG(comp, fmi2Error, LOG_STATUSERROR, "fmi2SerializeFMUstate: Invalid argument size = %d. Expected %d.", (int)size, (int)fmu2StateSerializedSize(s))
+    return fmi2Error;
+  }
+
+  memcpy(pos, &version, sizeof(int));
+  pos += sizeof(int);
+  memcpy(pos, &guidLength, sizeof(size_t));
+  pos += sizeof(size_t);
+  memcpy(pos, MODEL_GUID, guidLength);
+  pos += guidLength;
+  memcpy(pos, s, s->size);
+  return fmi2OK;
 }
 
 fmi2Status fmi2DeSerializeFMUstate(fmi2Component c, const fmi2Byte serializedState[], size_t size, fmi2FMUstate* FMUstate)
 {
-  return unsupportedFunction(c, "fmi2DeSerializeFMUstate", modelInstantiated|modelInitializationMode|modelEventMode|modelContinuousTimeMode|modelTerminated|modelError);
+  ModelInstance *comp = (ModelInstance *)c;
+  FMU2_STATE header, *s;
+  size_t guidLength;
+  int version;
+  const char *pos = serializedState, *end = serializedState + size;
+  if (invalidState(comp, "fmi2DeSerializeFMUstate", FMU2_STATE_ALL_MODES, FMU2_STATE_ALL_MODES))
+    return fmi2Error;
+  if (nullPointer(comp, "fmi2DeSerializeFMUstate", "serializedState", serializedState))
+    return fmi2Error;
+  if (nullPointer(comp, "fmi2DeSerializeFMUstate", "FMUstate", FMUstate))
+    return fmi2Error;
+  FILTERED_LOG(comp, fmi2OK, LOG_FMI2_CALL, "fmi2DeSerializeFMUstate: size = %d", (int)size)
+
+  /* check the version, the model and the layout of the state before the given state is touched */
+  if (size < sizeof(int) + sizeof(size_t))
+    goto invalid;
+  memcpy(&version, pos, sizeof(int));
+  pos += sizeof(int);
+  memcpy(&guidLength, pos, sizeof(size_t));
+  pos += sizeof(size_t);
+  if (version != FMU2_STATE_VERSION || guidLength != strlen(MODEL_GUID) || (size_t)(end - pos) < guidLength + sizeof(FMU2_STATE) || strncmp(pos, MODEL_GUID, guidLength))
+    goto invalid;
+  pos += guidLength;
+  memcpy(&header, pos, sizeof(FMU2_STATE));
+  if ((size_t)(end - pos) < header.size || !fmu2StateIsValid(comp, &header, pos))
+    goto invalid;
+
+  /* reuse the given state if it is large enough */
+  s = (FMU2_STATE*)*FMUstate;
+  if (!s || s->allocatedSize < header.size) {
+    FMU2_STATE *newState = (FMU2_STATE*)comp->functions->allocateMemory(1, header.size);
+    if (!newState) {
+      FILTERED_LOG(comp, fmi2Error, LOG_STATUSERROR, "fmi2DeSerializeFMUstate: Out of memory.")
+      return fmi2Error;
+    }
+    if (s)
+      comp->functions->freeMemory(s);
+    s = newState;
+    header.allocatedSize = header.size;
+  } else {
+    header.allocatedSize = s->allocatedSize;
+  }
+  memcpy(s, pos, header.size);
+  s->allocatedSize = header.allocatedSize;
+  *FMUstate = (fmi2FMUstate)s;
+  return fmi2OK;
+
+invalid:
+  FILTERED_LOG(comp, fmi2Error, LOG_STATUSERROR, "fmi2DeSerializeFMUstate: The serialized FMU state is invalid or does not belong to this model.")
+  return fmi2Error;
 }
 
 fmi2Status fmi2GetDirectionalDerivative(fmi2Component c,
@@ -1309,20 +1799,164 @@ fmi2Status fmi2GetRealOutputDerivatives(fmi2Component c, const fmi2ValueReferenc
   return unsupportedFunction(c, "fmi2GetRealOutputDerivatives", ~0);
 }
 
+// ---------------------------------------------------------------------------
+// Private helpers for the built-in solver of fmi2DoStep
+// ---------------------------------------------------------------------------
+/* The solver can be selected with -DFMI2_DOSTEP_SOLVER=FMI2_DOSTEP_EULER when the FMU is compiled. */
+#define FMI2_DOSTEP_EULER 1            /* forward Euler, one step per communication interval */
+#define FMI2_DOSTEP_RK23  2            /* embedded Runge-Kutta method of Bogacki and Shampine with error control */
+#if !defined(FMI2_DOSTEP_SOLVER)
+#define FMI2_DOSTEP_SOLVER FMI2_DOSTEP_RK23
+#endif
+
+/* relative and absolute tolerance if fmi2SetupExperiment does not define one */
+#define FMI2_DOSTEP_DEFAULT_TOLERANCE 1e-6
+
+/* sets time and states and evaluates the derivatives */
+static fmi2Status doStepDerivatives(ModelInstance *comp, fmi2Real t, const fmi2Real *x, fmi2Real *der)
+{
+  if (fmi2SetTime(comp, t) != fmi2OK)
+    return fmi2Error;
+  if (fmi2SetContinuousStates(comp, x, NUMBER_OF_STATES) != fmi2OK)
+    return fmi2Error;
+  return fmi2GetDerivatives(comp, der, NUMBER_OF_STATES);
+}
+
+/* returns 1 if an event indicator changed its sign */
+static int doStepZeroCrossing(const fmi2Real *indicators, const fmi2Real *indicatorsPrev)
+{
+  int i;
+  for (i = 0; i < NUMBER_OF_EVENT_INDICATORS; i++) {
+    if (indicators[i]*indicatorsPrev[i] < 0) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* cubic Hermite interpolation of the states at t+theta*h of the substep [t, t+h] */
+static void doStepInterpolate(ModelInstance *comp, fmi2Real h, fmi2Real theta, fmi2Real *x)
+{
+  int i;
+  fmi2Real h00 = (1 + 2*theta)*(1 - theta)*(1 - theta);
+  fmi2Real h10 = theta*(1 - theta)*(1 - theta);
+  fmi2Real h01 = theta*theta*(3 - 2*theta);
+  fmi2Real h11 = theta*theta*(theta - 1);
+  for (i = 0; i < NUMBER_OF_STATES; i++) {
+    x[i] = h00*comp->states[i] + h10*h*comp->states_der[i] + h01*comp->states_new[i] + h11*h*comp->states_der_new[i];
+  }
+}
+
+/* sets time and states of the substep [t, t+h] to t+theta*h */
+static fmi2Status doStepSetInterpolated(ModelInstance *comp, fmi2Real t, fmi2Real h, fmi2Real theta)
+{
+  doStepInterpolate(comp, h, theta, comp->states_interpolated);
+  if (fmi2SetTime(comp, t + theta*h) != fmi2OK)
+    return fmi2Error;
+  if (NUMBER_OF_STATES > 0)
+    return fmi2SetContinuousStates(comp, comp->states_interpolated, NUMBER_OF_STATES);
+  return fmi2OK;
+}
+
+/* Locates the first zero-crossing of the accepted substep [t, t+h] by bisection on the dense output.
+ * Afterwards the FMU is at the right side of the zero-crossing. */
+static fmi2Status doStepLocateEvent(ModelInstance *comp, fmi2Real t, fmi2Real h, fmi2Real tol)
+{
+  fmi2Real left = 0, right = 1, theta;
+
+  while (right - left > 1e-3*tol) {
+    theta = 0.5*(left + right);
+    if (doStepSetInterpolated(comp, t, h, theta) != fmi2OK)
+      return fmi2Error;
+    if (fmi2GetEventIndicators(comp, comp->event_indicators, NUMBER_OF_EVENT_INDICATORS) != fmi2OK)
+      return fmi2Error;
+
+    if (doStepZeroCrossing(comp->event_indicators, comp->event_indicators_prev)) {
+      right = theta;
+    } else {
+      left = theta;
+      memcpy(comp->event_indicators_prev, comp->event_indicators, NUMBER_OF_EVENT_INDICATORS*sizeof(fmi2Real));
+    }
+  }
+  FILTERED_LOG(comp, fmi2OK, LOG_EVENTS, "fmi2DoStep: zero-crossing located at time=%.16g", t + right*h)
+  return doStepSetInterpolated(comp, t, h, right);
+}
+
+/* Integrates from t towards tNext with one accepted substep. On return the FMU is at t+hStep with the
+ * states states_new, derivativesValid is 1 if states_der_new are the derivatives at this point. */
+static fmi2Status doStepIntegrate(ModelInstance *comp, fmi2Real t, fmi2Real tNext, fmi2Real tol, fmi2Real *h, fmi2Real *hStep, int *derivativesValid)
+{
+  int i;
+#if FMI2_DOSTEP_SOLVER == FMI2_DOSTEP_EULER
+  *hStep = tNext - t;
+  for (i = 0; i < NUMBER_OF_STATES; i++) {
+    comp->states_new[i] = comp->states[i] + *hStep * comp->states_der[i];
+    comp->states_der_new[i] = comp->states_der[i];
+  }
+  *derivativesValid = 0;
+  if (fmi2SetTime(comp, tNext) != fmi2OK)
+    return fmi2Error;
+  return fmi2SetContinuousStates(comp, comp->states_new, NUMBER_OF_STATES);
+#else
+  fmi2Real *k1 = comp->states_der, *k2 = comp->states_stages, *k3 = comp->states_stages + NUMBER_OF_STATES, *k4 = comp->states_der_new;
+  fmi2Real err, sc, factor;
+  int lastStep;
+
+  while (1) {
+    /* do not step over tNext and avoid a tiny last step */
+    lastStep = (t + 1.1 * *h >= tNext);
+    *hStep = lastStep ? tNext - t : *h;
+    if (*hStep <= 1e-14*fmax(1.0, fabs(t))) {
+      FILTERED_LOG(comp, fmi2Error, LOG_STATUSERROR, "fmi2DoStep: step size too small at time=%.16g", t)
+      return fmi2Error;
+    }
+
+    for (i = 0; i < NUMBER_OF_STATES; i++)
+      comp->states_new[i] = comp->states[i] + 0.5 * *hStep * k1[i];
+    if (doStepDerivatives(comp, t + 0.5 * *hStep, comp->states_new, k2) != fmi2OK)
+      return fmi2Error;
+
+    for (i = 0; i < NUMBER_OF_STATES; i++)
+      comp->states_new[i] = comp->states[i] + 0.75 * *hStep * k2[i];
+    if (doStepDerivatives(comp, t + 0.75 * *hStep, comp->states_new, k3) != fmi2OK)
+      return fmi2Error;
+
+    for (i = 0; i < NUMBER_OF_STATES; i++)
+      comp->states_new[i] = comp->states[i] + *hStep * (2.0/9.0*k1[i] + 1.0/3.0*k2[i] + 4.0/9.0*k3[i]);
+    if (doStepDerivatives(comp, lastStep ? tNext : t + *hStep, comp->states_new, k4) != fmi2OK)
+      return fmi2Error;
+
+    /* weighted root mean square of the difference to the embedded second order solution */
+    err = 0;
+    for (i = 0; i < NUMBER_OF_STATES; i++) {
+      sc = tol + tol*fmax(fabs(comp->states[i]), fabs(comp->states_new[i]));
+      err += pow(*hStep * (-5.0/72.0*k1[i] + 1.0/12.0*k2[i] + 1.0/9.0*k3[i] - 1.0/8.0*k4[i]) / sc, 2);
+    }
+    err = sqrt(err / NUMBER_OF_STATES);
+
+    factor = (err > 0) ? 0.9*pow(err, -1.0/3.0) : 5.0;
+    factor = fmin(5.0, fmax(0.2, factor));
+    if (err <= 1.0) {
+      /* a truncated last step must not reduce the step size of the next communication interval */
+      *h = lastStep ? fmax(*h, *hStep * factor) : *hStep * factor;
+      *derivativesValid = 1;
+      return fmi2OK;
+    }
+    FILTERED_LOG(comp, fmi2OK, LOG_FMI2_CALL, "fmi2DoStep: reject step at time=%.16g with step size %g, error %g", t, *hStep, err)
+    *h = *hStep * factor;
+  }
+#endif
+}
+
 fmi2Status fmi2DoStep(fmi2Component c, fmi2Real currentCommunicationPoint, fmi2Real communicationStepSize, fmi2Boolean noSetFMUStatePriorToCurrentPoint)
 {
   ModelInstance *comp = (ModelInstance *)c;
-  fmi2CallbackFunctions* functions = (fmi2CallbackFunctions*)comp->functions;
-  int i, zc_event = 0, time_event = 0;
+  int zc_event, time_event, derivativesValid = 0;
   fmi2Status status = fmi2OK;
-  fmi2Real* states = (fmi2Real*)functions->allocateMemory(NUMBER_OF_STATES, sizeof(fmi2Real));
-  fmi2Real* states_der = (fmi2Real*)functions->allocateMemory(NUMBER_OF_STATES, sizeof(fmi2Real));
-  fmi2Real* event_indicators = (fmi2Real*)functions->allocateMemory(NUMBER_OF_EVENT_INDICATORS, sizeof(fmi2Real));
-  fmi2Real* event_indicators_prev = (fmi2Real*)functions->allocateMemory(NUMBER_OF_EVENT_INDICATORS, sizeof(fmi2Real));
-  fmi2Real t = comp->fmuData->localData[0]->timeValue;
-  fmi2Real tNext, tEnd;
+  fmi2Real t, tNext, tEnd, h, hStep, *tmp;
+  fmi2Real tol = comp->toleranceDefined ? comp->tolerance : FMI2_DOSTEP_DEFAULT_TOLERANCE;
   fmi2Boolean enterEventMode = fmi2False, terminateSimulation = fmi2False;
-  fmi2Real tCommunication;
+  memory_pool_mark stepMark;
 
   fmi2EventInfo eventInfo;
   eventInfo.newDiscreteStatesNeeded           = fmi2False;
@@ -1332,120 +1966,114 @@ fmi2Status fmi2DoStep(fmi2Component c, fmi2Real currentCommunicationPoint, fmi2R
   eventInfo.nextEventTimeDefined              = fmi2False;
   eventInfo.nextEventTime                     = -0.0;
 
-  if (comp->stopTimeDefined)
+  tEnd = currentCommunicationPoint + communicationStepSize;
+  if (comp->stopTimeDefined && tEnd > comp->stopTime)
     tEnd = comp->stopTime;
-  else
-    tEnd = currentCommunicationPoint + communicationStepSize;
-  tCommunication = currentCommunicationPoint;
+
+  /* start with the step size of the last communication interval */
+  h = (comp->doStepSize > 0) ? comp->doStepSize : communicationStepSize;
+
+  /* all temporaries of the step are released at the end */
+  if (comp->releaseStepMemory)
+    stepMark = pool_mark();
 
   fmi2EnterEventMode(c);
   fmi2EventIteration(c, &eventInfo);
   fmi2EnterContinuousTimeMode(c);
 
-  while (status == fmi2OK && comp->fmuData->localData[0]->timeValue < tEnd)
+  if (NUMBER_OF_EVENT_INDICATORS > 0)
   {
-    while (tCommunication <= comp->fmuData->localData[0]->timeValue)
-    {
-      tCommunication += communicationStepSize;
-    }
-
-    /* fprintf(stderr, "DoStep %g -> %g State: %s\n", comp->fmuData->localData[0]->timeValue, tNext, stateToString(comp)); */
-
-    if (NUMBER_OF_STATES > 0)
-    {
-      status = fmi2GetDerivatives(c, states_der, NUMBER_OF_STATES);
-      if (status != fmi2OK) {status=fmi2Error; break;}
-
-
-      status = fmi2GetContinuousStates(c, states, NUMBER_OF_STATES);
-      if (status != fmi2OK) {status=fmi2Error; break;}
-    }
-
-    if (NUMBER_OF_EVENT_INDICATORS > 0)
-    {
-      status = fmi2GetEventIndicators(c, event_indicators_prev, NUMBER_OF_EVENT_INDICATORS);
-      if (status != fmi2OK) {status=fmi2Error; break;}
-    }
+    status = fmi2GetEventIndicators(c, comp->event_indicators_prev, NUMBER_OF_EVENT_INDICATORS);
+    if (status != fmi2OK) status = fmi2Error;
+  }
 
-    /* adjust tNext step to get tEnd exactly */
-    if (tCommunication > tEnd - communicationStepSize/1e16)
-      tNext = tEnd;
-    else
-      tNext = tCommunication;
+  while (status == fmi2OK && comp->fmuData->localData[0]->timeValue < tEnd)
+  {
+    t = comp->fmuData->localData[0]->timeValue;
+    zc_event = 0;
+    time_event = 0;
 
     /* adjust for time events */
-    if (eventInfo.nextEventTimeDefined && (eventInfo.nextEventTime <= tNext))
+    tNext = tEnd;
+    if (eventInfo.nextEventTimeDefined && eventInfo.nextEventTime > t && eventInfo.nextEventTime <= tNext)
     {
       tNext = eventInfo.nextEventTime;
       time_event = 1;
     }
 
     /* integrate */
-    for (i = 0; i < NUMBER_OF_STATES; i++)
+    if (NUMBER_OF_STATES > 0)
     {
-      states[i] = states[i] + (tNext - comp->fmuData->localData[0]->timeValue) * states_der[i];
+      if (!derivativesValid)
+      {
+        status = fmi2GetContinuousStates(c, comp->states, NUMBER_OF_STATES);
+        if (status != fmi2OK) {status=fmi2Error; break;}
+        status = fmi2GetDerivatives(c, comp->states_der, NUMBER_OF_STATES);
+        if (status != fmi2OK) {status=fmi2Error; break;}
+      }
+      status = doStepIntegrate(comp, t, tNext, tol, &h, &hStep, &derivativesValid);
+      if (status != fmi2OK) {status=fmi2Error; break;}
     }
-    fmi2SetTime(c, tNext);
-
-    /* set the continuous states */
-    if (NUMBER_OF_STATES > 0)
+    else
     {
-      status = fmi2SetContinuousStates(c, states, NUMBER_OF_STATES);
+      hStep = tNext - t;
+      status = fmi2SetTime(c, tNext);
       if (status != fmi2OK) {status=fmi2Error; break;}
     }
+    if (hStep < tNext - t)
+      time_event = 0;
 
-    /* signal completed integrator step */
-    status = fmi2CompletedIntegratorStep(c, fmi2True, &enterEventMode, &terminateSimulation);
-    if (status != fmi2OK) {status=fmi2Error; break;}
-
-    /* check for events */
+    /* check for events inside the substep */
     if (NUMBER_OF_EVENT_INDICATORS > 0)
     {
-      status = fmi2GetEventIndicators(c, event_indicators, NUMBER_OF_EVENT_INDICATORS);
+      status = fmi2GetEventIndicators(c, comp->event_indicators, NUMBER_OF_EVENT_INDICATORS);
       if (status != fmi2OK) {status=fmi2Error; break;}
 
-      for (i = 0; i < NUMBER_OF_EVENT_INDICATORS; i++)
+      if (doStepZeroCrossing(comp->event_indicators, comp->event_indicators_prev))
       {
-        if (event_indicators[i]*event_indicators_prev[i] < 0)
-        {
-          zc_event = 1;
-          break;
-        }
+        zc_event = 1;
+        status = doStepLocateEvent(comp, t, hStep, tol);
+        if (status != fmi2OK) {status=fmi2Error; break;}
+        time_event = 0;
+        derivativesValid = 0;
       }
     }
 
+    /* signal completed integrator step */
+    status = fmi2CompletedIntegratorStep(c, fmi2True, &enterEventMode, &terminateSimulation);
+    if (status != fmi2OK) {status=fmi2Error; break;}
+
     if (enterEventMode || zc_event || time_event)
     {
-      /* fprintf(stderr, "enterEventMode = %d, zc_event = %d, time_event = %d\n", enterEventMode, zc_event, time_event); */
-
       fmi2EnterEventMode(c);
       fmi2EventIteration(c, &eventInfo);
+      derivativesValid = 0;
 
-      if (eventInfo.valuesOfContinuousStatesChanged)
-      {
-        status = fmi2GetContinuousStates(c, states, NUMBER_OF_STATES);
-        if (status != fmi2OK) {status=fmi2Error; break;}
-      }
-
-      if (eventInfo.nominalsOfContinuousStatesChanged)
-      {
-        status = fmi2GetNominalsOfContinuousStates(c, states, NUMBER_OF_STATES);
-        if (status != fmi2OK) {status=fmi2Error; break;}
-      }
-
-      status = fmi2GetEventIndicators(c, event_indicators_prev, NUMBER_OF_EVENT_INDICATORS);
+      status = fmi2GetEventIndicators(c, comp->event_indicators_prev, NUMBER_OF_EVENT_INDICATORS);
       if (status != fmi2OK) {status=fmi2Error; break;}
 
       status = fmi2EnterContinuousTimeMode(c);
       if (status != fmi2OK) {status=fmi2Error; break;}
     }
-  }
+    else
+    {
+      tmp = comp->event_indicators_prev;
+      comp->event_indicators_prev = comp->event_indicators;
+      comp->event_indicators = tmp;
+    }
 
-  functions->freeMemory(states);
-  functions->freeMemory(states_der);
-  functions->freeMemory(event_indicators);
-  functions->freeMemory(event_indicators_prev);
+    /* the end of the substep is the beginning of the next one */
+    tmp = comp->states;
+    comp->states = comp->states_new;
+    comp->states_new = tmp;
+    tmp = comp->states_der;
+    comp->states_der = comp->states_der_new;
+    comp->states_der_new = tmp;
+  }
 
+  comp->doStepSize = h;
+  if (comp->releaseStepMemory)
+    pool_release(stepMark);
   return status;
 }
 
@@ -91,6 +91,21 @@ typedef struct {
   int _need_update;
   int _has_jacobian;
   ANALYTIC_JACOBIAN* fmiDerJac;
+
+  /* built-in solver of fmi2DoStep, the work arrays are allocated once in fmi2Instantiate */
+  fmi2Real* doStepWork;                /* memory of all work arrays */
+  fmi2Real* states;                    /* states at the beginning of the substep */
+  fmi2Real* states_der;                /* derivatives at the beginning of the substep */
+  fmi2Real* states_new;                /* states at the end of the substep */
+  fmi2Real* states_der_new;            /* derivatives at the end of the substep */
+  fmi2Real* states_stages;             /* intermediate stages of the Runge-Kutta method */
+  fmi2Real* states_interpolated;       /* dense output used to locate zero-crossings */
+  fmi2Real* event_indicators;
+  fmi2Real* event_indicators_prev;
+  fmi2Real doStepSize;                 /* step size proposed by the error control for the next substep */
+
+  int memoryPool;                      /* temporaries are allocated from the memory pool (omc_alloc_interface_pooled) */
+  int releaseStepMemory;               /* fmi2DoStep releases its temporaries, only without string variables */
 } ModelInstance;
 
 /* reset alignment policy to the one set before reading this file */
@@ -48,18 +48,23 @@ typedef struct {
   UA_Boolean step;
   pthread_mutex_t mutex_pause;
   pthread_cond_t cond_pause;
-  double time[2];
   pthread_t thread;
   UA_MethodAttributes runAttr;
   double *inputVarsBackup;
   int gotNewInput;
+  int pendingWrites;          /* set by the server thread if inputs or states were written, read without lock */
   pthread_mutex_t write_values;
-  pthread_mutex_t mutex_values[2];
-  int latestValues;
-  UA_Double *realVals[2];
+  /* Values published to the clients. They are protected by a sequence lock: the simulation
+   * thread makes valuesSeq odd while it updates the values, a reader retries if valuesSeq was
+   * odd or has changed while it read the value. Readers never block the simulation thread. */
+  unsigned int valuesSeq;
+  double time;
+  UA_Double *realVals;
   int *realValsInputIndex;
-  UA_Boolean *boolVals[2];
+  int *changedReal;           /* indices of the real values that changed in this step */
+  UA_Boolean *boolVals;
   int *boolValsInputIndex;
+  int *changedBool;           /* indices of the boolean values that changed in this step */
   int reinitStateFlag;
   int *stateWasUpdatedFlag;
   double *updatedStates;
@@ -81,16 +86,47 @@ static void* threadWork(void *data)
   return status == UA_STATUSCODE_GOOD ? (void*)0 : (void*)1;
 }
 
+static inline unsigned int valuesReadBegin(omc_opc_ua_state *state)
+{
+  unsigned int seq;
+  while ((seq = __atomic_load_n(&state->valuesSeq, __ATOMIC_ACQUIRE)) & 1) {
+    /* the simulation thread is writing the changed values */
+  }
+  return seq;
+}
+
+static inline int valuesReadRetry(omc_opc_ua_state *state, unsigned int seq)
+{
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  return __atomic_load_n(&state->valuesSeq, __ATOMIC_RELAXED) != seq;
+}
+
+static inline void valuesWriteBegin(omc_opc_ua_state *state)
+{
+  __atomic_store_n(&state->valuesSeq, state->valuesSeq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void valuesWriteEnd(omc_opc_ua_state *state)
+{
+  __atomic_store_n(&state->valuesSeq, state->valuesSeq + 1, __ATOMIC_RELEASE);
+}
+
 static void waitForStep(omc_opc_ua_state *state)
 {
   int run;
   state->step = 0;
-  pthread_mutex_lock(&state->mutex_pause);
-  run = state->run;
-  while (!(state->run || state->step)) {
-    pthread_cond_wait(&state->cond_pause, &state->mutex_pause);
+  if (__atomic_load_n(&state->run, __ATOMIC_ACQUIRE)) {
+    /* running, no need to take the lock */
+    run = 1;
+  } else {
+    pthread_mutex_lock(&state->mutex_pause);
+    run = state->run;
+    while (!(state->run || state->step)) {
+      pthread_cond_wait(&state->cond_pause, &state->mutex_pause);
+    }
+    pthread_mutex_unlock(&state->mutex_pause);
   }
-  pthread_mutex_unlock(&state->mutex_pause);
   if (!run || state->data->real_time_sync.scaling != state->real_time_sync_scaling) {
     /* We were not running or the scaling factor changed. Reset the real-time synchronization! */
     state->omc_real_time_sync_update(state->data, state->real_time_sync_scaling);
@@ -126,11 +162,12 @@ readBoolean(void *handle, const UA_NodeId nodeid, UA_Boolean sourceTimeStamp, co
     int index1 = nodeid.identifier.numeric-VARKIND_BOOL*MAX_VARS_KIND;
     int index = index1 >= ALIAS_START_ID ? modelData->booleanAlias[index1-ALIAS_START_ID].nameID : index1;
     int negate = index1 >= ALIAS_START_ID ? modelData->booleanAlias[index1-ALIAS_START_ID].negate : 0;
-    int latestValues = state->latestValues;
-    pthread_mutex_lock(&state->mutex_values[latestValues]);
-    val = state->boolVals[latestValues][index];
+    unsigned int seq;
+    do {
+      seq = valuesReadBegin(state);
+      val = state->boolVals[index];
+    } while (valuesReadRetry(state, seq));
     val = negate ? !val : val;
-    pthread_mutex_unlock(&state->mutex_values[latestValues]);
   } else {
     dataValue->hasValue = UA_FALSE;
     BAD_RESULT()
@@ -180,13 +217,12 @@ writeBoolean(void *handle, const UA_NodeId nodeid, const UA_Variant *data, const
         if (state->data->simulationInfo->inputVars[inputIndex] != newVal) {
           state->gotNewInput = 1;
           state->inputVarsBackup[inputIndex] = newVal;
+          __atomic_store_n(&state->pendingWrites, 1, __ATOMIC_RELEASE);
         }
       } else {
-        pthread_mutex_unlock(&state->write_values);
         statusCode = UA_STATUSCODE_BADUNEXPECTEDERROR;
       }
     } else {
-      pthread_mutex_unlock(&state->write_values);
       statusCode = UA_STATUSCODE_BADUNEXPECTEDERROR;
     }
     pthread_mutex_unlock(&state->write_values);
@@ -202,31 +238,33 @@ readReal(void *handle, const UA_NodeId nodeid, UA_Boolean sourceTimeStamp, const
   omc_opc_ua_state *state = (omc_opc_ua_state*) handle;
   MODEL_DATA *modelData = state->data->modelData;
   UA_Double val;
-  int latestValues = state->latestValues;
+  unsigned int seq;
 
   if (nodeid.identifierType != UA_NODEIDTYPE_NUMERIC) {
     BAD_RESULT()
     return UA_STATUSCODE_BADNODEIDUNKNOWN;
   }
 
-  pthread_mutex_lock(&state->mutex_values[latestValues]);
-
   if (nodeid.identifier.numeric==OMC_OPC_NODEID_TIME) {
-    val = state->time[latestValues];
+    do {
+      seq = valuesReadBegin(state);
+      val = state->time;
+    } while (valuesReadRetry(state, seq));
   } else if (nodeid.identifier.numeric==OMC_OPC_NODEID_REAL_TIME_SCALING_FACTOR) {
     val = state->real_time_sync_scaling;
   } else if (nodeid.identifier.numeric >= VARKIND_REAL*MAX_VARS_KIND && nodeid.identifier.numeric < (1+VARKIND_REAL)*MAX_VARS_KIND) {
     int index1 = nodeid.identifier.numeric-VARKIND_REAL*MAX_VARS_KIND;
     int index = index1 >= ALIAS_START_ID ? modelData->realAlias[index1-ALIAS_START_ID].nameID : index1;
     int negate = index1 >= ALIAS_START_ID ? modelData->realAlias[index1-ALIAS_START_ID].negate : 0;
-    val = state->realVals[latestValues][index];
+    do {
+      seq = valuesReadBegin(state);
+      val = state->realVals[index];
+    } while (valuesReadRetry(state, seq));
     val = negate ? -val : val;
   } else {
-    pthread_mutex_unlock(&state->mutex_values[latestValues]);
     BAD_RESULT()
     return UA_STATUSCODE_BADNODEIDUNKNOWN;
   }
-  pthread_mutex_unlock(&state->mutex_values[latestValues]);
 
   dataValue->hasValue = UA_TRUE;
   UA_Variant_setScalarCopy(&dataValue->value, &val, &UA_TYPES[UA_TYPES_DOUBLE]);
@@ -267,11 +305,13 @@ writeReal(void *handle, const UA_NodeId nodeid, const UA_Variant *data, const UA
       if (state->data->simulationInfo->inputVars[inputIndex] != newVal) {
         state->gotNewInput = 1;
         state->inputVarsBackup[inputIndex] = newVal;
+        __atomic_store_n(&state->pendingWrites, 1, __ATOMIC_RELEASE);
       }
     } else if (index < state->data->modelData->nStates) {
       state->reinitStateFlag = 1;
       state->stateWasUpdatedFlag[index] = 1;
       state->updatedStates[index] = newVal;
+      __atomic_store_n(&state->pendingWrites, 1, __ATOMIC_RELEASE);
     } else {
       BAD_RESULT()
       pthread_mutex_unlock(&state->write_values);
@@ -306,7 +346,7 @@ static inline omc_opc_ua_state* addVars(omc_opc_ua_state *state, var_kind_t varK
     case VARKIND_REAL:
     {
       STATIC_REAL_DATA *realVarsData = modelData->realVarsData;
-      state->realVals[state->latestValues][*varIndex] = ((double*)vars)[i];
+      state->realVals[*varIndex] = ((double*)vars)[i];
       inputIndex = realVarsData[i].info.inputIndex;
       state->realValsInputIndex[*varIndex] = inputIndex;
       nameStr = (char*) realVarsData[i].info.name;
@@ -318,7 +358,7 @@ static inline omc_opc_ua_state* addVars(omc_opc_ua_state *state, var_kind_t varK
     case VARKIND_BOOL:
     {
       STATIC_BOOLEAN_DATA *booleanVarsData = modelData->booleanVarsData;
-      state->boolVals[state->latestValues][*varIndex] = ((int*)vars)[i];
+      state->boolVals[*varIndex] = ((modelica_boolean*)vars)[i];
       inputIndex = booleanVarsData[i].info.inputIndex;
       state->boolValsInputIndex[*varIndex] = inputIndex;
       nameStr = (char*) booleanVarsData[i].info.name;
@@ -487,17 +527,13 @@ void* omc_embedded_server_init(DATA *data, double t, double step, const char *ar
   state->real_time_sync_scaling = data->real_time_sync.scaling;
 
   state->server_running = 1;
-  state->time[0] = t;
-  state->time[1] = t;
+  state->valuesSeq = 0;
+  state->time = t;
   state->omc_real_time_sync_update = omc_real_time_sync_update;
 
   pthread_cond_init(&state->cond_pause, NULL);
   pthread_mutex_init(&state->mutex_pause, NULL);
   pthread_mutex_init(&state->write_values, NULL);
-  pthread_mutex_init(&state->mutex_values[0], NULL);
-  pthread_mutex_init(&state->mutex_values[1], NULL);
-
-  state->latestValues = 0;
 
   state->run = 0;
   state->step = 0;
@@ -583,14 +619,15 @@ void* omc_embedded_server_init(DATA *data, double t, double step, const char *ar
                                       timeName, UA_NODEID_NULL, timeAttr, timeDataSource, NULL);
 
   state->gotNewInput = 0;
+  state->pendingWrites = 0;
   state->inputVarsBackup = malloc(modelData->nInputVars * sizeof(double));
   memcpy(state->inputVarsBackup, data->simulationInfo->inputVars, modelData->nInputVars * sizeof(double));
-  state->realVals[0] = malloc(modelData->nVariablesReal * sizeof(UA_Double));
-  state->realVals[1] = malloc(modelData->nVariablesReal * sizeof(UA_Double));
+  state->realVals = malloc(modelData->nVariablesReal * sizeof(UA_Double));
   state->realValsInputIndex = malloc(modelData->nVariablesReal * sizeof(int));
-  state->boolVals[0] = malloc(modelData->nVariablesBoolean * sizeof(UA_Boolean));
-  state->boolVals[1] = malloc(modelData->nVariablesBoolean * sizeof(UA_Boolean));
+  state->changedReal = malloc(modelData->nVariablesReal * sizeof(int));
+  state->boolVals = malloc(modelData->nVariablesBoolean * sizeof(UA_Boolean));
   state->boolValsInputIndex = malloc(modelData->nVariablesBoolean * sizeof(int));
+  state->changedBool = malloc(modelData->nVariablesBoolean * sizeof(int));
 
   state->reinitStateFlag = 0;
   state->stateWasUpdatedFlag = (int*) calloc(sizeof(int), modelData->nStates);
@@ -625,52 +662,69 @@ void omc_embedded_server_deinit(void *state_vp)
   state->nl.deleteMembers(&state->nl);
   pthread_mutex_destroy(&state->mutex_pause);
   pthread_mutex_destroy(&state->write_values);
-  pthread_mutex_destroy(&state->mutex_values[0]);
-  pthread_mutex_destroy(&state->mutex_values[1]);
   pthread_cond_destroy(&state->cond_pause);
   free(state->inputVarsBackup);
-  free(state->realVals[0]);
-  free(state->realVals[1]);
+  free(state->realVals);
   free(state->realValsInputIndex);
-  free(state->boolVals[0]);
-  free(state->boolVals[1]);
+  free(state->changedReal);
+  free(state->boolVals);
   free(state->boolValsInputIndex);
+  free(state->changedBool);
+  free(state->stateWasUpdatedFlag);
+  free(state->updatedStates);
   free(state);
 }
 
 int omc_embedded_server_update(void *state_vp, double t)
 {
   omc_opc_ua_state *state = (omc_opc_ua_state*) state_vp;
-  int i, realIndex=0, boolIndex=0, res=0;
+  int i, nChangedReal=0, nChangedBool=0, res=0;
   DATA *data = state->data;
   MODEL_DATA *modelData = data->modelData;
-  int latestValues;
+  modelica_real *realVars = (data->localData[0])->realVars;
+  modelica_boolean *booleanVars = (data->localData[0])->booleanVars;
 
   waitForStep(state);
 
-  pthread_mutex_lock(&state->mutex_values[state->latestValues ? 0 : 1]);
-  latestValues = state->latestValues;
-  state->latestValues = state->latestValues ? 0 : 1;
-
-  state->time[latestValues] = t;
+  /* Only the simulation thread writes the published values, so they can be compared without
+   * the lock. Only the changed values are written while the readers have to wait. */
+  for (i = 0; i < modelData->nVariablesReal; i++) {
+    if (state->realVals[i] != realVars[i]) {
+      state->changedReal[nChangedReal++] = i;
+    }
+  }
+  for (i = 0; i < modelData->nVariablesBoolean; i++) {
+    if (state->boolVals[i] != booleanVars[i]) {
+      state->changedBool[nChangedBool++] = i;
+    }
+  }
 
-  for (i = 0; i < modelData->nVariablesReal; i++, realIndex++) {
-    state->realVals[latestValues][realIndex] = (data->localData[0])->realVars[i];
+  valuesWriteBegin(state);
+  state->time = t;
+  for (i = 0; i < nChangedReal; i++) {
+    state->realVals[state->changedReal[i]] = realVars[state->changedReal[i]];
+  }
+  for (i = 0; i < nChangedBool; i++) {
+    state->boolVals[state->changedBool[i]] = booleanVars[state->changedBool[i]];
   }
-  for (i = 0; i < modelData->nVariablesReal; i++, boolIndex++) {
-    state->boolVals[latestValues][boolIndex] = (data->localData[0])->booleanVars[i];
+  valuesWriteEnd(state);
+
+  if (!__atomic_load_n(&state->pendingWrites, __ATOMIC_ACQUIRE)) {
+    return res;
   }
 
-  pthread_mutex_unlock(&state->mutex_values[latestValues]);
   pthread_mutex_lock(&state->write_values);
+  state->pendingWrites = 0;
 
   if (state->gotNewInput) {
     res = 1; /* Trigger an event in the solver, restarting it */
+    state->gotNewInput = 0;
     memcpy(data->simulationInfo->inputVars, state->inputVarsBackup, modelData->nInputVars * sizeof(double));
   }
 
   if (state->reinitStateFlag) {
     res = 1; /* Trigger an event in the solver, restarting it */
+    state->reinitStateFlag = 0;
     for (i = 0; i < modelData->nStates; i++) {
       if (state->stateWasUpdatedFlag[i]) {
         state->stateWasUpdatedFlag[i] = 0;